@@ -0,0 +1,53 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/CompactInstructions.cpp" "CMakeFiles/ShitCore.dir/src/CompactInstructions.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/CompactInstructions.cpp.o.d"
+  "/root/repo/src/ControlFlowGraph.cpp" "CMakeFiles/ShitCore.dir/src/ControlFlowGraph.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/ControlFlowGraph.cpp.o.d"
+  "/root/repo/src/DeadCodeEliminator.cpp" "CMakeFiles/ShitCore.dir/src/DeadCodeEliminator.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/DeadCodeEliminator.cpp.o.d"
+  "/root/repo/src/Function.cpp" "CMakeFiles/ShitCore.dir/src/Function.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Function.cpp.o.d"
+  "/root/repo/src/Fusion.cpp" "CMakeFiles/ShitCore.dir/src/Fusion.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Fusion.cpp.o.d"
+  "/root/repo/src/IO.cpp" "CMakeFiles/ShitCore.dir/src/IO.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/IO.cpp.o.d"
+  "/root/repo/src/Instruction.cpp" "CMakeFiles/ShitCore.dir/src/Instruction.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Instruction.cpp.o.d"
+  "/root/repo/src/Mapping.cpp" "CMakeFiles/ShitCore.dir/src/Mapping.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Mapping.cpp.o.d"
+  "/root/repo/src/Memory.cpp" "CMakeFiles/ShitCore.dir/src/Memory.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Memory.cpp.o.d"
+  "/root/repo/src/Object.cpp" "CMakeFiles/ShitCore.dir/src/Object.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Object.cpp.o.d"
+  "/root/repo/src/OffsetIndex.cpp" "CMakeFiles/ShitCore.dir/src/OffsetIndex.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/OffsetIndex.cpp.o.d"
+  "/root/repo/src/PeepholeOptimizer.cpp" "CMakeFiles/ShitCore.dir/src/PeepholeOptimizer.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/PeepholeOptimizer.cpp.o.d"
+  "/root/repo/src/StringPool.cpp" "CMakeFiles/ShitCore.dir/src/StringPool.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/StringPool.cpp.o.d"
+  "/root/repo/src/Structure.cpp" "CMakeFiles/ShitCore.dir/src/Structure.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Structure.cpp.o.d"
+  "/root/repo/src/Type.cpp" "CMakeFiles/ShitCore.dir/src/Type.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/Type.cpp.o.d"
+  "/root/repo/src/core/ByteFile.cpp" "CMakeFiles/ShitCore.dir/src/core/ByteFile.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/ByteFile.cpp.o.d"
+  "/root/repo/src/core/CTranslator.cpp" "CMakeFiles/ShitCore.dir/src/core/CTranslator.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/CTranslator.cpp.o.d"
+  "/root/repo/src/core/ConstantFolder.cpp" "CMakeFiles/ShitCore.dir/src/core/ConstantFolder.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/ConstantFolder.cpp.o.d"
+  "/root/repo/src/core/ConstantPool.cpp" "CMakeFiles/ShitCore.dir/src/core/ConstantPool.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/ConstantPool.cpp.o.d"
+  "/root/repo/src/core/FrameAnalyzer.cpp" "CMakeFiles/ShitCore.dir/src/core/FrameAnalyzer.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/FrameAnalyzer.cpp.o.d"
+  "/root/repo/src/core/FunctionMap.cpp" "CMakeFiles/ShitCore.dir/src/core/FunctionMap.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/FunctionMap.cpp.o.d"
+  "/root/repo/src/core/Inliner.cpp" "CMakeFiles/ShitCore.dir/src/core/Inliner.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/Inliner.cpp.o.d"
+  "/root/repo/src/core/LinkedImage.cpp" "CMakeFiles/ShitCore.dir/src/core/LinkedImage.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/LinkedImage.cpp.o.d"
+  "/root/repo/src/core/MappedFile.cpp" "CMakeFiles/ShitCore.dir/src/core/MappedFile.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/MappedFile.cpp.o.d"
+  "/root/repo/src/core/ModuleBase.cpp" "CMakeFiles/ShitCore.dir/src/core/ModuleBase.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/ModuleBase.cpp.o.d"
+  "/root/repo/src/core/Parser.cpp" "CMakeFiles/ShitCore.dir/src/core/Parser.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/Parser.cpp.o.d"
+  "/root/repo/src/core/ReferenceInterpreter.cpp" "CMakeFiles/ShitCore.dir/src/core/ReferenceInterpreter.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/ReferenceInterpreter.cpp.o.d"
+  "/root/repo/src/core/RegisterCode.cpp" "CMakeFiles/ShitCore.dir/src/core/RegisterCode.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/RegisterCode.cpp.o.d"
+  "/root/repo/src/core/SSA.cpp" "CMakeFiles/ShitCore.dir/src/core/SSA.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/SSA.cpp.o.d"
+  "/root/repo/src/core/TemplateJit.cpp" "CMakeFiles/ShitCore.dir/src/core/TemplateJit.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/TemplateJit.cpp.o.d"
+  "/root/repo/src/core/ThreadedFunction.cpp" "CMakeFiles/ShitCore.dir/src/core/ThreadedFunction.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/ThreadedFunction.cpp.o.d"
+  "/root/repo/src/core/Verifier.cpp" "CMakeFiles/ShitCore.dir/src/core/Verifier.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/Verifier.cpp.o.d"
+  "/root/repo/src/core/Version.cpp" "CMakeFiles/ShitCore.dir/src/core/Version.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/Version.cpp.o.d"
+  "/root/repo/src/core/Writer.cpp" "CMakeFiles/ShitCore.dir/src/core/Writer.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/Writer.cpp.o.d"
+  "/root/repo/src/core/virtual/VirtualFunction.cpp" "CMakeFiles/ShitCore.dir/src/core/virtual/VirtualFunction.cpp.o" "gcc" "CMakeFiles/ShitCore.dir/src/core/virtual/VirtualFunction.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
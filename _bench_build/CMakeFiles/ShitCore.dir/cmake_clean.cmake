@@ -0,0 +1,79 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ShitCore.dir/src/CompactInstructions.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/CompactInstructions.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/ControlFlowGraph.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/ControlFlowGraph.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/DeadCodeEliminator.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/DeadCodeEliminator.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Function.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Function.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Fusion.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Fusion.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/IO.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/IO.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Instruction.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Instruction.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Mapping.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Mapping.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Memory.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Memory.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Object.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Object.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/OffsetIndex.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/OffsetIndex.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/PeepholeOptimizer.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/PeepholeOptimizer.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/StringPool.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/StringPool.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Structure.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Structure.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/Type.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/Type.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/ByteFile.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/ByteFile.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/CTranslator.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/CTranslator.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/ConstantFolder.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/ConstantFolder.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/ConstantPool.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/ConstantPool.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/FrameAnalyzer.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/FrameAnalyzer.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/FunctionMap.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/FunctionMap.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/Inliner.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/Inliner.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/LinkedImage.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/LinkedImage.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/MappedFile.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/MappedFile.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/ModuleBase.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/ModuleBase.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/Parser.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/Parser.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/ReferenceInterpreter.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/ReferenceInterpreter.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/RegisterCode.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/RegisterCode.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/SSA.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/SSA.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/TemplateJit.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/TemplateJit.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/ThreadedFunction.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/ThreadedFunction.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/Verifier.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/Verifier.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/Version.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/Version.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/Writer.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/Writer.cpp.o.d"
+  "CMakeFiles/ShitCore.dir/src/core/virtual/VirtualFunction.cpp.o"
+  "CMakeFiles/ShitCore.dir/src/core/virtual/VirtualFunction.cpp.o.d"
+  "libShitCore.a"
+  "libShitCore.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ShitCore.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ShitCoreBench.dir/bench/Bench.cpp.o"
+  "CMakeFiles/ShitCoreBench.dir/bench/Bench.cpp.o.d"
+  "lib/ShitCoreBench"
+  "lib/ShitCoreBench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ShitCoreBench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,373 @@
+#include <svm/CompactInstructions.hpp>
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/Function.hpp>
+#include <svm/IO.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/Structure.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/ConstantPool.hpp>
+#include <svm/core/Loader.hpp>
+#include <svm/core/Parser.hpp>
+#include <svm/core/ReferenceInterpreter.hpp>
+#include <svm/core/RegisterCode.hpp>
+#include <svm/core/Writer.hpp>
+#include <svm/core/virtual/VirtualFunction.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <initializer_list>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace svm;
+using namespace svm::core;
+
+namespace {
+	using BenchLoader = Loader<VirtualFunctionInfo>;
+
+	using BenchInterpreter = ReferenceInterpreter<VirtualFunctionInfo>;
+
+	struct BenchOptions final {
+		int Runs = 5;
+		std::uint32_t FunctionCount = 256;
+		std::uint32_t BlockCount = 340;
+		std::vector<std::filesystem::path> Paths;
+	};
+
+	template<typename F>
+	void Measure(std::string_view name, int runs, std::uint64_t items, F&& function) {
+		std::vector<double> times;
+		for (int i = 0; i < runs; ++i) {
+			const auto begin = std::chrono::steady_clock::now();
+			function();
+			const auto end = std::chrono::steady_clock::now();
+			times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+		}
+		std::sort(times.begin(), times.end());
+
+		std::cout << "    " << name << ": min " << times.front() << " ms, median " << times[times.size() / 2] << " ms";
+		if (items) {
+			std::cout << ", " << static_cast<double>(items) / times.front() / 1000 << " M/s";
+		}
+		std::cout << '\n';
+	}
+
+	std::uint64_t GetInstructionCount(const Functions& functions) {
+		std::uint64_t result = 0;
+		for (const FunctionInfo& function : functions) {
+			result += function.Instructions.GetInstructionCount();
+		}
+		return result;
+	}
+
+	// A function of blockCount blocks that count up to the argument. Every fourth block jumps back three blocks,
+	// so the function has nested loops for the graph and register benchmarks.
+	Instructions MakeSyntheticFunction(std::uint32_t blockCount) {
+		constexpr std::uint32_t blockSize = 12;
+
+		Instructions result;
+		for (std::uint32_t i = 0; i <= blockCount; ++i) {
+			result.AddLabel(4 + static_cast<std::uint64_t>(i) * blockSize);
+		}
+
+		const auto add = [&result](OpCode opCode, std::uint32_t operand = 0) {
+			result.AddInstruction(Instruction(opCode, operand, static_cast<std::uint64_t>(0)));
+		};
+		add(OpCode::Push, 0); add(OpCode::Store, 1);
+		add(OpCode::Push, 0); add(OpCode::Store, 2);
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			add(OpCode::Load, 2); add(OpCode::Push, 1); add(OpCode::Add); add(OpCode::Store, 2);
+			add(OpCode::Load, 1); add(OpCode::Load, 2); add(OpCode::Xor); add(OpCode::Store, 1);
+			add(OpCode::Load, 2); add(OpCode::Load, 0); add(OpCode::Cmp);
+			add(OpCode::Jb, i % 4 == 3 ? i - 3 : i + 1);
+		}
+		add(OpCode::Load, 1); add(OpCode::Ret);
+
+		result.UpdateOffsets();
+		return result;
+	}
+	std::filesystem::path WriteSyntheticModule(const BenchOptions& options) {
+		std::deque<std::string> names;
+		ConstantPool constantPool;
+		constantPool.AddIntConstant(0);
+		constantPool.AddIntConstant(1);
+
+		Functions functions;
+		for (std::uint32_t i = 0; i < options.FunctionCount; ++i) {
+			functions.emplace_back(names.emplace_back("f" + std::to_string(i)), 1, true, MakeSyntheticFunction(options.BlockCount));
+		}
+
+		Instructions entrypoint;
+		entrypoint.AddInstruction(Instruction(OpCode::Ret, static_cast<std::uint64_t>(0)));
+
+		const auto path = std::filesystem::temp_directory_path() / "ShitCoreBench.sbf";
+		Writer writer;
+		writer.Write(ByteFile(path.string(), {}, std::move(constantPool), Structures(), std::move(functions), Mappings(), std::move(entrypoint)));
+		writer.Save(path);
+		return path;
+	}
+
+	// The programs run by the interpreter benchmark: a recursive call, a counting loop, field access through a pointer
+	// and a walk over an array.
+	std::filesystem::path WriteProgramModule() {
+		const auto structure = static_cast<std::uint32_t>(TypeCode::Structure);
+		const auto intCode = static_cast<std::uint32_t>(TypeCode::Int);
+
+		ConstantPool constantPool;
+		constantPool.AddIntConstant(0);
+		constantPool.AddIntConstant(1);
+		constantPool.AddIntConstant(2);
+
+		Structures structures;
+		ArenaVector<Field> fields;
+		fields.push_back(Field{ 0, IntType, 0 });
+		fields.push_back(Field{ 0, LongType, 0 });
+		structures.emplace_back("Point", std::move(fields), TypeInfo("Point", TypeCode::Structure, 0));
+
+		Functions functions;
+		const auto addFunction = [&functions](std::string_view name, std::initializer_list<std::uint64_t> labels,
+			std::initializer_list<std::pair<OpCode, std::uint32_t>> insts) {
+			Instructions instructions;
+			for (const std::uint64_t label : labels) {
+				instructions.AddLabel(label);
+			}
+			for (const auto& [opCode, operand] : insts) {
+				instructions.AddInstruction(Instruction(opCode, operand, static_cast<std::uint64_t>(0)));
+			}
+			instructions.UpdateOffsets();
+			functions.emplace_back(name, 1, true, std::move(instructions));
+		};
+		addFunction("fib", { 6 }, {
+			{ OpCode::Load, 0 }, { OpCode::Push, 2 }, { OpCode::ICmp, 0 }, { OpCode::Jae, 0 }, { OpCode::Load, 0 }, { OpCode::Ret, 0 },
+			{ OpCode::Load, 0 }, { OpCode::Push, 1 }, { OpCode::Sub, 0 }, { OpCode::Call, 0 },
+			{ OpCode::Load, 0 }, { OpCode::Push, 2 }, { OpCode::Sub, 0 }, { OpCode::Call, 0 }, { OpCode::Add, 0 }, { OpCode::Ret, 0 },
+		});
+		addFunction("loop", { 4, 16 }, {
+			{ OpCode::Push, 0 }, { OpCode::Store, 1 }, { OpCode::Push, 0 }, { OpCode::Store, 2 },
+			{ OpCode::Load, 2 }, { OpCode::Load, 0 }, { OpCode::Cmp, 0 }, { OpCode::Jae, 1 },
+			{ OpCode::Load, 1 }, { OpCode::Load, 2 }, { OpCode::Add, 0 }, { OpCode::Store, 1 },
+			{ OpCode::Load, 2 }, { OpCode::Inc, 0 }, { OpCode::Store, 2 }, { OpCode::Jmp, 0 },
+			{ OpCode::Load, 1 }, { OpCode::Ret, 0 },
+		});
+		addFunction("struct", { 4, 20 }, {
+			{ OpCode::New, structure }, { OpCode::Store, 1 }, { OpCode::Push, 0 }, { OpCode::Store, 2 },
+			{ OpCode::Load, 2 }, { OpCode::Load, 0 }, { OpCode::Cmp, 0 }, { OpCode::Jae, 1 },
+			{ OpCode::Load, 1 }, { OpCode::FLea, 0 }, { OpCode::TLoad, 0 }, { OpCode::Load, 2 }, { OpCode::Add, 0 },
+			{ OpCode::Load, 1 }, { OpCode::FLea, 0 }, { OpCode::TStore, 0 },
+			{ OpCode::Load, 2 }, { OpCode::Inc, 0 }, { OpCode::Store, 2 }, { OpCode::Jmp, 0 },
+			{ OpCode::Load, 1 }, { OpCode::FLea, 0 }, { OpCode::TLoad, 0 }, { OpCode::Load, 1 }, { OpCode::Delete, 0 }, { OpCode::Ret, 0 },
+		});
+		addFunction("array", { 5, 18, 22, 37 }, {
+			{ OpCode::Load, 0 }, { OpCode::ANew, intCode }, { OpCode::Store, 1 }, { OpCode::Push, 0 }, { OpCode::Store, 2 },
+			{ OpCode::Load, 2 }, { OpCode::Load, 0 }, { OpCode::Cmp, 0 }, { OpCode::Jae, 1 },
+			{ OpCode::Load, 2 }, { OpCode::Load, 1 }, { OpCode::Load, 2 }, { OpCode::ALea, 0 }, { OpCode::TStore, 0 },
+			{ OpCode::Load, 2 }, { OpCode::Inc, 0 }, { OpCode::Store, 2 }, { OpCode::Jmp, 0 },
+			{ OpCode::Push, 0 }, { OpCode::Store, 3 }, { OpCode::Push, 0 }, { OpCode::Store, 2 },
+			{ OpCode::Load, 2 }, { OpCode::Load, 0 }, { OpCode::Cmp, 0 }, { OpCode::Jae, 3 },
+			{ OpCode::Load, 3 }, { OpCode::Load, 1 }, { OpCode::Load, 2 }, { OpCode::ALea, 0 }, { OpCode::TLoad, 0 }, { OpCode::Add, 0 }, { OpCode::Store, 3 },
+			{ OpCode::Load, 2 }, { OpCode::Inc, 0 }, { OpCode::Store, 2 }, { OpCode::Jmp, 2 },
+			{ OpCode::Load, 1 }, { OpCode::Delete, 0 }, { OpCode::Load, 3 }, { OpCode::Ret, 0 },
+		});
+
+		Instructions entrypoint;
+		entrypoint.AddInstruction(Instruction(OpCode::Ret, static_cast<std::uint64_t>(0)));
+
+		const auto path = std::filesystem::temp_directory_path() / "ShitCoreBenchPrograms.sbf";
+		Writer writer;
+		writer.Write(ByteFile(path.string(), {}, std::move(constantPool), std::move(structures), std::move(functions), Mappings(), std::move(entrypoint)));
+		writer.Save(path);
+		return path;
+	}
+
+	std::vector<std::uint8_t> ReadBytes(const std::filesystem::path& path) {
+		std::ifstream stream(path, std::ifstream::binary);
+		if (!stream) throw std::runtime_error("Failed to open the file.");
+
+		return { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+	}
+
+	void BenchParse(const BenchOptions& options, const std::filesystem::path& path) {
+		const std::vector<std::uint8_t> bytes = ReadBytes(path);
+		const auto parse = [&bytes, &path](const ParseOptions& parseOptions, bool decode) {
+			Parser parser;
+			parser.SetOptions(parseOptions);
+			parser.Open(bytes.data(), bytes.size(), path);
+			parser.Parse();
+
+			const ByteFile byteFile = parser.GetResult();
+			return decode ? GetInstructionCount(byteFile.GetFunctions()) : 0;
+		};
+		const std::uint64_t instCount = parse({}, true);
+
+		std::cout << "  parse (" << bytes.size() << " bytes, " << instCount << " instructions):\n";
+		ParseOptions parseOptions;
+		Measure("sequential", options.Runs, instCount, [&] { parse(parseOptions, false); });
+		parseOptions.ParallelFunctions = true;
+		Measure("parallel", options.Runs, instCount, [&] { parse(parseOptions, false); });
+		parseOptions.ParallelFunctions = false;
+		parseOptions.LazyFunctions = true;
+		Measure("lazy", options.Runs, 0, [&] { parse(parseOptions, false); });
+		Measure("lazy, then decoded", options.Runs, instCount, [&] { parse(parseOptions, true); });
+	}
+	void BenchLayout(const BenchOptions& options, const Functions& functions) {
+		const std::uint64_t instCount = GetInstructionCount(functions);
+		std::vector<CompactInstructions> compacts;
+		Measure("CompactInstructions, built", options.Runs, instCount, [&] {
+			compacts.clear();
+			for (const FunctionInfo& function : functions) {
+				compacts.emplace_back(function.Instructions);
+			}
+		});
+
+		std::size_t compactSize = 0;
+		for (const CompactInstructions& instructions : compacts) {
+			compactSize += instructions.GetMemoryUsage();
+		}
+
+		std::cout << "    memory: " << instCount * sizeof(Instruction) << " bytes as Instruction, " << compactSize << " bytes compact\n";
+
+		volatile std::uint64_t sink = 0;
+		Measure("Instructions, scanned", options.Runs, instCount, [&] {
+			std::uint64_t result = 0;
+			for (const FunctionInfo& function : functions) {
+				const Instructions& instructions = function.Instructions;
+				const std::uint64_t count = instructions.GetInstructionCount();
+				for (std::uint64_t i = 0; i < count; ++i) {
+					const Instruction& inst = instructions.GetInstruction(i);
+					result += static_cast<std::uint8_t>(inst.OpCode) + inst.Operand;
+				}
+			}
+			sink = result;
+		});
+		Measure("CompactInstructions, scanned", options.Runs, instCount, [&] {
+			std::uint64_t result = 0;
+			for (const CompactInstructions& instructions : compacts) {
+				const OpCode* const opCodes = instructions.GetOpCodes();
+				const std::uint32_t* const operands = instructions.GetOperands();
+				const std::uint64_t count = instructions.GetInstructionCount();
+				for (std::uint64_t i = 0; i < count; ++i) {
+					result += static_cast<std::uint8_t>(opCodes[i]) + operands[i];
+				}
+			}
+			sink = result;
+		});
+	}
+	void BenchGraph(const BenchOptions& options, const Functions& functions) {
+		std::uint64_t blockCount = 0;
+		Measure("built", options.Runs, GetInstructionCount(functions), [&] {
+			blockCount = 0;
+			for (const FunctionInfo& function : functions) {
+				blockCount += ControlFlowGraph(function.Instructions).GetBlockCount();
+			}
+		});
+		std::cout << "    blocks: " << blockCount << '\n';
+	}
+	void BenchRegisterCode(const BenchOptions& options, const ModuleInfo<VirtualFunctionInfo>& module) {
+		std::vector<RegisterCode> registerCodes;
+		RegisterCodeStatistics statistics;
+		Measure("translated", options.Runs, GetInstructionCount(std::get<ByteFile>(module.Module).GetFunctions()), [&] {
+			statistics = module.BuildRegisterCode(registerCodes, 16);
+		});
+		std::cout << Indent << Indent << statistics << UnIndent << UnIndent << '\n';
+	}
+
+	void BenchPrograms(const BenchOptions& options) {
+		ParseOptions parseOptions;
+		parseOptions.Verification = true;
+		BenchLoader loader;
+		loader.SetParseOptions(parseOptions);
+
+		const auto module = loader.Load(WriteProgramModule());
+		const std::pair<std::string_view, std::uint32_t> programs[] = {
+			{ "fib", 25 }, { "loop", 1000000 }, { "struct", 1000000 }, { "array", 100000 },
+		};
+
+		std::cout << "programs:\n";
+		for (const auto& [name, argument] : programs) {
+			const FunctionInfo& function = *std::get<Function>(module->GetFunction(name));
+			const std::string title = std::string(name) + '(' + std::to_string(argument) + ')';
+
+			BenchInterpreter interpreter(loader);
+			ReferenceValue result;
+			Measure(title, options.Runs, 0, [&] {
+				result = interpreter.Call(function, { ReferenceValue(argument) });
+			});
+			std::cout << "      result: " << result << '\n';
+
+			// Where the JIT is available, its result is checked against the interpreter's. A low hot count makes
+			// compiled code and its exits run as well.
+			if (!TemplateCompiler::IsSupported()) continue;
+
+			BenchInterpreter jitInterpreter(loader);
+			jitInterpreter.SetJitOptions({ true, 2 });
+			ReferenceValue jitResult;
+			Measure(title + ", JIT", options.Runs, 0, [&] {
+				jitResult = jitInterpreter.Call(function, { ReferenceValue(argument) });
+			});
+			if (jitInterpreter.GetJitStatistics().Compiled == 0 || jitResult.Type != result.Type || jitResult.IntValue != result.IntValue)
+				throw std::runtime_error("Failed to check " + title + ". The JIT result differs from the interpreter result.");
+		}
+	}
+
+	void BenchModule(const BenchOptions& options, const std::filesystem::path& path) {
+		std::cout << path.string() << ":\n";
+		BenchParse(options, path);
+
+		ParseOptions parseOptions;
+		parseOptions.Verification = true;
+		BenchLoader loader;
+		loader.SetParseOptions(parseOptions);
+
+		const auto module = loader.Load(path);
+		const Functions& functions = std::get<ByteFile>(module->Module).GetFunctions();
+
+		std::cout << "  layout:\n";
+		BenchLayout(options, functions);
+		std::cout << "  control flow graph:\n";
+		BenchGraph(options, functions);
+		std::cout << "  register code:\n";
+		BenchRegisterCode(options, *module);
+	}
+}
+
+// Usage: ShitCoreBench [-r runs] [byte files...]
+// Without byte files, the interpreter programs are run, and a synthetic module of 256 functions of about 4,000
+// instructions is written to the temporary directory and measured instead.
+int main(int argc, char* argv[]) {
+	BenchOptions options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "-r" && i + 1 < argc) {
+			options.Runs = std::max(std::atoi(argv[++i]), 1);
+		} else {
+			options.Paths.push_back(arg);
+		}
+	}
+
+	try {
+		if (options.Paths.empty()) {
+			BenchPrograms(options);
+			options.Paths.push_back(WriteSyntheticModule(options));
+		}
+		for (const auto& path : options.Paths) {
+			BenchModule(options, path);
+		}
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
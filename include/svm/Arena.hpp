@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace svm {
+	template<typename T>
+	class ArenaAllocator {
+		template<typename U>
+		friend class ArenaAllocator;
+
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+	private:
+		std::pmr::memory_resource* m_Resource = std::pmr::get_default_resource();
+
+	public:
+		ArenaAllocator() noexcept = default;
+		ArenaAllocator(std::pmr::memory_resource* resource) noexcept;
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& allocator) noexcept;
+		ArenaAllocator(const ArenaAllocator& allocator) noexcept = default;
+		~ArenaAllocator() = default;
+
+	public:
+		ArenaAllocator& operator=(const ArenaAllocator& allocator) noexcept = default;
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& allocator) const noexcept;
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& allocator) const noexcept;
+
+	public:
+		T* allocate(std::size_t count);
+		void deallocate(T* pointer, std::size_t count) noexcept;
+
+		std::pmr::memory_resource* GetResource() const noexcept;
+	};
+
+	template<typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
+
+#include "detail/impl/Arena.hpp"
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <svm/Instruction.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace svm {
+	class CompactInstructions final {
+	public:
+		static constexpr std::size_t OffsetStride = 64;
+
+	private:
+		std::vector<std::uint64_t> m_Labels;
+		std::vector<OpCode> m_OpCodes;
+		std::vector<std::uint32_t> m_Operands;
+		std::vector<std::uint64_t> m_Offsets;
+		std::vector<std::uint8_t> m_OperandIndices;
+
+	public:
+		CompactInstructions() noexcept = default;
+		explicit CompactInstructions(const Instructions& instructions);
+		CompactInstructions(CompactInstructions&& instructions) noexcept = default;
+		~CompactInstructions() = default;
+
+	public:
+		CompactInstructions& operator=(CompactInstructions&& instructions) noexcept = default;
+		bool operator==(const CompactInstructions&) = delete;
+		bool operator!=(const CompactInstructions&) = delete;
+
+	public:
+		void Clear() noexcept;
+
+		std::uint64_t GetLabel(std::uint32_t index) const noexcept;
+		std::uint32_t GetLabelCount() const noexcept;
+		Instruction GetInstruction(std::uint64_t index) const noexcept;
+		std::uint64_t GetInstructionCount() const noexcept;
+
+		OpCode GetOpCode(std::uint64_t index) const noexcept;
+		std::uint32_t GetOperand(std::uint64_t index) const noexcept;
+		std::uint64_t GetOffset(std::uint64_t index) const noexcept;
+		const OpCode* GetOpCodes() const noexcept;
+		const std::uint32_t* GetOperands() const noexcept;
+
+		std::uint32_t AddLabel(std::uint64_t index);
+		std::uint64_t AddInstruction(const Instruction& instruction);
+
+		Instructions ToInstructions() const;
+		std::size_t GetMemoryUsage() const noexcept;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const CompactInstructions& instructions);
+}
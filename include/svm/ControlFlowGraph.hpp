@@ -0,0 +1,100 @@
+#pragma once
+
+#include <svm/Instruction.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace svm {
+	struct BasicBlock final {
+		std::uint64_t Begin = 0;
+		std::uint64_t End = 0;
+	};
+
+	class BlockList final {
+	private:
+		const std::uint32_t* m_Begin = nullptr;
+		const std::uint32_t* m_End = nullptr;
+
+	public:
+		BlockList() noexcept = default;
+		BlockList(const std::uint32_t* begin, const std::uint32_t* end) noexcept;
+		BlockList(const BlockList& list) noexcept = default;
+		~BlockList() = default;
+
+	public:
+		BlockList& operator=(const BlockList& list) noexcept = default;
+		std::uint32_t operator[](std::size_t index) const noexcept;
+
+	public:
+		const std::uint32_t* begin() const noexcept;
+		const std::uint32_t* end() const noexcept;
+		std::size_t size() const noexcept;
+		bool empty() const noexcept;
+	};
+}
+
+namespace svm {
+	class ControlFlowGraph final {
+	public:
+		static constexpr std::uint32_t NPos = std::numeric_limits<std::uint32_t>::max();
+
+	private:
+		std::vector<BasicBlock> m_Blocks;
+		std::vector<std::uint32_t> m_SuccessorOffsets;
+		std::vector<std::uint32_t> m_Successors;
+		std::vector<std::uint32_t> m_PredecessorOffsets;
+		std::vector<std::uint32_t> m_Predecessors;
+
+		std::vector<std::uint32_t> m_ReversePostOrder;
+		std::vector<std::uint32_t> m_ImmediateDominators;
+		std::vector<std::uint32_t> m_DominatorEnter;
+		std::vector<std::uint32_t> m_DominatorLeave;
+
+		std::vector<std::uint32_t> m_LoopHeaders;
+		std::vector<std::uint32_t> m_LoopParents;
+		std::vector<std::uint32_t> m_LoopDepths;
+
+	public:
+		ControlFlowGraph() noexcept = default;
+		explicit ControlFlowGraph(const Instructions& instructions);
+		ControlFlowGraph(ControlFlowGraph&& graph) noexcept = default;
+		~ControlFlowGraph() = default;
+
+	public:
+		ControlFlowGraph& operator=(ControlFlowGraph&& graph) noexcept = default;
+		bool operator==(const ControlFlowGraph&) = delete;
+		bool operator!=(const ControlFlowGraph&) = delete;
+
+	public:
+		void Clear() noexcept;
+		void Build(const Instructions& instructions);
+
+		std::uint32_t GetBlockCount() const noexcept;
+		const BasicBlock& GetBlock(std::uint32_t index) const noexcept;
+		std::uint32_t GetBlockOf(std::uint64_t instruction) const noexcept;
+		BlockList GetSuccessors(std::uint32_t block) const noexcept;
+		BlockList GetPredecessors(std::uint32_t block) const noexcept;
+		BlockList GetReversePostOrder() const noexcept;
+		bool IsReachable(std::uint32_t block) const noexcept;
+
+		std::uint32_t GetImmediateDominator(std::uint32_t block) const noexcept;
+		bool Dominates(std::uint32_t dominator, std::uint32_t block) const noexcept;
+
+		bool IsLoopHeader(std::uint32_t block) const noexcept;
+		std::uint32_t GetLoopHeader(std::uint32_t block) const noexcept;
+		std::uint32_t GetParentLoop(std::uint32_t header) const noexcept;
+		std::uint32_t GetLoopDepth(std::uint32_t block) const noexcept;
+
+	private:
+		void BuildBlocks(const Instructions& instructions);
+		void BuildReversePostOrder();
+		void BuildDominators();
+		void BuildLoops();
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const ControlFlowGraph& graph);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace svm {
+	struct DeadCodeOptions final {
+		bool UnreachableCode = true;
+		bool DeadStores = true;
+		bool UnusedLabels = true;
+		unsigned int MaxIterations = 4;
+	};
+
+	struct DeadCodeStatistics final {
+		std::uint64_t OriginalCount = 0;
+		std::uint64_t ResultCount = 0;
+		std::uint64_t UnreachableInstructions = 0;
+		std::uint64_t DeadStores = 0;
+		std::uint64_t RemovedLabels = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const DeadCodeStatistics& statistics);
+}
+
+namespace svm {
+	class DeadCodeEliminator final {
+	private:
+		DeadCodeOptions m_Options;
+		DeadCodeStatistics m_Statistics;
+
+	public:
+		DeadCodeEliminator() noexcept = default;
+		explicit DeadCodeEliminator(const DeadCodeOptions& options) noexcept;
+		DeadCodeEliminator(const DeadCodeEliminator&) = delete;
+		~DeadCodeEliminator() = default;
+
+	public:
+		DeadCodeEliminator& operator=(const DeadCodeEliminator&) = delete;
+		bool operator==(const DeadCodeEliminator&) = delete;
+		bool operator!=(const DeadCodeEliminator&) = delete;
+
+	public:
+		bool Eliminate(Instructions& instructions);
+		void Eliminate(Functions& functions);
+
+		const DeadCodeOptions& GetOptions() const noexcept;
+		void SetOptions(const DeadCodeOptions& newOptions) noexcept;
+		const DeadCodeStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+
+	private:
+		bool RemoveUnreachableCode(Instructions& instructions);
+		bool RemoveDeadStores(Instructions& instructions);
+	};
+}
@@ -1,27 +1,50 @@
 #pragma once
 
+#include <svm/Arena.hpp>
 #include <svm/Instruction.hpp>
 #include <svm/detail/ReferenceWrapper.hpp>
 
 #include <cstdint>
+#include <limits>
 #include <ostream>
-#include <string>
+#include <string_view>
 #include <vector>
 
+namespace svm {
+	struct FrameInfo final {
+		static constexpr std::uint64_t Unbounded = std::numeric_limits<std::uint64_t>::max();
+
+		bool IsAnalyzed = false;
+		std::uint32_t MaxStackSlots = 0;
+		std::uint64_t MaxStackBytes = 0;
+		std::uint32_t LocalCount = 0;
+	};
+}
+
+namespace svm {
+	enum class VerificationLevel : std::uint8_t {
+		Unverified,
+		Structural,
+		TypeSafe,
+	};
+}
+
 namespace svm {
 	class FunctionInfo final {
 	public:
-		std::string Name;
+		std::string_view Name;
 		std::uint32_t Module = 0;
 		std::uint16_t Arity = 0;
 		bool HasResult = false;
 		svm::Instructions Instructions;
+		FrameInfo Frame;
+		VerificationLevel Verification = VerificationLevel::Unverified;
 
 	public:
 		FunctionInfo() noexcept = default;
-		FunctionInfo(std::string name, std::uint16_t arity, bool hasResult) noexcept;
-		FunctionInfo(std::string name, std::uint16_t arity, svm::Instructions&& instructions) noexcept;
-		FunctionInfo(std::string name, std::uint16_t arity, bool hasResult, svm::Instructions&& instructions) noexcept;
+		FunctionInfo(std::string_view name, std::uint16_t arity, bool hasResult) noexcept;
+		FunctionInfo(std::string_view name, std::uint16_t arity, svm::Instructions&& instructions) noexcept;
+		FunctionInfo(std::string_view name, std::uint16_t arity, bool hasResult, svm::Instructions&& instructions) noexcept;
 		FunctionInfo(FunctionInfo&& functionInfo) noexcept;
 		~FunctionInfo() = default;
 
@@ -40,7 +63,7 @@ namespace svm {
 		using detail::ReferenceWrapper<FunctionInfo>::ReferenceWrapper;
 	};
 
-	using Functions = std::vector<FunctionInfo>;
+	using Functions = ArenaVector<FunctionInfo>;
 
 	std::ostream& operator<<(std::ostream& stream, const Function& function);
 	std::ostream& operator<<(std::ostream& stream, const Functions& functions);
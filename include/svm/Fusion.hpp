@@ -0,0 +1,70 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace svm {
+	struct FusionStatistics final {
+		std::uint64_t OriginalCount = 0;
+		std::uint64_t FusedCount = 0;
+		std::uint64_t ResultCount = 0;
+	};
+
+	// Fusion is an analysis API for sizing a superinstruction set: Fuse reports how many dispatches the fused set
+	// would save. Nothing executes, verifies or stores fused instructions, and the other passes leave fused code
+	// untouched, so fused Instructions must be unfused before they are used again. load; load; cmp; jcc has no
+	// opcode of its own and becomes load.load and cmp.jcc.
+	bool IsFused(OpCode opCode) noexcept;
+	std::uint32_t PackFusedOperands(std::uint32_t first, std::uint32_t second) noexcept;
+	std::uint32_t GetFusedOperand(const Instruction& instruction, std::size_t index) noexcept;
+
+	FusionStatistics Fuse(Instructions& instructions);
+	FusionStatistics Fuse(Functions& functions);
+	void Unfuse(Instructions& instructions);
+	void Unfuse(Functions& functions);
+}
+
+namespace svm {
+	class NGramCounter final {
+	public:
+		static constexpr std::size_t MaxLength = 8;
+
+		struct NGram final {
+			std::vector<OpCode> OpCodes;
+			std::uint64_t Count = 0;
+		};
+
+	private:
+		std::size_t m_Length;
+		std::unordered_map<std::uint64_t, std::uint64_t> m_Counts;
+		std::uint64_t m_TotalCount = 0;
+
+	public:
+		explicit NGramCounter(std::size_t length) noexcept;
+		NGramCounter(NGramCounter&& counter) noexcept = default;
+		~NGramCounter() = default;
+
+	public:
+		NGramCounter& operator=(NGramCounter&& counter) noexcept = default;
+		bool operator==(const NGramCounter&) = delete;
+		bool operator!=(const NGramCounter&) = delete;
+
+	public:
+		void Clear() noexcept;
+
+		void Add(const Instructions& instructions);
+		void Add(const Functions& functions);
+
+		std::size_t GetLength() const noexcept;
+		std::uint64_t GetTotalCount() const noexcept;
+		std::vector<NGram> GetMostFrequent(std::size_t count) const;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const NGramCounter::NGram& nGram);
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <svm/Arena.hpp>
 #include <svm/Specification.hpp>
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <ostream>
 #include <vector>
 
@@ -73,6 +76,26 @@ namespace svm {
 		AGCNew,
 		ALea,
 		Count,
+
+		// Fused, not stored in byte files
+		PushPush,
+		PushPushAdd,
+		LoadLoad,
+		LoadIncStore,
+		LoadDecStore,
+		CmpJe,
+		CmpJne,
+		CmpJa,
+		CmpJae,
+		CmpJb,
+		CmpJbe,
+		ICmpJe,
+		ICmpJne,
+		ICmpJa,
+		ICmpJae,
+		ICmpJb,
+		ICmpJbe,
+		FusedCount,
 	};
 
 	static constexpr const char* Mnemonics[] = {
@@ -84,6 +107,9 @@ namespace svm {
 		"tob", "tosh", "toi", "tol", "tosi", "tod", "top",
 		"null", "new", "delete", "gcnull", "gcnew",
 		"apush", "anew", "agcnew", "alea", "count",
+		"push.push", "push.push.add", "load.load", "load.inc.store", "load.dec.store",
+		"cmp.je", "cmp.jne", "cmp.ja", "cmp.jae", "cmp.jb", "cmp.jbe",
+		"icmp.je", "icmp.jne", "icmp.ja", "icmp.jae", "icmp.jb", "icmp.jbe", "fusedcount",
 	};
 
 	static constexpr bool HasOperand[] = {
@@ -95,10 +121,18 @@ namespace svm {
 		false/*tob*/, false/*tosh*/, false/*toi*/, false/*tol*/, false/*tosi*/, false/*tod*/, false/*top*/,
 		false/*null*/, true/*new*/, false/*delete*/, false/*gcnull*/, true/*gcnew*/,
 		true/*apush*/, true/*anew*/, true/*agcnew*/, false/*alea*/, false/*count*/,
+		true/*push.push*/, true/*push.push.add*/, true/*load.load*/, true/*load.inc.store*/, true/*load.dec.store*/,
+		true/*cmp.je*/, true/*cmp.jne*/, true/*cmp.ja*/, true/*cmp.jae*/, true/*cmp.jb*/, true/*cmp.jbe*/,
+		true/*icmp.je*/, true/*icmp.jne*/, true/*icmp.ja*/, true/*icmp.jae*/, true/*icmp.jb*/, true/*icmp.jbe*/, false/*fusedcount*/,
 	};
 
 	OpCode ConvertOpCode(std::uint8_t opCode, ShitBCVersion version) noexcept;
 	std::uint8_t ConvertOpCode(OpCode opCode, ShitBCVersion version) noexcept;
+
+	bool IsJump(OpCode opCode) noexcept;
+	bool IsConditionalJump(OpCode opCode) noexcept;
+	bool IsTerminator(OpCode opCode) noexcept;
+	bool GetStackEffect(OpCode opCode, std::uint32_t& popCount, std::uint32_t& pushCount) noexcept;
 }
 
 namespace svm {
@@ -133,14 +167,18 @@ namespace svm {
 namespace svm {
 	class Instructions final {
 	private:
-		std::vector<std::uint64_t> m_Labels;
-		std::vector<Instruction> m_Instructions;
+		struct LazyState;
+
+		mutable ArenaVector<std::uint64_t> m_Labels;
+		mutable ArenaVector<Instruction> m_Instructions;
+		std::unique_ptr<LazyState> m_LazyState;
 
 	public:
-		Instructions() noexcept = default;
-		Instructions(std::vector<std::uint64_t> labels, std::vector<Instruction> instructions) noexcept;
+		Instructions() noexcept;
+		Instructions(ArenaVector<std::uint64_t> labels, ArenaVector<Instruction> instructions) noexcept;
+		explicit Instructions(std::function<Instructions()> decoder);
 		Instructions(Instructions&& instructions) noexcept;
-		~Instructions() = default;
+		~Instructions();
 
 	public:
 		Instructions& operator=(Instructions&& instructions) noexcept;
@@ -150,14 +188,24 @@ namespace svm {
 	public:
 		void Clear() noexcept;
 
-		std::uint64_t GetLabel(std::uint32_t index) const noexcept;
-		std::uint32_t GetLabelCount() const noexcept;
-		const Instruction& GetInstruction(std::uint64_t index) const noexcept;
-		std::uint64_t GetInstructionCount() const noexcept;
+		std::uint64_t GetLabel(std::uint32_t index) const;
+		std::uint32_t GetLabelCount() const;
+		const Instruction& GetInstruction(std::uint64_t index) const;
+		std::uint64_t GetInstructionCount() const;
+		std::vector<bool> GetLabelTargets() const;
 
 		std::uint32_t AddLabel(std::uint64_t index);
-		void SetLabel(std::uint32_t index, std::uint64_t label) noexcept;
+		void SetLabel(std::uint32_t index, std::uint64_t label);
 		std::uint64_t AddInstruction(const Instruction& instruction);
+		void SetInstruction(std::uint64_t index, const Instruction& instruction);
+		void SetInstructions(ArenaVector<Instruction> instructions, const std::vector<std::uint64_t>& indexMap);
+		void UpdateOffsets();
+		std::uint32_t CompactLabels();
+
+		bool IsDecoded() const noexcept;
+
+	private:
+		void Decode() const;
 	};
 
 	std::ostream& operator<<(std::ostream& stream, const Instructions& instructions);
@@ -1,16 +1,17 @@
 #pragma once
 
+#include <svm/StringPool.hpp>
 #include <svm/Type.hpp>
 
 #include <cstdint>
 #include <ostream>
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace svm {
 	struct Mapping {
 		std::uint32_t Module;
-		std::string Name;
+		std::string_view Name;
 	};
 
 	std::ostream& operator<<(std::ostream& stream, const Mapping& mapping);
@@ -42,8 +43,8 @@ namespace svm {
 	public:
 		void Clear() noexcept;
 
-		void AddStructureMapping(std::uint32_t module, std::string name);
-		void AddFunctionMapping(std::uint32_t module, std::string name);
+		void AddStructureMapping(std::uint32_t module, std::string_view name, StringPool& stringPool);
+		void AddFunctionMapping(std::uint32_t module, std::string_view name, StringPool& stringPool);
 
 		const StructureMapping& GetStructureMapping(std::uint32_t index) const noexcept;
 		std::uint32_t GetStructureMappingCount() const noexcept;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <svm/Instruction.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace svm {
+	// Maps byte offsets in a function, as Instruction::Offset counts them, back to instruction indices. An offset
+	// inside the operand of an instruction maps to that instruction.
+	class OffsetIndex final {
+	public:
+		static constexpr std::uint64_t NPos = std::numeric_limits<std::uint64_t>::max();
+
+	private:
+		std::vector<std::uint32_t> m_Offsets;
+		std::uint64_t m_Size = 0;
+
+	public:
+		OffsetIndex() noexcept = default;
+		explicit OffsetIndex(const Instructions& instructions);
+		OffsetIndex(OffsetIndex&& index) noexcept = default;
+		~OffsetIndex() = default;
+
+	public:
+		OffsetIndex& operator=(OffsetIndex&& index) noexcept = default;
+		bool operator==(const OffsetIndex&) = delete;
+		bool operator!=(const OffsetIndex&) = delete;
+
+	public:
+		void Clear() noexcept;
+		void Build(const Instructions& instructions);
+
+		std::uint64_t GetInstruction(std::uint64_t offset) const noexcept;
+		std::uint64_t GetOffset(std::uint64_t instruction) const noexcept;
+		std::uint64_t GetInstructionCount() const noexcept;
+		std::uint64_t GetSize() const noexcept;
+	};
+}
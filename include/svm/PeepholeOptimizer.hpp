@@ -0,0 +1,75 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace svm {
+	enum class PeepholePass : std::uint8_t {
+		Nop,
+		PushPop,
+		CopyPop,
+		StoreLoad,
+		DoubleNegation,
+		JumpToNext,
+		Count,
+	};
+
+	static constexpr const char* PeepholePassNames[] = {
+		"nop", "push-pop", "copy-pop", "store-load", "double-negation", "jump-to-next",
+	};
+
+	struct PeepholeOptions final {
+		bool Nop = true;
+		bool PushPop = true;
+		bool CopyPop = true;
+		bool StoreLoad = true;
+		bool DoubleNegation = true;
+		bool JumpToNext = true;
+		unsigned int MaxIterations = 8;
+	};
+
+	struct PeepholeStatistics final {
+		std::uint64_t OriginalCount = 0;
+		std::uint64_t ResultCount = 0;
+		std::uint64_t Removed[static_cast<std::size_t>(PeepholePass::Count)] = {};
+		std::uint64_t Rewritten[static_cast<std::size_t>(PeepholePass::Count)] = {};
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const PeepholeStatistics& statistics);
+}
+
+namespace svm {
+	class PeepholeOptimizer final {
+	private:
+		PeepholeOptions m_Options;
+		PeepholeStatistics m_Statistics;
+
+	public:
+		PeepholeOptimizer() noexcept = default;
+		explicit PeepholeOptimizer(const PeepholeOptions& options) noexcept;
+		PeepholeOptimizer(const PeepholeOptimizer&) = delete;
+		~PeepholeOptimizer() = default;
+
+	public:
+		PeepholeOptimizer& operator=(const PeepholeOptimizer&) = delete;
+		bool operator==(const PeepholeOptimizer&) = delete;
+		bool operator!=(const PeepholeOptimizer&) = delete;
+
+	public:
+		void Optimize(Instructions& instructions);
+		void Optimize(Functions& functions);
+
+		const PeepholeOptions& GetOptions() const noexcept;
+		void SetOptions(const PeepholeOptions& newOptions) noexcept;
+		const PeepholeStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+
+	private:
+		bool IsEnabled(PeepholePass pass) const noexcept;
+		bool Run(Instructions& instructions, PeepholePass pass);
+	};
+}
@@ -9,9 +9,21 @@ namespace svm {
 		v0_3_0,
 		v0_4_0,
 		v0_5_0,
+		v0_6_0,
+		v0_7_0,
 
 		Least = v0_4_0,
-		Latest = v0_5_0,
+		Latest = v0_7_0,
+	};
+
+	enum class ShitBFSection : std::uint32_t {
+		Dependencies,
+		Mappings,
+		ConstantPool,
+		Structures,
+		Functions,
+		Entrypoint,
+		Count,
 	};
 
 	enum class ShitBCVersion : std::uint16_t {
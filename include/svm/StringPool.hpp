@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_set>
+
+namespace svm {
+	class StringPool final {
+	private:
+		std::pmr::monotonic_buffer_resource m_Arena;
+		std::unordered_set<std::string_view> m_Strings;
+
+	public:
+		StringPool() = default;
+		explicit StringPool(std::pmr::memory_resource* upstream);
+		StringPool(const StringPool&) = delete;
+		~StringPool() = default;
+
+	public:
+		StringPool& operator=(const StringPool&) = delete;
+		bool operator==(const StringPool&) = delete;
+		bool operator!=(const StringPool&) = delete;
+
+	public:
+		void Clear() noexcept;
+
+		std::string_view Intern(std::string_view string);
+		std::size_t GetCount() const noexcept;
+	};
+}
@@ -1,12 +1,13 @@
 #pragma once
 
+#include <svm/Arena.hpp>
 #include <svm/Type.hpp>
 #include <svm/detail/ReferenceWrapper.hpp>
 
 #include <cstddef>
 #include <cstdint>
 #include <ostream>
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace svm {
@@ -22,13 +23,13 @@ namespace svm {
 namespace svm {
 	class StructureInfo {
 	public:
-		std::string Name;
-		std::vector<Field> Fields;
+		std::string_view Name;
+		ArenaVector<Field> Fields;
 		TypeInfo Type;
 
 	public:
 		StructureInfo() noexcept = default;
-		StructureInfo(std::string name, std::vector<Field> fields, TypeInfo&& type) noexcept;
+		StructureInfo(std::string_view name, ArenaVector<Field> fields, TypeInfo&& type) noexcept;
 		StructureInfo(StructureInfo&& structInfo) noexcept;
 		~StructureInfo() = default;
 
@@ -47,7 +48,7 @@ namespace svm {
 		using detail::ReferenceWrapper<StructureInfo>::ReferenceWrapper;
 	};
 
-	using Structures = std::vector<StructureInfo>;
+	using Structures = ArenaVector<StructureInfo>;
 
 	Type GetStructureType(const Structures& structures, TypeCode code) noexcept;
 
@@ -4,7 +4,7 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <string>
+#include <string_view>
 
 namespace svm {
 	enum class TypeCode : std::uint32_t {
@@ -24,15 +24,15 @@ namespace svm {
 
 	class TypeInfo final {
 	public:
-		std::string Name;
+		std::string_view Name;
 		std::uint32_t Module = 0;
 		TypeCode Code = TypeCode::None;
 		std::size_t Size = 0;
 
 	public:
 		TypeInfo() noexcept = default;
-		TypeInfo(std::string name, TypeCode code) noexcept;
-		TypeInfo(std::string name, TypeCode code, std::size_t size) noexcept;
+		TypeInfo(std::string_view name, TypeCode code) noexcept;
+		TypeInfo(std::string_view name, TypeCode code, std::size_t size) noexcept;
 		TypeInfo(TypeInfo&& typeInfo) noexcept;
 		~TypeInfo() = default;
 
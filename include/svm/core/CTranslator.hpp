@@ -0,0 +1,144 @@
+#pragma once
+
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/Structure.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/FrameAnalyzer.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace svm::core {
+	// The values, runtime and functions of the emitted C, as seen from C++. Type handles are TypeInfo pointers and
+	// values of fundamental types have the layout of the matching objects, like ReferenceValue.
+	struct CValue final {
+		const TypeInfo* Type = nullptr;
+		union {
+			std::uint32_t IntValue;
+			std::uint64_t LongValue = 0;
+			float SingleValue;
+			double DoubleValue;
+			void* PointerValue;
+		};
+	};
+
+	// Provided by the host for every call. Types[code] is the type the module numbers code, as ModuleInfo resolves
+	// it, and Call, New, NewArray and Delete report failures by setting Error. Call takes the operand of a call
+	// instruction, so it is reached for mapped functions and for module functions that were not translated.
+	struct CRuntime final {
+		const TypeInfo* const* Types = nullptr;
+		int(*Call)(CRuntime* runtime, std::uint32_t function, CValue* arguments, CValue* result) = nullptr;
+		void*(*New)(CRuntime* runtime, std::uint32_t type, int isGC) = nullptr;
+		void*(*NewArray)(CRuntime* runtime, std::uint32_t elementType, std::uint64_t count, int isGC) = nullptr;
+		int(*Delete)(CRuntime* runtime, void* object) = nullptr;
+		const char* Error = nullptr;
+		void* Context = nullptr;
+	};
+
+	enum class CStatus : int {
+		Ok,
+		Error,
+		Unsupported,
+	};
+
+	using CFunction = int(*)(CRuntime* runtime, CValue* arguments, CValue* result);
+}
+
+namespace svm::core {
+	struct CTranslationStatistics final {
+		std::uint64_t Functions = 0;
+		std::uint64_t Rejected = 0;
+		std::uint64_t Instructions = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const CTranslationStatistics& statistics);
+}
+
+namespace svm::core {
+	// Emits a byte file as a C translation unit that the system C compiler can build into a shared object. Each
+	// function becomes a C function over one variable per local and stack slot; types stay dynamic but are
+	// checked against handles the compiler can fold. Constants and field offsets are inlined, calls inside the
+	// module are direct and calls through mappings go to the runtime.
+	// Functions that are not verified, or that hold structures or arrays on the stack, are not translated and
+	// have a null entry in the exported table. A translated function returns CStatus::Unsupported without side
+	// effects when an argument is an aggregate, so the host can interpret the call instead.
+	class CTranslator final {
+	private:
+		struct Analysis;
+
+	private:
+		const ByteFile& m_ByteFile;
+		std::vector<FunctionSignature> m_MappedFunctions;
+		std::vector<const StructureInfo*> m_MappedStructures;
+		std::string m_Prefix = "svm";
+		CTranslationStatistics m_Statistics;
+
+	public:
+		explicit CTranslator(const ByteFile& byteFile) noexcept;
+		CTranslator(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions,
+			std::vector<const StructureInfo*> mappedStructures) noexcept;
+		CTranslator(const CTranslator&) = delete;
+		~CTranslator() = default;
+
+	public:
+		CTranslator& operator=(const CTranslator&) = delete;
+		bool operator==(const CTranslator&) = delete;
+		bool operator!=(const CTranslator&) = delete;
+
+	public:
+		void Translate(std::ostream& stream);
+
+		std::string_view GetPrefix() const noexcept;
+		void SetPrefix(std::string newPrefix);
+		const CTranslationStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+
+	private:
+		bool Analyze(const FunctionInfo& function, Analysis& result) const;
+		bool GetStackDepths(const Instructions& instructions, const ControlFlowGraph& graph, Analysis& result) const;
+		void WritePrelude(std::ostream& stream) const;
+		void WriteFunction(std::ostream& stream, std::uint32_t index, const Analysis& analysis, const std::vector<bool>& isTranslated) const;
+		void WriteInstruction(std::ostream& stream, const Instruction& instruction, const Instructions& instructions,
+			std::uint32_t depth, bool hasResult, const std::vector<bool>& isTranslated) const;
+		void WriteFieldAddress(std::ostream& stream, const std::string& slot, std::uint32_t field) const;
+		bool GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept;
+		const StructureInfo* GetStructure(std::uint32_t index) const noexcept;
+	};
+}
+
+namespace svm::core {
+	// A shared object built from the output of CTranslator, opened with the prefix it was translated with.
+	class CLibrary final {
+	private:
+		void* m_Handle = nullptr;
+		const CFunction* m_Functions = nullptr;
+		const char* const* m_Names = nullptr;
+		std::uint32_t m_FunctionCount = 0;
+
+	public:
+		CLibrary() noexcept = default;
+		CLibrary(CLibrary&& library) noexcept;
+		~CLibrary();
+
+	public:
+		CLibrary& operator=(CLibrary&& library) noexcept;
+		bool operator==(const CLibrary&) = delete;
+		bool operator!=(const CLibrary&) = delete;
+
+	public:
+		bool Open(const std::filesystem::path& path, std::string_view prefix) noexcept;
+		void Close() noexcept;
+
+		bool IsOpen() const noexcept;
+		CFunction GetFunction(std::uint32_t index) const noexcept;
+		CFunction GetFunction(std::string_view name) const noexcept;
+		std::uint32_t GetFunctionCount() const noexcept;
+	};
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <svm/Instruction.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/ConstantPool.hpp>
+#include <svm/core/FrameAnalyzer.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+namespace svm::detail {
+	// Single constants are stored widened; the conversion is exact.
+	struct ConstantValue final {
+		TypeCode Code = TypeCode::None;
+		std::uint64_t Integer = 0;
+		double Real = 0.0;
+
+		bool IsConstant() const noexcept {
+			return Code != TypeCode::None;
+		}
+		bool operator==(const ConstantValue& value) const noexcept {
+			return Code == value.Code && Integer == value.Integer &&
+				std::memcmp(&Real, &value.Real, sizeof(Real)) == 0;
+		}
+		bool operator!=(const ConstantValue& value) const noexcept {
+			return !(*this == value);
+		}
+	};
+
+	ConstantValue ReadConstant(const core::ConstantPool& constantPool, const core::ConstantPoolLayout& layout, std::uint32_t index) noexcept;
+	ConstantValue EvaluateBinary(OpCode opCode, const ConstantValue& lhs, const ConstantValue& rhs) noexcept;
+	ConstantValue EvaluateUnary(OpCode opCode, const ConstantValue& operand) noexcept;
+	ConstantValue EvaluateConversion(OpCode opCode, const ConstantValue& operand) noexcept;
+	bool CompareConstants(OpCode opCode, const ConstantValue& lhs, const ConstantValue& rhs, int& result) noexcept;
+	bool IsJumpTaken(OpCode opCode, int order) noexcept;
+	std::uint32_t FindConstant(const core::ConstantPool& constantPool, const ConstantValue& value) noexcept;
+	std::uint32_t AddConstant(core::ConstantPool& constantPool, const ConstantValue& value, std::uint64_t& addedCount);
+}
+
+namespace svm::core {
+	struct ConstantFoldingStatistics final {
+		std::uint64_t Propagated = 0;
+		std::uint64_t Folded = 0;
+		std::uint64_t RemovedBranches = 0;
+		std::uint64_t AddedConstants = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const ConstantFoldingStatistics& statistics);
+}
+
+namespace svm::core {
+	class ConstantFolder final {
+	private:
+		struct State;
+
+	private:
+		std::vector<FunctionSignature> m_MappedFunctions;
+		unsigned int m_MaxIterations = 4;
+		ConstantFoldingStatistics m_Statistics;
+
+	public:
+		ConstantFolder() noexcept = default;
+		explicit ConstantFolder(std::vector<FunctionSignature> mappedFunctions) noexcept;
+		ConstantFolder(const ConstantFolder&) = delete;
+		~ConstantFolder() = default;
+
+	public:
+		ConstantFolder& operator=(const ConstantFolder&) = delete;
+		bool operator==(const ConstantFolder&) = delete;
+		bool operator!=(const ConstantFolder&) = delete;
+
+	public:
+		void Fold(ByteFile& byteFile);
+
+		unsigned int GetMaxIterations() const noexcept;
+		void SetMaxIterations(unsigned int newMaxIterations) noexcept;
+		const ConstantFoldingStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+
+	private:
+		bool Fold(const ByteFile& byteFile, ConstantPool& constantPool, const ConstantPoolLayout& layout,
+			Instructions& instructions, std::uint16_t arity, bool isRewriting);
+		bool Analyze(const ByteFile& byteFile, const ConstantPool& constantPool, const ConstantPoolLayout& layout,
+			const Instructions& instructions, std::uint16_t arity, const std::vector<bool>& isEscaped, std::vector<State>& states) const;
+		bool Interpret(const ByteFile& byteFile, const ConstantPool& constantPool, const ConstantPoolLayout& layout,
+			const Instruction& instruction, const std::vector<bool>& isEscaped, State& state) const;
+		bool GetSignature(const ByteFile& byteFile, std::uint32_t function, FunctionSignature& result) const noexcept;
+	};
+}
@@ -7,6 +7,18 @@
 #include <ostream>
 #include <vector>
 
+namespace svm::core {
+	struct ConstantPoolLayout final {
+		std::uint32_t IntOffset = 0;
+		std::uint32_t LongOffset = 0;
+		std::uint32_t SingleOffset = 0;
+		std::uint32_t DoubleOffset = 0;
+		std::uint32_t AllCount = 0;
+
+		std::uint32_t Remap(std::uint32_t index, const ConstantPoolLayout& newLayout) const noexcept;
+	};
+}
+
 namespace svm::core {
 	class ConstantPool {
 	public:
@@ -43,6 +55,7 @@ namespace svm::core {
 		std::uint32_t GetSingleOffset() const noexcept;
 		std::uint32_t GetDoubleOffset() const noexcept;
 		std::uint32_t GetAllCount() const noexcept;
+		ConstantPoolLayout GetLayout() const noexcept;
 		template<typename T>
 		std::uint32_t GetCount() const noexcept;
 		std::uint32_t GetIntCount() const noexcept;
@@ -58,6 +71,8 @@ namespace svm::core {
 		std::uint32_t FindLongConstant(std::uint64_t value) const noexcept;
 		std::uint32_t FindSingleConstant(float value) const noexcept;
 		std::uint32_t FindDoubleConstant(double value) const noexcept;
+		std::uint32_t FindConstant(const ConstantPool& constantPool, std::uint32_t index) const noexcept;
+		bool ImportConstant(const ConstantPool& constantPool, std::uint32_t index);
 
 		const std::vector<IntObject>& GetIntPool() const noexcept;
 		void SetIntPool(std::vector<IntObject> newIntPool) noexcept;
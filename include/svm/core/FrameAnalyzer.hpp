@@ -0,0 +1,55 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ByteFile.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace svm::core {
+	struct FunctionSignature final {
+		std::uint16_t Arity = 0;
+		bool HasResult = false;
+	};
+}
+
+namespace svm::core {
+	class FrameAnalyzer final {
+	private:
+		struct State;
+
+	private:
+		const ByteFile& m_ByteFile;
+		std::vector<FunctionSignature> m_MappedFunctions;
+		std::vector<const TypeInfo*> m_MappedStructures;
+		std::size_t m_UnknownSize = 0;
+
+	public:
+		explicit FrameAnalyzer(const ByteFile& byteFile) noexcept;
+		FrameAnalyzer(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions,
+			std::vector<const TypeInfo*> mappedStructures) noexcept;
+		FrameAnalyzer(const FrameAnalyzer&) = delete;
+		~FrameAnalyzer() = default;
+
+	public:
+		FrameAnalyzer& operator=(const FrameAnalyzer&) = delete;
+		bool operator==(const FrameAnalyzer&) = delete;
+		bool operator!=(const FrameAnalyzer&) = delete;
+
+	public:
+		bool Analyze(FunctionInfo& function) const;
+		bool Analyze(const Instructions& instructions, std::uint16_t arity, FrameInfo& result) const;
+
+		std::size_t GetUnknownSize() const noexcept;
+		void SetUnknownSize(std::size_t newUnknownSize) noexcept;
+
+	private:
+		bool Interpret(const Instruction& instruction, State& state, FrameInfo& result) const;
+		bool GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept;
+		const TypeInfo* GetStructureType(std::uint32_t index) const noexcept;
+		std::size_t GetSize(const TypeInfo* type) const noexcept;
+	};
+}
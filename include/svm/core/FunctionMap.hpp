@@ -0,0 +1,53 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/OffsetIndex.hpp>
+#include <svm/core/ThreadedFunction.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace svm::core {
+	// Maps the addresses of threaded instructions, which is where an executing ReferenceInterpreter points, back to the
+	// functions that own them and their indices there. Each function also has an OffsetIndex for its byte offsets.
+	// The entrypoint is not part of the map.
+	class FunctionMap final {
+	public:
+		static constexpr std::uint32_t NPos = std::numeric_limits<std::uint32_t>::max();
+
+	private:
+		struct Range final {
+			std::uintptr_t Begin = 0;
+			std::uintptr_t End = 0;
+			std::uint32_t Function = 0;
+		};
+
+	private:
+		std::vector<Range> m_Ranges;
+		std::vector<OffsetIndex> m_Indices;
+
+	public:
+		FunctionMap() noexcept = default;
+		FunctionMap(const Functions& functions, const std::vector<const ThreadedFunction*>& threadedFunctions);
+		FunctionMap(FunctionMap&& map) noexcept = default;
+		~FunctionMap() = default;
+
+	public:
+		FunctionMap& operator=(FunctionMap&& map) noexcept = default;
+		bool operator==(const FunctionMap&) = delete;
+		bool operator!=(const FunctionMap&) = delete;
+
+	public:
+		void Clear() noexcept;
+		void Build(const Functions& functions, const std::vector<const ThreadedFunction*>& threadedFunctions);
+
+		std::uint32_t FindFunction(const ThreadedInstruction* instruction) const noexcept;
+		std::uint64_t FindInstruction(const ThreadedInstruction* instruction) const noexcept;
+		const OffsetIndex& GetOffsetIndex(std::uint32_t function) const noexcept;
+		std::uint32_t GetFunctionCount() const noexcept;
+
+	private:
+		const Range* FindRange(const ThreadedInstruction* instruction) const noexcept;
+	};
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/core/FrameAnalyzer.hpp>
+#include <svm/core/Module.hpp>
+#include <svm/core/ModuleBase.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace svm::core {
+	class CallProfile final {
+	private:
+		std::unordered_map<std::string, std::uint64_t> m_CallCounts;
+
+	public:
+		CallProfile() = default;
+		CallProfile(CallProfile&& profile) noexcept = default;
+		~CallProfile() = default;
+
+	public:
+		CallProfile& operator=(CallProfile&& profile) noexcept = default;
+		bool operator==(const CallProfile&) = delete;
+		bool operator!=(const CallProfile&) = delete;
+
+	public:
+		void Clear() noexcept;
+		bool IsEmpty() const noexcept;
+
+		void Load(const std::filesystem::path& path);
+		void Load(std::istream& stream);
+		void Save(const std::filesystem::path& path) const;
+		void Save(std::ostream& stream) const;
+
+		std::uint64_t GetCallCount(const ModulePath& module, std::string_view function) const;
+		void SetCallCount(const ModulePath& module, std::string_view function, std::uint64_t count);
+		void AddCallCount(const ModulePath& module, std::string_view function, std::uint64_t count);
+
+	private:
+		static std::string MakeKey(const ModulePath& module, std::string_view function);
+	};
+}
+
+namespace svm::core {
+	struct InlinerOptions final {
+		std::uint64_t MaxCalleeSize = 12;
+		std::uint64_t MaxHotCalleeSize = 48;
+		std::uint64_t HotCallCount = 1000;
+		std::uint64_t MaxCallerGrowth = 256;
+		unsigned int MaxIterations = 2;
+		bool CrossModule = true;
+		std::shared_ptr<const CallProfile> Profile;
+	};
+
+	struct InlinerStatistics final {
+		std::uint64_t Inlined = 0;
+		std::uint64_t AddedInstructions = 0;
+		std::uint64_t RefusedRecursive = 0;
+		std::uint64_t RefusedSize = 0;
+		std::uint64_t RefusedBudget = 0;
+		std::uint64_t RefusedUnsupported = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const InlinerStatistics& statistics);
+}
+
+namespace svm::core {
+	template<typename FI>
+	class Inliner final {
+	private:
+		enum class CalleeStatus : std::uint8_t {
+			Inlinable,
+			Recursive,
+			Unsupported,
+		};
+
+		struct Callee;
+		struct CallSite;
+		struct State;
+
+	private:
+		InlinerOptions m_Options;
+		InlinerStatistics m_Statistics;
+
+	public:
+		Inliner() noexcept = default;
+		explicit Inliner(InlinerOptions options) noexcept;
+		Inliner(const Inliner&) = delete;
+		~Inliner() = default;
+
+	public:
+		Inliner& operator=(const Inliner&) = delete;
+		bool operator==(const Inliner&) = delete;
+		bool operator!=(const Inliner&) = delete;
+
+	public:
+		bool Inline(ModuleInfo<FI>& module);
+
+		const InlinerOptions& GetOptions() const noexcept;
+		void SetOptions(InlinerOptions newOptions) noexcept;
+		const InlinerStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+
+	private:
+		bool Inline(State& state, Instructions& instructions, std::uint32_t caller, bool isCounting);
+		bool SelectCallSites(State& state, const Instructions& instructions, std::uint32_t caller, bool isCounting,
+			std::vector<CallSite>& callSites);
+		void ImportConstants(State& state, const std::vector<CallSite>& callSites);
+		void EmitCallee(State& state, const CallSite& callSite, std::uint32_t localBase, std::uint32_t labelBase,
+			std::uint64_t offset, ArenaVector<Instruction>& result, std::vector<std::uint64_t>& labels);
+
+		CalleeStatus GetStatus(State& state, const Callee& callee) const;
+		bool IsBalanced(const ModuleInfo<FI>& module, const FunctionInfo& function) const;
+		bool IsRecursive(const Callee& callee) const;
+		bool CanTranslate(const State& state, const Callee& callee) const;
+		std::uint32_t TranslateCall(State& state, const Callee& callee, std::uint32_t operand) const;
+
+		static bool ResolveCallee(const ModuleInfo<FI>& module, std::uint32_t operand, Callee& result) noexcept;
+		static bool GetSignature(const ModuleInfo<FI>& module, std::uint32_t operand, FunctionSignature& result) noexcept;
+		static std::uint32_t GetLocalCount(const Instructions& instructions, std::uint16_t arity);
+	};
+}
+
+#include "detail/impl/Inliner.hpp"
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/MappedFile.hpp>
+#include <svm/core/ModuleBase.hpp>
+#include <svm/core/Parser.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace svm::core {
+	struct LinkedField final {
+		std::uint64_t Offset = 0;
+		std::uint32_t Module = std::numeric_limits<std::uint32_t>::max();
+		std::uint32_t Structure = 0;
+	};
+
+	struct LinkedStructure final {
+		std::uint64_t Size = 0;
+		std::vector<LinkedField> Fields;
+	};
+
+	// State is the byte file as it was loaded, written by LinkedImage::WriteState. FileSize and FileTime are those of
+	// the source file when it was hashed, so an unchanged file does not have to be read to validate the image.
+	struct LinkedModule final {
+		ModulePath Path;
+		std::uint64_t Hash = 0;
+		std::uint64_t FileSize = 0;
+		std::int64_t FileTime = 0;
+		const std::uint8_t* State = nullptr;
+		std::size_t StateSize = 0;
+		std::vector<std::uint32_t> Dependencies;
+		std::vector<LinkedStructure> Structures;
+
+		bool IsExternal() const noexcept;
+	};
+}
+
+namespace svm::core {
+	class LinkedImage final {
+	public:
+		static constexpr std::uint32_t NPos = std::numeric_limits<std::uint32_t>::max();
+
+	private:
+		MappedFile m_File;
+		std::vector<LinkedModule> m_Modules;
+		std::uint64_t m_Key = 0;
+
+	public:
+		LinkedImage() noexcept = default;
+		LinkedImage(LinkedImage&& image) noexcept = default;
+		~LinkedImage() = default;
+
+	public:
+		LinkedImage& operator=(LinkedImage&& image) noexcept = default;
+		bool operator==(const LinkedImage&) = delete;
+		bool operator!=(const LinkedImage&) = delete;
+
+	public:
+		void Clear() noexcept;
+
+		bool Open(const std::filesystem::path& path);
+		void Save(const std::filesystem::path& path) const;
+		bool IsUpToDate() const;
+
+		const std::vector<LinkedModule>& GetModules() const noexcept;
+		void SetModules(std::vector<LinkedModule> newModules) noexcept;
+		std::uint64_t GetKey() const noexcept;
+
+		static std::uint64_t Hash(const std::uint8_t* data, std::size_t size, std::uint64_t seed = 0) noexcept;
+		static bool HashFile(const std::filesystem::path& path, std::uint64_t& hash) noexcept;
+		static bool StatFile(const std::filesystem::path& path, std::uint64_t& size, std::int64_t& time) noexcept;
+
+		static std::vector<std::uint8_t> WriteState(const ByteFile& byteFile);
+		static bool ReadState(const LinkedModule& module, const ParseOptions& options, ByteFile& result);
+
+	private:
+		static std::uint64_t CalcKey(const std::vector<LinkedModule>& modules);
+	};
+}
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <svm/core/Inliner.hpp>
+#include <svm/core/LinkedImage.hpp>
 #include <svm/core/Module.hpp>
+#include <svm/core/Parser.hpp>
 #include <svm/core/virtual/VirtualModule.hpp>
 
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -16,6 +20,8 @@ namespace svm::core {
 	private:
 		Modules<FI> m_Modules;
 		std::vector<std::filesystem::path> m_LibraryDirectories;
+		ParseOptions m_ParseOptions;
+		std::vector<LinkedImage> m_Images;
 
 	public:
 		Loader() noexcept = default;
@@ -31,11 +37,16 @@ namespace svm::core {
 		void Clear() noexcept;
 
 		void AddLibraryDirectory(const std::filesystem::path& path);
+		const ParseOptions& GetParseOptions() const noexcept;
+		void SetParseOptions(const ParseOptions& newParseOptions) noexcept;
 
 		Module<FI> Load(const std::filesystem::path& path);
+		Module<FI> Load(const std::uint8_t* data, std::size_t size, ModulePath path);
 		VirtualModule<FI>& Create(const std::filesystem::path& path);
 		VirtualModule<FI>& Create(const std::string& path);
 		void Build(VirtualModule<FI>& module);
+		bool LoadImage(const std::filesystem::path& path);
+		void SaveImage(const std::filesystem::path& path) const;
 
 		Module<FI> GetModule(std::uint32_t index) const noexcept;
 		Module<FI> GetModule(const ModulePath& path) const noexcept;
@@ -43,10 +54,12 @@ namespace svm::core {
 		const Modules<FI>& GetModules() const noexcept;
 		Modules<FI>& GetModules() noexcept;
 		void SetModules(Modules<FI>&& newModules) noexcept;
+		std::uint32_t SweepFunctions();
 
 		ModulePath ResolveDependency(Module<FI> module, const std::string& dependency) const;
 
 	private:
+		Module<FI> Load(Parser& parser);
 		void LoadDependencies(ModuleInfo<FI>* module);
 
 		void FindCycle(ModuleInfo<FI>* module) const;
@@ -57,6 +70,7 @@ namespace svm::core {
 		void CalcOffset(ModuleInfo<FI>* module);
 
 		ModuleInfo<FI>* GetModuleInternal(const ModulePath& path) const noexcept;
+		std::uint32_t GetModuleIndex(const void* module) const noexcept;
 	};
 }
 
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace svm::core {
+	class MappedFile final {
+	private:
+		void* m_Data = nullptr;
+		std::size_t m_Size = 0;
+
+	public:
+		MappedFile() noexcept = default;
+		MappedFile(MappedFile&& file) noexcept;
+		~MappedFile();
+
+	public:
+		MappedFile& operator=(MappedFile&& file) noexcept;
+		bool operator==(const MappedFile&) = delete;
+		bool operator!=(const MappedFile&) = delete;
+
+	public:
+		bool Open(const std::filesystem::path& path) noexcept;
+		void Close() noexcept;
+
+		bool IsOpen() const noexcept;
+		const std::uint8_t* GetData() const noexcept;
+		std::size_t GetSize() const noexcept;
+	};
+}
\ No newline at end of file
@@ -1,13 +1,23 @@
 #pragma once
 
+#include <svm/DeadCodeEliminator.hpp>
 #include <svm/Structure.hpp>
 #include <svm/core/ByteFile.hpp>
+#include <svm/core/CTranslator.hpp>
+#include <svm/core/ConstantFolder.hpp>
+#include <svm/core/FrameAnalyzer.hpp>
+#include <svm/core/FunctionMap.hpp>
 #include <svm/core/ModuleBase.hpp>
+#include <svm/core/RegisterCode.hpp>
+#include <svm/core/SSA.hpp>
+#include <svm/core/ThreadedFunction.hpp>
+#include <svm/core/Verifier.hpp>
 #include <svm/core/virtual/VirtualModule.hpp>
 #include <svm/detail/ReferenceWrapper.hpp>
 
 #include <cstdint>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -16,12 +26,18 @@
 namespace svm::core {
 	template<typename FI>
 	class ModuleInfo final {
+	private:
+		struct ThreadedCache;
+
 	public:
 		std::variant<std::monostate, ByteFile, VirtualModule<FI>> Module;
 
+	private:
+		std::unique_ptr<ThreadedCache> m_ThreadedCache;
+
 	public:
 		ModuleInfo() noexcept = default;
-		ModuleInfo(ByteFile&& byteFile) noexcept;
+		ModuleInfo(ByteFile&& byteFile);
 		ModuleInfo(VirtualModule<FI>&& virtualModule) noexcept;
 		ModuleInfo(ModuleInfo&& moduleInfo) noexcept;
 		~ModuleInfo() = default;
@@ -41,15 +57,45 @@ namespace svm::core {
 		Dependency& GetDependency(std::uint32_t index) noexcept;
 		std::uint32_t GetDependencyCount() const noexcept;
 		Structure GetStructure(std::uint32_t index) const noexcept;
-		Structure GetStructure(const std::string& name) const noexcept;
+		Structure GetStructure(std::string_view name) const noexcept;
 		StructureInfo& GetStructure(std::uint32_t index) noexcept;
 		std::uint32_t GetStructureCount() const noexcept;
 		std::variant<Function, VirtualFunction<FI>> GetFunction(std::uint32_t index) const noexcept;
-		std::variant<Function, VirtualFunction<FI>> GetFunction(const std::string& name) const noexcept;
+		std::variant<Function, VirtualFunction<FI>> GetFunction(std::string_view name) const noexcept;
 		std::uint32_t GetFunctionCount() const noexcept;
 		const Mappings& GetMappings() const noexcept;
 
 		void UpdateStructureInfos(std::uint32_t module) noexcept;
+		ConstantFoldingStatistics FoldConstants();
+		SSAStatistics OptimizeSSA(const SSAOptions& options);
+		DeadCodeStatistics EliminateDeadCode(const DeadCodeOptions& options);
+		std::uint32_t SweepFunctions(const std::vector<std::string_view>& exports);
+		std::uint32_t AnalyzeFrames();
+		void ResetUnverifiedFrames() noexcept;
+		RegisterCodeStatistics BuildRegisterCode(std::vector<RegisterCode>& result, std::uint32_t registerFileSize) const;
+		CTranslationStatistics TranslateToC(std::ostream& stream, std::string prefix) const;
+		std::vector<const TypeInfo*> ResolveTypes() const;
+		void Verify();
+		VerifierResult VerifyEntrypoint() const;
+
+		const ThreadedFunction& GetThreadedFunction(std::uint32_t index) const;
+		const ThreadedFunction& GetThreadedFunction(const FunctionInfo& function) const;
+		const ThreadedFunction& GetThreadedEntrypoint() const;
+		void ClearThreadedFunctions();
+
+		const FunctionMap& GetFunctionMap() const;
+		const FunctionInfo* FindFunction(const ThreadedInstruction* instruction) const;
+		std::uint64_t FindInstruction(const ThreadedInstruction* instruction) const;
+		std::uint64_t FindInstruction(const FunctionInfo& function, std::uint64_t offset) const;
+
+	private:
+		const ThreadedFunction& GetThreadedFunction(std::uint32_t index, const FunctionInfo* function, const Instructions& instructions) const;
+		std::uint32_t GetFunctionIndex(const FunctionInfo& function) const noexcept;
+		ThreadedFunction BuildThreadedFunction(const FunctionInfo* function, const Instructions& instructions) const;
+		const TypeInfo* ResolveType(std::uint32_t code) const noexcept;
+		bool ResolveFunction(const FunctionMapping& mapping, std::variant<Function, VirtualFunction<FI>>& result) const noexcept;
+		const StructureInfo* ResolveStructure(const StructureMapping& mapping) const noexcept;
+		void ResolveMappings(std::vector<FunctionSignature>& mappedFunctions, std::vector<const StructureInfo*>& mappedStructures) const;
 	};
 }
 
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <svm/Mapping.hpp>
+#include <svm/StringPool.hpp>
 #include <svm/Structure.hpp>
 
 #include <filesystem>
+#include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -14,6 +18,7 @@ namespace svm::core {
 	struct Dependency final {
 		std::string Path;
 		const void* Module = nullptr;
+		std::uint32_t ModuleIndex = 0;
 	};
 }
 
@@ -25,11 +30,13 @@ namespace svm::core {
 	template<typename F>
 	class ModuleBase {
 	private:
+		std::unique_ptr<std::pmr::monotonic_buffer_resource> m_Arena;
 		ModulePath m_Path;
 		std::vector<Dependency> m_Dependencies;
 		Structures m_Structures;
 		F m_Functions;
 		Mappings m_Mappings;
+		std::unique_ptr<StringPool> m_StringPool;
 
 	public:
 		ModuleBase() noexcept = default;
@@ -59,6 +66,12 @@ namespace svm::core {
 		const Mappings& GetMappings() const noexcept;
 		Mappings& GetMappings() noexcept;
 		void SetMappings(Mappings&& newMappings) noexcept;
+		const StringPool* GetStringPool() const noexcept;
+		StringPool& GetStringPool();
+		std::string_view Intern(std::string_view string);
+		void ClearStringPool() noexcept;
+		std::pmr::memory_resource* GetArena();
+		void ClearArena() noexcept;
 
 		void UpdateStructureInfos(std::uint32_t module) noexcept;
 		void UpdateFunctionInfos(std::uint32_t module) noexcept;
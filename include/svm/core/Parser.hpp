@@ -1,25 +1,68 @@
 #pragma once
 
+#include <svm/DeadCodeEliminator.hpp>
+#include <svm/PeepholeOptimizer.hpp>
 #include <svm/Specification.hpp>
 #include <svm/Structure.hpp>
 #include <svm/Type.hpp>
 #include <svm/core/ByteFile.hpp>
+#include <svm/core/Inliner.hpp>
+#include <svm/core/MappedFile.hpp>
+#include <svm/core/SSA.hpp>
 
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <istream>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
+namespace svm::core {
+	struct ParseOptions final {
+		bool LazyFunctions = false;
+		bool ParallelFunctions = false;
+		unsigned int ThreadCount = 0;
+		bool ArenaAllocation = false;
+		bool PeepholeOptimization = false;
+		PeepholeOptions Peephole;
+		bool Inlining = false;
+		InlinerOptions Inliner;
+		bool ConstantFolding = false;
+		bool SSAOptimization = false;
+		SSAOptions SSA;
+		bool DeadCodeElimination = false;
+		DeadCodeOptions DeadCode;
+		bool FrameAnalysis = false;
+		bool Verification = false;
+	};
+}
+
 namespace svm::core {
 	class Parser {
 	private:
-		std::vector<std::uint8_t> m_File;
+		struct SectionInfo final {
+			std::uint64_t Offset = 0;
+			std::uint64_t Size = 0;
+		};
+
+	private:
+		MappedFile m_FileMapping;
+		std::vector<std::uint8_t> m_FileBuffer;
+		std::shared_ptr<const void> m_FileOwner;
+		const std::uint8_t* m_File = nullptr;
+		std::size_t m_FileSize = 0;
 		std::size_t m_Cursor = 0;
 
 		ByteFile m_ByteFile;
 		ShitBFVersion m_ShitBFVersion = ShitBFVersion::Latest;
 		ShitBCVersion m_ShitBCVersion = ShitBCVersion::Latest;
+		ParseOptions m_Options;
+
+		std::vector<SectionInfo> m_Sections;
+		std::vector<SectionInfo> m_FunctionSections;
 
 	public:
 		Parser() noexcept = default;
@@ -35,17 +78,33 @@ namespace svm::core {
 		void Clear() noexcept;
 
 		void Open(const std::filesystem::path& path);
+		void Open(const std::uint8_t* data, std::size_t size, ModulePath path) noexcept;
+		void Open(std::vector<std::uint8_t> bytes, ModulePath path) noexcept;
+		void Open(std::istream& stream, ModulePath path);
 		void Parse();
 		ByteFile GetResult() noexcept;
 
+		const ParseOptions& GetOptions() const noexcept;
+		void SetOptions(const ParseOptions& newOptions) noexcept;
+
 	private:
+		void ReadStream(std::istream& stream);
+		void CloseFile() noexcept;
+		std::shared_ptr<const void> ShareFile();
+		std::pmr::memory_resource* GetArena();
+
 		template<typename T>
 		T ReadFile() noexcept;
 		inline std::string ReadFileString();
+		inline std::string_view ReadFileName();
 		inline auto ReadFile(std::size_t size) noexcept;
 
 		Type GetType(Structures& structures, TypeCode code);
 
+		void ParseSectionTable();
+		SectionInfo ReadSectionInfo();
+		void SeekSection(ShitBFSection section) noexcept;
+
 		void ParseDependencies();
 		void ParseMappings();
 		template<typename T>
@@ -55,7 +114,16 @@ namespace svm::core {
 		void ParseConstants(std::vector<T>& pool) noexcept;
 		void ParseStructures();
 		void ParseFunctions();
+		void ParseFunction(FunctionInfo& function);
+		void ParseFunction(FunctionInfo& function, const SectionInfo& section);
+		void ParseFunctionHeader(FunctionInfo& function);
+		void ParseFunctionsParallel(Functions& functions);
 		Instructions ParseInstructions();
+		Instructions ParseInstructions(std::size_t end);
+		Instructions ParseInstructionsLazily();
+		Instructions ParseInstructionsLazily(std::size_t end);
+		void SkipInstructions();
+		static Instructions DecodeInstructions(const std::uint8_t* data, std::size_t size, ShitBCVersion version, const ParseOptions& options);
 
 		OpCode ReadOpCode() noexcept;
 	};
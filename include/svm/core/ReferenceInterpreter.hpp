@@ -0,0 +1,159 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Object.hpp>
+#include <svm/Predefined.hpp>
+#include <svm/Structure.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/Loader.hpp>
+#include <svm/core/Module.hpp>
+#include <svm/core/TemplateJit.hpp>
+#include <svm/core/ThreadedFunction.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#if (defined(SVM_GCC) || defined(SVM_CLANG)) && !defined(SVM_NO_COMPUTED_GOTO)
+#	define SVM_COMPUTED_GOTO
+#endif
+
+namespace svm::core {
+	// Values of fundamental types have the layout of the matching objects, so lea can hand out the address of a local.
+	// Structures and arrays are held by address; their storage belongs to the interpreter.
+	class ReferenceValue final {
+	public:
+		svm::Type Type;
+		union {
+			std::uint32_t IntValue;
+			std::uint64_t LongValue = 0;
+			float SingleValue;
+			double DoubleValue;
+			void* PointerValue;
+		};
+
+	public:
+		ReferenceValue() noexcept = default;
+		ReferenceValue(std::uint32_t value) noexcept;
+		ReferenceValue(std::uint64_t value) noexcept;
+		ReferenceValue(float value) noexcept;
+		ReferenceValue(double value) noexcept;
+		ReferenceValue(svm::Type type, void* value) noexcept;
+		ReferenceValue(const ReferenceValue& value) noexcept = default;
+		~ReferenceValue() = default;
+
+	public:
+		ReferenceValue& operator=(const ReferenceValue& value) noexcept = default;
+		bool operator==(const ReferenceValue&) = delete;
+		bool operator!=(const ReferenceValue&) = delete;
+
+	public:
+		bool IsEmpty() const noexcept;
+		bool IsAggregate() const noexcept;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const ReferenceValue& value);
+}
+
+namespace svm::core {
+	// Executes threaded functions of loaded byte files. It is meant as a baseline for measuring changes to the
+	// instruction, object and module layouts, not as a production engine: the stack discipline of the code is trusted
+	// to the verifier, so unverified functions are rejected, and structure or array values copied onto the stack live
+	// until their frame returns.
+	// With JIT enabled, functions whose calls and backward jumps reach the hot count are compiled by TemplateCompiler
+	// and run on the same frames; the interpreter executes the instructions the compiled code exits at.
+	// Loader::SweepFunctions and ModuleInfo::ClearThreadedFunctions free the threaded functions the interpreter holds
+	// states for, so it must be cleared or created again after them.
+	template<typename FI>
+	class ReferenceInterpreter final {
+	public:
+		using VirtualCallHandler = std::function<ReferenceValue(ReferenceInterpreter&, const FI&, const ReferenceValue*)>;
+
+		static constexpr std::size_t DefaultStackSize = 1024 * 1024;
+
+	private:
+		struct Frame;
+		struct FunctionState final {
+			const ThreadedFunction* Function = nullptr;
+			std::uint32_t LocalCount = 0;
+			std::uint64_t HotCount = 0;
+			const NativeFunction* Native = nullptr;
+			bool IsRejected = false;
+		};
+
+	private:
+		const Loader<FI>& m_Loader;
+		VirtualCallHandler m_VirtualCallHandler;
+		std::unique_ptr<ReferenceValue[]> m_Stack;
+		std::size_t m_StackSize = 0;
+		ReferenceValue* m_Top = nullptr;
+		std::vector<Frame> m_Frames;
+		std::vector<std::unique_ptr<std::uint8_t[]>> m_Aggregates;
+		std::unordered_map<const void*, std::unique_ptr<std::uint8_t[]>> m_Heap;
+		std::unordered_map<const void*, std::unique_ptr<std::uint8_t[]>> m_GCHeap;
+		std::unordered_map<std::uint64_t, FunctionState> m_FunctionStates;
+		JitOptions m_JitOptions;
+		TemplateCompiler m_Compiler;
+		CodeCache m_CodeCache;
+
+	public:
+		explicit ReferenceInterpreter(const Loader<FI>& loader);
+		ReferenceInterpreter(const Loader<FI>& loader, std::size_t stackSize);
+		ReferenceInterpreter(const ReferenceInterpreter&) = delete;
+		~ReferenceInterpreter() = default;
+
+	public:
+		ReferenceInterpreter& operator=(const ReferenceInterpreter&) = delete;
+		bool operator==(const ReferenceInterpreter&) = delete;
+		bool operator!=(const ReferenceInterpreter&) = delete;
+
+	public:
+		void Clear() noexcept;
+
+		void Run(const ModuleInfo<FI>& module);
+		ReferenceValue Call(const FunctionInfo& function, const std::vector<ReferenceValue>& arguments);
+
+		const VirtualCallHandler& GetVirtualCallHandler() const noexcept;
+		void SetVirtualCallHandler(VirtualCallHandler newVirtualCallHandler) noexcept;
+		std::size_t GetStackSize() const noexcept;
+		std::size_t GetAllocationCount() const noexcept;
+		const JitOptions& GetJitOptions() const noexcept;
+		void SetJitOptions(const JitOptions& newJitOptions) noexcept;
+		const JitStatistics& GetJitStatistics() const noexcept;
+
+	private:
+		void Invoke(const ThreadedFunction& function, ReferenceValue* arguments, std::uint16_t arity, bool hasResult);
+		void Execute(const ThreadedFunction& function, ReferenceValue* arguments, std::uint16_t arity, bool hasResult);
+		ReferenceValue* EnterFrame(const ThreadedFunction& function, ReferenceValue* arguments, std::uint16_t arity, bool hasResult);
+		void ReleaseAggregates(std::size_t mark, const ReferenceValue* result) noexcept;
+		ReferenceValue CallVirtual(const FI& function, const ReferenceValue* arguments);
+		FunctionState& GetFunctionState(const ThreadedFunction& function, std::uint16_t arity);
+		const NativeFunction* TierUp(FunctionState& state);
+
+		ReferenceValue NewAggregate(const TypeInfo* type);
+		ReferenceValue NewAggregate(const TypeInfo* elementType, std::uint64_t count);
+		ReferenceValue CopyAggregate(const void* object);
+		void StoreLocal(ReferenceValue& local, const ReferenceValue& value) noexcept;
+		void* New(const TypeInfo* type, bool isGC);
+		void* New(const TypeInfo* elementType, std::uint64_t count, bool isGC);
+		void Delete(void* object);
+
+		ReferenceValue Load(const void* object);
+		void Store(void* object, const ReferenceValue& value) const;
+		void* GetField(void* object, std::uint32_t index) const;
+		void* GetElement(void* array, std::uint64_t index) const;
+
+		void Initialize(std::uint8_t* object, const TypeInfo* type) const;
+		void Initialize(std::uint8_t* array, const TypeInfo* elementType, std::uint64_t count) const;
+		const StructureInfo& GetStructure(const TypeInfo* type) const noexcept;
+
+		static std::size_t GetObjectSize(const void* object) noexcept;
+		static std::size_t GetArraySize(const TypeInfo* elementType, std::uint64_t count);
+	};
+}
+
+#include "detail/impl/ReferenceInterpreter.hpp"
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/FrameAnalyzer.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace svm::core {
+	// Three-address form of an instruction. Push loads a constant into Result and Copy moves Left into Result;
+	// the other opcodes keep their meaning but read Left and Right and write Result instead of the stack.
+	// Call reads its arguments from the argument list, starting at Left with Right elements.
+	struct RegisterInstruction final {
+		static constexpr std::uint32_t NoRegister = std::numeric_limits<std::uint32_t>::max();
+
+		svm::OpCode OpCode = svm::OpCode::Nop;
+		std::uint32_t Result = NoRegister;
+		std::uint32_t Left = NoRegister;
+		std::uint32_t Right = NoRegister;
+		std::uint32_t Operand = 0;
+		std::uint64_t Offset = 0;
+	};
+}
+
+namespace svm::core {
+	class RegisterCode final {
+	private:
+		std::vector<std::uint64_t> m_Labels;
+		std::vector<RegisterInstruction> m_Instructions;
+		std::vector<std::uint32_t> m_Arguments;
+		std::uint32_t m_RegisterCount = 0;
+		std::uint32_t m_RegisterFileSize = 0;
+		std::uint32_t m_SpillSlotCount = 0;
+		std::vector<std::uint32_t> m_Locations;
+
+	public:
+		RegisterCode() noexcept = default;
+		RegisterCode(RegisterCode&& registerCode) noexcept = default;
+		~RegisterCode() = default;
+
+	public:
+		RegisterCode& operator=(RegisterCode&& registerCode) noexcept = default;
+		bool operator==(const RegisterCode&) = delete;
+		bool operator!=(const RegisterCode&) = delete;
+
+	public:
+		void Clear() noexcept;
+		bool IsEmpty() const noexcept;
+
+		std::uint64_t GetLabel(std::uint32_t index) const noexcept;
+		std::uint32_t GetLabelCount() const noexcept;
+		std::uint32_t AddLabel(std::uint64_t index);
+		const RegisterInstruction& GetInstruction(std::uint64_t index) const noexcept;
+		RegisterInstruction& GetInstruction(std::uint64_t index) noexcept;
+		std::uint64_t GetInstructionCount() const noexcept;
+		std::uint64_t AddInstruction(const RegisterInstruction& instruction);
+		const std::uint32_t* GetArguments(const RegisterInstruction& instruction) const noexcept;
+		std::uint32_t GetArgumentCount() const noexcept;
+		std::uint32_t AddArgument(std::uint32_t reg);
+
+		std::uint32_t GetRegisterCount() const noexcept;
+		void SetRegisterCount(std::uint32_t newRegisterCount) noexcept;
+
+		bool IsAllocated() const noexcept;
+		std::uint32_t GetRegisterFileSize() const noexcept;
+		std::uint32_t GetSpillSlotCount() const noexcept;
+		std::uint32_t GetLocation(std::uint32_t reg) const noexcept;
+		bool IsSpilled(std::uint32_t location) const noexcept;
+		std::uint32_t Allocate(std::uint32_t registerFileSize);
+
+	private:
+		void GetUses(const RegisterInstruction& instruction, std::vector<std::uint32_t>& result) const;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const RegisterCode& registerCode);
+}
+
+namespace svm::core {
+	struct RegisterCodeStatistics final {
+		std::uint64_t Functions = 0;
+		std::uint64_t StackInstructions = 0;
+		std::uint64_t RegisterInstructions = 0;
+		std::uint64_t Moves = 0;
+		std::uint64_t SpilledRegisters = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const RegisterCodeStatistics& statistics);
+}
+
+namespace svm::core {
+	class RegisterTranslator final {
+	private:
+		struct State;
+
+	private:
+		const ByteFile& m_ByteFile;
+		std::vector<FunctionSignature> m_MappedFunctions;
+		std::uint32_t m_RegisterFileSize = 0;
+		RegisterCodeStatistics m_Statistics;
+
+	public:
+		explicit RegisterTranslator(const ByteFile& byteFile) noexcept;
+		RegisterTranslator(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions) noexcept;
+		RegisterTranslator(const RegisterTranslator&) = delete;
+		~RegisterTranslator() = default;
+
+	public:
+		RegisterTranslator& operator=(const RegisterTranslator&) = delete;
+		bool operator==(const RegisterTranslator&) = delete;
+		bool operator!=(const RegisterTranslator&) = delete;
+
+	public:
+		bool Translate(const FunctionInfo& function, RegisterCode& result);
+		bool Translate(const Instructions& instructions, std::uint16_t arity, bool hasResult, RegisterCode& result);
+
+		std::uint32_t GetRegisterFileSize() const noexcept;
+		void SetRegisterFileSize(std::uint32_t newRegisterFileSize) noexcept;
+		const RegisterCodeStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+
+	private:
+		bool GetStackDepths(const Instructions& instructions, const ControlFlowGraph& graph,
+			std::vector<std::uint32_t>& depths, std::uint32_t& maxDepth) const;
+		bool Interpret(const Instruction& instruction, bool hasResult, State& state, RegisterCode& result) const;
+		void Materialize(State& state, RegisterCode& result) const;
+		bool GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept;
+	};
+}
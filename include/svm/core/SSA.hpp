@@ -0,0 +1,167 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/Structure.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/ConstantFolder.hpp>
+#include <svm/core/FrameAnalyzer.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace svm::core {
+	enum class SSAValueKind : std::uint8_t {
+		Undefined,
+		Parameter,
+		Constant,
+		Phi,
+		Instruction,
+	};
+
+	// Parameters and constants belong to no block. Instructions keep the opcode and operand they were built from and
+	// read their stack operands from Operands; jumps branch to the successors of their block instead of a label.
+	// Constants read from the constant pool keep their index in Operand, constants computed later have NPos.
+	struct SSAValue final {
+		SSAValueKind Kind = SSAValueKind::Undefined;
+		svm::OpCode OpCode = svm::OpCode::Nop;
+		std::uint32_t Operand = 0;
+		detail::ConstantValue Constant;
+		const TypeInfo* Type = nullptr;
+		bool HasResult = false;
+		std::uint32_t Block = std::numeric_limits<std::uint32_t>::max();
+		std::vector<std::uint32_t> Operands;
+	};
+
+	// The last value of a block is its terminator. Phi operands follow the order of Predecessors, and a conditional jump
+	// branches to the first successor and falls through to the second.
+	struct SSABlock final {
+		std::vector<std::uint32_t> Phis;
+		std::vector<std::uint32_t> Values;
+		std::vector<std::uint32_t> Predecessors;
+		std::vector<std::uint32_t> Successors;
+	};
+}
+
+namespace svm::core {
+	class SSAFunction final {
+	public:
+		static constexpr std::uint32_t NPos = std::numeric_limits<std::uint32_t>::max();
+		static constexpr std::uint32_t Undefined = 0;
+
+	private:
+		std::vector<SSAValue> m_Values;
+		std::vector<SSABlock> m_Blocks;
+		std::uint16_t m_Arity = 0;
+		bool m_HasResult = false;
+
+	public:
+		SSAFunction() noexcept = default;
+		SSAFunction(SSAFunction&& function) noexcept = default;
+		~SSAFunction() = default;
+
+	public:
+		SSAFunction& operator=(SSAFunction&& function) noexcept = default;
+		bool operator==(const SSAFunction&) = delete;
+		bool operator!=(const SSAFunction&) = delete;
+
+	public:
+		void Clear() noexcept;
+		void Reset(std::uint16_t arity, bool hasResult);
+		bool IsEmpty() const noexcept;
+
+		std::uint16_t GetArity() const noexcept;
+		bool HasResult() const noexcept;
+
+		const SSAValue& GetValue(std::uint32_t index) const noexcept;
+		SSAValue& GetValue(std::uint32_t index) noexcept;
+		std::uint32_t GetValueCount() const noexcept;
+		std::uint32_t AddValue(SSAValue value);
+
+		const SSABlock& GetBlock(std::uint32_t index) const noexcept;
+		SSABlock& GetBlock(std::uint32_t index) noexcept;
+		std::uint32_t GetBlockCount() const noexcept;
+		std::uint32_t AddBlock();
+		void InsertBlock(std::uint32_t index);
+		void RemoveBlocks(const std::vector<bool>& isRemoved);
+		void AddEdge(std::uint32_t from, std::uint32_t to);
+		void RemoveEdge(std::uint32_t from, std::uint32_t to);
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const SSAFunction& function);
+}
+
+namespace svm::core {
+	struct SSAOptions final {
+		bool ConditionalConstantPropagation = true;
+		bool GlobalValueNumbering = true;
+		bool LoopInvariantCodeMotion = true;
+	};
+
+	struct SSAStatistics final {
+		std::uint64_t Functions = 0;
+		std::uint64_t Rejected = 0;
+		std::uint64_t OriginalCount = 0;
+		std::uint64_t ResultCount = 0;
+		std::uint64_t FoldedValues = 0;
+		std::uint64_t RemovedBranches = 0;
+		std::uint64_t RemovedBlocks = 0;
+		std::uint64_t NumberedValues = 0;
+		std::uint64_t HoistedValues = 0;
+		std::uint64_t DeadValues = 0;
+		std::uint64_t AddedConstants = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const SSAStatistics& statistics);
+}
+
+namespace svm::core {
+	class SSAOptimizer final {
+	private:
+		struct BuildState;
+
+	private:
+		SSAOptions m_Options;
+		std::vector<FunctionSignature> m_MappedFunctions;
+		std::vector<const StructureInfo*> m_MappedStructures;
+		SSAStatistics m_Statistics;
+
+	public:
+		SSAOptimizer() noexcept = default;
+		explicit SSAOptimizer(const SSAOptions& options) noexcept;
+		SSAOptimizer(const SSAOptions& options, std::vector<FunctionSignature> mappedFunctions,
+			std::vector<const StructureInfo*> mappedStructures) noexcept;
+		SSAOptimizer(const SSAOptimizer&) = delete;
+		~SSAOptimizer() = default;
+
+	public:
+		SSAOptimizer& operator=(const SSAOptimizer&) = delete;
+		bool operator==(const SSAOptimizer&) = delete;
+		bool operator!=(const SSAOptimizer&) = delete;
+
+	public:
+		void Optimize(ByteFile& byteFile);
+		bool Build(const ByteFile& byteFile, const Instructions& instructions, std::uint16_t arity, bool hasResult, SSAFunction& result) const;
+		void Optimize(SSAFunction& function);
+		bool Lower(const ByteFile& byteFile, const SSAFunction& function, Instructions& result) const;
+
+		const SSAOptions& GetOptions() const noexcept;
+		void SetOptions(const SSAOptions& newOptions) noexcept;
+		const SSAStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+
+	private:
+		bool Interpret(const ByteFile& byteFile, const Instruction& instruction, BuildState& state, SSAFunction& function) const;
+		bool PropagateConstants(SSAFunction& function);
+		bool NumberValues(SSAFunction& function);
+		bool HoistInvariants(SSAFunction& function);
+		bool EliminateDeadValues(SSAFunction& function);
+
+		void CompactLocals(Instructions& instructions, std::uint16_t arity, const std::vector<const TypeInfo*>& localTypes) const;
+		bool GetSignature(const ByteFile& byteFile, std::uint32_t function, FunctionSignature& result) const noexcept;
+		const TypeInfo* GetType(const ByteFile& byteFile, std::uint32_t code) const noexcept;
+	};
+}
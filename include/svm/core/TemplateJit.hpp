@@ -0,0 +1,124 @@
+#pragma once
+
+#include <svm/Predefined.hpp>
+#include <svm/core/ThreadedFunction.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#if defined(SVM_X64) && defined(__linux__) && !defined(SVM_NO_JIT)
+#	define SVM_JIT
+#endif
+
+namespace svm::core {
+	class ReferenceValue;
+
+	// The state shared between interpreted and compiled code. Index is the instruction to start at on entry and the
+	// instruction the interpreter has to execute on exit.
+	struct NativeFrame final {
+		ReferenceValue* Locals = nullptr;
+		ReferenceValue* Stack = nullptr;
+		std::uint64_t Index = 0;
+	};
+
+	struct JitOptions final {
+		bool IsEnabled = false;
+		std::uint64_t HotCount = 1000;
+	};
+
+	struct JitStatistics final {
+		std::uint64_t Compiled = 0;
+		std::uint64_t Rejected = 0;
+		std::uint64_t NativeInstructions = 0;
+		std::uint64_t ExitInstructions = 0;
+		std::uint64_t CodeSize = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const JitStatistics& statistics);
+}
+
+namespace svm::core {
+	class NativeFunction final {
+	private:
+		void* m_Code = nullptr;
+		std::size_t m_Size = 0;
+		std::vector<std::uint32_t> m_Entries;
+
+	public:
+		NativeFunction() noexcept = default;
+		NativeFunction(void* code, std::size_t size, std::vector<std::uint32_t> entries) noexcept;
+		NativeFunction(NativeFunction&& function) noexcept;
+		~NativeFunction();
+
+	public:
+		NativeFunction& operator=(NativeFunction&& function) noexcept;
+		bool operator==(const NativeFunction&) = delete;
+		bool operator!=(const NativeFunction&) = delete;
+
+	public:
+		bool IsEmpty() const noexcept;
+		std::size_t GetSize() const noexcept;
+
+		void Enter(NativeFrame& frame) const noexcept;
+	};
+}
+
+namespace svm::core {
+	// Compiled code lives in pages that are never writable and executable at the same time: they are filled while
+	// mapped read-write and only then made read-execute.
+	class CodeCache final {
+	private:
+		std::unordered_map<std::uint64_t, NativeFunction> m_Functions;
+		std::size_t m_CodeSize = 0;
+
+	public:
+		CodeCache() = default;
+		CodeCache(CodeCache&& cache) noexcept = default;
+		~CodeCache() = default;
+
+	public:
+		CodeCache& operator=(CodeCache&& cache) noexcept = default;
+		bool operator==(const CodeCache&) = delete;
+		bool operator!=(const CodeCache&) = delete;
+
+	public:
+		void Clear() noexcept;
+
+		const NativeFunction* Find(const ThreadedFunction& function) const noexcept;
+		const NativeFunction* Add(const ThreadedFunction& function, const std::vector<std::uint8_t>& code, std::vector<std::uint32_t> entries);
+		std::uint32_t GetFunctionCount() const noexcept;
+		std::size_t GetCodeSize() const noexcept;
+	};
+}
+
+namespace svm::core {
+	// Translates every instruction of a threaded function into a fixed x86-64 template that works on the frame of
+	// ReferenceInterpreter. Templates cover the arithmetic and object access fast paths; everything else, and every
+	// guard that fails, exits to the interpreter at the instruction, which can re-enter at any later one.
+	class TemplateCompiler final {
+	private:
+		JitStatistics m_Statistics;
+
+	public:
+		TemplateCompiler() noexcept = default;
+		TemplateCompiler(const TemplateCompiler&) = delete;
+		~TemplateCompiler() = default;
+
+	public:
+		TemplateCompiler& operator=(const TemplateCompiler&) = delete;
+		bool operator==(const TemplateCompiler&) = delete;
+		bool operator!=(const TemplateCompiler&) = delete;
+
+	public:
+		static bool IsSupported() noexcept;
+
+		const NativeFunction* Compile(const ThreadedFunction& function, CodeCache& cache);
+		bool Compile(const ThreadedFunction& function, std::vector<std::uint8_t>& code, std::vector<std::uint32_t>& entries);
+
+		const JitStatistics& GetStatistics() const noexcept;
+		void ResetStatistics() noexcept;
+	};
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/Type.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace svm::core {
+	class ThreadedInstruction final {
+	public:
+		svm::OpCode OpCode = svm::OpCode::Nop;
+		bool IsVirtualCall = false;
+		TypeCode ConstantType = TypeCode::None;
+		union {
+			std::uint64_t Operand = 0;
+			std::uint64_t Target;
+			std::uint32_t IntValue;
+			std::uint64_t LongValue;
+			float SingleValue;
+			double DoubleValue;
+			const TypeInfo* Type;
+			const FunctionInfo* Function;
+			const void* VirtualFunction;
+		};
+
+	public:
+		ThreadedInstruction() noexcept = default;
+		ThreadedInstruction(svm::OpCode opCode, std::uint64_t operand) noexcept;
+		ThreadedInstruction(const ThreadedInstruction& instruction) noexcept = default;
+		~ThreadedInstruction() = default;
+
+	public:
+		ThreadedInstruction& operator=(const ThreadedInstruction& instruction) noexcept = default;
+		bool operator==(const ThreadedInstruction&) = delete;
+		bool operator!=(const ThreadedInstruction&) = delete;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const ThreadedInstruction& instruction);
+}
+
+namespace svm::core {
+	// Each constructed function takes an id that is never reused, so caches keyed by it cannot mistake a function
+	// rebuilt at a freed address for the old one.
+	class ThreadedFunction final {
+	private:
+		const FunctionInfo* m_Function = nullptr;
+		std::vector<ThreadedInstruction> m_Instructions;
+		std::uint64_t m_Id = 0;
+
+	public:
+		ThreadedFunction() noexcept = default;
+		ThreadedFunction(const FunctionInfo* function, std::vector<ThreadedInstruction> instructions) noexcept;
+		ThreadedFunction(ThreadedFunction&& function) noexcept = default;
+		~ThreadedFunction() = default;
+
+	public:
+		ThreadedFunction& operator=(ThreadedFunction&& function) noexcept = default;
+		bool operator==(const ThreadedFunction&) = delete;
+		bool operator!=(const ThreadedFunction&) = delete;
+
+	public:
+		const FunctionInfo* GetFunction() const noexcept;
+		std::uint64_t GetId() const noexcept;
+		const ThreadedInstruction& GetInstruction(std::uint64_t index) const noexcept;
+		std::uint64_t GetInstructionCount() const noexcept;
+		const ThreadedInstruction* GetInstructions() const noexcept;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const ThreadedFunction& function);
+}
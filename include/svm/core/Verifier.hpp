@@ -0,0 +1,79 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/Structure.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/FrameAnalyzer.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace svm::core {
+	enum class VerifierError : std::uint8_t {
+		None,
+		InvalidOpCode,
+		InvalidLabel,
+		InvalidConstant,
+		InvalidFunction,
+		InvalidType,
+		InvalidLocal,
+		StackUnderflow,
+		StackMismatch,
+		TypeMismatch,
+		MissingResult,
+		FallOffEnd,
+	};
+
+	static constexpr const char* VerifierErrorMessages[] = {
+		"none",
+		"invalid opcode", "invalid label", "invalid constant", "invalid function", "invalid type", "invalid local",
+		"stack underflow", "stack mismatch", "type mismatch", "missing result", "fall off end",
+	};
+
+	struct VerifierResult final {
+		VerifierError Error = VerifierError::None;
+		std::uint64_t Instruction = 0;
+		VerificationLevel Level = VerificationLevel::Unverified;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const VerifierResult& result);
+}
+
+namespace svm::core {
+	class Verifier final {
+	private:
+		struct Value;
+		struct State;
+
+	private:
+		const ByteFile& m_ByteFile;
+		std::vector<FunctionSignature> m_MappedFunctions;
+		std::vector<const StructureInfo*> m_MappedStructures;
+
+	public:
+		explicit Verifier(const ByteFile& byteFile) noexcept;
+		Verifier(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions,
+			std::vector<const StructureInfo*> mappedStructures) noexcept;
+		Verifier(const Verifier&) = delete;
+		~Verifier() = default;
+
+	public:
+		Verifier& operator=(const Verifier&) = delete;
+		bool operator==(const Verifier&) = delete;
+		bool operator!=(const Verifier&) = delete;
+
+	public:
+		VerifierResult Verify(FunctionInfo& function) const;
+		VerifierResult Verify(const Instructions& instructions, std::uint16_t arity, bool hasResult) const;
+
+	private:
+		VerifierError CheckOperands(const Instructions& instructions, std::uint64_t& index) const;
+		VerifierError Interpret(const Instruction& instruction, State& state, bool hasResult, bool& isTypeSafe) const;
+		bool GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept;
+		const TypeInfo* GetType(std::uint32_t code) const noexcept;
+		const StructureInfo* GetStructure(const TypeInfo* type) const noexcept;
+	};
+}
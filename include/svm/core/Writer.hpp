@@ -0,0 +1,71 @@
+#pragma once
+
+#include <svm/Function.hpp>
+#include <svm/Instruction.hpp>
+#include <svm/Mapping.hpp>
+#include <svm/Specification.hpp>
+#include <svm/Structure.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ByteFile.hpp>
+#include <svm/core/ConstantPool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace svm::core {
+	class Writer final {
+	private:
+		std::vector<std::uint8_t> m_Buffer;
+		std::size_t m_Cursor = 0;
+
+	public:
+		Writer() noexcept = default;
+		Writer(Writer&& writer) noexcept = default;
+		~Writer() = default;
+
+	public:
+		Writer& operator=(Writer&& writer) noexcept = default;
+		bool operator==(const Writer&) = delete;
+		bool operator!=(const Writer&) = delete;
+
+	public:
+		void Clear() noexcept;
+
+		void Write(const ByteFile& byteFile);
+		void Save(const std::filesystem::path& path) const;
+		void Save(std::ostream& stream) const;
+		const std::vector<std::uint8_t>& GetResult() const noexcept;
+		std::vector<std::uint8_t> GetResult() noexcept;
+
+	private:
+		template<typename T>
+		void WriteFile(T value) noexcept;
+		inline void WriteFileString(std::string_view string) noexcept;
+		void WriteSectionInfo(std::uint64_t offset, std::uint64_t size) noexcept;
+
+		static std::size_t CalcSize(std::string_view string) noexcept;
+		static std::size_t CalcSize(const std::vector<Dependency>& dependencies) noexcept;
+		static std::size_t CalcSize(const Mappings& mappings) noexcept;
+		static std::size_t CalcSize(const ConstantPool& constantPool) noexcept;
+		static std::size_t CalcSize(const Structures& structures) noexcept;
+		static std::size_t CalcSize(const FunctionInfo& function);
+		static std::size_t CalcSize(const Instructions& instructions);
+
+		void WriteDependencies(const std::vector<Dependency>& dependencies) noexcept;
+		void WriteMappings(const Mappings& mappings) noexcept;
+		void WriteConstantPool(const ConstantPool& constantPool) noexcept;
+		template<typename T>
+		void WriteConstants(const std::vector<T>& pool) noexcept;
+		void WriteStructures(const Structures& structures, const Mappings& mappings, const std::vector<Dependency>& dependencies);
+		void WriteFunction(const FunctionInfo& function);
+		void WriteInstructions(const Instructions& instructions);
+
+		static TypeCode GetTypeCode(const Structures& structures, const Mappings& mappings, const std::vector<Dependency>& dependencies, Type type);
+	};
+}
+
+#include "detail/impl/Writer.hpp"
@@ -0,0 +1,555 @@
+#pragma once
+#include <svm/core/Inliner.hpp>
+
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ConstantPool.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace svm::core {
+	template<typename FI>
+	struct Inliner<FI>::Callee final {
+		const ModuleInfo<FI>* Module = nullptr;
+		std::uint32_t Index = 0;
+		const FunctionInfo* Function = nullptr; // nullptr if the callee is a virtual function.
+	};
+
+	template<typename FI>
+	struct Inliner<FI>::CallSite final {
+		std::uint64_t Index = 0;
+		Callee Target;
+		std::uint64_t CallCount = 0;
+		std::uint64_t Cost = 0;
+	};
+
+	template<typename FI>
+	struct Inliner<FI>::State final {
+		ModuleInfo<FI>* Module = nullptr;
+		ByteFile* File = nullptr;
+		std::map<std::pair<const ModuleInfo<FI>*, std::uint32_t>, CalleeStatus> Statuses;
+		std::vector<std::uint64_t> Growths;
+	};
+}
+
+namespace svm::core {
+	template<typename FI>
+	Inliner<FI>::Inliner(InlinerOptions options) noexcept
+		: m_Options(std::move(options)) {}
+
+	template<typename FI>
+	bool Inliner<FI>::Inline(ModuleInfo<FI>& module) {
+		assert(module.IsByteFile());
+
+		State state;
+		state.Module = &module;
+		state.File = &std::get<ByteFile>(module.Module);
+
+		Functions& functions = state.File->GetFunctions();
+		const auto funcCount = static_cast<std::uint32_t>(functions.size());
+		state.Growths.assign(funcCount + 1, 0);
+
+		bool result = false;
+		for (unsigned int i = 0; i < m_Options.MaxIterations; ++i) {
+			// Later iterations inline the calls exposed by the previous one; refusals are counted once.
+			const bool isCounting = i == 0;
+			bool isChanged = false;
+			for (std::uint32_t j = 0; j < funcCount; ++j) {
+				FunctionInfo& function = functions[j];
+				if (!Inline(state, function.Instructions, j, isCounting)) continue;
+
+				function.Frame = {};
+				function.Verification = VerificationLevel::Unverified;
+				isChanged = true;
+			}
+			isChanged |= Inline(state, state.File->GetEntrypoint(), funcCount, isCounting);
+
+			if (!isChanged) break;
+			result = true;
+		}
+
+		if (result) {
+			module.ClearThreadedFunctions();
+		}
+		return result;
+	}
+
+	template<typename FI>
+	const InlinerOptions& Inliner<FI>::GetOptions() const noexcept {
+		return m_Options;
+	}
+	template<typename FI>
+	void Inliner<FI>::SetOptions(InlinerOptions newOptions) noexcept {
+		m_Options = std::move(newOptions);
+	}
+	template<typename FI>
+	const InlinerStatistics& Inliner<FI>::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	template<typename FI>
+	void Inliner<FI>::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+
+	template<typename FI>
+	bool Inliner<FI>::Inline(State& state, Instructions& instructions, std::uint32_t caller, bool isCounting) {
+		std::vector<CallSite> callSites;
+		if (!SelectCallSites(state, instructions, caller, isCounting, callSites)) return false;
+
+		ImportConstants(state, callSites);
+
+		const Functions& functions = state.File->GetFunctions();
+		const std::uint16_t arity = caller < functions.size() ? functions[caller].Arity : 0;
+		std::uint32_t localCount = GetLocalCount(instructions, arity);
+
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		ArenaVector<Instruction> result;
+		std::vector<std::uint64_t> indexMap(instCount + 1);
+		std::vector<std::uint64_t> labels;
+		result.reserve(instCount);
+
+		// Callee locals are placed past the caller's, and callee labels past the caller's.
+		auto callSite = callSites.begin();
+		for (std::size_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			indexMap[i] = result.size();
+			if (callSite != callSites.end() && callSite->Index == i) {
+				const auto labelBase = static_cast<std::uint32_t>(labelCount + labels.size());
+				EmitCallee(state, *callSite, localCount, labelBase, inst.Offset, result, labels);
+				localCount += GetLocalCount(callSite->Target.Function->Instructions, callSite->Target.Function->Arity);
+				++callSite;
+			} else {
+				result.push_back(inst);
+			}
+		}
+		indexMap[instCount] = result.size();
+
+		instructions.SetInstructions(std::move(result), indexMap);
+		for (const std::uint64_t label : labels) {
+			instructions.AddLabel(label);
+		}
+		instructions.UpdateOffsets();
+		return true;
+	}
+	template<typename FI>
+	bool Inliner<FI>::SelectCallSites(State& state, const Instructions& instructions, std::uint32_t caller, bool isCounting,
+		std::vector<CallSite>& callSites) {
+		const CallProfile* const profile = m_Options.Profile.get();
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		for (std::uint64_t i = 0; i + 1 < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode != OpCode::Call) continue;
+
+			Callee callee;
+			if (!ResolveCallee(*state.Module, inst.Operand, callee)) continue;
+			if (callee.Module != state.Module && !m_Options.CrossModule) continue;
+
+			CalleeStatus status = CalleeStatus::Recursive;
+			if (callee.Module != state.Module || callee.Index != caller) {
+				status = GetStatus(state, callee);
+			}
+			if (status != CalleeStatus::Inlinable) {
+				if (isCounting && status == CalleeStatus::Recursive) {
+					++m_Statistics.RefusedRecursive;
+				} else if (isCounting) {
+					++m_Statistics.RefusedUnsupported;
+				}
+				continue;
+			}
+
+			// A profile lets hot callees grow past the static limit.
+			const FunctionInfo& function = *callee.Function;
+			const std::uint64_t callCount = profile ? profile->GetCallCount(callee.Module->GetPath(), function.Name) : 0;
+			const std::uint64_t maxSize = profile && callCount >= m_Options.HotCallCount ?
+				m_Options.MaxHotCalleeSize : m_Options.MaxCalleeSize;
+			const std::uint64_t size = function.Instructions.GetInstructionCount();
+			if (size > maxSize) {
+				if (isCounting) {
+					++m_Statistics.RefusedSize;
+				}
+				continue;
+			}
+
+			// The call is replaced by a store for each argument and the callee's instructions.
+			callSites.push_back({ i, callee, callCount, function.Arity + size - 1 });
+		}
+
+		// Hotter and then smaller callees are given the budget first.
+		std::stable_sort(callSites.begin(), callSites.end(), [](const CallSite& lhs, const CallSite& rhs) {
+			if (lhs.CallCount != rhs.CallCount) return lhs.CallCount > rhs.CallCount;
+			else return lhs.Cost < rhs.Cost;
+		});
+
+		std::uint64_t& growth = state.Growths[caller];
+		std::vector<CallSite> selected;
+		for (const CallSite& callSite : callSites) {
+			if (growth + callSite.Cost > m_Options.MaxCallerGrowth) {
+				if (isCounting) {
+					++m_Statistics.RefusedBudget;
+				}
+				continue;
+			}
+
+			growth += callSite.Cost;
+			++m_Statistics.Inlined;
+			m_Statistics.AddedInstructions += callSite.Cost;
+			selected.push_back(callSite);
+		}
+		callSites = std::move(selected);
+
+		std::sort(callSites.begin(), callSites.end(), [](const CallSite& lhs, const CallSite& rhs) {
+			return lhs.Index < rhs.Index;
+		});
+		return !callSites.empty();
+	}
+	template<typename FI>
+	void Inliner<FI>::ImportConstants(State& state, const std::vector<CallSite>& callSites) {
+		ConstantPool& constantPool = state.File->GetConstantPool();
+		const ConstantPoolLayout oldLayout = constantPool.GetLayout();
+		for (const CallSite& callSite : callSites) {
+			if (callSite.Target.Module == state.Module) continue;
+
+			const ConstantPool& calleePool = std::get<ByteFile>(callSite.Target.Module->Module).GetConstantPool();
+			const Instructions& instructions = callSite.Target.Function->Instructions;
+			const std::uint64_t instCount = instructions.GetInstructionCount();
+			for (std::uint64_t i = 0; i < instCount; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (inst.OpCode == OpCode::Push) {
+					constantPool.ImportConstant(calleePool, inst.Operand);
+				}
+			}
+		}
+
+		const ConstantPoolLayout layout = constantPool.GetLayout();
+		if (layout.AllCount == oldLayout.AllCount) return;
+
+		const auto remap = [&](Instructions& instructions) {
+			const std::uint64_t instCount = instructions.GetInstructionCount();
+			for (std::uint64_t i = 0; i < instCount; ++i) {
+				Instruction inst = instructions.GetInstruction(i);
+				if (inst.OpCode != OpCode::Push) continue;
+
+				inst.Operand = oldLayout.Remap(inst.Operand, layout);
+				instructions.SetInstruction(i, inst);
+			}
+		};
+		for (FunctionInfo& function : state.File->GetFunctions()) {
+			remap(function.Instructions);
+		}
+		remap(state.File->GetEntrypoint());
+	}
+	template<typename FI>
+	void Inliner<FI>::EmitCallee(State& state, const CallSite& callSite, std::uint32_t localBase, std::uint32_t labelBase,
+		std::uint64_t offset, ArenaVector<Instruction>& result, std::vector<std::uint64_t>& labels) {
+		const FunctionInfo& function = *callSite.Target.Function;
+		const Instructions& instructions = function.Instructions;
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		const bool isForeign = callSite.Target.Module != state.Module;
+		const ConstantPool& constantPool = state.File->GetConstantPool();
+		const ConstantPool& calleePool = std::get<ByteFile>(callSite.Target.Module->Module).GetConstantPool();
+
+		// Arguments are on the stack with the last one on top.
+		for (std::uint16_t i = function.Arity; i-- > 0;) {
+			result.push_back(Instruction(OpCode::Store, localBase + i, offset));
+		}
+
+		// Returns jump past the callee, except the last one, which falls through.
+		const std::uint64_t begin = result.size();
+		const std::uint32_t endLabel = labelBase + labelCount;
+		bool hasEndLabel = false;
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			Instruction inst = instructions.GetInstruction(i);
+			inst.Offset = offset;
+
+			switch (inst.OpCode) {
+			case OpCode::Push:
+				if (isForeign) {
+					inst.Operand = constantPool.FindConstant(calleePool, inst.Operand);
+				}
+				break;
+
+			case OpCode::Load:
+			case OpCode::Store:
+			case OpCode::Lea:
+				inst.Operand += localBase;
+				break;
+
+			case OpCode::Jmp:
+			case OpCode::Je:
+			case OpCode::Jne:
+			case OpCode::Ja:
+			case OpCode::Jae:
+			case OpCode::Jb:
+			case OpCode::Jbe:
+				inst.Operand += labelBase;
+				break;
+
+			case OpCode::Call:
+				if (isForeign) {
+					inst.Operand = TranslateCall(state, callSite.Target, inst.Operand);
+				}
+				break;
+
+			case OpCode::Ret:
+				if (i + 1 == instCount) continue;
+
+				inst = Instruction(OpCode::Jmp, endLabel, offset);
+				hasEndLabel = true;
+				break;
+
+			default:
+				break;
+			}
+			result.push_back(inst);
+		}
+
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			labels.push_back(begin + instructions.GetLabel(i));
+		}
+		if (hasEndLabel) {
+			labels.push_back(result.size());
+		}
+	}
+
+	template<typename FI>
+	typename Inliner<FI>::CalleeStatus Inliner<FI>::GetStatus(State& state, const Callee& callee) const {
+		const auto key = std::make_pair(callee.Module, callee.Index);
+		if (const auto iter = state.Statuses.find(key); iter != state.Statuses.end()) return iter->second;
+
+		CalleeStatus result = CalleeStatus::Inlinable;
+		if (!callee.Function || !IsBalanced(*callee.Module, *callee.Function) ||
+			(callee.Module != state.Module && !CanTranslate(state, callee))) {
+			result = CalleeStatus::Unsupported;
+		} else if (IsRecursive(callee)) {
+			result = CalleeStatus::Recursive;
+		}
+		return state.Statuses[key] = result;
+	}
+	template<typename FI>
+	bool Inliner<FI>::IsBalanced(const ModuleInfo<FI>& module, const FunctionInfo& function) const {
+		const Instructions& instructions = function.Instructions;
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		if (instCount == 0) return false;
+
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			if (instructions.GetLabel(i) >= instCount) return false;
+		}
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode >= OpCode::Count) return false;
+			if (IsJump(inst.OpCode) && inst.Operand >= labelCount) return false;
+		}
+
+		// Every path must reach a return with exactly the result on the stack.
+		constexpr std::uint64_t unvisited = std::numeric_limits<std::uint64_t>::max();
+		const ControlFlowGraph graph(instructions);
+		std::vector<std::uint64_t> depths(graph.GetBlockCount(), unvisited);
+		std::vector<std::uint32_t> worklist{ 0 };
+		depths[0] = 0;
+
+		while (!worklist.empty()) {
+			const std::uint32_t block = worklist.back();
+			worklist.pop_back();
+
+			std::uint64_t depth = depths[block];
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				std::uint32_t popCount = 0, pushCount = 0;
+				if (inst.OpCode == OpCode::Call) {
+					FunctionSignature signature;
+					if (!GetSignature(module, inst.Operand, signature)) return false;
+
+					popCount = signature.Arity;
+					pushCount = signature.HasResult;
+				} else if (!GetStackEffect(inst.OpCode, popCount, pushCount)) return false;
+
+				if (depth < popCount) return false;
+				depth = depth - popCount + pushCount;
+				if (inst.OpCode == OpCode::Ret && depth != static_cast<std::uint64_t>(function.HasResult)) return false;
+			}
+			if (range.End == instCount && !IsTerminator(instructions.GetInstruction(range.End - 1).OpCode)) return false;
+
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				if (depths[successor] == unvisited) {
+					depths[successor] = depth;
+					worklist.push_back(successor);
+				} else if (depths[successor] != depth) return false;
+			}
+		}
+		return true;
+	}
+	template<typename FI>
+	bool Inliner<FI>::IsRecursive(const Callee& callee) const {
+		std::set<std::pair<const ModuleInfo<FI>*, std::uint32_t>> visited;
+		std::vector<const FunctionInfo*> worklist{ callee.Function };
+		std::vector<const ModuleInfo<FI>*> modules{ callee.Module };
+		while (!worklist.empty()) {
+			const FunctionInfo* const function = worklist.back();
+			const ModuleInfo<FI>* const module = modules.back();
+			worklist.pop_back();
+			modules.pop_back();
+
+			const Instructions& instructions = function->Instructions;
+			const std::uint64_t instCount = instructions.GetInstructionCount();
+			for (std::uint64_t i = 0; i < instCount; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				Callee next;
+				if (inst.OpCode != OpCode::Call || !ResolveCallee(*module, inst.Operand, next)) continue;
+				if (next.Module == callee.Module && next.Index == callee.Index) return true;
+				if (!next.Function || !visited.emplace(next.Module, next.Index).second) continue;
+
+				worklist.push_back(next.Function);
+				modules.push_back(next.Module);
+			}
+		}
+		return false;
+	}
+	template<typename FI>
+	bool Inliner<FI>::CanTranslate(const State& state, const Callee& callee) const {
+		// Structures of another module would need mappings of their own, so such callees are left alone.
+		const ByteFile& byteFile = std::get<ByteFile>(callee.Module->Module);
+		const std::uint32_t constCount = byteFile.GetConstantPool().GetAllCount();
+		const std::uint32_t dependencyCount = state.Module->GetDependencyCount();
+
+		const Instructions& instructions = callee.Function->Instructions;
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			switch (inst.OpCode) {
+			case OpCode::Push:
+				if (inst.Operand >= constCount) return false;
+				break;
+
+			case OpCode::New:
+			case OpCode::GCNew:
+			case OpCode::APush:
+			case OpCode::ANew:
+			case OpCode::AGCNew:
+				if (inst.Operand >= static_cast<std::uint32_t>(TypeCode::Structure)) return false;
+				break;
+
+			case OpCode::Call: {
+				Callee target;
+				if (!ResolveCallee(*callee.Module, inst.Operand, target)) return false;
+				if (target.Module == state.Module) break;
+
+				bool isDependency = false;
+				for (std::uint32_t j = 0; j < dependencyCount && !isDependency; ++j) {
+					isDependency = state.Module->GetDependency(j).Module == target.Module;
+				}
+				if (!isDependency) return false;
+				break;
+			}
+
+			default:
+				break;
+			}
+		}
+		return true;
+	}
+	template<typename FI>
+	std::uint32_t Inliner<FI>::TranslateCall(State& state, const Callee& callee, std::uint32_t operand) const {
+		Callee target;
+		ResolveCallee(*callee.Module, operand, target);
+		if (target.Module == state.Module) return target.Index;
+
+		std::uint32_t dependency = 0;
+		while (state.Module->GetDependency(dependency).Module != target.Module) {
+			++dependency;
+		}
+
+		const auto function = target.Module->GetFunction(target.Index);
+		const std::string_view name = std::holds_alternative<Function>(function) ?
+			std::get<Function>(function)->Name : std::get<VirtualFunction<FI>>(function)->GetName();
+
+		const auto funcCount = static_cast<std::uint32_t>(state.File->GetFunctions().size());
+		Mappings& mappings = state.File->GetMappings();
+		const std::uint32_t mappingCount = mappings.GetFunctionMappingCount();
+		for (std::uint32_t i = 0; i < mappingCount; ++i) {
+			const FunctionMapping& mapping = mappings.GetFunctionMapping(i);
+			if (mapping.Module == dependency && mapping.Name == name) return funcCount + i;
+		}
+
+		mappings.AddFunctionMapping(dependency, name, state.File->GetStringPool());
+		return funcCount + mappingCount;
+	}
+
+	template<typename FI>
+	bool Inliner<FI>::ResolveCallee(const ModuleInfo<FI>& module, std::uint32_t operand, Callee& result) noexcept {
+		if (!module.IsByteFile()) return false;
+
+		const ByteFile& byteFile = std::get<ByteFile>(module.Module);
+		const Functions& functions = byteFile.GetFunctions();
+		if (operand < functions.size()) {
+			result = { &module, operand, &functions[operand] };
+			return true;
+		}
+
+		const Mappings& mappings = byteFile.GetMappings();
+		const std::uint64_t mappingIndex = operand - functions.size();
+		if (mappingIndex >= mappings.GetFunctionMappingCount()) return false;
+
+		const FunctionMapping& mapping = mappings.GetFunctionMapping(static_cast<std::uint32_t>(mappingIndex));
+		if (mapping.Module >= module.GetDependencyCount()) return false;
+
+		const auto dependency = static_cast<const ModuleInfo<FI>*>(module.GetDependency(mapping.Module).Module);
+		if (!dependency || dependency->IsEmpty()) return false;
+
+		if (dependency->IsByteFile()) {
+			const Functions& dependencyFunctions = std::get<ByteFile>(dependency->Module).GetFunctions();
+			const auto iter = std::find_if(dependencyFunctions.begin(), dependencyFunctions.end(), [&mapping](const auto& function) {
+				return mapping.Name == function.Name;
+			});
+			if (iter == dependencyFunctions.end()) return false;
+
+			result = { dependency, static_cast<std::uint32_t>(iter - dependencyFunctions.begin()), &*iter };
+		} else {
+			const VirtualFunctions<FI>& dependencyFunctions = std::get<VirtualModule<FI>>(dependency->Module).GetFunctions();
+			const auto iter = std::find_if(dependencyFunctions.begin(), dependencyFunctions.end(), [&mapping](const auto& function) {
+				return mapping.Name == function.GetName();
+			});
+			if (iter == dependencyFunctions.end()) return false;
+
+			result = { dependency, static_cast<std::uint32_t>(iter - dependencyFunctions.begin()), nullptr };
+		}
+		return true;
+	}
+	template<typename FI>
+	bool Inliner<FI>::GetSignature(const ModuleInfo<FI>& module, std::uint32_t operand, FunctionSignature& result) noexcept {
+		Callee callee;
+		if (!ResolveCallee(module, operand, callee)) return false;
+
+		const auto function = callee.Module->GetFunction(callee.Index);
+		if (std::holds_alternative<Function>(function)) {
+			result.Arity = std::get<Function>(function)->Arity;
+			result.HasResult = std::get<Function>(function)->HasResult;
+		} else {
+			result.Arity = std::get<VirtualFunction<FI>>(function)->GetArity();
+			result.HasResult = std::get<VirtualFunction<FI>>(function)->HasResult();
+		}
+		return true;
+	}
+	template<typename FI>
+	std::uint32_t Inliner<FI>::GetLocalCount(const Instructions& instructions, std::uint16_t arity) {
+		std::uint32_t result = arity;
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Store || inst.OpCode == OpCode::Lea) {
+				result = std::max(result, inst.Operand + 1);
+			}
+		}
+		return result;
+	}
+}
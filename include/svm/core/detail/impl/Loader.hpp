@@ -3,42 +3,67 @@
 
 #include <svm/Memory.hpp>
 #include <svm/Structure.hpp>
-#include <svm/core/Parser.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <memory>
 #include <iterator>
 #include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace svm::core {
 	template<typename FI>
 	Loader<FI>::Loader(Loader&& loader) noexcept
-		: m_Modules(std::move(loader.m_Modules)), m_LibraryDirectories(std::move(loader.m_LibraryDirectories)){}
+		: m_Modules(std::move(loader.m_Modules)), m_LibraryDirectories(std::move(loader.m_LibraryDirectories)),
+		m_ParseOptions(loader.m_ParseOptions), m_Images(std::move(loader.m_Images)) {}
 
 	template<typename FI>
 	Loader<FI>& Loader<FI>::operator=(Loader&& loader) noexcept {
 		m_Modules = std::move(loader.m_Modules);
 		m_LibraryDirectories = std::move(loader.m_LibraryDirectories);
+		m_ParseOptions = loader.m_ParseOptions;
+		m_Images = std::move(loader.m_Images);
 		return *this;
 	}
 
 	template<typename FI>
 	void Loader<FI>::Clear() noexcept {
 		m_Modules.clear();
+		m_Images.clear();
 	}
 
 	template<typename FI>
 	void Loader<FI>::AddLibraryDirectory(const std::filesystem::path& path) {
 		m_LibraryDirectories.push_back(std::filesystem::canonical(path));
 	}
+	template<typename FI>
+	const ParseOptions& Loader<FI>::GetParseOptions() const noexcept {
+		return m_ParseOptions;
+	}
+	template<typename FI>
+	void Loader<FI>::SetParseOptions(const ParseOptions& newParseOptions) noexcept {
+		m_ParseOptions = newParseOptions;
+	}
 
 	template<typename FI>
 	Module<FI> Loader<FI>::Load(const std::filesystem::path& path) {
 		Parser parser;
 		parser.Open(path);
+		return Load(parser);
+	}
+	template<typename FI>
+	Module<FI> Loader<FI>::Load(const std::uint8_t* data, std::size_t size, ModulePath path) {
+		Parser parser;
+		parser.Open(data, size, std::move(path));
+		return Load(parser);
+	}
+	template<typename FI>
+	Module<FI> Loader<FI>::Load(Parser& parser) {
+		parser.SetOptions(m_ParseOptions);
 		parser.Parse();
 
 		const auto index = static_cast<std::uint32_t>(m_Modules.size());
@@ -47,7 +72,35 @@ namespace svm::core {
 		byteFile.UpdateFunctionInfos(index);
 
 		auto result = m_Modules.emplace_back(std::make_unique<ModuleInfo<FI>>(std::move(byteFile))).get();
-		LoadDependencies(result);
+		try {
+			LoadDependencies(result);
+			if (m_ParseOptions.Inlining) {
+				Inliner<FI> inliner(m_ParseOptions.Inliner);
+				inliner.Inline(*result);
+			}
+			if (m_ParseOptions.ConstantFolding) {
+				result->FoldConstants();
+			}
+			if (m_ParseOptions.SSAOptimization) {
+				result->OptimizeSSA(m_ParseOptions.SSA);
+			}
+			if (m_ParseOptions.DeadCodeElimination) {
+				result->EliminateDeadCode(m_ParseOptions.DeadCode);
+			}
+			if (m_ParseOptions.Verification) {
+				result->Verify();
+			}
+			if (m_ParseOptions.FrameAnalysis) {
+				result->AnalyzeFrames();
+			} else {
+				// Frames stored in the file are kept only for functions that were verified and not changed since.
+				result->ResetUnverifiedFrames();
+			}
+		} catch (...) {
+			// Every module after this one was loaded as its dependency, and only this one refers to them.
+			m_Modules.erase(m_Modules.begin() + index, m_Modules.end());
+			throw;
+		}
 		return *result;
 	}
 	template<typename FI>
@@ -77,6 +130,167 @@ namespace svm::core {
 
 		LoadDependencies(moduleIter->get());
 	}
+	template<typename FI>
+	bool Loader<FI>::LoadImage(const std::filesystem::path& path) {
+		LinkedImage image;
+		if (!image.Open(path) || !image.IsUpToDate()) return false;
+
+		const auto& linkedModules = image.GetModules();
+		const auto linkedModuleCount = static_cast<std::uint32_t>(linkedModules.size());
+		std::vector<ModuleInfo<FI>*> modules(linkedModuleCount);
+		std::vector<std::uint32_t> moduleIndices(linkedModuleCount);
+		std::vector<bool> isNewModules(linkedModuleCount);
+		Modules<FI> newModules;
+
+		for (std::uint32_t i = 0; i < linkedModuleCount; ++i) {
+			const LinkedModule& linkedModule = linkedModules[i];
+			if (const auto module = GetModuleInternal(linkedModule.Path); module) {
+				modules[i] = module;
+				moduleIndices[i] = GetModuleIndex(module);
+				continue;
+			} else if (linkedModule.IsExternal()) return false;
+
+			ByteFile byteFile;
+			if (!LinkedImage::ReadState(linkedModule, m_ParseOptions, byteFile)) return false;
+
+			const auto index = static_cast<std::uint32_t>(m_Modules.size() + newModules.size());
+			byteFile.UpdateStructureInfos(index);
+			byteFile.UpdateFunctionInfos(index);
+
+			modules[i] = newModules.emplace_back(std::make_unique<ModuleInfo<FI>>(std::move(byteFile))).get();
+			moduleIndices[i] = index;
+			isNewModules[i] = true;
+		}
+
+		for (std::uint32_t i = 0; i < linkedModuleCount; ++i) {
+			if (!isNewModules[i]) continue;
+
+			const LinkedModule& linkedModule = linkedModules[i];
+			ModuleInfo<FI>* const module = modules[i];
+
+			const std::uint32_t dependencyCount = module->GetDependencyCount();
+			if (dependencyCount != linkedModule.Dependencies.size()) return false;
+			for (std::uint32_t j = 0; j < dependencyCount; ++j) {
+				Dependency& dependency = module->GetDependency(j);
+				dependency.Module = modules[linkedModule.Dependencies[j]];
+				dependency.ModuleIndex = moduleIndices[linkedModule.Dependencies[j]];
+			}
+
+			const std::uint32_t structCount = module->GetStructureCount();
+			if (structCount != linkedModule.Structures.size()) return false;
+			for (std::uint32_t j = 0; j < structCount; ++j) {
+				StructureInfo& structure = module->GetStructure(j);
+				const LinkedStructure& linkedStructure = linkedModule.Structures[j];
+				if (structure.Fields.size() != linkedStructure.Fields.size()) return false;
+
+				structure.Type.Size = static_cast<std::size_t>(linkedStructure.Size);
+				for (std::size_t k = 0; k < structure.Fields.size(); ++k) {
+					Field& field = structure.Fields[k];
+					const LinkedField& linkedField = linkedStructure.Fields[k];
+
+					field.Offset = static_cast<std::size_t>(linkedField.Offset);
+					if (linkedField.Module == LinkedImage::NPos) continue;
+
+					ModuleInfo<FI>* const fieldModule = modules[linkedField.Module];
+					if (linkedField.Structure >= fieldModule->GetStructureCount()) return false;
+
+					field.Type = fieldModule->GetStructure(linkedField.Structure).Type;
+				}
+			}
+		}
+
+		if (m_ParseOptions.Inlining) {
+			Inliner<FI> inliner(m_ParseOptions.Inliner);
+			for (const auto& module : newModules) {
+				inliner.Inline(*module);
+			}
+		}
+		if (m_ParseOptions.ConstantFolding) {
+			for (const auto& module : newModules) {
+				module->FoldConstants();
+			}
+		}
+		if (m_ParseOptions.SSAOptimization) {
+			for (const auto& module : newModules) {
+				module->OptimizeSSA(m_ParseOptions.SSA);
+			}
+		}
+		if (m_ParseOptions.DeadCodeElimination) {
+			for (const auto& module : newModules) {
+				module->EliminateDeadCode(m_ParseOptions.DeadCode);
+			}
+		}
+		if (m_ParseOptions.Verification) {
+			for (const auto& module : newModules) {
+				module->Verify();
+			}
+		}
+		for (const auto& module : newModules) {
+			if (m_ParseOptions.FrameAnalysis) {
+				module->AnalyzeFrames();
+			} else {
+				module->ResetUnverifiedFrames();
+			}
+		}
+
+		std::move(newModules.begin(), newModules.end(), std::back_inserter(m_Modules));
+		if (m_ParseOptions.LazyFunctions) {
+			m_Images.push_back(std::move(image));
+		}
+		return true;
+	}
+	template<typename FI>
+	void Loader<FI>::SaveImage(const std::filesystem::path& path) const {
+		const auto moduleCount = static_cast<std::uint32_t>(m_Modules.size());
+		std::vector<LinkedModule> linkedModules(moduleCount);
+		std::vector<std::vector<std::uint8_t>> states(moduleCount);
+
+		for (std::uint32_t i = 0; i < moduleCount; ++i) {
+			const ModuleInfo<FI>& module = *m_Modules[i];
+			LinkedModule& linkedModule = linkedModules[i];
+			linkedModule.Path = module.GetPath();
+
+			if (module.IsByteFile() && std::holds_alternative<std::filesystem::path>(linkedModule.Path)) {
+				const auto& modulePath = std::get<std::filesystem::path>(linkedModule.Path);
+				if (!LinkedImage::StatFile(modulePath, linkedModule.FileSize, linkedModule.FileTime) ||
+					!LinkedImage::HashFile(modulePath, linkedModule.Hash)) throw std::runtime_error("Failed to open the file.");
+
+				states[i] = LinkedImage::WriteState(std::get<ByteFile>(module.Module));
+				linkedModule.State = states[i].data();
+				linkedModule.StateSize = states[i].size();
+			}
+
+			const std::uint32_t dependencyCount = module.GetDependencyCount();
+			linkedModule.Dependencies.resize(dependencyCount);
+			for (std::uint32_t j = 0; j < dependencyCount; ++j) {
+				linkedModule.Dependencies[j] = GetModuleIndex(module.GetDependency(j).Module);
+			}
+
+			const std::uint32_t structCount = module.GetStructureCount();
+			linkedModule.Structures.resize(structCount);
+			for (std::uint32_t j = 0; j < structCount; ++j) {
+				const Structure structure = module.GetStructure(j);
+				LinkedStructure& linkedStructure = linkedModule.Structures[j];
+
+				linkedStructure.Size = structure->Type.Size;
+				linkedStructure.Fields.resize(structure->Fields.size());
+				for (std::size_t k = 0; k < structure->Fields.size(); ++k) {
+					const Field& field = structure->Fields[k];
+					LinkedField& linkedField = linkedStructure.Fields[k];
+
+					linkedField.Offset = field.Offset;
+					if (!field.Type.IsStructure()) continue;
+
+					linkedField.Module = field.Type->Module;
+					linkedField.Structure = static_cast<std::uint32_t>(field.Type->Code) - static_cast<std::uint32_t>(TypeCode::Structure);
+				}
+			}
+		}
+
+		LinkedImage image;
+		image.SetModules(std::move(linkedModules));
+		image.Save(path);
+	}
 
 	template<typename FI>
 	Module<FI> Loader<FI>::GetModule(std::uint32_t index) const noexcept {
@@ -104,6 +318,39 @@ namespace svm::core {
 		m_Modules = std::move(newModules);
 	}
 
+	template<typename FI>
+	std::uint32_t Loader<FI>::SweepFunctions() {
+		// Functions mapped by any other loaded module are exported; modules loaded later may not map swept functions.
+		std::unordered_map<const void*, std::vector<std::string_view>> exports;
+		for (const auto& module : m_Modules) {
+			const Mappings& mappings = module->GetMappings();
+			const std::uint32_t funcMappingCount = mappings.GetFunctionMappingCount();
+			for (std::uint32_t i = 0; i < funcMappingCount; ++i) {
+				const FunctionMapping& mapping = mappings.GetFunctionMapping(i);
+				if (mapping.Module >= module->GetDependencyCount()) throw std::runtime_error("Failed to sweep the functions. Invalid mapping.");
+
+				exports[module->GetDependency(mapping.Module).Module].push_back(mapping.Name);
+			}
+		}
+
+		std::uint32_t result = 0;
+		for (const auto& module : m_Modules) {
+			if (!module->IsByteFile()) continue;
+
+			result += module->SweepFunctions(exports[module.get()]);
+		}
+		if (result == 0) return 0;
+
+		// Threaded calls through mappings point at functions of other modules, which a sweep moves. Every threaded
+		// function is built again, so interpreters used before the sweep must be cleared or created again.
+		for (const auto& module : m_Modules) {
+			if (module->IsByteFile()) {
+				module->ClearThreadedFunctions();
+			}
+		}
+		return result;
+	}
+
 	template<typename FI>
 	ModulePath Loader<FI>::ResolveDependency(Module<FI> module, const std::string& dependency) const {
 		if (dependency[0] == '/') {
@@ -144,6 +391,7 @@ namespace svm::core {
 			} else {
 				dependency.Module = Load(std::get<std::filesystem::path>(dependencyPath)).GetPointer();
 			}
+			dependency.ModuleIndex = GetModuleIndex(dependency.Module);
 		}
 
 		const auto structCount = module->GetStructureCount();
@@ -254,4 +502,11 @@ namespace svm::core {
 		if (iter == m_Modules.end()) return nullptr;
 		else return iter->get();
 	}
+	template<typename FI>
+	std::uint32_t Loader<FI>::GetModuleIndex(const void* module) const noexcept {
+		const auto iter = std::find_if(m_Modules.begin(), m_Modules.end(), [module](const auto& module2) {
+			return module2.get() == module;
+		});
+		return static_cast<std::uint32_t>(std::distance(m_Modules.begin(), iter));
+	}
 }
\ No newline at end of file
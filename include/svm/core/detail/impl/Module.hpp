@@ -2,23 +2,51 @@
 #include <svm/core/Module.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace svm::core {
 	template<typename FI>
-	ModuleInfo<FI>::ModuleInfo(ByteFile&& byteFile) noexcept
-		: Module(std::move(byteFile)) {}
+	struct ModuleInfo<FI>::ThreadedCache final {
+		std::vector<std::atomic<const ThreadedFunction*>> Functions;
+		std::atomic<const FunctionMap*> Map = nullptr;
+
+		explicit ThreadedCache(std::size_t count)
+			: Functions(count) {
+			for (auto& function : Functions) {
+				function.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+		~ThreadedCache() {
+			for (auto& function : Functions) {
+				delete function.load(std::memory_order_relaxed);
+			}
+			delete Map.load(std::memory_order_relaxed);
+		}
+	};
+}
+
+namespace svm::core {
+	template<typename FI>
+	ModuleInfo<FI>::ModuleInfo(ByteFile&& byteFile)
+		: Module(std::move(byteFile)),
+		m_ThreadedCache(std::make_unique<ThreadedCache>(std::get<ByteFile>(Module).GetFunctions().size() + 1)) {}
 	template<typename FI>
 	ModuleInfo<FI>::ModuleInfo(VirtualModule<FI>&& virtualModule) noexcept
 		: Module(std::move(virtualModule)) {}
 	template<typename FI>
 	ModuleInfo<FI>::ModuleInfo(ModuleInfo&& moduleInfo) noexcept
-		: Module(std::move(moduleInfo.Module)) {}
+		: Module(std::move(moduleInfo.Module)), m_ThreadedCache(std::move(moduleInfo.m_ThreadedCache)) {}
 
 	template<typename FI>
 	ModuleInfo<FI>& ModuleInfo<FI>::operator=(ModuleInfo&& moduleInfo) noexcept {
 		Module = std::move(moduleInfo.Module);
+		m_ThreadedCache = std::move(moduleInfo.m_ThreadedCache);
 		return *this;
 	}
 
@@ -71,12 +99,12 @@ namespace svm::core {
 		else return std::get<VirtualModule<FI>>(Module).GetStructures()[index];
 	}
 	template<typename FI>
-	Structure ModuleInfo<FI>::GetStructure(const std::string& name) const noexcept {
+	Structure ModuleInfo<FI>::GetStructure(std::string_view name) const noexcept {
 		assert(!IsEmpty());
 
 		const Structures* structures = IsByteFile() ? &std::get<ByteFile>(Module).GetStructures()
 													: &std::get<VirtualModule<FI>>(Module).GetStructures();
-		const auto iter = std::find_if(structures->begin(), structures->end(), [&name](const auto& structure) {
+		const auto iter = std::find_if(structures->begin(), structures->end(), [name](const auto& structure) {
 			return name == structure.Name;
 		});
 		assert(iter != structures->end());
@@ -104,19 +132,19 @@ namespace svm::core {
 		else return std::get<VirtualModule<FI>>(Module).GetFunctions()[index];
 	}
 	template<typename FI>
-	std::variant<Function, VirtualFunction<FI>> ModuleInfo<FI>::GetFunction(const std::string& name) const noexcept {
+	std::variant<Function, VirtualFunction<FI>> ModuleInfo<FI>::GetFunction(std::string_view name) const noexcept {
 		assert(!IsEmpty());
 
 		if (IsByteFile()) {
 			const Functions& functions = std::get<ByteFile>(Module).GetFunctions();
-			const auto iter = std::find_if(functions.begin(), functions.end(), [&name](const auto& function) {
+			const auto iter = std::find_if(functions.begin(), functions.end(), [name](const auto& function) {
 				return name == function.Name;
 			});
 			assert(iter != functions.end());
 			return *iter;
 		} else {
 			const VirtualFunctions<FI>& functions = std::get<VirtualModule<FI>>(Module).GetFunctions();
-			const auto iter = std::find_if(functions.begin(), functions.end(), [&name](const auto& function) {
+			const auto iter = std::find_if(functions.begin(), functions.end(), [name](const auto& function) {
 				return name == function.GetName();
 			});
 			assert(iter != functions.end());
@@ -145,4 +173,480 @@ namespace svm::core {
 		if (IsByteFile()) return std::get<ByteFile>(Module).UpdateStructureInfos(module);
 		else return std::get<VirtualModule<FI>>(Module).UpdateStructureInfos(module);
 	}
+
+	template<typename FI>
+	const ThreadedFunction& ModuleInfo<FI>::GetThreadedFunction(std::uint32_t index) const {
+		assert(IsByteFile());
+
+		const Functions& functions = std::get<ByteFile>(Module).GetFunctions();
+		return GetThreadedFunction(index, &functions[index], functions[index].Instructions);
+	}
+	template<typename FI>
+	const ThreadedFunction& ModuleInfo<FI>::GetThreadedFunction(const FunctionInfo& function) const {
+		assert(IsByteFile());
+
+		const std::uint32_t index = GetFunctionIndex(function);
+		if (index == FunctionMap::NPos) throw std::runtime_error("Failed to build the threaded function. The function does not belong to the module.");
+
+		return GetThreadedFunction(index, &function, function.Instructions);
+	}
+	template<typename FI>
+	const ThreadedFunction& ModuleInfo<FI>::GetThreadedEntrypoint() const {
+		assert(IsByteFile());
+
+		const ByteFile& byteFile = std::get<ByteFile>(Module);
+		return GetThreadedFunction(static_cast<std::uint32_t>(byteFile.GetFunctions().size()), nullptr, byteFile.GetEntrypoint());
+	}
+	template<typename FI>
+	ConstantFoldingStatistics ModuleInfo<FI>::FoldConstants() {
+		assert(IsByteFile());
+
+		std::vector<FunctionSignature> mappedFunctions;
+		std::vector<const StructureInfo*> mappedStructures;
+		ResolveMappings(mappedFunctions, mappedStructures);
+
+		ConstantFolder folder(std::move(mappedFunctions));
+		folder.Fold(std::get<ByteFile>(Module));
+		ClearThreadedFunctions();
+		return folder.GetStatistics();
+	}
+	template<typename FI>
+	SSAStatistics ModuleInfo<FI>::OptimizeSSA(const SSAOptions& options) {
+		assert(IsByteFile());
+
+		std::vector<FunctionSignature> mappedFunctions;
+		std::vector<const StructureInfo*> mappedStructures;
+		ResolveMappings(mappedFunctions, mappedStructures);
+
+		SSAOptimizer optimizer(options, std::move(mappedFunctions), std::move(mappedStructures));
+		optimizer.Optimize(std::get<ByteFile>(Module));
+		ClearThreadedFunctions();
+		return optimizer.GetStatistics();
+	}
+	template<typename FI>
+	DeadCodeStatistics ModuleInfo<FI>::EliminateDeadCode(const DeadCodeOptions& options) {
+		assert(IsByteFile());
+
+		ByteFile& byteFile = std::get<ByteFile>(Module);
+		DeadCodeEliminator eliminator(options);
+		eliminator.Eliminate(byteFile.GetFunctions());
+		eliminator.Eliminate(byteFile.GetEntrypoint());
+		ClearThreadedFunctions();
+		return eliminator.GetStatistics();
+	}
+	template<typename FI>
+	std::uint32_t ModuleInfo<FI>::SweepFunctions(const std::vector<std::string_view>& exports) {
+		assert(IsByteFile());
+
+		ByteFile& byteFile = std::get<ByteFile>(Module);
+		Functions& functions = byteFile.GetFunctions();
+		const auto funcCount = static_cast<std::uint32_t>(functions.size());
+
+		std::vector<bool> isReachable(funcCount);
+		std::vector<std::uint32_t> worklist;
+		const auto mark = [&](std::uint32_t function) {
+			if (function < funcCount && !isReachable[function]) {
+				isReachable[function] = true;
+				worklist.push_back(function);
+			}
+		};
+		const auto markCallees = [&](const Instructions& instructions) {
+			const std::uint64_t instCount = instructions.GetInstructionCount();
+			for (std::uint64_t i = 0; i < instCount; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (inst.OpCode == OpCode::Call) {
+					mark(inst.Operand);
+				}
+			}
+		};
+
+		for (std::uint32_t i = 0; i < funcCount; ++i) {
+			if (std::find(exports.begin(), exports.end(), functions[i].Name) != exports.end()) {
+				mark(i);
+			}
+		}
+		markCallees(byteFile.GetEntrypoint());
+		while (!worklist.empty()) {
+			const std::uint32_t function = worklist.back();
+			worklist.pop_back();
+			markCallees(functions[function].Instructions);
+		}
+
+		const auto removed = static_cast<std::uint32_t>(std::count(isReachable.begin(), isReachable.end(), false));
+		if (removed == 0) return 0;
+
+		std::vector<std::uint32_t> indexMap(funcCount);
+		Functions result(functions.get_allocator());
+		for (std::uint32_t i = 0; i < funcCount; ++i) {
+			if (!isReachable[i]) continue;
+
+			indexMap[i] = static_cast<std::uint32_t>(result.size());
+			result.push_back(std::move(functions[i]));
+		}
+
+		// Calls past the functions refer to mappings, which move down by the number of removed functions.
+		const auto remap = [&](Instructions& instructions) {
+			const std::uint64_t instCount = instructions.GetInstructionCount();
+			for (std::uint64_t i = 0; i < instCount; ++i) {
+				Instruction inst = instructions.GetInstruction(i);
+				if (inst.OpCode != OpCode::Call) continue;
+
+				inst.Operand = inst.Operand < funcCount ? indexMap[inst.Operand] : inst.Operand - removed;
+				instructions.SetInstruction(i, inst);
+			}
+		};
+		for (FunctionInfo& function : result) {
+			remap(function.Instructions);
+		}
+		remap(byteFile.GetEntrypoint());
+
+		byteFile.SetFunctions(std::move(result));
+		ClearThreadedFunctions();
+		return removed;
+	}
+	template<typename FI>
+	std::uint32_t ModuleInfo<FI>::AnalyzeFrames() {
+		assert(IsByteFile());
+
+		ByteFile& byteFile = std::get<ByteFile>(Module);
+		std::vector<FunctionSignature> mappedFunctions;
+		std::vector<const StructureInfo*> mappedStructures;
+		ResolveMappings(mappedFunctions, mappedStructures);
+
+		std::vector<const TypeInfo*> mappedTypes(mappedStructures.size());
+		std::transform(mappedStructures.begin(), mappedStructures.end(), mappedTypes.begin(), [](const StructureInfo* structure) {
+			return &structure->Type;
+		});
+
+		const FrameAnalyzer analyzer(byteFile, std::move(mappedFunctions), std::move(mappedTypes));
+		std::uint32_t result = 0;
+		for (FunctionInfo& function : byteFile.GetFunctions()) {
+			if (analyzer.Analyze(function)) {
+				++result;
+			} else {
+				function.Frame = {};
+			}
+		}
+		return result;
+	}
+	template<typename FI>
+	void ModuleInfo<FI>::ResetUnverifiedFrames() noexcept {
+		assert(IsByteFile());
+
+		for (FunctionInfo& function : std::get<ByteFile>(Module).GetFunctions()) {
+			if (function.Verification == VerificationLevel::Unverified) {
+				function.Frame = {};
+			}
+		}
+	}
+	template<typename FI>
+	RegisterCodeStatistics ModuleInfo<FI>::BuildRegisterCode(std::vector<RegisterCode>& result, std::uint32_t registerFileSize) const {
+		assert(IsByteFile());
+
+		const ByteFile& byteFile = std::get<ByteFile>(Module);
+		std::vector<FunctionSignature> mappedFunctions;
+		std::vector<const StructureInfo*> mappedStructures;
+		ResolveMappings(mappedFunctions, mappedStructures);
+
+		// Functions that cannot be translated are left empty.
+		RegisterTranslator translator(byteFile, std::move(mappedFunctions));
+		translator.SetRegisterFileSize(registerFileSize);
+
+		const Functions& functions = byteFile.GetFunctions();
+		result.clear();
+		result.resize(functions.size());
+		for (std::size_t i = 0; i < functions.size(); ++i) {
+			translator.Translate(functions[i], result[i]);
+		}
+		return translator.GetStatistics();
+	}
+	template<typename FI>
+	CTranslationStatistics ModuleInfo<FI>::TranslateToC(std::ostream& stream, std::string prefix) const {
+		assert(IsByteFile());
+
+		std::vector<FunctionSignature> mappedFunctions;
+		std::vector<const StructureInfo*> mappedStructures;
+		ResolveMappings(mappedFunctions, mappedStructures);
+
+		CTranslator translator(std::get<ByteFile>(Module), std::move(mappedFunctions), std::move(mappedStructures));
+		translator.SetPrefix(std::move(prefix));
+		translator.Translate(stream);
+		return translator.GetStatistics();
+	}
+	template<typename FI>
+	std::vector<const TypeInfo*> ModuleInfo<FI>::ResolveTypes() const {
+		assert(IsByteFile());
+
+		// Indexed by type code, as CRuntime::Types expects; codes that name no type are null.
+		const auto structure = static_cast<std::uint32_t>(TypeCode::Structure);
+		std::vector<const TypeInfo*> result(structure + GetStructureCount() + GetMappings().GetStructureMappingCount());
+		for (std::uint32_t code = 0; code < result.size(); ++code) {
+			if (code >= structure) {
+				result[code] = ResolveType(code);
+			} else if (static_cast<TypeCode>(code) == TypeCode::Array) {
+				result[code] = ArrayType.GetPointer();
+			} else if (const Type type = GetFundamentalType(static_cast<TypeCode>(code)); type != NoneType) {
+				result[code] = type.GetPointer();
+			}
+		}
+		return result;
+	}
+
+	template<typename FI>
+	void ModuleInfo<FI>::Verify() {
+		assert(IsByteFile());
+
+		ByteFile& byteFile = std::get<ByteFile>(Module);
+		std::vector<FunctionSignature> mappedFunctions;
+		std::vector<const StructureInfo*> mappedStructures;
+		ResolveMappings(mappedFunctions, mappedStructures);
+
+		const Verifier verifier(byteFile, std::move(mappedFunctions), std::move(mappedStructures));
+		bool isValid = verifier.Verify(byteFile.GetEntrypoint(), 0, false).Error == VerifierError::None;
+		for (FunctionInfo& function : byteFile.GetFunctions()) {
+			isValid = isValid && verifier.Verify(function).Error == VerifierError::None;
+		}
+		if (!isValid) throw std::runtime_error("Failed to load the file. Invalid bytecode.");
+	}
+	template<typename FI>
+	VerifierResult ModuleInfo<FI>::VerifyEntrypoint() const {
+		assert(IsByteFile());
+
+		const ByteFile& byteFile = std::get<ByteFile>(Module);
+		std::vector<FunctionSignature> mappedFunctions;
+		std::vector<const StructureInfo*> mappedStructures;
+		ResolveMappings(mappedFunctions, mappedStructures);
+
+		const Verifier verifier(byteFile, std::move(mappedFunctions), std::move(mappedStructures));
+		return verifier.Verify(byteFile.GetEntrypoint(), 0, false);
+	}
+
+	template<typename FI>
+	void ModuleInfo<FI>::ClearThreadedFunctions() {
+		assert(IsByteFile());
+
+		m_ThreadedCache = std::make_unique<ThreadedCache>(std::get<ByteFile>(Module).GetFunctions().size() + 1);
+	}
+
+	template<typename FI>
+	const FunctionMap& ModuleInfo<FI>::GetFunctionMap() const {
+		assert(IsByteFile() && m_ThreadedCache);
+
+		auto& slot = m_ThreadedCache->Map;
+		if (const auto result = slot.load(std::memory_order_acquire); result) return *result;
+
+		// The map holds the addresses of the threaded functions, so it is built with them and cleared with them.
+		const Functions& functions = std::get<ByteFile>(Module).GetFunctions();
+		std::vector<const ThreadedFunction*> threadedFunctions;
+		threadedFunctions.reserve(functions.size());
+		for (std::uint32_t i = 0; i < functions.size(); ++i) {
+			threadedFunctions.push_back(&GetThreadedFunction(i));
+		}
+
+		const FunctionMap* expected = nullptr;
+		const auto result = new FunctionMap(functions, threadedFunctions);
+		if (slot.compare_exchange_strong(expected, result, std::memory_order_acq_rel)) return *result;
+
+		delete result;
+		return *expected;
+	}
+	template<typename FI>
+	const FunctionInfo* ModuleInfo<FI>::FindFunction(const ThreadedInstruction* instruction) const {
+		const std::uint32_t index = GetFunctionMap().FindFunction(instruction);
+		if (index == FunctionMap::NPos) return nullptr;
+		else return &std::get<ByteFile>(Module).GetFunctions()[index];
+	}
+	template<typename FI>
+	std::uint64_t ModuleInfo<FI>::FindInstruction(const ThreadedInstruction* instruction) const {
+		return GetFunctionMap().FindInstruction(instruction);
+	}
+	template<typename FI>
+	std::uint64_t ModuleInfo<FI>::FindInstruction(const FunctionInfo& function, std::uint64_t offset) const {
+		const std::uint32_t index = GetFunctionIndex(function);
+		if (index == FunctionMap::NPos) return OffsetIndex::NPos;
+		else return GetFunctionMap().GetOffsetIndex(index).GetInstruction(offset);
+	}
+
+	template<typename FI>
+	const ThreadedFunction& ModuleInfo<FI>::GetThreadedFunction(std::uint32_t index, const FunctionInfo* function, const Instructions& instructions) const {
+		assert(m_ThreadedCache && index < m_ThreadedCache->Functions.size());
+
+		auto& slot = m_ThreadedCache->Functions[index];
+		if (const auto result = slot.load(std::memory_order_acquire); result) return *result;
+
+		const ThreadedFunction* expected = nullptr;
+		const auto result = new ThreadedFunction(BuildThreadedFunction(function, instructions));
+		if (slot.compare_exchange_strong(expected, result, std::memory_order_acq_rel)) return *result;
+
+		delete result;
+		return *expected;
+	}
+	template<typename FI>
+	std::uint32_t ModuleInfo<FI>::GetFunctionIndex(const FunctionInfo& function) const noexcept {
+		// std::less orders pointers into different arrays as well, so a function of another module is rejected here.
+		const Functions& functions = std::get<ByteFile>(Module).GetFunctions();
+		const std::less<const FunctionInfo*> less;
+		if (less(&function, functions.data()) || !less(&function, functions.data() + functions.size())) return FunctionMap::NPos;
+		else return static_cast<std::uint32_t>(&function - functions.data());
+	}
+	template<typename FI>
+	ThreadedFunction ModuleInfo<FI>::BuildThreadedFunction(const FunctionInfo* function, const Instructions& instructions) const {
+		const ByteFile& byteFile = std::get<ByteFile>(Module);
+		const ConstantPool& constantPool = byteFile.GetConstantPool();
+		const Functions& functions = byteFile.GetFunctions();
+		const auto funcCount = static_cast<std::uint32_t>(functions.size());
+
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		std::vector<ThreadedInstruction> result(static_cast<std::size_t>(instCount));
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			ThreadedInstruction& threaded = result[static_cast<std::size_t>(i)];
+			threaded.OpCode = inst.OpCode;
+			threaded.Operand = inst.Operand;
+
+			switch (inst.OpCode) {
+			case OpCode::Push:
+				if (inst.Operand >= constantPool.GetAllCount()) {
+					threaded.ConstantType = TypeCode::Structure;
+					threaded.Type = ResolveType(static_cast<std::uint32_t>(TypeCode::Structure) + inst.Operand - constantPool.GetAllCount());
+					if (!threaded.Type) throw std::runtime_error("Failed to resolve the structure.");
+					break;
+				}
+
+				threaded.ConstantType = constantPool.GetConstantType(inst.Operand)->Code;
+				switch (threaded.ConstantType) {
+				case TypeCode::Int: threaded.IntValue = constantPool.GetConstant<IntObject>(inst.Operand).Value; break;
+				case TypeCode::Long: threaded.LongValue = constantPool.GetConstant<LongObject>(inst.Operand).Value; break;
+				case TypeCode::Single: threaded.SingleValue = constantPool.GetConstant<SingleObject>(inst.Operand).Value; break;
+				case TypeCode::Double: threaded.DoubleValue = constantPool.GetConstant<DoubleObject>(inst.Operand).Value; break;
+				default: break;
+				}
+				break;
+
+			case OpCode::Jmp:
+			case OpCode::Je:
+			case OpCode::Jne:
+			case OpCode::Ja:
+			case OpCode::Jae:
+			case OpCode::Jb:
+			case OpCode::Jbe:
+				if (inst.Operand >= instructions.GetLabelCount()) throw std::runtime_error("Failed to resolve the label.");
+
+				threaded.Target = instructions.GetLabel(inst.Operand);
+				break;
+
+			case OpCode::Call:
+				if (inst.Operand < funcCount) {
+					threaded.Function = &functions[inst.Operand];
+				} else {
+					std::variant<Function, VirtualFunction<FI>> callee;
+					if (inst.Operand - funcCount >= byteFile.GetMappings().GetFunctionMappingCount() ||
+						!ResolveFunction(byteFile.GetMappings().GetFunctionMapping(inst.Operand - funcCount), callee))
+						throw std::runtime_error("Failed to resolve the function.");
+
+					if (std::holds_alternative<Function>(callee)) {
+						threaded.Function = std::get<Function>(callee).GetPointer();
+					} else {
+						threaded.IsVirtualCall = true;
+						threaded.VirtualFunction = std::get<VirtualFunction<FI>>(callee).GetPointer();
+					}
+				}
+				break;
+
+			case OpCode::New:
+			case OpCode::GCNew:
+			case OpCode::APush:
+			case OpCode::ANew:
+			case OpCode::AGCNew:
+				threaded.Type = ResolveType(inst.Operand);
+				if (!threaded.Type) throw std::runtime_error("Failed to resolve the type.");
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		return { function, std::move(result) };
+	}
+	template<typename FI>
+	const TypeInfo* ModuleInfo<FI>::ResolveType(std::uint32_t code) const noexcept {
+		if (const Type type = GetFundamentalType(static_cast<TypeCode>(code)); type != NoneType) return type.GetPointer();
+
+		const Structures& structures = std::get<ByteFile>(Module).GetStructures();
+		if (const Type type = GetStructureType(structures, static_cast<TypeCode>(code)); type != NoneType) return type.GetPointer();
+
+		const auto structure = static_cast<std::uint32_t>(TypeCode::Structure) + static_cast<std::uint32_t>(structures.size());
+		if (code < structure || code - structure >= GetMappings().GetStructureMappingCount()) return nullptr;
+
+		const StructureInfo* const mapped = ResolveStructure(GetMappings().GetStructureMapping(code - structure));
+		return mapped ? &mapped->Type : nullptr;
+	}
+	template<typename FI>
+	bool ModuleInfo<FI>::ResolveFunction(const FunctionMapping& mapping, std::variant<Function, VirtualFunction<FI>>& result) const noexcept {
+		// The dependency index and the name of a mapping come from the file, so neither is trusted.
+		if (mapping.Module >= GetDependencyCount()) return false;
+
+		const auto dependency = static_cast<const ModuleInfo*>(GetDependency(mapping.Module).Module);
+		if (!dependency || dependency->IsEmpty()) return false;
+
+		if (dependency->IsByteFile()) {
+			const Functions& functions = std::get<ByteFile>(dependency->Module).GetFunctions();
+			const auto iter = std::find_if(functions.begin(), functions.end(), [&mapping](const auto& function) {
+				return mapping.Name == function.Name;
+			});
+			if (iter == functions.end()) return false;
+
+			result = *iter;
+		} else {
+			const VirtualFunctions<FI>& functions = std::get<VirtualModule<FI>>(dependency->Module).GetFunctions();
+			const auto iter = std::find_if(functions.begin(), functions.end(), [&mapping](const auto& function) {
+				return mapping.Name == function.GetName();
+			});
+			if (iter == functions.end()) return false;
+
+			result = *iter;
+		}
+		return true;
+	}
+	template<typename FI>
+	const StructureInfo* ModuleInfo<FI>::ResolveStructure(const StructureMapping& mapping) const noexcept {
+		if (mapping.Module >= GetDependencyCount()) return nullptr;
+
+		const auto dependency = static_cast<const ModuleInfo*>(GetDependency(mapping.Module).Module);
+		if (!dependency || dependency->IsEmpty()) return nullptr;
+
+		const Structures& structures = dependency->IsByteFile() ? std::get<ByteFile>(dependency->Module).GetStructures()
+																: std::get<VirtualModule<FI>>(dependency->Module).GetStructures();
+		const auto iter = std::find_if(structures.begin(), structures.end(), [&mapping](const auto& structure) {
+			return mapping.Name == structure.Name;
+		});
+		return iter == structures.end() ? nullptr : &*iter;
+	}
+	template<typename FI>
+	void ModuleInfo<FI>::ResolveMappings(std::vector<FunctionSignature>& mappedFunctions, std::vector<const StructureInfo*>& mappedStructures) const {
+		const Mappings& mappings = std::get<ByteFile>(Module).GetMappings();
+
+		const std::uint32_t funcMappingCount = mappings.GetFunctionMappingCount();
+		mappedFunctions.assign(funcMappingCount, {});
+		for (std::uint32_t i = 0; i < funcMappingCount; ++i) {
+			std::variant<Function, VirtualFunction<FI>> callee;
+			if (!ResolveFunction(mappings.GetFunctionMapping(i), callee)) throw std::runtime_error("Failed to load the file. Invalid bytecode.");
+
+			if (std::holds_alternative<Function>(callee)) {
+				const Function function = std::get<Function>(callee);
+				mappedFunctions[i] = { function->Arity, function->HasResult };
+			} else {
+				const VirtualFunction<FI> function = std::get<VirtualFunction<FI>>(callee);
+				mappedFunctions[i] = { function->GetArity(), function->HasResult() };
+			}
+		}
+
+		const std::uint32_t structMappingCount = mappings.GetStructureMappingCount();
+		mappedStructures.assign(structMappingCount, nullptr);
+		for (std::uint32_t i = 0; i < structMappingCount; ++i) {
+			mappedStructures[i] = ResolveStructure(mappings.GetStructureMapping(i));
+			if (!mappedStructures[i]) throw std::runtime_error("Failed to load the file. Invalid bytecode.");
+		}
+	}
 }
\ No newline at end of file
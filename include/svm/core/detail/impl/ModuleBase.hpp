@@ -14,8 +14,9 @@ namespace svm::core {
 		m_Functions(std::move(functions)), m_Mappings(std::move(mappings)) {}
 	template<typename F>
 	ModuleBase<F>::ModuleBase(ModuleBase&& module) noexcept
-		: m_Path(std::move(module.m_Path)), m_Dependencies(std::move(module.m_Dependencies)), m_Structures(std::move(module.m_Structures)),
-		m_Functions(std::move(module.m_Functions)), m_Mappings(std::move(module.m_Mappings)) {}
+		: m_Arena(std::move(module.m_Arena)), m_Path(std::move(module.m_Path)), m_Dependencies(std::move(module.m_Dependencies)), m_Structures(std::move(module.m_Structures)),
+		m_Functions(std::move(module.m_Functions)), m_Mappings(std::move(module.m_Mappings)),
+		m_StringPool(std::move(module.m_StringPool)) {}
 
 	template<typename F>
 	ModuleBase<F>& ModuleBase<F>::operator=(ModuleBase&& module) noexcept {
@@ -24,6 +25,8 @@ namespace svm::core {
 		m_Structures = std::move(module.m_Structures);
 		m_Functions = std::move(module.m_Functions);
 		m_Mappings = std::move(module.m_Mappings);
+		m_StringPool = std::move(module.m_StringPool);
+		m_Arena = std::move(module.m_Arena);
 		return *this;
 	}
 
@@ -83,6 +86,39 @@ namespace svm::core {
 	void ModuleBase<F>::SetMappings(Mappings&& newMappings) noexcept {
 		m_Mappings = std::move(newMappings);
 	}
+	template<typename F>
+	const StringPool* ModuleBase<F>::GetStringPool() const noexcept {
+		return m_StringPool.get();
+	}
+	template<typename F>
+	StringPool& ModuleBase<F>::GetStringPool() {
+		if (!m_StringPool) {
+			m_StringPool = std::make_unique<StringPool>(GetArena());
+		}
+		return *m_StringPool;
+	}
+	template<typename F>
+	std::string_view ModuleBase<F>::Intern(std::string_view string) {
+		return GetStringPool().Intern(string);
+	}
+	template<typename F>
+	void ModuleBase<F>::ClearStringPool() noexcept {
+		m_StringPool.reset();
+	}
+	template<typename F>
+	std::pmr::memory_resource* ModuleBase<F>::GetArena() {
+		if (!m_Arena) {
+			m_Arena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+		}
+		return m_Arena.get();
+	}
+	template<typename F>
+	void ModuleBase<F>::ClearArena() noexcept {
+		m_Structures = Structures();
+		m_Functions = F();
+		m_StringPool.reset();
+		m_Arena.reset();
+	}
 
 	template<typename F>
 	void ModuleBase<F>::UpdateStructureInfos(std::uint32_t module) noexcept {
@@ -9,7 +9,7 @@
 namespace svm::core {
 	template<typename T>
 	T Parser::ReadFile() noexcept {
-		T result = reinterpret_cast<T&>(m_File[m_Cursor]);
+		T result = reinterpret_cast<const T&>(m_File[m_Cursor]);
 		m_Cursor += sizeof(result);
 
 		if (sizeof(result) > 1 && GetEndian() != Endian::Little) return ReverseEndian(result);
@@ -17,14 +17,19 @@ namespace svm::core {
 	}
 	inline std::string Parser::ReadFileString() {
 		const std::uint32_t length = ReadFile<std::uint32_t>();
-		std::string result(length, 0);
-		std::copy(m_File.begin() + m_Cursor, m_File.begin() + m_Cursor + length, result.data());
+		std::string result(reinterpret_cast<const char*>(m_File + m_Cursor), length);
 		m_Cursor += length;
 		return result;
 	}
+	inline std::string_view Parser::ReadFileName() {
+		const std::uint32_t length = ReadFile<std::uint32_t>();
+		const std::string_view result(reinterpret_cast<const char*>(m_File + m_Cursor), length);
+		m_Cursor += length;
+		return m_ByteFile.Intern(result);
+	}
 	inline auto Parser::ReadFile(std::size_t size) noexcept {
-		const auto begin = m_File.begin() + m_Cursor;
-		const auto end = m_File.begin() + (m_Cursor += size);
+		const auto begin = m_File + m_Cursor;
+		const auto end = m_File + (m_Cursor += size);
 		return std::make_pair(begin, end);
 	}
 
@@ -32,7 +37,7 @@ namespace svm::core {
 	void Parser::ParseMappings(std::vector<T>& mappings) noexcept {
 		for (T& mapping : mappings) {
 			mapping.Module = ReadFile<std::uint32_t>();
-			mapping.Name = ReadFileString();
+			mapping.Name = ReadFileName();
 		}
 	}
 
@@ -0,0 +1,912 @@
+#pragma once
+#include <svm/core/ReferenceInterpreter.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace svm::core {
+	inline ReferenceValue::ReferenceValue(std::uint32_t value) noexcept
+		: Type(IntType), IntValue(value) {}
+	inline ReferenceValue::ReferenceValue(std::uint64_t value) noexcept
+		: Type(LongType), LongValue(value) {}
+	inline ReferenceValue::ReferenceValue(float value) noexcept
+		: Type(SingleType), SingleValue(value) {}
+	inline ReferenceValue::ReferenceValue(double value) noexcept
+		: Type(DoubleType), DoubleValue(value) {}
+	inline ReferenceValue::ReferenceValue(svm::Type type, void* value) noexcept
+		: Type(type), PointerValue(value) {}
+
+	inline bool ReferenceValue::IsEmpty() const noexcept {
+		return Type.GetPointer() == nullptr;
+	}
+	inline bool ReferenceValue::IsAggregate() const noexcept {
+		const TypeInfo* const type = Type.GetPointer();
+		return type && (type->Code == TypeCode::Array || type->Code >= TypeCode::Structure);
+	}
+
+	static_assert(sizeof(ReferenceValue) == sizeof(IntObject) && sizeof(ReferenceValue) == sizeof(LongObject) &&
+		sizeof(ReferenceValue) == sizeof(SingleObject) && sizeof(ReferenceValue) == sizeof(DoubleObject) &&
+		sizeof(ReferenceValue) == sizeof(PointerObject) && sizeof(ReferenceValue) == sizeof(GCPointerObject));
+}
+
+namespace svm::detail {
+	[[noreturn]] inline void ThrowExecutionError(const char* reason) {
+		throw std::runtime_error(std::string("Failed to execute the function. ") + reason);
+	}
+
+	inline Type GetConstantType(TypeCode code) noexcept {
+		switch (code) {
+		case TypeCode::Int: return IntType;
+		case TypeCode::Long: return LongType;
+		case TypeCode::Single: return SingleType;
+		default: return DoubleType;
+		}
+	}
+	inline const Object* GetObjectHeader(const void* object) {
+		if (!object) ThrowExecutionError("The pointer is null.");
+		return static_cast<const Object*>(object);
+	}
+	inline std::uint64_t GetCount(const core::ReferenceValue& value) {
+		switch (value.Type->Code) {
+		case TypeCode::Int: return value.IntValue;
+		case TypeCode::Long: return value.LongValue;
+		default: ThrowExecutionError("The count is not an integer.");
+		}
+	}
+
+	// Integer division and remainder trap on a zero divisor; the signed forms wrap instead of overflowing.
+	template<bool IsIntegerOnly, typename F>
+	void ApplyBinary(core::ReferenceValue& lhs, const core::ReferenceValue& rhs, F&& function) {
+		if (lhs.Type != rhs.Type) ThrowExecutionError("The types of the operands do not match.");
+
+		switch (lhs.Type->Code) {
+		case TypeCode::Int: lhs.IntValue = static_cast<std::uint32_t>(function(lhs.IntValue, rhs.IntValue)); return;
+		case TypeCode::Long: lhs.LongValue = static_cast<std::uint64_t>(function(lhs.LongValue, rhs.LongValue)); return;
+		case TypeCode::Single:
+			if constexpr (!IsIntegerOnly) {
+				lhs.SingleValue = static_cast<float>(function(lhs.SingleValue, rhs.SingleValue));
+				return;
+			}
+			break;
+		case TypeCode::Double:
+			if constexpr (!IsIntegerOnly) {
+				lhs.DoubleValue = static_cast<double>(function(lhs.DoubleValue, rhs.DoubleValue));
+				return;
+			}
+			break;
+		default: break;
+		}
+		ThrowExecutionError("The types of the operands are not supported.");
+	}
+	template<bool IsIntegerOnly, typename F>
+	void ApplyUnary(core::ReferenceValue& value, F&& function) {
+		switch (value.Type->Code) {
+		case TypeCode::Int: value.IntValue = static_cast<std::uint32_t>(function(value.IntValue)); return;
+		case TypeCode::Long: value.LongValue = static_cast<std::uint64_t>(function(value.LongValue)); return;
+		case TypeCode::Single:
+			if constexpr (!IsIntegerOnly) {
+				value.SingleValue = static_cast<float>(function(value.SingleValue));
+				return;
+			}
+			break;
+		case TypeCode::Double:
+			if constexpr (!IsIntegerOnly) {
+				value.DoubleValue = static_cast<double>(function(value.DoubleValue));
+				return;
+			}
+			break;
+		default: break;
+		}
+		ThrowExecutionError("The type of the operand is not supported.");
+	}
+
+	template<typename T>
+	T Divide(T lhs, T rhs) {
+		if constexpr (std::is_integral_v<T>) {
+			if (rhs == 0) ThrowExecutionError("The divisor is zero.");
+		}
+		return lhs / rhs;
+	}
+	template<typename T>
+	T Remainder(T lhs, T rhs) {
+		if constexpr (std::is_integral_v<T>) {
+			if (rhs == 0) ThrowExecutionError("The divisor is zero.");
+			return lhs % rhs;
+		} else return std::fmod(lhs, rhs);
+	}
+	template<typename T>
+	T SignedDivide(T lhs, T rhs) {
+		using S = std::make_signed_t<T>;
+		if (rhs == 0) ThrowExecutionError("The divisor is zero.");
+		if (static_cast<S>(rhs) == -1) return T(0) - lhs;
+		return static_cast<T>(static_cast<S>(lhs) / static_cast<S>(rhs));
+	}
+	template<typename T>
+	T SignedRemainder(T lhs, T rhs) {
+		using S = std::make_signed_t<T>;
+		if (rhs == 0) ThrowExecutionError("The divisor is zero.");
+		if (static_cast<S>(rhs) == -1) return 0;
+		return static_cast<T>(static_cast<S>(lhs) % static_cast<S>(rhs));
+	}
+	template<typename T>
+	T ShiftRightArithmetic(T lhs, T rhs) noexcept {
+		return static_cast<T>(static_cast<std::make_signed_t<T>>(lhs) >> (rhs & (sizeof(T) * 8 - 1)));
+	}
+
+	// Orders are encoded as -1, 0 and 1, which is what ConstantFolder assumes for the conditional jumps.
+	inline std::uint32_t Compare(const core::ReferenceValue& lhs, const core::ReferenceValue& rhs, bool isSigned) {
+		if (lhs.Type != rhs.Type) ThrowExecutionError("The types of the operands do not match.");
+
+		const auto order = [](auto l, auto r) {
+			return static_cast<std::uint32_t>(l < r ? -1 : (r < l ? 1 : 0));
+		};
+		switch (lhs.Type->Code) {
+		case TypeCode::Int:
+			if (isSigned) return order(static_cast<std::int32_t>(lhs.IntValue), static_cast<std::int32_t>(rhs.IntValue));
+			return order(lhs.IntValue, rhs.IntValue);
+
+		case TypeCode::Long:
+			if (isSigned) return order(static_cast<std::int64_t>(lhs.LongValue), static_cast<std::int64_t>(rhs.LongValue));
+			return order(lhs.LongValue, rhs.LongValue);
+
+		case TypeCode::Single:
+			if (!isSigned) return order(lhs.SingleValue, rhs.SingleValue);
+			break;
+
+		case TypeCode::Double:
+			if (!isSigned) return order(lhs.DoubleValue, rhs.DoubleValue);
+			break;
+
+		case TypeCode::Pointer:
+		case TypeCode::GCPointer:
+			if (!isSigned) return order(reinterpret_cast<std::uintptr_t>(lhs.PointerValue), reinterpret_cast<std::uintptr_t>(rhs.PointerValue));
+			break;
+
+		default: break;
+		}
+		ThrowExecutionError("The types of the operands are not supported.");
+	}
+
+	inline core::ReferenceValue MakeValue(const IntObject& object) noexcept {
+		return object.Value;
+	}
+	inline core::ReferenceValue MakeValue(const LongObject& object) noexcept {
+		return object.Value;
+	}
+	inline core::ReferenceValue MakeValue(const SingleObject& object) noexcept {
+		return object.Value;
+	}
+	inline core::ReferenceValue MakeValue(const DoubleObject& object) noexcept {
+		return object.Value;
+	}
+	inline core::ReferenceValue MakeValue(const PointerObject& object) noexcept {
+		return { PointerType, object.Value };
+	}
+	template<typename T>
+	core::ReferenceValue Convert(const core::ReferenceValue& value) {
+		switch (value.Type->Code) {
+		case TypeCode::Int: return MakeValue(IntObject(value.IntValue).Cast<T>());
+		case TypeCode::Long: return MakeValue(LongObject(value.LongValue).Cast<T>());
+		case TypeCode::Single: return MakeValue(SingleObject(value.SingleValue).Cast<T>());
+		case TypeCode::Double: return MakeValue(DoubleObject(value.DoubleValue).Cast<T>());
+		case TypeCode::Pointer:
+		case TypeCode::GCPointer: return MakeValue(PointerObject(value.PointerValue).Cast<T>());
+		default: ThrowExecutionError("The type of the operand is not supported.");
+		}
+	}
+
+	inline const core::ThreadedInstruction* RunNative(const core::NativeFunction& native, const core::ThreadedInstruction* code,
+		const core::ThreadedInstruction* ip, core::ReferenceValue* locals, core::ReferenceValue*& sp) noexcept {
+		core::NativeFrame frame{ locals, sp, static_cast<std::uint64_t>(ip - code) };
+		native.Enter(frame);
+		sp = frame.Stack;
+		return code + frame.Index;
+	}
+}
+
+namespace svm::core {
+	template<typename FI>
+	struct ReferenceInterpreter<FI>::Frame final {
+		const ThreadedInstruction* Instructions = nullptr;
+		const ThreadedInstruction* Return = nullptr;
+		ReferenceValue* Locals = nullptr;
+		std::size_t AggregateMark = 0;
+		bool HasResult = false;
+		FunctionState* State = nullptr;
+	};
+}
+
+namespace svm::core {
+	template<typename FI>
+	ReferenceInterpreter<FI>::ReferenceInterpreter(const Loader<FI>& loader)
+		: ReferenceInterpreter(loader, DefaultStackSize) {}
+	template<typename FI>
+	ReferenceInterpreter<FI>::ReferenceInterpreter(const Loader<FI>& loader, std::size_t stackSize)
+		: m_Loader(loader), m_Stack(std::make_unique<ReferenceValue[]>(stackSize)), m_StackSize(stackSize), m_Top(m_Stack.get()) {}
+
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Clear() noexcept {
+		assert(m_Frames.empty());
+
+		m_Top = m_Stack.get();
+		m_Aggregates.clear();
+		m_Heap.clear();
+		m_GCHeap.clear();
+		m_FunctionStates.clear();
+		m_CodeCache.Clear();
+	}
+
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Run(const ModuleInfo<FI>& module) {
+		if (module.VerifyEntrypoint().Error != VerifierError::None) throw std::runtime_error("Failed to run the module. The entrypoint is not verified.");
+
+		Invoke(module.GetThreadedEntrypoint(), m_Top, 0, false);
+	}
+	template<typename FI>
+	ReferenceValue ReferenceInterpreter<FI>::Call(const FunctionInfo& function, const std::vector<ReferenceValue>& arguments) {
+		if (arguments.size() != function.Arity) throw std::runtime_error("Failed to call the function. The number of arguments does not match.");
+		if (arguments.size() > m_StackSize - static_cast<std::size_t>(m_Top - m_Stack.get()))
+			throw std::runtime_error("Failed to call the function. The stack has overflowed.");
+
+		ReferenceValue* const base = m_Top;
+		std::copy(arguments.begin(), arguments.end(), base);
+
+		const ThreadedFunction& threaded = m_Loader.GetModule(function.Module)->GetThreadedFunction(function);
+		Invoke(threaded, base, function.Arity, function.HasResult);
+		m_Top = base;
+		return function.HasResult ? *base : ReferenceValue();
+	}
+
+	template<typename FI>
+	const typename ReferenceInterpreter<FI>::VirtualCallHandler& ReferenceInterpreter<FI>::GetVirtualCallHandler() const noexcept {
+		return m_VirtualCallHandler;
+	}
+	template<typename FI>
+	void ReferenceInterpreter<FI>::SetVirtualCallHandler(VirtualCallHandler newVirtualCallHandler) noexcept {
+		m_VirtualCallHandler = std::move(newVirtualCallHandler);
+	}
+	template<typename FI>
+	std::size_t ReferenceInterpreter<FI>::GetStackSize() const noexcept {
+		return m_StackSize;
+	}
+	template<typename FI>
+	std::size_t ReferenceInterpreter<FI>::GetAllocationCount() const noexcept {
+		return m_Heap.size() + m_GCHeap.size();
+	}
+	template<typename FI>
+	const JitOptions& ReferenceInterpreter<FI>::GetJitOptions() const noexcept {
+		return m_JitOptions;
+	}
+	template<typename FI>
+	void ReferenceInterpreter<FI>::SetJitOptions(const JitOptions& newJitOptions) noexcept {
+		m_JitOptions = newJitOptions;
+	}
+	template<typename FI>
+	const JitStatistics& ReferenceInterpreter<FI>::GetJitStatistics() const noexcept {
+		return m_Compiler.GetStatistics();
+	}
+
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Invoke(const ThreadedFunction& function, ReferenceValue* arguments, std::uint16_t arity, bool hasResult) {
+		const std::size_t frameCount = m_Frames.size();
+		const std::size_t aggregateCount = m_Aggregates.size();
+		try {
+			Execute(function, arguments, arity, hasResult);
+		} catch (...) {
+			m_Frames.erase(m_Frames.begin() + static_cast<std::ptrdiff_t>(frameCount), m_Frames.end());
+			m_Aggregates.erase(m_Aggregates.begin() + static_cast<std::ptrdiff_t>(aggregateCount), m_Aggregates.end());
+			m_Top = arguments;
+			throw;
+		}
+	}
+
+#ifdef SVM_COMPUTED_GOTO
+#	define SVM_DISPATCH() goto* table[static_cast<std::uint8_t>(ip->OpCode)]
+#	define SVM_CASE(opCode) case OpCode::opCode: op_##opCode
+#	define SVM_SELECT() table = native ? reenterTable : dispatchTable
+#else
+#	define SVM_DISPATCH() continue
+#	define SVM_CASE(opCode) case OpCode::opCode
+#	define SVM_SELECT() static_cast<void>(0)
+#endif
+#define SVM_NEXT() ++ip; SVM_DISPATCH()
+// Taken backward jumps count towards tiering. The body is a plain block because SVM_DISPATCH may be a continue.
+#define SVM_JUMP(condition)																	\
+	{																						\
+		const ThreadedInstruction* const target = (condition) ? code + ip->Target : ip + 1;	\
+		if (target <= ip && m_JitOptions.IsEnabled && !native) {							\
+			native = TierUp(*m_Frames.back().State);										\
+			SVM_SELECT();																	\
+		}																					\
+		ip = target;																		\
+		SVM_DISPATCH();																		\
+	}
+
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Execute(const ThreadedFunction& function, ReferenceValue* arguments, std::uint16_t arity, bool hasResult) {
+#ifdef SVM_COMPUTED_GOTO
+		static const void* const dispatchTable[] = {
+			&&op_Nop,
+			&&op_Push, &&op_Pop, &&op_Load, &&op_Store, &&op_Lea, &&op_FLea, &&op_TLoad, &&op_TStore, &&op_Copy, &&op_Swap,
+			&&op_Add, &&op_Sub, &&op_Mul, &&op_IMul, &&op_Div, &&op_IDiv, &&op_Mod, &&op_IMod, &&op_Neg, &&op_Inc, &&op_Dec,
+			&&op_And, &&op_Or, &&op_Xor, &&op_Not, &&op_Shl, &&op_Sal, &&op_Shr, &&op_Sar,
+			&&op_Cmp, &&op_ICmp, &&op_Jmp, &&op_Je, &&op_Jne, &&op_Ja, &&op_Jae, &&op_Jb, &&op_Jbe, &&op_Call, &&op_Ret,
+			&&op_Unsupported, &&op_Unsupported, &&op_ToI, &&op_ToL, &&op_ToSi, &&op_ToD, &&op_ToP,
+			&&op_Null, &&op_New, &&op_Delete, &&op_GCNull, &&op_GCNew,
+			&&op_APush, &&op_ANew, &&op_AGCNew, &&op_ALea, &&op_Count,
+			&&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported,
+			&&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported,
+			&&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported, &&op_Unsupported,
+			&&op_Unsupported,
+		};
+		static_assert(std::size(dispatchTable) == static_cast<std::size_t>(OpCode::FusedCount) + 1);
+
+		// Frames with compiled code dispatch every instruction to op_Reenter, which runs the compiled code up to the
+		// next exit and then executes the exiting instruction through dispatchTable.
+		static const void* reenterTable[std::size(dispatchTable)];
+		static const bool isReenterTableFilled = (std::fill(std::begin(reenterTable), std::end(reenterTable), &&op_Reenter), true);
+		static_cast<void>(isReenterTableFilled);
+#endif
+
+		const std::size_t frameCount = m_Frames.size();
+		ReferenceValue* sp = EnterFrame(function, arguments, arity, hasResult);
+		const ThreadedInstruction* code = function.GetInstructions();
+		const ThreadedInstruction* ip = code;
+		ReferenceValue* locals = arguments;
+		const NativeFunction* native = m_Frames.back().State->Native;
+
+#ifdef SVM_COMPUTED_GOTO
+		const void* const* table = dispatchTable;
+		SVM_SELECT();
+		SVM_DISPATCH();
+
+	op_Reenter:
+		ip = detail::RunNative(*native, code, ip, locals, sp);
+		goto* dispatchTable[static_cast<std::uint8_t>(ip->OpCode)];
+#endif
+		for (;;) {
+#ifndef SVM_COMPUTED_GOTO
+			if (native) {
+				ip = detail::RunNative(*native, code, ip, locals, sp);
+			}
+#endif
+			switch (ip->OpCode) {
+			SVM_CASE(Nop):
+				SVM_NEXT();
+
+			SVM_CASE(Push):
+				if (ip->ConstantType == TypeCode::Structure) {
+					*sp++ = NewAggregate(ip->Type);
+				} else {
+					sp->Type = detail::GetConstantType(ip->ConstantType);
+					sp->LongValue = ip->LongValue;
+					++sp;
+				}
+				SVM_NEXT();
+
+			SVM_CASE(Pop):
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Load):
+				*sp = locals[ip->Operand];
+				if (sp->IsAggregate()) {
+					*sp = CopyAggregate(sp->PointerValue);
+				}
+				++sp;
+				SVM_NEXT();
+
+			SVM_CASE(Store):
+				StoreLocal(locals[ip->Operand], *--sp);
+				SVM_NEXT();
+
+			SVM_CASE(Lea): {
+				ReferenceValue& local = locals[ip->Operand];
+				*sp++ = ReferenceValue(PointerType, local.IsAggregate() ? local.PointerValue : &local);
+				SVM_NEXT();
+			}
+
+			SVM_CASE(FLea):
+				sp[-1] = ReferenceValue(PointerType, GetField(sp[-1].PointerValue, static_cast<std::uint32_t>(ip->Operand)));
+				SVM_NEXT();
+
+			SVM_CASE(TLoad):
+				sp[-1] = Load(sp[-1].PointerValue);
+				SVM_NEXT();
+
+			SVM_CASE(TStore):
+				Store(sp[-1].PointerValue, sp[-2]);
+				sp -= 2;
+				SVM_NEXT();
+
+			SVM_CASE(Copy):
+				*sp = sp[-1].IsAggregate() ? CopyAggregate(sp[-1].PointerValue) : sp[-1];
+				++sp;
+				SVM_NEXT();
+
+			SVM_CASE(Swap):
+				std::swap(sp[-1], sp[-2]);
+				SVM_NEXT();
+
+			SVM_CASE(Add):
+				detail::ApplyBinary<false>(sp[-2], sp[-1], [](auto l, auto r) { return l + r; });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Sub):
+				detail::ApplyBinary<false>(sp[-2], sp[-1], [](auto l, auto r) { return l - r; });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Mul):
+				detail::ApplyBinary<false>(sp[-2], sp[-1], [](auto l, auto r) { return l * r; });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(IMul):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return l * r; });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Div):
+				detail::ApplyBinary<false>(sp[-2], sp[-1], [](auto l, auto r) { return detail::Divide(l, r); });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(IDiv):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return detail::SignedDivide(l, r); });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Mod):
+				detail::ApplyBinary<false>(sp[-2], sp[-1], [](auto l, auto r) { return detail::Remainder(l, r); });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(IMod):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return detail::SignedRemainder(l, r); });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Neg):
+				detail::ApplyUnary<false>(sp[-1], [](auto v) { return -v; });
+				SVM_NEXT();
+
+			SVM_CASE(Inc):
+				detail::ApplyUnary<false>(sp[-1], [](auto v) { return v + 1; });
+				SVM_NEXT();
+
+			SVM_CASE(Dec):
+				detail::ApplyUnary<false>(sp[-1], [](auto v) { return v - 1; });
+				SVM_NEXT();
+
+			SVM_CASE(And):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return l & r; });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Or):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return l | r; });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Xor):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return l ^ r; });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Not):
+				detail::ApplyUnary<true>(sp[-1], [](auto v) { return ~v; });
+				SVM_NEXT();
+
+			SVM_CASE(Shl):
+			SVM_CASE(Sal):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return l << (r & (sizeof(l) * 8 - 1)); });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Shr):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return l >> (r & (sizeof(l) * 8 - 1)); });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Sar):
+				detail::ApplyBinary<true>(sp[-2], sp[-1], [](auto l, auto r) { return detail::ShiftRightArithmetic(l, r); });
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Cmp):
+				sp[-2] = detail::Compare(sp[-2], sp[-1], false);
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(ICmp):
+				sp[-2] = detail::Compare(sp[-2], sp[-1], true);
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Jmp):
+				SVM_JUMP(true)
+
+			SVM_CASE(Je):
+				SVM_JUMP(static_cast<std::int32_t>((--sp)->IntValue) == 0)
+
+			SVM_CASE(Jne):
+				SVM_JUMP(static_cast<std::int32_t>((--sp)->IntValue) != 0)
+
+			SVM_CASE(Ja):
+				SVM_JUMP(static_cast<std::int32_t>((--sp)->IntValue) > 0)
+
+			SVM_CASE(Jae):
+				SVM_JUMP(static_cast<std::int32_t>((--sp)->IntValue) >= 0)
+
+			SVM_CASE(Jb):
+				SVM_JUMP(static_cast<std::int32_t>((--sp)->IntValue) < 0)
+
+			SVM_CASE(Jbe):
+				SVM_JUMP(static_cast<std::int32_t>((--sp)->IntValue) <= 0)
+
+			SVM_CASE(Call): {
+				if (ip->IsVirtualCall) {
+					const FI& callee = *static_cast<const FI*>(ip->VirtualFunction);
+					m_Top = sp;
+					const ReferenceValue result = CallVirtual(callee, sp - callee.GetArity());
+					sp -= callee.GetArity();
+					if (callee.HasResult()) {
+						*sp++ = result;
+					}
+					SVM_NEXT();
+				}
+
+				const FunctionInfo& callee = *ip->Function;
+				const ThreadedFunction& threaded = m_Loader.GetModule(callee.Module)->GetThreadedFunction(callee);
+				m_Frames.back().Return = ip + 1;
+
+				locals = sp - callee.Arity;
+				sp = EnterFrame(threaded, locals, callee.Arity, callee.HasResult);
+				code = ip = threaded.GetInstructions();
+				native = m_Frames.back().State->Native;
+				SVM_SELECT();
+				SVM_DISPATCH();
+			}
+
+			SVM_CASE(Ret): {
+				const Frame& frame = m_Frames.back();
+				ReferenceValue* const base = frame.Locals;
+				const bool hasFrameResult = frame.HasResult;
+				if (hasFrameResult) {
+					*base = sp[-1];
+				}
+				ReleaseAggregates(frame.AggregateMark, hasFrameResult ? base : nullptr);
+				m_Frames.pop_back();
+				sp = base + hasFrameResult;
+
+				if (m_Frames.size() == frameCount) {
+					m_Top = sp;
+					return;
+				}
+
+				const Frame& caller = m_Frames.back();
+				code = caller.Instructions;
+				ip = caller.Return;
+				locals = caller.Locals;
+				native = caller.State->Native;
+				SVM_SELECT();
+				SVM_DISPATCH();
+			}
+
+			SVM_CASE(ToI):
+				sp[-1] = detail::Convert<IntObject>(sp[-1]);
+				SVM_NEXT();
+
+			SVM_CASE(ToL):
+				sp[-1] = detail::Convert<LongObject>(sp[-1]);
+				SVM_NEXT();
+
+			SVM_CASE(ToSi):
+				sp[-1] = detail::Convert<SingleObject>(sp[-1]);
+				SVM_NEXT();
+
+			SVM_CASE(ToD):
+				sp[-1] = detail::Convert<DoubleObject>(sp[-1]);
+				SVM_NEXT();
+
+			SVM_CASE(ToP):
+				sp[-1] = detail::Convert<PointerObject>(sp[-1]);
+				SVM_NEXT();
+
+			SVM_CASE(Null):
+				*sp++ = ReferenceValue(PointerType, nullptr);
+				SVM_NEXT();
+
+			SVM_CASE(New):
+				*sp++ = ReferenceValue(PointerType, New(ip->Type, false));
+				SVM_NEXT();
+
+			SVM_CASE(Delete):
+				Delete((--sp)->PointerValue);
+				SVM_NEXT();
+
+			SVM_CASE(GCNull):
+				*sp++ = ReferenceValue(GCPointerType, nullptr);
+				SVM_NEXT();
+
+			SVM_CASE(GCNew):
+				*sp++ = ReferenceValue(GCPointerType, New(ip->Type, true));
+				SVM_NEXT();
+
+			SVM_CASE(APush):
+				sp[-1] = NewAggregate(ip->Type, detail::GetCount(sp[-1]));
+				SVM_NEXT();
+
+			SVM_CASE(ANew):
+				sp[-1] = ReferenceValue(PointerType, New(ip->Type, detail::GetCount(sp[-1]), false));
+				SVM_NEXT();
+
+			SVM_CASE(AGCNew):
+				sp[-1] = ReferenceValue(GCPointerType, New(ip->Type, detail::GetCount(sp[-1]), true));
+				SVM_NEXT();
+
+			SVM_CASE(ALea):
+				sp[-2] = ReferenceValue(PointerType, GetElement(sp[-2].PointerValue, detail::GetCount(sp[-1])));
+				--sp;
+				SVM_NEXT();
+
+			SVM_CASE(Count): {
+				const Object* const array = detail::GetObjectHeader(sp[-1].PointerValue);
+				if (array->GetType() != ArrayType) detail::ThrowExecutionError("The operand is not an array.");
+
+				sp[-1] = ReferenceValue(static_cast<std::uint64_t>(static_cast<const ArrayObject*>(array)->Count));
+				SVM_NEXT();
+			}
+
+			default:
+#ifdef SVM_COMPUTED_GOTO
+			op_Unsupported:
+#endif
+				detail::ThrowExecutionError("The instruction is not supported.");
+			}
+		}
+	}
+
+#undef SVM_JUMP
+#undef SVM_NEXT
+#undef SVM_SELECT
+#undef SVM_CASE
+#undef SVM_DISPATCH
+
+	template<typename FI>
+	ReferenceValue* ReferenceInterpreter<FI>::EnterFrame(const ThreadedFunction& function, ReferenceValue* arguments, std::uint16_t arity, bool hasResult) {
+		// Verified code cannot keep more values on the stack than it has instructions. The entrypoint is verified by Run.
+		if (const FunctionInfo* const info = function.GetFunction(); info && info->Verification == VerificationLevel::Unverified)
+			throw std::runtime_error("Failed to call the function. The function is not verified.");
+
+		FunctionState& state = GetFunctionState(function, arity);
+		const std::uint32_t localCount = state.LocalCount;
+		const std::size_t available = m_StackSize - static_cast<std::size_t>(arguments - m_Stack.get());
+		if (localCount + function.GetInstructionCount() + 1 > available) throw std::runtime_error("Failed to call the function. The stack has overflowed.");
+
+		if (m_JitOptions.IsEnabled && !state.Native) {
+			TierUp(state);
+		}
+
+		std::fill(arguments + arity, arguments + localCount, ReferenceValue());
+		m_Frames.push_back({ function.GetInstructions(), nullptr, arguments, m_Aggregates.size(), hasResult, &state });
+		return arguments + localCount;
+	}
+	template<typename FI>
+	void ReferenceInterpreter<FI>::ReleaseAggregates(std::size_t mark, const ReferenceValue* result) noexcept {
+		if (m_Aggregates.size() == mark) return;
+
+		if (result && result->IsAggregate()) {
+			const auto iter = std::find_if(m_Aggregates.begin() + static_cast<std::ptrdiff_t>(mark), m_Aggregates.end(), [result](const auto& aggregate) {
+				return aggregate.get() == result->PointerValue;
+			});
+			if (iter != m_Aggregates.end()) {
+				std::swap(m_Aggregates[mark], *iter);
+				++mark;
+			}
+		}
+		m_Aggregates.erase(m_Aggregates.begin() + static_cast<std::ptrdiff_t>(mark), m_Aggregates.end());
+	}
+	template<typename FI>
+	ReferenceValue ReferenceInterpreter<FI>::CallVirtual(const FI& function, const ReferenceValue* arguments) {
+		if (!m_VirtualCallHandler) throw std::runtime_error("Failed to call the virtual function. There is no virtual call handler.");
+
+		return m_VirtualCallHandler(*this, function, arguments);
+	}
+	template<typename FI>
+	typename ReferenceInterpreter<FI>::FunctionState& ReferenceInterpreter<FI>::GetFunctionState(const ThreadedFunction& function, std::uint16_t arity) {
+		const auto [iter, isInserted] = m_FunctionStates.try_emplace(function.GetId());
+		FunctionState& state = iter->second;
+		if (!isInserted) return state;
+
+		state.Function = &function;
+		state.LocalCount = arity;
+
+		const std::uint64_t instCount = function.GetInstructionCount();
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const ThreadedInstruction& inst = function.GetInstruction(i);
+			if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Store || inst.OpCode == OpCode::Lea) {
+				state.LocalCount = std::max(state.LocalCount, static_cast<std::uint32_t>(inst.Operand) + 1);
+			}
+		}
+		return state;
+	}
+	template<typename FI>
+	const NativeFunction* ReferenceInterpreter<FI>::TierUp(FunctionState& state) {
+		if (state.IsRejected || ++state.HotCount < m_JitOptions.HotCount) return nullptr;
+
+		state.Native = m_Compiler.Compile(*state.Function, m_CodeCache);
+		state.IsRejected = !state.Native;
+		return state.Native;
+	}
+
+	template<typename FI>
+	ReferenceValue ReferenceInterpreter<FI>::NewAggregate(const TypeInfo* type) {
+		std::uint8_t* const object = m_Aggregates.emplace_back(std::make_unique<std::uint8_t[]>(type->Size)).get();
+		Initialize(object, type);
+		return { *type, object };
+	}
+	template<typename FI>
+	ReferenceValue ReferenceInterpreter<FI>::NewAggregate(const TypeInfo* elementType, std::uint64_t count) {
+		std::uint8_t* const array = m_Aggregates.emplace_back(std::make_unique<std::uint8_t[]>(GetArraySize(elementType, count))).get();
+		Initialize(array, elementType, count);
+		return { ArrayType, array };
+	}
+	template<typename FI>
+	ReferenceValue ReferenceInterpreter<FI>::CopyAggregate(const void* object) {
+		const std::size_t size = GetObjectSize(object);
+		std::uint8_t* const result = m_Aggregates.emplace_back(std::make_unique<std::uint8_t[]>(size)).get();
+		std::memcpy(result, object, size);
+		return { static_cast<const Object*>(object)->GetType(), result };
+	}
+	template<typename FI>
+	void ReferenceInterpreter<FI>::StoreLocal(ReferenceValue& local, const ReferenceValue& value) noexcept {
+		// Overwriting an aggregate in place keeps the addresses taken by lea valid.
+		if (value.IsAggregate() && local.Type == value.Type) {
+			const std::size_t size = GetObjectSize(value.PointerValue);
+			if (GetObjectSize(local.PointerValue) == size) {
+				std::memcpy(local.PointerValue, value.PointerValue, size);
+				return;
+			}
+		}
+		local = value;
+	}
+	template<typename FI>
+	void* ReferenceInterpreter<FI>::New(const TypeInfo* type, bool isGC) {
+		auto object = std::make_unique<std::uint8_t[]>(type->Size);
+		Initialize(object.get(), type);
+
+		void* const result = object.get();
+		(isGC ? m_GCHeap : m_Heap).emplace(result, std::move(object));
+		return result;
+	}
+	template<typename FI>
+	void* ReferenceInterpreter<FI>::New(const TypeInfo* elementType, std::uint64_t count, bool isGC) {
+		auto array = std::make_unique<std::uint8_t[]>(GetArraySize(elementType, count));
+		Initialize(array.get(), elementType, count);
+
+		void* const result = array.get();
+		(isGC ? m_GCHeap : m_Heap).emplace(result, std::move(array));
+		return result;
+	}
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Delete(void* object) {
+		if (!object) return;
+		if (!m_Heap.erase(object)) detail::ThrowExecutionError("The pointer was not returned by new.");
+	}
+
+	template<typename FI>
+	ReferenceValue ReferenceInterpreter<FI>::Load(const void* object) {
+		const Type type = detail::GetObjectHeader(object)->GetType();
+		switch (type->Code) {
+		case TypeCode::Int: return static_cast<const IntObject*>(object)->Value;
+		case TypeCode::Long: return static_cast<const LongObject*>(object)->Value;
+		case TypeCode::Single: return static_cast<const SingleObject*>(object)->Value;
+		case TypeCode::Double: return static_cast<const DoubleObject*>(object)->Value;
+		case TypeCode::Pointer: return { PointerType, static_cast<const PointerObject*>(object)->Value };
+		case TypeCode::GCPointer: return { GCPointerType, static_cast<const GCPointerObject*>(object)->Value };
+		default: return CopyAggregate(object);
+		}
+	}
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Store(void* object, const ReferenceValue& value) const {
+		const Type type = detail::GetObjectHeader(object)->GetType();
+		if (type != value.Type) detail::ThrowExecutionError("The type of the value does not match the object.");
+
+		switch (type->Code) {
+		case TypeCode::Int: static_cast<IntObject*>(object)->Value = value.IntValue; return;
+		case TypeCode::Long: static_cast<LongObject*>(object)->Value = value.LongValue; return;
+		case TypeCode::Single: static_cast<SingleObject*>(object)->Value = value.SingleValue; return;
+		case TypeCode::Double: static_cast<DoubleObject*>(object)->Value = value.DoubleValue; return;
+		case TypeCode::Pointer: static_cast<PointerObject*>(object)->Value = value.PointerValue; return;
+		case TypeCode::GCPointer: static_cast<GCPointerObject*>(object)->Value = value.PointerValue; return;
+		default: break;
+		}
+
+		const std::size_t size = GetObjectSize(object);
+		if (GetObjectSize(value.PointerValue) != size) detail::ThrowExecutionError("The type of the value does not match the object.");
+		std::memcpy(object, value.PointerValue, size);
+	}
+	template<typename FI>
+	void* ReferenceInterpreter<FI>::GetField(void* object, std::uint32_t index) const {
+		const Type type = detail::GetObjectHeader(object)->GetType();
+		if (type->Code < TypeCode::Structure) detail::ThrowExecutionError("The operand is not a structure.");
+
+		const StructureInfo& structure = GetStructure(type.GetPointer());
+		if (index >= structure.Fields.size()) detail::ThrowExecutionError("The field does not exist.");
+		return static_cast<std::uint8_t*>(object) + structure.Fields[index].Offset;
+	}
+	template<typename FI>
+	void* ReferenceInterpreter<FI>::GetElement(void* array, std::uint64_t index) const {
+		const auto object = static_cast<const ArrayObject*>(detail::GetObjectHeader(array));
+		if (object->GetType() != ArrayType) detail::ThrowExecutionError("The operand is not an array.");
+		if (index >= object->Count) detail::ThrowExecutionError("The index is out of range.");
+
+		std::uint8_t* const elements = static_cast<std::uint8_t*>(array) + sizeof(ArrayObject);
+		return elements + static_cast<std::size_t>(index) * reinterpret_cast<const Object*>(elements)->GetType()->Size;
+	}
+
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Initialize(std::uint8_t* object, const TypeInfo* type) const {
+		switch (type->Code) {
+		case TypeCode::Int: new(object) IntObject(); return;
+		case TypeCode::Long: new(object) LongObject(); return;
+		case TypeCode::Single: new(object) SingleObject(); return;
+		case TypeCode::Double: new(object) DoubleObject(); return;
+		case TypeCode::Pointer: new(object) PointerObject(); return;
+		case TypeCode::GCPointer: new(object) GCPointerObject(); return;
+		default: break;
+		}
+
+		new(object) StructureObject(*type);
+		for (const Field& field : GetStructure(type).Fields) {
+			if (field.IsArray()) {
+				Initialize(object + field.Offset, field.Type.GetPointer(), field.Count);
+			} else {
+				Initialize(object + field.Offset, field.Type.GetPointer());
+			}
+		}
+	}
+	template<typename FI>
+	void ReferenceInterpreter<FI>::Initialize(std::uint8_t* array, const TypeInfo* elementType, std::uint64_t count) const {
+		new(array) ArrayObject(static_cast<std::size_t>(count));
+
+		std::uint8_t* element = array + sizeof(ArrayObject);
+		for (std::uint64_t i = 0; i < count; ++i, element += elementType->Size) {
+			Initialize(element, elementType);
+		}
+	}
+	template<typename FI>
+	const StructureInfo& ReferenceInterpreter<FI>::GetStructure(const TypeInfo* type) const noexcept {
+		const auto index = static_cast<std::uint32_t>(type->Code) - static_cast<std::uint32_t>(TypeCode::Structure);
+		return m_Loader.GetModule(type->Module)->GetStructure(index).GetReference();
+	}
+
+	template<typename FI>
+	std::size_t ReferenceInterpreter<FI>::GetObjectSize(const void* object) noexcept {
+		const Type type = static_cast<const Object*>(object)->GetType();
+		if (type != ArrayType) return type->Size;
+
+		const std::size_t count = static_cast<const ArrayObject*>(object)->Count;
+		if (!count) return sizeof(ArrayObject);
+
+		const auto element = reinterpret_cast<const Object*>(static_cast<const std::uint8_t*>(object) + sizeof(ArrayObject));
+		return sizeof(ArrayObject) + count * element->GetType()->Size;
+	}
+	template<typename FI>
+	std::size_t ReferenceInterpreter<FI>::GetArraySize(const TypeInfo* elementType, std::uint64_t count) {
+		const std::size_t maxCount = (std::numeric_limits<std::size_t>::max() - sizeof(ArrayObject)) / std::max<std::size_t>(elementType->Size, 1);
+		if (count > maxCount) detail::ThrowExecutionError("The array is too large.");
+		return sizeof(ArrayObject) + static_cast<std::size_t>(count) * elementType->Size;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <svm/core/Writer.hpp>
+
+#include <svm/Memory.hpp>
+
+#include <cstring>
+
+namespace svm::core {
+	template<typename T>
+	void Writer::WriteFile(T value) noexcept {
+		if (sizeof(value) > 1 && GetEndian() != Endian::Little) {
+			value = ReverseEndian(value);
+		}
+
+		std::memcpy(m_Buffer.data() + m_Cursor, &value, sizeof(value));
+		m_Cursor += sizeof(value);
+	}
+	inline void Writer::WriteFileString(std::string_view string) noexcept {
+		WriteFile(static_cast<std::uint32_t>(string.size()));
+		std::memcpy(m_Buffer.data() + m_Cursor, string.data(), string.size());
+		m_Cursor += string.size();
+	}
+
+	template<typename T>
+	void Writer::WriteConstants(const std::vector<T>& pool) noexcept {
+		WriteFile(static_cast<std::uint32_t>(pool.size()));
+		for (const T& obj : pool) {
+			WriteFile(obj.Value);
+		}
+	}
+}
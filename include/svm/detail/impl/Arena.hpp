@@ -0,0 +1,37 @@
+#pragma once
+#include <svm/Arena.hpp>
+
+namespace svm {
+	template<typename T>
+	ArenaAllocator<T>::ArenaAllocator(std::pmr::memory_resource* resource) noexcept
+		: m_Resource(resource) {}
+	template<typename T>
+	template<typename U>
+	ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& allocator) noexcept
+		: m_Resource(allocator.m_Resource) {}
+
+	template<typename T>
+	template<typename U>
+	bool ArenaAllocator<T>::operator==(const ArenaAllocator<U>& allocator) const noexcept {
+		return m_Resource == allocator.m_Resource || m_Resource->is_equal(*allocator.m_Resource);
+	}
+	template<typename T>
+	template<typename U>
+	bool ArenaAllocator<T>::operator!=(const ArenaAllocator<U>& allocator) const noexcept {
+		return !(*this == allocator);
+	}
+
+	template<typename T>
+	T* ArenaAllocator<T>::allocate(std::size_t count) {
+		return static_cast<T*>(m_Resource->allocate(count * sizeof(T), alignof(T)));
+	}
+	template<typename T>
+	void ArenaAllocator<T>::deallocate(T* pointer, std::size_t count) noexcept {
+		m_Resource->deallocate(pointer, count * sizeof(T), alignof(T));
+	}
+
+	template<typename T>
+	std::pmr::memory_resource* ArenaAllocator<T>::GetResource() const noexcept {
+		return m_Resource;
+	}
+}
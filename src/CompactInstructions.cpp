@@ -0,0 +1,135 @@
+#include <svm/CompactInstructions.hpp>
+
+#include <svm/IO.hpp>
+
+#include <string>
+
+namespace svm {
+	CompactInstructions::CompactInstructions(const Instructions& instructions) {
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		m_Labels.reserve(labelCount);
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			m_Labels.push_back(instructions.GetLabel(i));
+		}
+
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		m_OpCodes.reserve(instCount);
+		m_Operands.reserve(instCount);
+		m_Offsets.reserve(instCount / OffsetStride + 1);
+		for (std::size_t i = 0; i < instCount; ++i) {
+			AddInstruction(instructions.GetInstruction(i));
+		}
+	}
+
+	void CompactInstructions::Clear() noexcept {
+		m_Labels.clear();
+		m_OpCodes.clear();
+		m_Operands.clear();
+		m_Offsets.clear();
+		m_OperandIndices.clear();
+	}
+
+	std::uint64_t CompactInstructions::GetLabel(std::uint32_t index) const noexcept {
+		return m_Labels[index];
+	}
+	std::uint32_t CompactInstructions::GetLabelCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Labels.size());
+	}
+	Instruction CompactInstructions::GetInstruction(std::uint64_t index) const noexcept {
+		Instruction result(GetOpCode(index), GetOperand(index), GetOffset(index));
+		if (!m_OperandIndices.empty()) {
+			result.OperandIndex = m_OperandIndices[static_cast<std::size_t>(index)];
+		}
+		return result;
+	}
+	std::uint64_t CompactInstructions::GetInstructionCount() const noexcept {
+		return m_OpCodes.size();
+	}
+
+	OpCode CompactInstructions::GetOpCode(std::uint64_t index) const noexcept {
+		return m_OpCodes[static_cast<std::size_t>(index)];
+	}
+	std::uint32_t CompactInstructions::GetOperand(std::uint64_t index) const noexcept {
+		return m_Operands[static_cast<std::size_t>(index)];
+	}
+	std::uint64_t CompactInstructions::GetOffset(std::uint64_t index) const noexcept {
+		const auto i = static_cast<std::size_t>(index);
+		const std::size_t begin = i / OffsetStride * OffsetStride;
+
+		std::uint64_t result = m_Offsets[i / OffsetStride];
+		for (std::size_t j = begin; j < i; ++j) {
+			result += svm::HasOperand[static_cast<std::uint8_t>(m_OpCodes[j])] ? 5 : 1;
+		}
+		return result;
+	}
+	const OpCode* CompactInstructions::GetOpCodes() const noexcept {
+		return m_OpCodes.data();
+	}
+	const std::uint32_t* CompactInstructions::GetOperands() const noexcept {
+		return m_Operands.data();
+	}
+
+	std::uint32_t CompactInstructions::AddLabel(std::uint64_t index) {
+		m_Labels.push_back(index);
+		return static_cast<std::uint32_t>(m_Labels.size() - 1);
+	}
+	std::uint64_t CompactInstructions::AddInstruction(const Instruction& instruction) {
+		const std::size_t index = m_OpCodes.size();
+		if (index % OffsetStride == 0) {
+			const std::uint64_t offset = index ? GetOffset(index - 1) + (HasOperand[static_cast<std::uint8_t>(m_OpCodes.back())] ? 5 : 1)
+											   : instruction.Offset;
+			m_Offsets.push_back(offset);
+		}
+
+		m_OpCodes.push_back(instruction.OpCode);
+		m_Operands.push_back(instruction.HasOperand() ? instruction.Operand : 0);
+
+		if (instruction.OperandIndex && m_OperandIndices.empty()) {
+			m_OperandIndices.resize(index);
+		}
+		if (!m_OperandIndices.empty()) {
+			m_OperandIndices.push_back(instruction.OperandIndex);
+		}
+		return index;
+	}
+
+	Instructions CompactInstructions::ToInstructions() const {
+		const std::size_t instCount = m_OpCodes.size();
+
+		ArenaVector<std::uint64_t> labels(m_Labels.begin(), m_Labels.end());
+		ArenaVector<Instruction> insts;
+		insts.reserve(instCount);
+		for (std::size_t i = 0; i < instCount; ++i) {
+			insts.push_back(GetInstruction(i));
+		}
+		return { std::move(labels), std::move(insts) };
+	}
+	std::size_t CompactInstructions::GetMemoryUsage() const noexcept {
+		return m_Labels.capacity() * sizeof(std::uint64_t) + m_OpCodes.capacity() * sizeof(OpCode) +
+			m_Operands.capacity() * sizeof(std::uint32_t) + m_Offsets.capacity() * sizeof(std::uint64_t) +
+			m_OperandIndices.capacity() * sizeof(std::uint8_t);
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const CompactInstructions& instructions) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+
+		stream << defIndent << "Instructions: " << instCount << '\n'
+			   << defIndent << indentOnce << "Labels: " << labelCount;
+
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			const std::uint64_t label = instructions.GetLabel(i);
+			stream << '\n' << defIndent << indentOnce << indentOnce
+				   << '[' << i << "]: " << label << '(' << QWord(instructions.GetOffset(label)) << ')';
+		}
+
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			stream << '\n' << defIndent << indentOnce << instructions.GetInstruction(i);
+		}
+
+		return stream;
+	}
+}
@@ -0,0 +1,369 @@
+#include <svm/ControlFlowGraph.hpp>
+
+#include <svm/IO.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace svm {
+	BlockList::BlockList(const std::uint32_t* begin, const std::uint32_t* end) noexcept
+		: m_Begin(begin), m_End(end) {}
+
+	std::uint32_t BlockList::operator[](std::size_t index) const noexcept {
+		return m_Begin[index];
+	}
+
+	const std::uint32_t* BlockList::begin() const noexcept {
+		return m_Begin;
+	}
+	const std::uint32_t* BlockList::end() const noexcept {
+		return m_End;
+	}
+	std::size_t BlockList::size() const noexcept {
+		return static_cast<std::size_t>(m_End - m_Begin);
+	}
+	bool BlockList::empty() const noexcept {
+		return m_Begin == m_End;
+	}
+}
+
+namespace svm {
+	ControlFlowGraph::ControlFlowGraph(const Instructions& instructions) {
+		Build(instructions);
+	}
+
+	void ControlFlowGraph::Clear() noexcept {
+		m_Blocks.clear();
+		m_SuccessorOffsets.clear();
+		m_Successors.clear();
+		m_PredecessorOffsets.clear();
+		m_Predecessors.clear();
+
+		m_ReversePostOrder.clear();
+		m_ImmediateDominators.clear();
+		m_DominatorEnter.clear();
+		m_DominatorLeave.clear();
+
+		m_LoopHeaders.clear();
+		m_LoopParents.clear();
+		m_LoopDepths.clear();
+	}
+	void ControlFlowGraph::Build(const Instructions& instructions) {
+		Clear();
+
+		BuildBlocks(instructions);
+		BuildReversePostOrder();
+		BuildDominators();
+		BuildLoops();
+	}
+
+	std::uint32_t ControlFlowGraph::GetBlockCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Blocks.size());
+	}
+	const BasicBlock& ControlFlowGraph::GetBlock(std::uint32_t index) const noexcept {
+		return m_Blocks[index];
+	}
+	std::uint32_t ControlFlowGraph::GetBlockOf(std::uint64_t instruction) const noexcept {
+		const auto iter = std::upper_bound(m_Blocks.begin(), m_Blocks.end(), instruction, [](std::uint64_t index, const BasicBlock& block) {
+			return index < block.Begin;
+		});
+		if (iter == m_Blocks.begin() || instruction >= (iter - 1)->End) return NPos;
+		return static_cast<std::uint32_t>(iter - m_Blocks.begin() - 1);
+	}
+	BlockList ControlFlowGraph::GetSuccessors(std::uint32_t block) const noexcept {
+		return { m_Successors.data() + m_SuccessorOffsets[block], m_Successors.data() + m_SuccessorOffsets[block + 1] };
+	}
+	BlockList ControlFlowGraph::GetPredecessors(std::uint32_t block) const noexcept {
+		return { m_Predecessors.data() + m_PredecessorOffsets[block], m_Predecessors.data() + m_PredecessorOffsets[block + 1] };
+	}
+	BlockList ControlFlowGraph::GetReversePostOrder() const noexcept {
+		return { m_ReversePostOrder.data(), m_ReversePostOrder.data() + m_ReversePostOrder.size() };
+	}
+	bool ControlFlowGraph::IsReachable(std::uint32_t block) const noexcept {
+		return m_DominatorEnter[block] != NPos;
+	}
+
+	std::uint32_t ControlFlowGraph::GetImmediateDominator(std::uint32_t block) const noexcept {
+		return m_ImmediateDominators[block];
+	}
+	bool ControlFlowGraph::Dominates(std::uint32_t dominator, std::uint32_t block) const noexcept {
+		if (!IsReachable(dominator) || !IsReachable(block)) return false;
+		return m_DominatorEnter[dominator] <= m_DominatorEnter[block] && m_DominatorLeave[block] <= m_DominatorLeave[dominator];
+	}
+
+	bool ControlFlowGraph::IsLoopHeader(std::uint32_t block) const noexcept {
+		return m_LoopHeaders[block] == block;
+	}
+	std::uint32_t ControlFlowGraph::GetLoopHeader(std::uint32_t block) const noexcept {
+		return m_LoopHeaders[block];
+	}
+	std::uint32_t ControlFlowGraph::GetParentLoop(std::uint32_t header) const noexcept {
+		return m_LoopParents[header];
+	}
+	std::uint32_t ControlFlowGraph::GetLoopDepth(std::uint32_t block) const noexcept {
+		return m_LoopDepths[block];
+	}
+
+	void ControlFlowGraph::BuildBlocks(const Instructions& instructions) {
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		const std::vector<bool> isTarget = instructions.GetLabelTargets();
+
+		std::vector<std::uint32_t> jumpLabels;
+		std::vector<bool> fallsThrough;
+		bool isLeader = true;
+		for (std::size_t i = 0; i < instCount; ++i) {
+			if (isLeader || isTarget[i]) {
+				if (!m_Blocks.empty()) {
+					m_Blocks.back().End = i;
+				}
+				m_Blocks.push_back({ i, instCount });
+				jumpLabels.push_back(NPos);
+				fallsThrough.push_back(true);
+			}
+
+			const Instruction& instruction = instructions.GetInstruction(i);
+			isLeader = IsJump(instruction.OpCode) || IsTerminator(instruction.OpCode);
+			if (isLeader) {
+				jumpLabels.back() = IsJump(instruction.OpCode) ? instruction.Operand : NPos;
+				fallsThrough.back() = !IsTerminator(instruction.OpCode);
+			}
+		}
+
+		const auto blockCount = static_cast<std::uint32_t>(m_Blocks.size());
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		std::vector<std::uint32_t> targets(blockCount * 2, NPos);
+		m_SuccessorOffsets.assign(blockCount + 1, 0);
+		m_PredecessorOffsets.assign(blockCount + 1, 0);
+
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			std::uint32_t* const target = targets.data() + i * 2;
+			if (fallsThrough[i] && i + 1 < blockCount) {
+				target[0] = i + 1;
+			}
+			if (jumpLabels[i] < labelCount) {
+				const std::uint32_t jumpTarget = GetBlockOf(instructions.GetLabel(jumpLabels[i]));
+				if (jumpTarget != target[0]) {
+					target[1] = jumpTarget;
+				}
+			}
+
+			for (std::size_t j = 0; j < 2; ++j) {
+				if (target[j] == NPos) continue;
+				++m_SuccessorOffsets[i + 1];
+				++m_PredecessorOffsets[target[j] + 1];
+			}
+		}
+
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			m_SuccessorOffsets[i + 1] += m_SuccessorOffsets[i];
+			m_PredecessorOffsets[i + 1] += m_PredecessorOffsets[i];
+		}
+		m_Successors.resize(m_SuccessorOffsets.back());
+		m_Predecessors.resize(m_PredecessorOffsets.back());
+
+		std::vector<std::uint32_t> predecessorCursors(m_PredecessorOffsets.begin(), m_PredecessorOffsets.end() - 1);
+		for (std::uint32_t i = 0, successorCursor = 0; i < blockCount; ++i) {
+			for (std::size_t j = 0; j < 2; ++j) {
+				const std::uint32_t target = targets[i * 2 + j];
+				if (target == NPos) continue;
+				m_Successors[successorCursor++] = target;
+				m_Predecessors[predecessorCursors[target]++] = i;
+			}
+		}
+	}
+	void ControlFlowGraph::BuildReversePostOrder() {
+		const auto blockCount = static_cast<std::uint32_t>(m_Blocks.size());
+		if (blockCount == 0) return;
+
+		std::vector<bool> isVisited(blockCount);
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> stack;
+		m_ReversePostOrder.reserve(blockCount);
+
+		stack.push_back({ 0, m_SuccessorOffsets[0] });
+		isVisited[0] = true;
+		while (!stack.empty()) {
+			auto& [block, next] = stack.back();
+			if (next == m_SuccessorOffsets[block + 1]) {
+				m_ReversePostOrder.push_back(block);
+				stack.pop_back();
+				continue;
+			}
+
+			const std::uint32_t successor = m_Successors[next++];
+			if (!isVisited[successor]) {
+				isVisited[successor] = true;
+				stack.push_back({ successor, m_SuccessorOffsets[successor] });
+			}
+		}
+
+		std::reverse(m_ReversePostOrder.begin(), m_ReversePostOrder.end());
+	}
+	void ControlFlowGraph::BuildDominators() {
+		const auto blockCount = static_cast<std::uint32_t>(m_Blocks.size());
+		m_ImmediateDominators.assign(blockCount, NPos);
+		m_DominatorEnter.assign(blockCount, NPos);
+		m_DominatorLeave.assign(blockCount, NPos);
+		if (blockCount == 0) return;
+
+		std::vector<std::uint32_t> orders(blockCount, NPos);
+		for (std::uint32_t i = 0; i < m_ReversePostOrder.size(); ++i) {
+			orders[m_ReversePostOrder[i]] = i;
+		}
+
+		// Cooper, Harvey and Kennedy's iterative algorithm over the reverse post order.
+		std::vector<std::uint32_t>& idoms = m_ImmediateDominators;
+		const auto intersect = [&](std::uint32_t lhs, std::uint32_t rhs) {
+			while (lhs != rhs) {
+				while (orders[lhs] > orders[rhs]) lhs = idoms[lhs];
+				while (orders[rhs] > orders[lhs]) rhs = idoms[rhs];
+			}
+			return lhs;
+		};
+
+		idoms[0] = 0;
+		for (bool isChanged = true; isChanged;) {
+			isChanged = false;
+			for (std::size_t i = 1; i < m_ReversePostOrder.size(); ++i) {
+				const std::uint32_t block = m_ReversePostOrder[i];
+
+				std::uint32_t newIdom = NPos;
+				for (const std::uint32_t predecessor : GetPredecessors(block)) {
+					if (idoms[predecessor] == NPos) continue;
+					newIdom = newIdom == NPos ? predecessor : intersect(predecessor, newIdom);
+				}
+				if (idoms[block] != newIdom) {
+					idoms[block] = newIdom;
+					isChanged = true;
+				}
+			}
+		}
+		idoms[0] = NPos;
+
+		std::vector<std::uint32_t> childOffsets(blockCount + 1);
+		for (std::uint32_t i = 1; i < blockCount; ++i) {
+			if (idoms[i] != NPos) {
+				++childOffsets[idoms[i] + 1];
+			}
+		}
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			childOffsets[i + 1] += childOffsets[i];
+		}
+
+		std::vector<std::uint32_t> children(childOffsets.back());
+		std::vector<std::uint32_t> childCursors(childOffsets.begin(), childOffsets.end() - 1);
+		for (std::uint32_t i = 1; i < blockCount; ++i) {
+			if (idoms[i] != NPos) {
+				children[childCursors[idoms[i]]++] = i;
+			}
+		}
+
+		std::uint32_t counter = 0;
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> stack;
+		stack.push_back({ 0, childOffsets[0] });
+		m_DominatorEnter[0] = counter++;
+		while (!stack.empty()) {
+			auto& [block, next] = stack.back();
+			if (next == childOffsets[block + 1]) {
+				m_DominatorLeave[block] = counter++;
+				stack.pop_back();
+				continue;
+			}
+
+			const std::uint32_t child = children[next++];
+			m_DominatorEnter[child] = counter++;
+			stack.push_back({ child, childOffsets[child] });
+		}
+	}
+	void ControlFlowGraph::BuildLoops() {
+		const auto blockCount = static_cast<std::uint32_t>(m_Blocks.size());
+		m_LoopHeaders.assign(blockCount, NPos);
+		m_LoopParents.assign(blockCount, NPos);
+		m_LoopDepths.assign(blockCount, 0);
+
+		const auto getOutermost = [this](std::uint32_t block) {
+			std::uint32_t header = m_LoopHeaders[block];
+			if (header == NPos) return block;
+			while (m_LoopParents[header] != NPos) {
+				header = m_LoopParents[header];
+			}
+			return header;
+		};
+
+		// Inner headers come later in the reverse post order, so visiting it backwards discovers loops inside out.
+		std::vector<std::uint32_t> worklist;
+		for (auto iter = m_ReversePostOrder.rbegin(); iter != m_ReversePostOrder.rend(); ++iter) {
+			const std::uint32_t header = *iter;
+			for (const std::uint32_t predecessor : GetPredecessors(header)) {
+				if (Dominates(header, predecessor)) {
+					worklist.push_back(predecessor);
+				}
+			}
+			if (worklist.empty()) continue;
+
+			m_LoopHeaders[header] = header;
+			while (!worklist.empty()) {
+				const std::uint32_t block = getOutermost(worklist.back());
+				worklist.pop_back();
+				if (block == header) continue;
+
+				if (m_LoopHeaders[block] == NPos) {
+					m_LoopHeaders[block] = header;
+				} else {
+					m_LoopParents[block] = header;
+				}
+				for (const std::uint32_t predecessor : GetPredecessors(block)) {
+					if (Dominates(header, predecessor)) {
+						worklist.push_back(predecessor);
+					}
+				}
+			}
+		}
+
+		for (const std::uint32_t block : m_ReversePostOrder) {
+			const std::uint32_t header = m_LoopHeaders[block];
+			if (header == NPos) continue;
+
+			if (header != block) {
+				m_LoopDepths[block] = m_LoopDepths[header];
+			} else if (const std::uint32_t parent = m_LoopParents[block]; parent != NPos) {
+				m_LoopDepths[block] = m_LoopDepths[parent] + 1;
+			} else {
+				m_LoopDepths[block] = 1;
+			}
+		}
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const ControlFlowGraph& graph) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		stream << defIndent << "Blocks: " << blockCount;
+
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			const BasicBlock& block = graph.GetBlock(i);
+			stream << '\n' << defIndent << indentOnce << '[' << i << "]: " << block.Begin << ".." << block.End;
+			if (!graph.IsReachable(i)) {
+				stream << " unreachable";
+				continue;
+			}
+
+			stream << " ->";
+			for (const std::uint32_t successor : graph.GetSuccessors(i)) {
+				stream << ' ' << successor;
+			}
+			if (const std::uint32_t idom = graph.GetImmediateDominator(i); idom != ControlFlowGraph::NPos) {
+				stream << " idom " << idom;
+			}
+			if (graph.IsLoopHeader(i)) {
+				stream << " header";
+			}
+			if (const std::uint32_t depth = graph.GetLoopDepth(i); depth) {
+				stream << " depth " << depth;
+			}
+		}
+
+		return stream;
+	}
+}
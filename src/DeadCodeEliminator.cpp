@@ -0,0 +1,233 @@
+#include <svm/DeadCodeEliminator.hpp>
+
+#include <svm/ControlFlowGraph.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace svm {
+	namespace {
+		bool IsPurePush(OpCode opCode) noexcept {
+			switch (opCode) {
+			case OpCode::Push:
+			case OpCode::Load:
+			case OpCode::Lea:
+			case OpCode::Null:
+			case OpCode::GCNull:
+			case OpCode::Copy:
+				return true;
+
+			default:
+				return false;
+			}
+		}
+		bool IsLocalAccess(OpCode opCode) noexcept {
+			return opCode == OpCode::Load || opCode == OpCode::Store || opCode == OpCode::Lea;
+		}
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const DeadCodeStatistics& statistics) {
+		return stream << "Instructions: " << statistics.OriginalCount << " -> " << statistics.ResultCount
+			<< "\n    unreachable: " << statistics.UnreachableInstructions << " removed"
+			<< "\n    dead-store: " << statistics.DeadStores << " removed"
+			<< "\n    label: " << statistics.RemovedLabels << " removed";
+	}
+}
+
+namespace svm {
+	DeadCodeEliminator::DeadCodeEliminator(const DeadCodeOptions& options) noexcept
+		: m_Options(options) {}
+
+	bool DeadCodeEliminator::Eliminate(Instructions& instructions) {
+		m_Statistics.OriginalCount += instructions.GetInstructionCount();
+
+		bool isChanged = false;
+		if (m_Options.UnreachableCode && RemoveUnreachableCode(instructions)) {
+			isChanged = true;
+		}
+		for (unsigned int i = 0; m_Options.DeadStores && i < m_Options.MaxIterations; ++i) {
+			if (!RemoveDeadStores(instructions)) break;
+			isChanged = true;
+		}
+		if (m_Options.UnusedLabels) {
+			m_Statistics.RemovedLabels += instructions.CompactLabels();
+		}
+
+		if (isChanged) {
+			instructions.UpdateOffsets();
+		}
+		m_Statistics.ResultCount += instructions.GetInstructionCount();
+		return isChanged;
+	}
+	void DeadCodeEliminator::Eliminate(Functions& functions) {
+		for (FunctionInfo& function : functions) {
+			if (Eliminate(function.Instructions)) {
+				function.Frame = {};
+			}
+		}
+	}
+
+	const DeadCodeOptions& DeadCodeEliminator::GetOptions() const noexcept {
+		return m_Options;
+	}
+	void DeadCodeEliminator::SetOptions(const DeadCodeOptions& newOptions) noexcept {
+		m_Options = newOptions;
+	}
+	const DeadCodeStatistics& DeadCodeEliminator::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	void DeadCodeEliminator::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+
+	bool DeadCodeEliminator::RemoveUnreachableCode(Instructions& instructions) {
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		for (std::size_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode >= OpCode::Count) return false;
+			if (IsJump(inst.OpCode) && (inst.Operand >= labelCount || instructions.GetLabel(inst.Operand) >= instCount)) return false;
+		}
+
+		const ControlFlowGraph graph(instructions);
+		ArenaVector<Instruction> result;
+		std::vector<std::uint64_t> indexMap(instCount + 1);
+		result.reserve(instCount);
+
+		for (std::uint32_t block = 0; block < graph.GetBlockCount(); ++block) {
+			const BasicBlock& range = graph.GetBlock(block);
+			const bool isReachable = graph.IsReachable(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				indexMap[static_cast<std::size_t>(i)] = result.size();
+				if (isReachable) {
+					result.push_back(instructions.GetInstruction(i));
+				}
+			}
+		}
+		indexMap[instCount] = result.size();
+
+		if (result.size() == instCount) return false;
+
+		m_Statistics.UnreachableInstructions += instCount - result.size();
+		instructions.SetInstructions(std::move(result), indexMap);
+		return true;
+	}
+	bool DeadCodeEliminator::RemoveDeadStores(Instructions& instructions) {
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		std::size_t localCount = 0;
+		for (std::size_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode >= OpCode::Count) return false;
+			if (IsJump(inst.OpCode) && (inst.Operand >= labelCount || instructions.GetLabel(inst.Operand) >= instCount)) return false;
+			if (IsLocalAccess(inst.OpCode)) {
+				localCount = std::max(localCount, static_cast<std::size_t>(inst.Operand) + 1);
+			}
+		}
+		if (localCount == 0) return false;
+
+		// Locals whose address is taken may be read through the pointer.
+		std::vector<bool> isEscaped(localCount);
+		for (std::size_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode == OpCode::Lea) {
+				isEscaped[inst.Operand] = true;
+			}
+		}
+
+		const ControlFlowGraph graph(instructions);
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		const auto transfer = [&](std::uint32_t block, std::vector<bool>& live) {
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.End; i-- > range.Begin;) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (inst.OpCode == OpCode::Store) {
+					live[inst.Operand] = false;
+				} else if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Lea) {
+					live[inst.Operand] = true;
+				}
+			}
+		};
+
+		// Backward liveness over the reverse of the reverse post order.
+		std::vector<std::vector<bool>> liveIn(blockCount, std::vector<bool>(localCount));
+		std::vector<bool> live;
+		const BlockList order = graph.GetReversePostOrder();
+		for (bool isChanged = true; isChanged;) {
+			isChanged = false;
+			for (std::size_t i = order.size(); i-- > 0;) {
+				const std::uint32_t block = order[i];
+				live.assign(localCount, false);
+				for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+					for (std::size_t j = 0; j < localCount; ++j) {
+						if (liveIn[successor][j]) {
+							live[j] = true;
+						}
+					}
+				}
+
+				transfer(block, live);
+				if (live != liveIn[block]) {
+					liveIn[block] = live;
+					isChanged = true;
+				}
+			}
+		}
+
+		std::vector<bool> isDead(instCount);
+		std::uint64_t deadCount = 0;
+		for (std::uint32_t block = 0; block < blockCount; ++block) {
+			if (!graph.IsReachable(block)) continue;
+
+			live.assign(localCount, false);
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				for (std::size_t j = 0; j < localCount; ++j) {
+					if (liveIn[successor][j]) {
+						live[j] = true;
+					}
+				}
+			}
+
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.End; i-- > range.Begin;) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (inst.OpCode == OpCode::Store) {
+					if (!live[inst.Operand] && !isEscaped[inst.Operand]) {
+						isDead[static_cast<std::size_t>(i)] = true;
+						++deadCount;
+					}
+					live[inst.Operand] = false;
+				} else if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Lea) {
+					live[inst.Operand] = true;
+				}
+			}
+		}
+		if (deadCount == 0) return false;
+
+		// A dead store becomes a pop, which cancels a pure push right before it.
+		const std::vector<bool> isTarget = instructions.GetLabelTargets();
+		ArenaVector<Instruction> result;
+		std::vector<std::uint64_t> indexMap(instCount + 1);
+		result.reserve(instCount);
+
+		for (std::size_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			indexMap[i] = result.size();
+			if (!isDead[i]) {
+				result.push_back(inst);
+			} else if (i > 0 && !isTarget[i] && !result.empty() && IsPurePush(result.back().OpCode) &&
+				indexMap[i - 1] == result.size() - 1) {
+				indexMap[i] = indexMap[i - 1];
+				result.pop_back();
+			} else {
+				result.push_back(Instruction(OpCode::Pop, inst.Offset));
+			}
+		}
+		indexMap[instCount] = result.size();
+
+		m_Statistics.DeadStores += deadCount;
+		instructions.SetInstructions(std::move(result), indexMap);
+		return true;
+	}
+}
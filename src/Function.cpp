@@ -6,20 +6,23 @@
 #include <utility>
 
 namespace svm {
-	FunctionInfo::FunctionInfo(std::string name, std::uint16_t arity, bool hasResult) noexcept
-		: Name(std::move(name)), Arity(arity), HasResult(hasResult) {}
-	FunctionInfo::FunctionInfo(std::string name, std::uint16_t arity, svm::Instructions&& instructions) noexcept
-		: Name(std::move(name)), Arity(arity), Instructions(std::move(instructions)) {}
-	FunctionInfo::FunctionInfo(std::string name, std::uint16_t arity, bool hasResult, svm::Instructions&& instructions) noexcept
-		: Name(std::move(name)), Arity(arity), HasResult(hasResult), Instructions(std::move(instructions)) {}
+	FunctionInfo::FunctionInfo(std::string_view name, std::uint16_t arity, bool hasResult) noexcept
+		: Name(name), Arity(arity), HasResult(hasResult) {}
+	FunctionInfo::FunctionInfo(std::string_view name, std::uint16_t arity, svm::Instructions&& instructions) noexcept
+		: Name(name), Arity(arity), Instructions(std::move(instructions)) {}
+	FunctionInfo::FunctionInfo(std::string_view name, std::uint16_t arity, bool hasResult, svm::Instructions&& instructions) noexcept
+		: Name(name), Arity(arity), HasResult(hasResult), Instructions(std::move(instructions)) {}
 	FunctionInfo::FunctionInfo(FunctionInfo&& functionInfo) noexcept
-		: Name(std::move(functionInfo.Name)), Arity(functionInfo.Arity), HasResult(functionInfo.HasResult), Instructions(std::move(functionInfo.Instructions)) {}
+		: Name(functionInfo.Name), Arity(functionInfo.Arity), HasResult(functionInfo.HasResult), Instructions(std::move(functionInfo.Instructions)),
+		Frame(functionInfo.Frame), Verification(functionInfo.Verification) {}
 
 	FunctionInfo& FunctionInfo::operator=(FunctionInfo&& functionInfo) noexcept {
-		Name = std::move(functionInfo.Name);
+		Name = functionInfo.Name;
 		Arity = functionInfo.Arity;
 		HasResult = functionInfo.HasResult;
 		Instructions = std::move(functionInfo.Instructions);
+		Frame = functionInfo.Frame;
+		Verification = functionInfo.Verification;
 		return *this;
 	}
 
@@ -30,9 +33,22 @@ namespace svm {
 		stream << defIndent << "Function:\n"
 			   << defIndent << indentOnce << "Name: \"" << function.Name << "\"\n"
 			   << defIndent << indentOnce << "Arity: " << function.Arity << '\n'
-			   << defIndent << indentOnce << "HasResult: " << std::boolalpha << function.HasResult << std::noboolalpha << '\n'
-			   << Indent << Indent << function.Instructions << UnIndent << UnIndent;
-		return stream;
+			   << defIndent << indentOnce << "HasResult: " << std::boolalpha << function.HasResult << std::noboolalpha << '\n';
+		if (function.Frame.IsAnalyzed) {
+			stream << defIndent << indentOnce << "MaxStackSlots: " << function.Frame.MaxStackSlots << '\n'
+				   << defIndent << indentOnce << "MaxStackBytes: ";
+			if (function.Frame.MaxStackBytes == FrameInfo::Unbounded) {
+				stream << "unbounded\n";
+			} else {
+				stream << function.Frame.MaxStackBytes << '\n';
+			}
+			stream << defIndent << indentOnce << "LocalCount: " << function.Frame.LocalCount << '\n';
+		}
+		if (function.Verification != VerificationLevel::Unverified) {
+			stream << defIndent << indentOnce << "Verification: "
+				   << (function.Verification == VerificationLevel::TypeSafe ? "typesafe" : "structural") << '\n';
+		}
+		return stream << Indent << Indent << function.Instructions << UnIndent << UnIndent;
 	}
 }
 
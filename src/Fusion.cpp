@@ -0,0 +1,262 @@
+#include <svm/Fusion.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace svm {
+	namespace {
+		OpCode GetConditionalJump(OpCode opCode) noexcept {
+			switch (opCode) {
+			case OpCode::Je:
+			case OpCode::Jne:
+			case OpCode::Ja:
+			case OpCode::Jae:
+			case OpCode::Jb:
+			case OpCode::Jbe:
+				return opCode;
+
+			default:
+				return OpCode::Nop;
+			}
+		}
+		bool IsShortOperand(std::uint32_t operand) noexcept {
+			return operand <= 0xFFFF;
+		}
+
+		std::size_t Match(const Instruction* insts, std::size_t count, Instruction& result) noexcept {
+			const OpCode first = insts[0].OpCode;
+			const OpCode second = count >= 2 ? insts[1].OpCode : OpCode::Nop;
+			const OpCode third = count >= 3 ? insts[2].OpCode : OpCode::Nop;
+
+			if (first == OpCode::Push && second == OpCode::Push &&
+				IsShortOperand(insts[0].Operand) && IsShortOperand(insts[1].Operand)) {
+				result.Operand = PackFusedOperands(insts[0].Operand, insts[1].Operand);
+				if (third == OpCode::Add) {
+					result.OpCode = OpCode::PushPushAdd;
+					return 3;
+				} else {
+					result.OpCode = OpCode::PushPush;
+					return 2;
+				}
+			} else if (first == OpCode::Load && (second == OpCode::Inc || second == OpCode::Dec) && third == OpCode::Store &&
+				IsShortOperand(insts[0].Operand) && IsShortOperand(insts[2].Operand)) {
+				result.OpCode = second == OpCode::Inc ? OpCode::LoadIncStore : OpCode::LoadDecStore;
+				result.Operand = PackFusedOperands(insts[0].Operand, insts[2].Operand);
+				return 3;
+			} else if (first == OpCode::Load && second == OpCode::Load &&
+				IsShortOperand(insts[0].Operand) && IsShortOperand(insts[1].Operand)) {
+				result.OpCode = OpCode::LoadLoad;
+				result.Operand = PackFusedOperands(insts[0].Operand, insts[1].Operand);
+				return 2;
+			} else if ((first == OpCode::Cmp || first == OpCode::ICmp) && GetConditionalJump(second) != OpCode::Nop) {
+				const auto jump = static_cast<std::uint8_t>(second) - static_cast<std::uint8_t>(OpCode::Je);
+				const OpCode base = first == OpCode::Cmp ? OpCode::CmpJe : OpCode::ICmpJe;
+				result.OpCode = static_cast<OpCode>(static_cast<std::uint8_t>(base) + jump);
+				result.Operand = insts[1].Operand;
+				return 2;
+			}
+			return 1;
+		}
+		std::size_t Expand(const Instruction& instruction, Instruction* result) noexcept {
+			const std::uint32_t first = GetFusedOperand(instruction, 0);
+			const std::uint32_t second = GetFusedOperand(instruction, 1);
+
+			switch (instruction.OpCode) {
+			case OpCode::PushPush:
+				result[0] = Instruction(OpCode::Push, first, instruction.Offset);
+				result[1] = Instruction(OpCode::Push, second, instruction.Offset);
+				return 2;
+
+			case OpCode::PushPushAdd:
+				result[0] = Instruction(OpCode::Push, first, instruction.Offset);
+				result[1] = Instruction(OpCode::Push, second, instruction.Offset);
+				result[2] = Instruction(OpCode::Add, instruction.Offset);
+				return 3;
+
+			case OpCode::LoadLoad:
+				result[0] = Instruction(OpCode::Load, first, instruction.Offset);
+				result[1] = Instruction(OpCode::Load, second, instruction.Offset);
+				return 2;
+
+			case OpCode::LoadIncStore:
+			case OpCode::LoadDecStore:
+				result[0] = Instruction(OpCode::Load, first, instruction.Offset);
+				result[1] = Instruction(instruction.OpCode == OpCode::LoadIncStore ? OpCode::Inc : OpCode::Dec, instruction.Offset);
+				result[2] = Instruction(OpCode::Store, second, instruction.Offset);
+				return 3;
+
+			default: {
+				const bool isICmp = instruction.OpCode >= OpCode::ICmpJe;
+				const OpCode base = isICmp ? OpCode::ICmpJe : OpCode::CmpJe;
+				const auto jump = static_cast<std::uint8_t>(instruction.OpCode) - static_cast<std::uint8_t>(base);
+				result[0] = Instruction(isICmp ? OpCode::ICmp : OpCode::Cmp, instruction.Offset);
+				result[1] = Instruction(static_cast<OpCode>(static_cast<std::uint8_t>(OpCode::Je) + jump), instruction.Operand, instruction.Offset);
+				return 2;
+			}
+			}
+		}
+	}
+
+	bool IsFused(OpCode opCode) noexcept {
+		return opCode > OpCode::Count && opCode < OpCode::FusedCount;
+	}
+	std::uint32_t PackFusedOperands(std::uint32_t first, std::uint32_t second) noexcept {
+		return first << 16 | (second & 0xFFFF);
+	}
+	std::uint32_t GetFusedOperand(const Instruction& instruction, std::size_t index) noexcept {
+		return index == 0 ? instruction.Operand >> 16 : instruction.Operand & 0xFFFF;
+	}
+
+	FusionStatistics Fuse(Instructions& instructions) {
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		const std::vector<bool> isTarget = instructions.GetLabelTargets();
+
+		std::vector<Instruction> window;
+		ArenaVector<Instruction> result;
+		std::vector<std::uint64_t> indexMap(instCount + 1);
+		FusionStatistics stat;
+		stat.OriginalCount = instCount;
+		result.reserve(instCount);
+
+		for (std::size_t i = 0; i < instCount;) {
+			// A fused instruction may only be entered from its first component.
+			std::size_t length = 1;
+			while (length < 3 && i + length < instCount && !isTarget[i + length]) {
+				++length;
+			}
+
+			window.clear();
+			for (std::size_t j = 0; j < length; ++j) {
+				window.push_back(instructions.GetInstruction(i + j));
+			}
+
+			Instruction fused(window[0]);
+			const std::size_t used = Match(window.data(), length, fused);
+			for (std::size_t j = 0; j < used; ++j) {
+				indexMap[i + j] = result.size();
+			}
+			if (used > 1) {
+				++stat.FusedCount;
+			}
+
+			result.push_back(fused);
+			i += used;
+		}
+		indexMap[instCount] = result.size();
+
+		stat.ResultCount = result.size();
+		instructions.SetInstructions(std::move(result), indexMap);
+		return stat;
+	}
+	FusionStatistics Fuse(Functions& functions) {
+		FusionStatistics result;
+		for (FunctionInfo& function : functions) {
+			const FusionStatistics stat = Fuse(function.Instructions);
+			result.OriginalCount += stat.OriginalCount;
+			result.FusedCount += stat.FusedCount;
+			result.ResultCount += stat.ResultCount;
+		}
+		return result;
+	}
+	void Unfuse(Instructions& instructions) {
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+
+		ArenaVector<Instruction> result;
+		std::vector<std::uint64_t> indexMap(instCount + 1);
+		result.reserve(instCount);
+
+		for (std::size_t i = 0; i < instCount; ++i) {
+			const Instruction& instruction = instructions.GetInstruction(i);
+			indexMap[i] = result.size();
+
+			if (IsFused(instruction.OpCode)) {
+				Instruction expanded[3];
+				const std::size_t count = Expand(instruction, expanded);
+				result.insert(result.end(), expanded, expanded + count);
+			} else {
+				result.push_back(instruction);
+			}
+		}
+		indexMap[instCount] = result.size();
+
+		instructions.SetInstructions(std::move(result), indexMap);
+		instructions.UpdateOffsets();
+	}
+	void Unfuse(Functions& functions) {
+		for (FunctionInfo& function : functions) {
+			Unfuse(function.Instructions);
+		}
+	}
+}
+
+namespace svm {
+	NGramCounter::NGramCounter(std::size_t length) noexcept
+		: m_Length(std::clamp<std::size_t>(length, 1, MaxLength)) {}
+
+	void NGramCounter::Clear() noexcept {
+		m_Counts.clear();
+		m_TotalCount = 0;
+	}
+
+	void NGramCounter::Add(const Instructions& instructions) {
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		if (instCount < m_Length) return;
+
+		const std::vector<bool> isTarget = instructions.GetLabelTargets();
+		const std::uint64_t mask = m_Length == MaxLength ? ~0ull : (1ull << m_Length * 8) - 1;
+
+		std::uint64_t key = 0;
+		std::size_t run = 0;
+		for (std::size_t i = 0; i < instCount; ++i) {
+			// Sequences that can be entered in the middle are not fusion candidates.
+			if (isTarget[i]) {
+				run = 0;
+			}
+
+			key = (key << 8 | static_cast<std::uint8_t>(instructions.GetInstruction(i).OpCode)) & mask;
+			if (++run >= m_Length) {
+				++m_Counts[key];
+				++m_TotalCount;
+			}
+		}
+	}
+	void NGramCounter::Add(const Functions& functions) {
+		for (const FunctionInfo& function : functions) {
+			Add(function.Instructions);
+		}
+	}
+
+	std::size_t NGramCounter::GetLength() const noexcept {
+		return m_Length;
+	}
+	std::uint64_t NGramCounter::GetTotalCount() const noexcept {
+		return m_TotalCount;
+	}
+	std::vector<NGramCounter::NGram> NGramCounter::GetMostFrequent(std::size_t count) const {
+		std::vector<std::pair<std::uint64_t, std::uint64_t>> counts(m_Counts.begin(), m_Counts.end());
+		count = std::min(count, counts.size());
+		std::partial_sort(counts.begin(), counts.begin() + count, counts.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+		});
+
+		std::vector<NGram> result(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			result[i].Count = counts[i].second;
+			for (std::size_t j = m_Length; j > 0; --j) {
+				result[i].OpCodes.push_back(static_cast<OpCode>(counts[i].first >> (j - 1) * 8 & 0xFF));
+			}
+		}
+		return result;
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const NGramCounter::NGram& nGram) {
+		stream << nGram.Count << '\t';
+		for (std::size_t i = 0; i < nGram.OpCodes.size(); ++i) {
+			if (i) {
+				stream << "; ";
+			}
+			stream << Mnemonics[static_cast<std::uint8_t>(nGram.OpCodes[i])];
+		}
+		return stream;
+	}
+}
@@ -2,8 +2,12 @@
 
 #include <svm/IO.hpp>
 
+#include <atomic>
 #include <cstddef>
+#include <limits>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 namespace svm {
@@ -13,6 +17,111 @@ namespace svm {
 	std::uint8_t ConvertOpCode(OpCode opCode, ShitBCVersion) noexcept {
 		return static_cast<std::uint8_t>(opCode);
 	}
+
+	bool IsJump(OpCode opCode) noexcept {
+		return opCode == OpCode::Jmp || IsConditionalJump(opCode);
+	}
+	bool IsConditionalJump(OpCode opCode) noexcept {
+		return (opCode >= OpCode::Je && opCode <= OpCode::Jbe) || (opCode >= OpCode::CmpJe && opCode <= OpCode::ICmpJbe);
+	}
+	bool IsTerminator(OpCode opCode) noexcept {
+		return opCode == OpCode::Jmp || opCode == OpCode::Ret;
+	}
+	bool GetStackEffect(OpCode opCode, std::uint32_t& popCount, std::uint32_t& pushCount) noexcept {
+		// The effect of call depends on the callee, and ret leaves the result to the caller.
+		switch (opCode) {
+		case OpCode::Nop:
+		case OpCode::Jmp:
+		case OpCode::Ret:
+			popCount = 0;
+			pushCount = 0;
+			return true;
+
+		case OpCode::Push:
+		case OpCode::Load:
+		case OpCode::Lea:
+		case OpCode::Null:
+		case OpCode::New:
+		case OpCode::GCNull:
+		case OpCode::GCNew:
+			popCount = 0;
+			pushCount = 1;
+			return true;
+
+		case OpCode::Pop:
+		case OpCode::Store:
+		case OpCode::Je:
+		case OpCode::Jne:
+		case OpCode::Ja:
+		case OpCode::Jae:
+		case OpCode::Jb:
+		case OpCode::Jbe:
+		case OpCode::Delete:
+			popCount = 1;
+			pushCount = 0;
+			return true;
+
+		case OpCode::FLea:
+		case OpCode::TLoad:
+		case OpCode::Neg:
+		case OpCode::Inc:
+		case OpCode::Dec:
+		case OpCode::Not:
+		case OpCode::ToB:
+		case OpCode::ToSh:
+		case OpCode::ToI:
+		case OpCode::ToL:
+		case OpCode::ToSi:
+		case OpCode::ToD:
+		case OpCode::ToP:
+		case OpCode::APush:
+		case OpCode::ANew:
+		case OpCode::AGCNew:
+			popCount = 1;
+			pushCount = 1;
+			return true;
+
+		case OpCode::TStore:
+			popCount = 2;
+			pushCount = 0;
+			return true;
+
+		case OpCode::Copy:
+			popCount = 1;
+			pushCount = 2;
+			return true;
+
+		case OpCode::Swap:
+			popCount = 2;
+			pushCount = 2;
+			return true;
+
+		case OpCode::Add:
+		case OpCode::Sub:
+		case OpCode::Mul:
+		case OpCode::IMul:
+		case OpCode::Div:
+		case OpCode::IDiv:
+		case OpCode::Mod:
+		case OpCode::IMod:
+		case OpCode::And:
+		case OpCode::Or:
+		case OpCode::Xor:
+		case OpCode::Shl:
+		case OpCode::Sal:
+		case OpCode::Shr:
+		case OpCode::Sar:
+		case OpCode::Cmp:
+		case OpCode::ICmp:
+		case OpCode::ALea:
+			popCount = 2;
+			pushCount = 1;
+			return true;
+
+		default:
+			return false;
+		}
+	}
 }
 
 namespace svm {
@@ -49,46 +158,159 @@ namespace svm {
 }
 
 namespace svm {
-	Instructions::Instructions(std::vector<std::uint64_t> labels, std::vector<Instruction> instructions) noexcept
+	struct Instructions::LazyState final {
+		std::function<Instructions()> Decoder;
+		std::once_flag DecodeFlag;
+		std::atomic<bool> IsDecoded = false;
+	};
+
+	Instructions::Instructions() noexcept = default;
+	Instructions::Instructions(ArenaVector<std::uint64_t> labels, ArenaVector<Instruction> instructions) noexcept
 		: m_Labels(std::move(labels)), m_Instructions(std::move(instructions)) {}
+	Instructions::Instructions(std::function<Instructions()> decoder)
+		: m_LazyState(std::make_unique<LazyState>()) {
+		m_LazyState->Decoder = std::move(decoder);
+	}
 	Instructions::Instructions(Instructions&& instructions) noexcept
-		: m_Labels(std::move(instructions.m_Labels)), m_Instructions(std::move(instructions.m_Instructions)) {}
+		: m_Labels(std::move(instructions.m_Labels)), m_Instructions(std::move(instructions.m_Instructions)),
+		m_LazyState(std::move(instructions.m_LazyState)) {}
+	Instructions::~Instructions() = default;
 
 	Instructions& Instructions::operator=(Instructions&& instructions) noexcept {
 		m_Labels = std::move(instructions.m_Labels);
 		m_Instructions = std::move(instructions.m_Instructions);
+		m_LazyState = std::move(instructions.m_LazyState);
 		return *this;
 	}
 
 	void Instructions::Clear() noexcept {
-		m_Labels.clear();
-		m_Instructions.clear();
+		m_Labels = ArenaVector<std::uint64_t>();
+		m_Instructions = ArenaVector<Instruction>();
+		m_LazyState.reset();
 	}
 
-	std::uint64_t Instructions::GetLabel(std::uint32_t index) const noexcept {
+	std::uint64_t Instructions::GetLabel(std::uint32_t index) const {
+		if (m_LazyState) Decode();
+
 		return m_Labels[index];
 	}
-	std::uint32_t Instructions::GetLabelCount() const noexcept {
+	std::uint32_t Instructions::GetLabelCount() const {
+		if (m_LazyState) Decode();
+
 		return static_cast<std::uint32_t>(m_Labels.size());
 	}
-	const Instruction& Instructions::GetInstruction(std::uint64_t index) const noexcept {
+	const Instruction& Instructions::GetInstruction(std::uint64_t index) const {
+		if (m_LazyState) Decode();
+
 		return m_Instructions[static_cast<std::size_t>(index)];
 	}
-	std::uint64_t Instructions::GetInstructionCount() const noexcept {
+	std::uint64_t Instructions::GetInstructionCount() const {
+		if (m_LazyState) Decode();
+
 		return m_Instructions.size();
 	}
+	std::vector<bool> Instructions::GetLabelTargets() const {
+		if (m_LazyState) Decode();
+
+		std::vector<bool> result(m_Instructions.size() + 1);
+		for (const std::uint64_t label : m_Labels) {
+			if (label < result.size()) {
+				result[static_cast<std::size_t>(label)] = true;
+			}
+		}
+		return result;
+	}
 	std::uint32_t Instructions::AddLabel(std::uint64_t index) {
+		if (m_LazyState) Decode();
+
 		m_Labels.push_back(index);
 		return static_cast<std::uint32_t>(m_Labels.size() - 1);
 	}
-	void Instructions::SetLabel(std::uint32_t index, std::uint64_t label) noexcept {
+	void Instructions::SetLabel(std::uint32_t index, std::uint64_t label) {
+		if (m_LazyState) Decode();
+
 		m_Labels[index] = label;
 	}
 	std::uint64_t Instructions::AddInstruction(const Instruction& instruction) {
+		if (m_LazyState) Decode();
+
 		m_Instructions.push_back(instruction);
 		return m_Instructions.size() - 1;
 	}
 
+	void Instructions::SetInstruction(std::uint64_t index, const Instruction& instruction) {
+		if (m_LazyState) Decode();
+
+		m_Instructions[static_cast<std::size_t>(index)] = instruction;
+	}
+	void Instructions::SetInstructions(ArenaVector<Instruction> instructions, const std::vector<std::uint64_t>& indexMap) {
+		if (m_LazyState) Decode();
+
+		const std::uint64_t oldEnd = indexMap.size() - 1;
+		for (std::uint64_t& label : m_Labels) {
+			label = label <= oldEnd ? indexMap[static_cast<std::size_t>(label)] : label - oldEnd + indexMap.back();
+		}
+		m_Instructions = std::move(instructions);
+	}
+	void Instructions::UpdateOffsets() {
+		if (m_LazyState) Decode();
+
+		std::uint64_t nextOffset = 0;
+		for (Instruction& instruction : m_Instructions) {
+			instruction.Offset = nextOffset;
+			nextOffset += instruction.HasOperand() ? 5 : 1;
+		}
+	}
+
+	std::uint32_t Instructions::CompactLabels() {
+		if (m_LazyState) Decode();
+
+		for (const Instruction& instruction : m_Instructions) {
+			if (IsJump(instruction.OpCode) && instruction.Operand >= m_Labels.size()) return 0;
+		}
+
+		// Labels are kept in order of first use; labels sharing a target are merged.
+		constexpr std::uint32_t unused = std::numeric_limits<std::uint32_t>::max();
+		std::vector<std::uint32_t> labelMap(m_Labels.size(), unused);
+		std::unordered_map<std::uint64_t, std::uint32_t> targets;
+		ArenaVector<std::uint64_t> labels(m_Labels.get_allocator());
+		for (Instruction& instruction : m_Instructions) {
+			if (!IsJump(instruction.OpCode)) continue;
+
+			std::uint32_t& label = labelMap[instruction.Operand];
+			if (label == unused) {
+				const auto [iter, isInserted] = targets.emplace(m_Labels[instruction.Operand], static_cast<std::uint32_t>(labels.size()));
+				if (isInserted) {
+					labels.push_back(iter->first);
+				}
+				label = iter->second;
+			}
+			instruction.Operand = label;
+		}
+
+		const auto result = static_cast<std::uint32_t>(m_Labels.size() - labels.size());
+		m_Labels = std::move(labels);
+		return result;
+	}
+
+	bool Instructions::IsDecoded() const noexcept {
+		return !m_LazyState || m_LazyState->IsDecoded.load(std::memory_order_acquire);
+	}
+
+	void Instructions::Decode() const {
+		LazyState& state = *m_LazyState;
+		if (state.IsDecoded.load(std::memory_order_acquire)) return;
+
+		std::call_once(state.DecodeFlag, [this, &state] {
+			Instructions decoded = state.Decoder();
+			m_Labels = std::move(decoded.m_Labels);
+			m_Instructions = std::move(decoded.m_Instructions);
+
+			state.Decoder = nullptr;
+			state.IsDecoded.store(true, std::memory_order_release);
+		});
+	}
+
 	std::ostream& operator<<(std::ostream& stream, const Instructions& instructions) {
 		const std::string defIndent = detail::MakeIndent(stream);
 		const std::string indentOnce(4, ' ');
@@ -33,14 +33,15 @@ namespace svm {
 		m_FunctionMappings.clear();
 	}
 
-	void Mappings::AddStructureMapping(std::uint32_t module, std::string name) {
-		m_StructureMappings.push_back({ module, name });
-
-		m_StructureMappings.back().TempType.Name = std::move(name);
-		m_StructureMappings.back().TempType.Module = module + 1;
+	void Mappings::AddStructureMapping(std::uint32_t module, std::string_view name, StringPool& stringPool) {
+		StructureMapping& mapping = m_StructureMappings.emplace_back();
+		mapping.Module = module;
+		mapping.Name = stringPool.Intern(name);
+		mapping.TempType.Name = mapping.Name;
+		mapping.TempType.Module = module + 1;
 	}
-	void Mappings::AddFunctionMapping(std::uint32_t module, std::string name) {
-		m_FunctionMappings.push_back({ module, std::move(name) });
+	void Mappings::AddFunctionMapping(std::uint32_t module, std::string_view name, StringPool& stringPool) {
+		m_FunctionMappings.push_back({ module, stringPool.Intern(name) });
 	}
 
 	const StructureMapping& Mappings::GetStructureMapping(std::uint32_t index) const noexcept {
@@ -0,0 +1,57 @@
+#include <svm/OffsetIndex.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+
+namespace svm {
+	OffsetIndex::OffsetIndex(const Instructions& instructions) {
+		Build(instructions);
+	}
+
+	void OffsetIndex::Clear() noexcept {
+		m_Offsets.clear();
+		m_Size = 0;
+	}
+	void OffsetIndex::Build(const Instructions& instructions) {
+		Clear();
+
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		if (instCount == 0) return;
+
+		const Instruction& last = instructions.GetInstruction(instCount - 1);
+		const std::uint64_t size = last.Offset + (last.HasOperand() ? 5 : 1);
+		if (size > std::numeric_limits<std::uint32_t>::max()) throw std::runtime_error("Failed to build the offset index. Too large function.");
+
+		m_Offsets.reserve(static_cast<std::size_t>(instCount));
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const std::uint64_t offset = instructions.GetInstruction(i).Offset;
+			if (!m_Offsets.empty() && offset < m_Offsets.back()) {
+				Clear();
+				throw std::runtime_error("Failed to build the offset index. Unordered offsets.");
+			}
+
+			m_Offsets.push_back(static_cast<std::uint32_t>(offset));
+		}
+		m_Size = size;
+	}
+
+	std::uint64_t OffsetIndex::GetInstruction(std::uint64_t offset) const noexcept {
+		if (offset >= m_Size || offset < m_Offsets.front()) return NPos;
+
+		const auto iter = std::upper_bound(m_Offsets.begin(), m_Offsets.end(), static_cast<std::uint32_t>(offset));
+		return static_cast<std::uint64_t>(iter - m_Offsets.begin()) - 1;
+	}
+	std::uint64_t OffsetIndex::GetOffset(std::uint64_t instruction) const noexcept {
+		assert(instruction < m_Offsets.size());
+
+		return m_Offsets[static_cast<std::size_t>(instruction)];
+	}
+	std::uint64_t OffsetIndex::GetInstructionCount() const noexcept {
+		return m_Offsets.size();
+	}
+	std::uint64_t OffsetIndex::GetSize() const noexcept {
+		return m_Size;
+	}
+}
@@ -0,0 +1,200 @@
+#include <svm/PeepholeOptimizer.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace svm {
+	namespace {
+		struct Rewrite final {
+			std::size_t Consumed = 0;
+			std::size_t Emitted = 0;
+			Instruction Result[2];
+		};
+
+		bool IsPurePush(OpCode opCode) noexcept {
+			switch (opCode) {
+			case OpCode::Push:
+			case OpCode::Load:
+			case OpCode::Lea:
+			case OpCode::Null:
+			case OpCode::GCNull:
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+		Rewrite Match(PeepholePass pass, const Instructions& instructions, std::size_t index, const Instruction* insts, std::size_t count) {
+			Rewrite result;
+			const Instruction& first = insts[0];
+			const OpCode second = count >= 2 ? insts[1].OpCode : OpCode::Nop;
+
+			switch (pass) {
+			case PeepholePass::Nop:
+				if (first.OpCode == OpCode::Nop) {
+					result.Consumed = 1;
+				}
+				break;
+
+			case PeepholePass::PushPop:
+				if (IsPurePush(first.OpCode) && second == OpCode::Pop) {
+					result.Consumed = 2;
+				}
+				break;
+
+			case PeepholePass::CopyPop:
+				if (first.OpCode == OpCode::Copy && second == OpCode::Pop) {
+					result.Consumed = 2;
+				}
+				break;
+
+			case PeepholePass::StoreLoad:
+				if (count < 2 || first.Operand != insts[1].Operand) break;
+				if (first.OpCode == OpCode::Load && second == OpCode::Store) {
+					result.Consumed = 2;
+				} else if (first.OpCode == OpCode::Store && second == OpCode::Load) {
+					result.Consumed = 2;
+					result.Emitted = 2;
+					result.Result[0] = Instruction(OpCode::Copy, first.Offset);
+					result.Result[1] = first;
+				}
+				break;
+
+			case PeepholePass::DoubleNegation:
+				if ((first.OpCode == OpCode::Neg || first.OpCode == OpCode::Not) && second == first.OpCode) {
+					result.Consumed = 2;
+				}
+				break;
+
+			case PeepholePass::JumpToNext:
+				if (first.OpCode >= OpCode::Jmp && first.OpCode <= OpCode::Jbe && first.Operand < instructions.GetLabelCount() &&
+					instructions.GetLabel(first.Operand) == index + 1) {
+					result.Consumed = 1;
+					if (first.OpCode != OpCode::Jmp) {
+						// A conditional jump still consumes its condition.
+						result.Emitted = 1;
+						result.Result[0] = Instruction(OpCode::Pop, first.Offset);
+					}
+				}
+				break;
+
+			default:
+				break;
+			}
+			return result;
+		}
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const PeepholeStatistics& statistics) {
+		stream << "Instructions: " << statistics.OriginalCount << " -> " << statistics.ResultCount;
+		for (std::size_t i = 0; i < static_cast<std::size_t>(PeepholePass::Count); ++i) {
+			stream << "\n    " << PeepholePassNames[i] << ": " << statistics.Removed[i] << " removed, "
+				   << statistics.Rewritten[i] << " rewritten";
+		}
+		return stream;
+	}
+}
+
+namespace svm {
+	PeepholeOptimizer::PeepholeOptimizer(const PeepholeOptions& options) noexcept
+		: m_Options(options) {}
+
+	void PeepholeOptimizer::Optimize(Instructions& instructions) {
+		m_Statistics.OriginalCount += instructions.GetInstructionCount();
+
+		bool isChanged = false;
+		for (unsigned int i = 0; i < m_Options.MaxIterations; ++i) {
+			bool isChangedNow = false;
+			for (std::size_t j = 0; j < static_cast<std::size_t>(PeepholePass::Count); ++j) {
+				const auto pass = static_cast<PeepholePass>(j);
+				if (IsEnabled(pass) && Run(instructions, pass)) {
+					isChangedNow = true;
+				}
+			}
+
+			if (!isChangedNow) break;
+			isChanged = true;
+		}
+
+		if (isChanged) {
+			instructions.UpdateOffsets();
+		}
+		m_Statistics.ResultCount += instructions.GetInstructionCount();
+	}
+	void PeepholeOptimizer::Optimize(Functions& functions) {
+		for (FunctionInfo& function : functions) {
+			Optimize(function.Instructions);
+		}
+	}
+
+	const PeepholeOptions& PeepholeOptimizer::GetOptions() const noexcept {
+		return m_Options;
+	}
+	void PeepholeOptimizer::SetOptions(const PeepholeOptions& newOptions) noexcept {
+		m_Options = newOptions;
+	}
+	const PeepholeStatistics& PeepholeOptimizer::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	void PeepholeOptimizer::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+
+	bool PeepholeOptimizer::IsEnabled(PeepholePass pass) const noexcept {
+		switch (pass) {
+		case PeepholePass::Nop: return m_Options.Nop;
+		case PeepholePass::PushPop: return m_Options.PushPop;
+		case PeepholePass::CopyPop: return m_Options.CopyPop;
+		case PeepholePass::StoreLoad: return m_Options.StoreLoad;
+		case PeepholePass::DoubleNegation: return m_Options.DoubleNegation;
+		case PeepholePass::JumpToNext: return m_Options.JumpToNext;
+		default: return false;
+		}
+	}
+	bool PeepholeOptimizer::Run(Instructions& instructions, PeepholePass pass) {
+		const auto instCount = static_cast<std::size_t>(instructions.GetInstructionCount());
+		const std::vector<bool> isTarget = instructions.GetLabelTargets();
+
+		ArenaVector<Instruction> result;
+		std::vector<std::uint64_t> indexMap(instCount + 1);
+		std::uint64_t& removed = m_Statistics.Removed[static_cast<std::size_t>(pass)];
+		std::uint64_t& rewritten = m_Statistics.Rewritten[static_cast<std::size_t>(pass)];
+		bool isChanged = false;
+		result.reserve(instCount);
+
+		for (std::size_t i = 0; i < instCount;) {
+			// Only the first instruction of a window may be a jump target.
+			Instruction window[2] = { instructions.GetInstruction(i) };
+			std::size_t count = 1;
+			if (i + 1 < instCount && !isTarget[i + 1]) {
+				window[count++] = instructions.GetInstruction(i + 1);
+			}
+
+			const Rewrite rewrite = Match(pass, instructions, i, window, count);
+			if (rewrite.Consumed == 0) {
+				indexMap[i++] = result.size();
+				result.push_back(window[0]);
+				continue;
+			}
+
+			for (std::size_t j = 0; j < rewrite.Consumed; ++j) {
+				indexMap[i + j] = result.size();
+			}
+			result.insert(result.end(), rewrite.Result, rewrite.Result + rewrite.Emitted);
+
+			removed += rewrite.Consumed - rewrite.Emitted;
+			if (rewrite.Emitted) {
+				++rewritten;
+			}
+			isChanged = true;
+			i += rewrite.Consumed;
+		}
+		indexMap[instCount] = result.size();
+
+		if (isChanged) {
+			instructions.SetInstructions(std::move(result), indexMap);
+		}
+		return isChanged;
+	}
+}
@@ -0,0 +1,25 @@
+#include <svm/StringPool.hpp>
+
+#include <cstring>
+
+namespace svm {
+	StringPool::StringPool(std::pmr::memory_resource* upstream)
+		: m_Arena(upstream) {}
+
+	void StringPool::Clear() noexcept {
+		m_Strings.clear();
+		m_Arena.release();
+	}
+
+	std::string_view StringPool::Intern(std::string_view string) {
+		if (const auto iter = m_Strings.find(string); iter != m_Strings.end()) return *iter;
+		else if (string.empty()) return *m_Strings.emplace().first;
+
+		const auto data = static_cast<char*>(m_Arena.allocate(string.size(), 1));
+		std::memcpy(data, string.data(), string.size());
+		return *m_Strings.emplace(data, string.size()).first;
+	}
+	std::size_t StringPool::GetCount() const noexcept {
+		return m_Strings.size();
+	}
+}
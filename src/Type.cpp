@@ -5,15 +5,15 @@
 #include <utility>
 
 namespace svm {
-	TypeInfo::TypeInfo(std::string name, TypeCode code) noexcept
-		: Name(std::move(name)), Code(code) {}
-	TypeInfo::TypeInfo(std::string name, TypeCode code, std::size_t size) noexcept
-		: Name(std::move(name)), Code(code), Size(size) {}
+	TypeInfo::TypeInfo(std::string_view name, TypeCode code) noexcept
+		: Name(name), Code(code) {}
+	TypeInfo::TypeInfo(std::string_view name, TypeCode code, std::size_t size) noexcept
+		: Name(name), Code(code), Size(size) {}
 	TypeInfo::TypeInfo(TypeInfo&& typeInfo) noexcept
-		: Name(std::move(typeInfo.Name)), Module(typeInfo.Module), Code(typeInfo.Code), Size(typeInfo.Size) {}
+		: Name(typeInfo.Name), Module(typeInfo.Module), Code(typeInfo.Code), Size(typeInfo.Size) {}
 
 	TypeInfo& TypeInfo::operator=(TypeInfo&& typeInfo) noexcept {
-		Name = std::move(typeInfo.Name);
+		Name = typeInfo.Name;
 		Module = typeInfo.Module;
 		Code = typeInfo.Code;
 		Size = typeInfo.Size;
@@ -15,10 +15,11 @@ namespace svm::core {
 		m_Entrypoint(std::move(byteFile.m_Entrypoint)) {}
 
 	ByteFile& ByteFile::operator=(ByteFile&& byteFile) noexcept {
-		ModuleBase<Functions>::operator=(std::move(byteFile));
-
+		// The old members may live in the old arena, which ModuleBase::operator= replaces last.
 		m_ConstantPool = std::move(byteFile.m_ConstantPool);
 		m_Entrypoint = std::move(byteFile.m_Entrypoint);
+
+		ModuleBase<Functions>::operator=(std::move(byteFile));
 		return *this;
 	}
 
@@ -30,6 +31,7 @@ namespace svm::core {
 		GetFunctions().clear();
 		GetMappings().Clear();
 		GetEntrypoint().Clear();
+		ClearArena();
 	}
 
 	const ConstantPool& ByteFile::GetConstantPool() const noexcept {
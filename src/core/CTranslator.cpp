@@ -0,0 +1,850 @@
+#include <svm/core/CTranslator.hpp>
+
+#include <svm/IO.hpp>
+#include <svm/Predefined.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifndef SVM_WINDOWS
+#	include <dlfcn.h>
+#endif
+
+namespace svm::core {
+	static_assert(sizeof(CValue) == sizeof(IntObject) && sizeof(CValue) == sizeof(LongObject) &&
+		sizeof(CValue) == sizeof(DoubleObject) && sizeof(CValue) == sizeof(PointerObject));
+	static_assert(sizeof(ArrayObject) == sizeof(void*) + sizeof(std::size_t));
+
+	std::ostream& operator<<(std::ostream& stream, const CTranslationStatistics& statistics) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+		const std::string indent = defIndent + indentOnce;
+
+		stream << defIndent << "CTranslationStatistics:\n"
+			<< indent << "Functions: " << statistics.Functions << '\n'
+			<< indent << "Rejected: " << statistics.Rejected << '\n'
+			<< indent << "Instructions: " << statistics.Instructions;
+		return stream;
+	}
+}
+
+namespace svm::core {
+	namespace {
+		// The emitted code names the type handles it compares against after their codes, and fails by returning from
+		// the function that expands the macros. Values never hold aggregates, so copying a value copies it whole.
+		constexpr const char* Prelude = R"c(#ifndef SVM_C_PRELUDE
+#define SVM_C_PRELUDE
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct svm_value {
+	const void* type;
+	union {
+		uint32_t i;
+		uint64_t l;
+		float s;
+		double d;
+		void* p;
+	} v;
+} svm_value;
+
+typedef struct svm_array {
+	const void* type;
+	size_t count;
+} svm_array;
+
+typedef struct svm_runtime svm_runtime;
+struct svm_runtime {
+	const void* const* types;
+	int (*call)(svm_runtime* rt, uint32_t function, svm_value* arguments, svm_value* result);
+	void* (*new_object)(svm_runtime* rt, uint32_t type, int is_gc);
+	void* (*new_array)(svm_runtime* rt, uint32_t element_type, uint64_t count, int is_gc);
+	int (*delete_object)(svm_runtime* rt, void* object);
+	const char* error;
+	void* context;
+};
+
+typedef int (*svm_function)(svm_runtime* rt, svm_value* arguments, svm_value* result);
+
+enum { SVM_OK, SVM_ERROR, SVM_UNSUPPORTED };
+
+static inline int svm_fail(svm_runtime* rt, const char* reason) {
+	rt->error = reason;
+	return SVM_ERROR;
+}
+static inline float svm_single(uint32_t bits) {
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+static inline double svm_double(uint64_t bits) {
+	double result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+/* Integers are written through the whole union where that keeps its low half, so the compiler can hold a value
+   in one register instead of merging partial writes through memory. */
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_ARM64)
+#	define SVM_SET_INT(x, value) ((x).v.l = (uint32_t)(value))
+#else
+#	define SVM_SET_INT(x, value) ((x).v.i = (uint32_t)(value))
+#endif
+#define SVM_SET_LONG(x, value) ((x).v.l = (uint64_t)(value))
+#define SVM_SET_SINGLE(x, value) ((x).v.s = (float)(value))
+#define SVM_SET_DOUBLE(x, value) ((x).v.d = (double)(value))
+
+#define SVM_TYPES \
+	const void* const ti = rt->types[3]; const void* const tl = rt->types[4]; \
+	const void* const ts = rt->types[5]; const void* const td = rt->types[6]; \
+	const void* const tp = rt->types[7]; const void* const tg = rt->types[8]; \
+	const void* const ta = rt->types[9]; \
+	(void)ti; (void)tl; (void)ts; (void)td; (void)tp; (void)tg; (void)ta
+
+#define SVM_FAIL(reason) return svm_fail(rt, reason)
+#define SVM_IS_VALUE(x) (!(x).type || (x).type == ti || (x).type == tl || (x).type == ts || (x).type == td || \
+	(x).type == tp || (x).type == tg)
+#define SVM_ORDER(a, b) ((a) < (b) ? UINT32_MAX : ((b) < (a) ? 1u : 0u))
+#define SVM_SAME(lhs, rhs) if ((lhs).type != (rhs).type) SVM_FAIL("The types of the operands do not match.")
+#define SVM_COUNT(x, out) \
+	if ((x).type == ti) out = (x).v.i; \
+	else if ((x).type == tl) out = (x).v.l; \
+	else SVM_FAIL("The count is not an integer.")
+
+#define SVM_ARITH(lhs, rhs, op) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) SVM_SET_INT(lhs, (lhs).v.i op (rhs).v.i); \
+	else if ((lhs).type == tl) (lhs).v.l = (lhs).v.l op (rhs).v.l; \
+	else if ((lhs).type == ts) (lhs).v.s = (lhs).v.s op (rhs).v.s; \
+	else if ((lhs).type == td) (lhs).v.d = (lhs).v.d op (rhs).v.d; \
+	else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+#define SVM_INTEGER(lhs, rhs, op) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) SVM_SET_INT(lhs, (lhs).v.i op (rhs).v.i); \
+	else if ((lhs).type == tl) (lhs).v.l = (lhs).v.l op (rhs).v.l; \
+	else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+#define SVM_SHIFT(lhs, rhs, op) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) SVM_SET_INT(lhs, (lhs).v.i op ((rhs).v.i & 31u)); \
+	else if ((lhs).type == tl) (lhs).v.l = (lhs).v.l op ((rhs).v.l & 63u); \
+	else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+#define SVM_SAR(lhs, rhs) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) SVM_SET_INT(lhs, (int32_t)(lhs).v.i >> ((rhs).v.i & 31u)); \
+	else if ((lhs).type == tl) (lhs).v.l = (uint64_t)((int64_t)(lhs).v.l >> ((rhs).v.l & 63u)); \
+	else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+
+#define SVM_DIV(lhs, rhs) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) { \
+		if (!(rhs).v.i) SVM_FAIL("The divisor is zero."); \
+		(lhs).v.i /= (rhs).v.i; \
+	} else if ((lhs).type == tl) { \
+		if (!(rhs).v.l) SVM_FAIL("The divisor is zero."); \
+		(lhs).v.l /= (rhs).v.l; \
+	} else if ((lhs).type == ts) (lhs).v.s /= (rhs).v.s; \
+	else if ((lhs).type == td) (lhs).v.d /= (rhs).v.d; \
+	else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+#define SVM_MOD(lhs, rhs) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) { \
+		if (!(rhs).v.i) SVM_FAIL("The divisor is zero."); \
+		(lhs).v.i %= (rhs).v.i; \
+	} else if ((lhs).type == tl) { \
+		if (!(rhs).v.l) SVM_FAIL("The divisor is zero."); \
+		(lhs).v.l %= (rhs).v.l; \
+	} else if ((lhs).type == ts) (lhs).v.s = fmodf((lhs).v.s, (rhs).v.s); \
+	else if ((lhs).type == td) (lhs).v.d = fmod((lhs).v.d, (rhs).v.d); \
+	else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+#define SVM_IDIV(lhs, rhs) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) { \
+		if (!(rhs).v.i) SVM_FAIL("The divisor is zero."); \
+		SVM_SET_INT(lhs, (rhs).v.i == UINT32_MAX ? 0u - (lhs).v.i : (uint32_t)((int32_t)(lhs).v.i / (int32_t)(rhs).v.i)); \
+	} else if ((lhs).type == tl) { \
+		if (!(rhs).v.l) SVM_FAIL("The divisor is zero."); \
+		(lhs).v.l = (rhs).v.l == UINT64_MAX ? 0u - (lhs).v.l : (uint64_t)((int64_t)(lhs).v.l / (int64_t)(rhs).v.l); \
+	} else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+#define SVM_IMOD(lhs, rhs) do { \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) { \
+		if (!(rhs).v.i) SVM_FAIL("The divisor is zero."); \
+		SVM_SET_INT(lhs, (rhs).v.i == UINT32_MAX ? 0u : (uint32_t)((int32_t)(lhs).v.i % (int32_t)(rhs).v.i)); \
+	} else if ((lhs).type == tl) { \
+		if (!(rhs).v.l) SVM_FAIL("The divisor is zero."); \
+		(lhs).v.l = (rhs).v.l == UINT64_MAX ? 0u : (uint64_t)((int64_t)(lhs).v.l % (int64_t)(rhs).v.l); \
+	} else SVM_FAIL("The types of the operands are not supported."); \
+} while (0)
+
+#define SVM_NEG(x) do { \
+	if ((x).type == ti) SVM_SET_INT(x, 0u - (x).v.i); \
+	else if ((x).type == tl) (x).v.l = 0u - (x).v.l; \
+	else if ((x).type == ts) (x).v.s = -(x).v.s; \
+	else if ((x).type == td) (x).v.d = -(x).v.d; \
+	else SVM_FAIL("The type of the operand is not supported."); \
+} while (0)
+#define SVM_STEP(x, op) do { \
+	if ((x).type == ti) SVM_SET_INT(x, (x).v.i op 1u); \
+	else if ((x).type == tl) (x).v.l = (x).v.l op 1u; \
+	else if ((x).type == ts) (x).v.s = (x).v.s op 1; \
+	else if ((x).type == td) (x).v.d = (x).v.d op 1; \
+	else SVM_FAIL("The type of the operand is not supported."); \
+} while (0)
+#define SVM_NOT(x) do { \
+	if ((x).type == ti) SVM_SET_INT(x, ~(x).v.i); \
+	else if ((x).type == tl) (x).v.l = ~(x).v.l; \
+	else SVM_FAIL("The type of the operand is not supported."); \
+} while (0)
+
+#define SVM_CMP(lhs, rhs) do { \
+	uint32_t svm_order_; \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) svm_order_ = SVM_ORDER((lhs).v.i, (rhs).v.i); \
+	else if ((lhs).type == tl) svm_order_ = SVM_ORDER((lhs).v.l, (rhs).v.l); \
+	else if ((lhs).type == ts) svm_order_ = SVM_ORDER((lhs).v.s, (rhs).v.s); \
+	else if ((lhs).type == td) svm_order_ = SVM_ORDER((lhs).v.d, (rhs).v.d); \
+	else if ((lhs).type == tp || (lhs).type == tg) svm_order_ = SVM_ORDER((uintptr_t)(lhs).v.p, (uintptr_t)(rhs).v.p); \
+	else SVM_FAIL("The types of the operands are not supported."); \
+	(lhs).type = ti; \
+	SVM_SET_INT(lhs, svm_order_); \
+} while (0)
+#define SVM_ICMP(lhs, rhs) do { \
+	uint32_t svm_order_; \
+	SVM_SAME(lhs, rhs); \
+	if ((lhs).type == ti) svm_order_ = SVM_ORDER((int32_t)(lhs).v.i, (int32_t)(rhs).v.i); \
+	else if ((lhs).type == tl) svm_order_ = SVM_ORDER((int64_t)(lhs).v.l, (int64_t)(rhs).v.l); \
+	else SVM_FAIL("The types of the operands are not supported."); \
+	(lhs).type = ti; \
+	SVM_SET_INT(lhs, svm_order_); \
+} while (0)
+
+#define SVM_CONVERT(x, set, T, target) do { \
+	const svm_value svm_x_ = (x); \
+	if (svm_x_.type == ti) set(x, (T)svm_x_.v.i); \
+	else if (svm_x_.type == tl) set(x, (T)svm_x_.v.l); \
+	else if (svm_x_.type == ts) set(x, (T)svm_x_.v.s); \
+	else if (svm_x_.type == td) set(x, (T)svm_x_.v.d); \
+	else if (svm_x_.type == tp || svm_x_.type == tg) set(x, (T)(uintptr_t)svm_x_.v.p); \
+	else SVM_FAIL("The type of the operand is not supported."); \
+	(x).type = target; \
+} while (0)
+#define SVM_TOP(x) do { \
+	const svm_value svm_x_ = (x); \
+	if (svm_x_.type == ti) (x).v.p = (void*)(uintptr_t)svm_x_.v.i; \
+	else if (svm_x_.type == tl) (x).v.p = (void*)(uintptr_t)svm_x_.v.l; \
+	else if (svm_x_.type == ts) (x).v.p = (void*)(uintptr_t)svm_x_.v.s; \
+	else if (svm_x_.type == td) (x).v.p = (void*)(uintptr_t)svm_x_.v.d; \
+	else if (svm_x_.type != tp && svm_x_.type != tg) SVM_FAIL("The type of the operand is not supported."); \
+	(x).type = tp; \
+} while (0)
+
+#define SVM_TLOAD(x) do { \
+	const svm_value* const svm_object_ = (const svm_value*)(x).v.p; \
+	if (!svm_object_) SVM_FAIL("The pointer is null."); \
+	if (svm_object_->type == ti) SVM_SET_INT(x, svm_object_->v.i); \
+	else if (svm_object_->type == tl) (x).v.l = svm_object_->v.l; \
+	else if (svm_object_->type == ts) (x).v.s = svm_object_->v.s; \
+	else if (svm_object_->type == td) (x).v.d = svm_object_->v.d; \
+	else if (svm_object_->type == tp || svm_object_->type == tg) (x).v.p = svm_object_->v.p; \
+	else SVM_FAIL("The type of the object is not supported."); \
+	(x).type = svm_object_->type; \
+} while (0)
+#define SVM_TSTORE(x, value) do { \
+	svm_value* const svm_object_ = (svm_value*)(x).v.p; \
+	if (!svm_object_) SVM_FAIL("The pointer is null."); \
+	if (svm_object_->type != (value).type) SVM_FAIL("The type of the value does not match the object."); \
+	if ((value).type == ti) svm_object_->v.i = (value).v.i; \
+	else if ((value).type == tl) svm_object_->v.l = (value).v.l; \
+	else if ((value).type == ts) svm_object_->v.s = (value).v.s; \
+	else if ((value).type == td) svm_object_->v.d = (value).v.d; \
+	else if ((value).type == tp || (value).type == tg) svm_object_->v.p = (value).v.p; \
+	else SVM_FAIL("The type of the object is not supported."); \
+} while (0)
+#define SVM_ARRAY(array) \
+	if (!(array)) SVM_FAIL("The pointer is null."); \
+	if ((array)->type != ta) SVM_FAIL("The operand is not an array.")
+#define SVM_ALEA(x, index, size_of) do { \
+	uint64_t svm_index_; \
+	const svm_array* const svm_array_ = (const svm_array*)(x).v.p; \
+	size_t svm_size_; \
+	SVM_COUNT(index, svm_index_); \
+	SVM_ARRAY(svm_array_); \
+	if (svm_index_ >= svm_array_->count) SVM_FAIL("The index is out of range."); \
+	svm_size_ = size_of(rt, ((const svm_value*)(svm_array_ + 1))->type); \
+	if (!svm_size_) SVM_FAIL("The type of the element is not supported."); \
+	(x).type = tp; \
+	(x).v.p = (unsigned char*)(svm_array_ + 1) + svm_size_ * svm_index_; \
+} while (0)
+#define SVM_NEW(x, code, target) do { \
+	void* const svm_object_ = rt->new_object(rt, code, (target) == tg); \
+	if (!svm_object_) return SVM_ERROR; \
+	(x).type = target; \
+	(x).v.p = svm_object_; \
+} while (0)
+#define SVM_ANEW(x, code, target) do { \
+	uint64_t svm_count_; \
+	void* svm_object_; \
+	SVM_COUNT(x, svm_count_); \
+	svm_object_ = rt->new_array(rt, code, svm_count_, (target) == tg); \
+	if (!svm_object_) return SVM_ERROR; \
+	(x).type = target; \
+	(x).v.p = svm_object_; \
+} while (0)
+#define SVM_DELETE(x) do { \
+	if (rt->delete_object(rt, (x).v.p) != SVM_OK) return SVM_ERROR; \
+} while (0)
+
+#endif
+)c";
+
+		std::string Slot(char kind, std::uint64_t index) {
+			return kind + ('[' + std::to_string(index) + ']');
+		}
+		std::string Hex(std::uint64_t value) {
+			static constexpr char digits[] = "0123456789abcdef";
+			std::string result;
+			do {
+				result.insert(result.begin(), digits[value & 0xF]);
+				value >>= 4;
+			} while (value);
+			return "0x" + result;
+		}
+		std::string Quote(std::string_view string) {
+			// Octal escapes have a fixed width, so the next character cannot be taken into them.
+			std::string result = "\"";
+			for (const char c : string) {
+				const auto u = static_cast<unsigned char>(c);
+				if (u >= 0x20 && u < 0x7F && c != '"' && c != '\\' && c != '?') {
+					result += c;
+				} else {
+					result += '\\';
+					result += static_cast<char>('0' + ((u >> 6) & 7));
+					result += static_cast<char>('0' + ((u >> 3) & 7));
+					result += static_cast<char>('0' + (u & 7));
+				}
+			}
+			return result + '"';
+		}
+		bool IsIdentifier(std::string_view string) noexcept {
+			if (string.empty() || std::isdigit(static_cast<unsigned char>(string.front()))) return false;
+
+			return std::all_of(string.begin(), string.end(), [](char c) {
+				return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+			});
+		}
+	}
+}
+
+namespace svm::core {
+	struct CTranslator::Analysis final {
+		ControlFlowGraph Graph;
+		std::vector<std::uint32_t> Depths;
+		std::vector<bool> IsTarget;
+		std::uint32_t LocalCount = 0;
+		std::uint32_t MaxDepth = 0;
+	};
+}
+
+namespace svm::core {
+	CTranslator::CTranslator(const ByteFile& byteFile) noexcept
+		: m_ByteFile(byteFile) {}
+	CTranslator::CTranslator(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions,
+		std::vector<const StructureInfo*> mappedStructures) noexcept
+		: m_ByteFile(byteFile), m_MappedFunctions(std::move(mappedFunctions)), m_MappedStructures(std::move(mappedStructures)) {}
+
+	void CTranslator::Translate(std::ostream& stream) {
+		const Functions& functions = m_ByteFile.GetFunctions();
+		const auto funcCount = static_cast<std::uint32_t>(functions.size());
+
+		// Calls between translated functions are direct, so every function is analyzed before any is written.
+		std::vector<Analysis> analyses(funcCount);
+		std::vector<bool> isTranslated(funcCount);
+		for (std::uint32_t i = 0; i < funcCount; ++i) {
+			isTranslated[i] = Analyze(functions[i], analyses[i]);
+			if (isTranslated[i]) {
+				++m_Statistics.Functions;
+				m_Statistics.Instructions += functions[i].Instructions.GetInstructionCount();
+			} else {
+				++m_Statistics.Rejected;
+			}
+		}
+
+		stream << Prelude << '\n';
+		WritePrelude(stream);
+
+		for (std::uint32_t i = 0; i < funcCount; ++i) {
+			if (isTranslated[i]) {
+				stream << "static int " << m_Prefix << "_f" << i << "(svm_runtime* rt, svm_value* args, svm_value* result);\n";
+			}
+		}
+		for (std::uint32_t i = 0; i < funcCount; ++i) {
+			if (isTranslated[i]) {
+				stream << '\n';
+				WriteFunction(stream, i, analyses[i], isTranslated);
+			}
+		}
+
+		const std::uint32_t tableSize = std::max<std::uint32_t>(funcCount, 1);
+		stream << "\nconst uint32_t " << m_Prefix << "_function_count = " << funcCount << "u;\n";
+		stream << "const svm_function " << m_Prefix << "_functions[" << tableSize << "] = {\n";
+		for (std::uint32_t i = 0; i < tableSize; ++i) {
+			stream << '\t';
+			if (i < funcCount && isTranslated[i]) {
+				stream << m_Prefix << "_f" << i;
+			} else {
+				stream << "NULL";
+			}
+			stream << ",\n";
+		}
+		stream << "};\n";
+		stream << "const char* const " << m_Prefix << "_names[" << tableSize << "] = {\n";
+		for (std::uint32_t i = 0; i < tableSize; ++i) {
+			stream << '\t' << (i < funcCount ? Quote(functions[i].Name) : "NULL") << ",\n";
+		}
+		stream << "};\n";
+	}
+
+	std::string_view CTranslator::GetPrefix() const noexcept {
+		return m_Prefix;
+	}
+	void CTranslator::SetPrefix(std::string newPrefix) {
+		if (!IsIdentifier(newPrefix)) throw std::runtime_error("Failed to set the prefix. Invalid identifier.");
+
+		m_Prefix = std::move(newPrefix);
+	}
+	const CTranslationStatistics& CTranslator::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	void CTranslator::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+
+	bool CTranslator::Analyze(const FunctionInfo& function, Analysis& result) const {
+		// The stack depth must be the same on every path, which only verified functions guarantee.
+		if (function.Verification == VerificationLevel::Unverified) return false;
+
+		const Instructions& instructions = function.Instructions;
+		const ConstantPool& constantPool = m_ByteFile.GetConstantPool();
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			if (instructions.GetLabel(i) >= instCount) return false;
+		}
+
+		result.IsTarget.assign(static_cast<std::size_t>(instCount), false);
+		result.LocalCount = function.Arity;
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			switch (inst.OpCode) {
+			case OpCode::Push:
+				// Structures on the stack would need storage owned by the frame.
+				if (inst.Operand >= constantPool.GetAllCount()) return false;
+				break;
+
+			case OpCode::Load:
+			case OpCode::Store:
+			case OpCode::Lea:
+				result.LocalCount = std::max(result.LocalCount, inst.Operand + 1);
+				break;
+
+			case OpCode::ToB:
+			case OpCode::ToSh:
+			case OpCode::APush:
+				return false;
+
+			default:
+				if (inst.OpCode >= OpCode::Count) return false;
+				if (IsJump(inst.OpCode)) {
+					if (inst.Operand >= labelCount) return false;
+					result.IsTarget[static_cast<std::size_t>(instructions.GetLabel(inst.Operand))] = true;
+				}
+				break;
+			}
+		}
+
+		result.Graph.Build(instructions);
+		return GetStackDepths(instructions, result.Graph, result);
+	}
+	bool CTranslator::GetStackDepths(const Instructions& instructions, const ControlFlowGraph& graph, Analysis& result) const {
+		constexpr std::uint32_t unvisited = std::numeric_limits<std::uint32_t>::max();
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		result.Depths.assign(blockCount, unvisited);
+		result.MaxDepth = 0;
+		if (blockCount == 0) return true;
+
+		std::vector<std::uint32_t> worklist{ 0 };
+		result.Depths[0] = 0;
+		while (!worklist.empty()) {
+			const std::uint32_t block = worklist.back();
+			worklist.pop_back();
+
+			std::uint32_t depth = result.Depths[block];
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				std::uint32_t popCount = 0, pushCount = 0;
+				if (inst.OpCode == OpCode::Call) {
+					FunctionSignature signature;
+					if (!GetSignature(inst.Operand, signature)) return false;
+
+					popCount = signature.Arity;
+					pushCount = signature.HasResult;
+				} else if (!GetStackEffect(inst.OpCode, popCount, pushCount)) return false;
+
+				if (depth < popCount) return false;
+				depth = depth - popCount + pushCount;
+				result.MaxDepth = std::max(result.MaxDepth, depth);
+			}
+
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				if (result.Depths[successor] == unvisited) {
+					result.Depths[successor] = depth;
+					worklist.push_back(successor);
+				} else if (result.Depths[successor] != depth) return false;
+			}
+		}
+		return true;
+	}
+	void CTranslator::WritePrelude(std::ostream& stream) const {
+		// Element sizes of arrays are looked up by the handle in the header of the first element.
+		const Structures& structures = m_ByteFile.GetStructures();
+		const auto typeCount = static_cast<std::uint32_t>(TypeCode::Structure) +
+			static_cast<std::uint32_t>(structures.size() + m_MappedStructures.size());
+
+		stream << "static inline size_t " << m_Prefix << "_size_of(const svm_runtime* rt, const void* type) {\n"
+			<< "\tstatic const size_t sizes[" << typeCount << "] = {";
+		for (std::uint32_t code = 0; code < typeCount; ++code) {
+			std::size_t size = 0;
+			if (code < static_cast<std::uint32_t>(TypeCode::Structure)) {
+				if (const Type type = GetFundamentalType(static_cast<TypeCode>(code)); type != NoneType && type != ArrayType) {
+					size = type->Size;
+				}
+			} else {
+				size = GetStructure(code - static_cast<std::uint32_t>(TypeCode::Structure))->Type.Size;
+			}
+			stream << (code % 10 ? " " : "\n\t\t") << size << "u,";
+		}
+		stream << "\n\t};\n"
+			<< "\tuint32_t code;\n"
+			<< "\tfor (code = 0; code < " << typeCount << "u; ++code) {\n"
+			<< "\t\tif (sizes[code] && rt->types[code] == type) return sizes[code];\n"
+			<< "\t}\n"
+			<< "\treturn 0;\n"
+			<< "}\n\n";
+	}
+	void CTranslator::WriteFunction(std::ostream& stream, std::uint32_t index, const Analysis& analysis, const std::vector<bool>& isTranslated) const {
+		const FunctionInfo& function = m_ByteFile.GetFunctions()[index];
+		const Instructions& instructions = function.Instructions;
+
+		stream << "static int " << m_Prefix << "_f" << index << "(svm_runtime* rt, svm_value* args, svm_value* result) {\n"
+			<< "\tSVM_TYPES;\n";
+		if (analysis.LocalCount) {
+			stream << "\tsvm_value l[" << analysis.LocalCount << "];\n";
+		}
+		if (analysis.MaxDepth) {
+			stream << "\tsvm_value s[" << analysis.MaxDepth << "];\n";
+		}
+		stream << "\t(void)args;\n\t(void)result;\n";
+
+		// Nothing has happened yet when an argument turns out to be an aggregate.
+		for (std::uint16_t i = 0; i < function.Arity; ++i) {
+			stream << "\tif (!SVM_IS_VALUE(args[" << i << "])) return SVM_UNSUPPORTED;\n";
+		}
+		for (std::uint32_t i = 0; i < analysis.LocalCount; ++i) {
+			if (i < function.Arity) {
+				stream << "\tl[" << i << "] = args[" << i << "];\n";
+			} else {
+				stream << "\tl[" << i << "].type = NULL;\n\tl[" << i << "].v.l = 0;\n";
+			}
+		}
+
+		const ControlFlowGraph& graph = analysis.Graph;
+		for (std::uint32_t block = 0; block < graph.GetBlockCount(); ++block) {
+			if (!graph.IsReachable(block)) continue;
+
+			std::uint32_t depth = analysis.Depths[block];
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (analysis.IsTarget[static_cast<std::size_t>(i)]) {
+					stream << "I" << i << ":;\n";
+				}
+
+				WriteInstruction(stream, inst, instructions, depth, function.HasResult, isTranslated);
+
+				std::uint32_t popCount = 0, pushCount = 0;
+				if (inst.OpCode == OpCode::Call) {
+					FunctionSignature signature;
+					GetSignature(inst.Operand, signature);
+					popCount = signature.Arity;
+					pushCount = signature.HasResult;
+				} else {
+					GetStackEffect(inst.OpCode, popCount, pushCount);
+				}
+				depth = depth - popCount + pushCount;
+			}
+		}
+		stream << "\treturn svm_fail(rt, \"The function does not return.\");\n}\n";
+	}
+	void CTranslator::WriteInstruction(std::ostream& stream, const Instruction& instruction, const Instructions& instructions,
+		std::uint32_t depth, bool hasResult, const std::vector<bool>& isTranslated) const {
+		const ConstantPool& constantPool = m_ByteFile.GetConstantPool();
+		const std::string top = depth ? Slot('s', depth - 1) : std::string();
+		const std::string second = depth > 1 ? Slot('s', depth - 2) : std::string();
+		const std::string next = Slot('s', depth);
+		const std::uint32_t operand = instruction.Operand;
+
+		stream << '\t';
+		switch (instruction.OpCode) {
+		case OpCode::Nop:
+		case OpCode::Pop:
+			stream << ";\n";
+			return;
+
+		case OpCode::Push:
+			switch (constantPool.GetConstantType(operand)->Code) {
+			case TypeCode::Int:
+				stream << next << ".type = ti; SVM_SET_INT(" << next << ", "
+					<< constantPool.GetConstant<IntObject>(operand).Value << "u);\n";
+				return;
+			case TypeCode::Long:
+				stream << next << ".type = tl; " << next << ".v.l = UINT64_C("
+					<< constantPool.GetConstant<LongObject>(operand).Value << ");\n";
+				return;
+			case TypeCode::Single: {
+				std::uint32_t bits;
+				const float value = constantPool.GetConstant<SingleObject>(operand).Value;
+				std::memcpy(&bits, &value, sizeof(bits));
+				stream << next << ".type = ts; " << next << ".v.s = svm_single(" << Hex(bits) << "u);\n";
+				return;
+			}
+			default: {
+				std::uint64_t bits;
+				const double value = constantPool.GetConstant<DoubleObject>(operand).Value;
+				std::memcpy(&bits, &value, sizeof(bits));
+				stream << next << ".type = td; " << next << ".v.d = svm_double(UINT64_C(" << Hex(bits) << "));\n";
+				return;
+			}
+			}
+
+		case OpCode::Load: stream << next << " = " << Slot('l', operand) << ";\n"; return;
+		case OpCode::Store: stream << Slot('l', operand) << " = " << top << ";\n"; return;
+		case OpCode::Lea: stream << next << ".type = tp; " << next << ".v.p = &" << Slot('l', operand) << ";\n"; return;
+		case OpCode::FLea: WriteFieldAddress(stream, top, operand); return;
+		case OpCode::TLoad: stream << "SVM_TLOAD(" << top << ");\n"; return;
+		case OpCode::TStore: stream << "SVM_TSTORE(" << top << ", " << second << ");\n"; return;
+		case OpCode::Copy: stream << next << " = " << top << ";\n"; return;
+		case OpCode::Swap: stream << "{ const svm_value t = " << top << "; " << top << " = " << second << "; " << second << " = t; }\n"; return;
+
+		case OpCode::Add: stream << "SVM_ARITH(" << second << ", " << top << ", +);\n"; return;
+		case OpCode::Sub: stream << "SVM_ARITH(" << second << ", " << top << ", -);\n"; return;
+		case OpCode::Mul: stream << "SVM_ARITH(" << second << ", " << top << ", *);\n"; return;
+		case OpCode::IMul: stream << "SVM_INTEGER(" << second << ", " << top << ", *);\n"; return;
+		case OpCode::Div: stream << "SVM_DIV(" << second << ", " << top << ");\n"; return;
+		case OpCode::IDiv: stream << "SVM_IDIV(" << second << ", " << top << ");\n"; return;
+		case OpCode::Mod: stream << "SVM_MOD(" << second << ", " << top << ");\n"; return;
+		case OpCode::IMod: stream << "SVM_IMOD(" << second << ", " << top << ");\n"; return;
+		case OpCode::Neg: stream << "SVM_NEG(" << top << ");\n"; return;
+		case OpCode::Inc: stream << "SVM_STEP(" << top << ", +);\n"; return;
+		case OpCode::Dec: stream << "SVM_STEP(" << top << ", -);\n"; return;
+
+		case OpCode::And: stream << "SVM_INTEGER(" << second << ", " << top << ", &);\n"; return;
+		case OpCode::Or: stream << "SVM_INTEGER(" << second << ", " << top << ", |);\n"; return;
+		case OpCode::Xor: stream << "SVM_INTEGER(" << second << ", " << top << ", ^);\n"; return;
+		case OpCode::Not: stream << "SVM_NOT(" << top << ");\n"; return;
+		case OpCode::Shl:
+		case OpCode::Sal: stream << "SVM_SHIFT(" << second << ", " << top << ", <<);\n"; return;
+		case OpCode::Shr: stream << "SVM_SHIFT(" << second << ", " << top << ", >>);\n"; return;
+		case OpCode::Sar: stream << "SVM_SAR(" << second << ", " << top << ");\n"; return;
+
+		case OpCode::Cmp: stream << "SVM_CMP(" << second << ", " << top << ");\n"; return;
+		case OpCode::ICmp: stream << "SVM_ICMP(" << second << ", " << top << ");\n"; return;
+		case OpCode::Jmp: stream << "goto I" << instructions.GetLabel(operand) << ";\n"; return;
+		case OpCode::Je: stream << "if ((int32_t)" << top << ".v.i == 0) goto I" << instructions.GetLabel(operand) << ";\n"; return;
+		case OpCode::Jne: stream << "if ((int32_t)" << top << ".v.i != 0) goto I" << instructions.GetLabel(operand) << ";\n"; return;
+		case OpCode::Ja: stream << "if ((int32_t)" << top << ".v.i > 0) goto I" << instructions.GetLabel(operand) << ";\n"; return;
+		case OpCode::Jae: stream << "if ((int32_t)" << top << ".v.i >= 0) goto I" << instructions.GetLabel(operand) << ";\n"; return;
+		case OpCode::Jb: stream << "if ((int32_t)" << top << ".v.i < 0) goto I" << instructions.GetLabel(operand) << ";\n"; return;
+		case OpCode::Jbe: stream << "if ((int32_t)" << top << ".v.i <= 0) goto I" << instructions.GetLabel(operand) << ";\n"; return;
+
+		case OpCode::Call: {
+			FunctionSignature signature;
+			GetSignature(operand, signature);
+
+			// Arguments and results go through block-scoped copies so the slots never have their address taken.
+			const std::uint32_t base = depth - signature.Arity;
+			const bool isDirect = operand < isTranslated.size() && isTranslated[operand];
+			stream << "{\n\t\tsvm_value a[" << std::max<std::uint32_t>(signature.Arity, 1) << "];\n"
+				<< "\t\tsvm_value r;\n"
+				<< "\t\tint status;\n";
+			for (std::uint16_t i = 0; i < signature.Arity; ++i) {
+				stream << "\t\ta[" << i << "] = " << Slot('s', base + i) << ";\n";
+			}
+			if (isDirect) {
+				stream << "\t\tstatus = " << m_Prefix << "_f" << operand << "(rt, a, &r);\n";
+			} else {
+				stream << "\t\tstatus = rt->call(rt, " << operand << "u, a, &r);\n";
+			}
+			stream << "\t\tif (status != SVM_OK) return status;\n";
+			if (signature.HasResult) {
+				if (!isDirect) {
+					stream << "\t\tif (!SVM_IS_VALUE(r)) SVM_FAIL(\"The type of the result is not supported.\");\n";
+				}
+				stream << "\t\t" << Slot('s', base) << " = r;\n";
+			}
+			stream << "\t}\n";
+			return;
+		}
+
+		case OpCode::Ret:
+			if (hasResult) {
+				stream << "*result = " << top << ";\n\t";
+			}
+			stream << "return SVM_OK;\n";
+			return;
+
+		case OpCode::ToI: stream << "SVM_CONVERT(" << top << ", SVM_SET_INT, uint32_t, ti);\n"; return;
+		case OpCode::ToL: stream << "SVM_CONVERT(" << top << ", SVM_SET_LONG, uint64_t, tl);\n"; return;
+		case OpCode::ToSi: stream << "SVM_CONVERT(" << top << ", SVM_SET_SINGLE, float, ts);\n"; return;
+		case OpCode::ToD: stream << "SVM_CONVERT(" << top << ", SVM_SET_DOUBLE, double, td);\n"; return;
+		case OpCode::ToP: stream << "SVM_TOP(" << top << ");\n"; return;
+
+		case OpCode::Null: stream << next << ".type = tp; " << next << ".v.p = NULL;\n"; return;
+		case OpCode::New: stream << "SVM_NEW(" << next << ", " << operand << "u, tp);\n"; return;
+		case OpCode::Delete: stream << "SVM_DELETE(" << top << ");\n"; return;
+		case OpCode::GCNull: stream << next << ".type = tg; " << next << ".v.p = NULL;\n"; return;
+		case OpCode::GCNew: stream << "SVM_NEW(" << next << ", " << operand << "u, tg);\n"; return;
+
+		case OpCode::ANew: stream << "SVM_ANEW(" << top << ", " << operand << "u, tp);\n"; return;
+		case OpCode::AGCNew: stream << "SVM_ANEW(" << top << ", " << operand << "u, tg);\n"; return;
+		case OpCode::ALea: stream << "SVM_ALEA(" << second << ", " << top << ", " << m_Prefix << "_size_of);\n"; return;
+
+		default:
+			stream << "SVM_FAIL(\"The instruction is not supported.\");\n";
+			return;
+		}
+	}
+	void CTranslator::WriteFieldAddress(std::ostream& stream, const std::string& slot, std::uint32_t field) const {
+		// Every structure the module knows that has the field gets a compare against its handle.
+		const auto structCount = static_cast<std::uint32_t>(m_ByteFile.GetStructures().size() + m_MappedStructures.size());
+		stream << "{\n\t\tunsigned char* const o = (unsigned char*)" << slot << ".v.p;\n"
+			<< "\t\tif (!o) SVM_FAIL(\"The pointer is null.\");\n\t\t";
+		for (std::uint32_t i = 0; i < structCount; ++i) {
+			const StructureInfo* const structure = GetStructure(i);
+			if (field >= structure->Fields.size()) continue;
+
+			stream << "if (*(const void* const*)o == rt->types[" << static_cast<std::uint32_t>(TypeCode::Structure) + i << "]) "
+				<< slot << ".v.p = o + " << structure->Fields[field].Offset << "u;\n\t\telse ";
+		}
+		stream << "SVM_FAIL(\"The field does not exist.\");\n"
+			<< "\t\t" << slot << ".type = tp;\n\t}\n";
+	}
+	bool CTranslator::GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept {
+		const Functions& functions = m_ByteFile.GetFunctions();
+		if (function < functions.size()) {
+			result.Arity = functions[function].Arity;
+			result.HasResult = functions[function].HasResult;
+			return true;
+		}
+
+		const std::size_t mapping = function - functions.size();
+		if (mapping >= m_MappedFunctions.size()) return false;
+
+		result = m_MappedFunctions[mapping];
+		return true;
+	}
+	const StructureInfo* CTranslator::GetStructure(std::uint32_t index) const noexcept {
+		const Structures& structures = m_ByteFile.GetStructures();
+		if (index < structures.size()) return &structures[index];
+		else return m_MappedStructures[index - structures.size()];
+	}
+}
+
+namespace svm::core {
+	CLibrary::CLibrary(CLibrary&& library) noexcept
+		: m_Handle(std::exchange(library.m_Handle, nullptr)), m_Functions(std::exchange(library.m_Functions, nullptr)),
+		m_Names(std::exchange(library.m_Names, nullptr)), m_FunctionCount(std::exchange(library.m_FunctionCount, 0)) {}
+	CLibrary::~CLibrary() {
+		Close();
+	}
+
+	CLibrary& CLibrary::operator=(CLibrary&& library) noexcept {
+		Close();
+
+		m_Handle = std::exchange(library.m_Handle, nullptr);
+		m_Functions = std::exchange(library.m_Functions, nullptr);
+		m_Names = std::exchange(library.m_Names, nullptr);
+		m_FunctionCount = std::exchange(library.m_FunctionCount, 0);
+		return *this;
+	}
+
+	bool CLibrary::Open(const std::filesystem::path& path, std::string_view prefix) noexcept {
+		Close();
+
+#ifndef SVM_WINDOWS
+		void* const handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+		if (!handle) return false;
+
+		const std::string name(prefix);
+		const auto count = static_cast<const std::uint32_t*>(dlsym(handle, (name + "_function_count").c_str()));
+		const auto functions = static_cast<const CFunction*>(dlsym(handle, (name + "_functions").c_str()));
+		const auto names = static_cast<const char* const*>(dlsym(handle, (name + "_names").c_str()));
+		if (!count || !functions || !names) {
+			dlclose(handle);
+			return false;
+		}
+
+		m_Handle = handle;
+		m_Functions = functions;
+		m_Names = names;
+		m_FunctionCount = *count;
+		return true;
+#else
+		static_cast<void>(path);
+		static_cast<void>(prefix);
+		return false;
+#endif
+	}
+	void CLibrary::Close() noexcept {
+		if (!m_Handle) return;
+
+#ifndef SVM_WINDOWS
+		dlclose(m_Handle);
+#endif
+		m_Handle = nullptr;
+		m_Functions = nullptr;
+		m_Names = nullptr;
+		m_FunctionCount = 0;
+	}
+
+	bool CLibrary::IsOpen() const noexcept {
+		return m_Handle != nullptr;
+	}
+	CFunction CLibrary::GetFunction(std::uint32_t index) const noexcept {
+		return index < m_FunctionCount ? m_Functions[index] : nullptr;
+	}
+	CFunction CLibrary::GetFunction(std::string_view name) const noexcept {
+		for (std::uint32_t i = 0; i < m_FunctionCount; ++i) {
+			if (name == m_Names[i]) return m_Functions[i];
+		}
+		return nullptr;
+	}
+	std::uint32_t CLibrary::GetFunctionCount() const noexcept {
+		return m_FunctionCount;
+	}
+}
@@ -0,0 +1,787 @@
+#include <svm/core/ConstantFolder.hpp>
+
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/IO.hpp>
+#include <svm/Object.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace svm::core {
+	std::ostream& operator<<(std::ostream& stream, const ConstantFoldingStatistics& statistics) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+		const std::string indent = defIndent + indentOnce;
+
+		stream << defIndent << "ConstantFoldingStatistics:\n"
+			<< indent << "Propagated: " << statistics.Propagated << '\n'
+			<< indent << "Folded: " << statistics.Folded << '\n'
+			<< indent << "RemovedBranches: " << statistics.RemovedBranches << '\n'
+			<< indent << "AddedConstants: " << statistics.AddedConstants;
+		return stream;
+	}
+}
+
+namespace svm::core {
+	struct ConstantFolder::State final {
+		bool IsVisited = false;
+		std::vector<detail::ConstantValue> Stack;
+		std::vector<detail::ConstantValue> Locals;
+
+		// Values that differ between paths are no longer constant.
+		bool Merge(const State& state, bool& isChanged) {
+			if (!IsVisited) {
+				*this = state;
+				return isChanged = true;
+			}
+			if (Stack.size() != state.Stack.size()) return false;
+
+			isChanged = false;
+			for (std::size_t i = 0; i < Stack.size(); ++i) {
+				if (Stack[i].IsConstant() && Stack[i] != state.Stack[i]) {
+					Stack[i] = {};
+					isChanged = true;
+				}
+			}
+			if (Locals.size() > state.Locals.size()) {
+				Locals.resize(state.Locals.size());
+				isChanged = true;
+			}
+			for (std::size_t i = 0; i < Locals.size(); ++i) {
+				if (Locals[i].IsConstant() && Locals[i] != state.Locals[i]) {
+					Locals[i] = {};
+					isChanged = true;
+				}
+			}
+			return true;
+		}
+	};
+}
+
+namespace svm::detail {
+	// Operands are read through the layout they were written against, which may be older than the pool.
+	ConstantValue ReadConstant(const core::ConstantPool& constantPool, const core::ConstantPoolLayout& layout, std::uint32_t index) noexcept {
+		ConstantValue result;
+		if (index >= layout.AllCount) return result;
+		else if (index >= layout.DoubleOffset) {
+			result.Code = TypeCode::Double;
+			result.Real = constantPool.GetDoublePool()[index - layout.DoubleOffset].Value;
+		} else if (index >= layout.SingleOffset) {
+			result.Code = TypeCode::Single;
+			result.Real = constantPool.GetSinglePool()[index - layout.SingleOffset].Value;
+		} else if (index >= layout.LongOffset) {
+			result.Code = TypeCode::Long;
+			result.Integer = constantPool.GetLongPool()[index - layout.LongOffset].Value;
+		} else {
+			result.Code = TypeCode::Int;
+			result.Integer = constantPool.GetIntPool()[index - layout.IntOffset].Value;
+		}
+		return result;
+	}
+}
+
+namespace svm::detail {
+	namespace {
+		template<typename U>
+		bool EvaluateInteger(OpCode opCode, U lhs, U rhs, U& result) noexcept {
+			using S = std::make_signed_t<U>;
+			static constexpr U width = std::numeric_limits<U>::digits;
+
+			switch (opCode) {
+			case OpCode::Add: result = static_cast<U>(lhs + rhs); return true;
+			case OpCode::Sub: result = static_cast<U>(lhs - rhs); return true;
+			case OpCode::Mul:
+			case OpCode::IMul: result = static_cast<U>(lhs * rhs); return true;
+			case OpCode::And: result = lhs & rhs; return true;
+			case OpCode::Or: result = lhs | rhs; return true;
+			case OpCode::Xor: result = lhs ^ rhs; return true;
+
+			case OpCode::Div:
+			case OpCode::Mod:
+				if (rhs == 0) return false;
+				result = opCode == OpCode::Div ? lhs / rhs : lhs % rhs;
+				return true;
+
+			case OpCode::IDiv:
+			case OpCode::IMod:
+				// Division by zero and the overflowing division trap at run time.
+				if (rhs == 0 || (static_cast<S>(lhs) == std::numeric_limits<S>::min() && static_cast<S>(rhs) == -1)) return false;
+				result = static_cast<U>(opCode == OpCode::IDiv ?
+					static_cast<S>(lhs) / static_cast<S>(rhs) : static_cast<S>(lhs) % static_cast<S>(rhs));
+				return true;
+
+			case OpCode::Shl:
+			case OpCode::Sal:
+			case OpCode::Shr:
+			case OpCode::Sar:
+				if (rhs >= width) return false;
+				if (opCode == OpCode::Shr) {
+					result = lhs >> rhs;
+				} else if (opCode == OpCode::Sar) {
+					result = static_cast<U>(static_cast<S>(lhs) >> rhs);
+				} else {
+					result = static_cast<U>(lhs << rhs);
+				}
+				return true;
+
+			default:
+				return false;
+			}
+		}
+		template<typename T>
+		bool EvaluateReal(OpCode opCode, T lhs, T rhs, T& result) noexcept {
+			switch (opCode) {
+			case OpCode::Add: result = lhs + rhs; return true;
+			case OpCode::Sub: result = lhs - rhs; return true;
+			case OpCode::Mul: result = lhs * rhs; return true;
+			case OpCode::Div: result = lhs / rhs; return true;
+			case OpCode::Mod: result = std::fmod(lhs, rhs); return true;
+			default: return false;
+			}
+		}
+
+		template<typename T, typename U>
+		bool IsInRange(double value) noexcept {
+			// Out-of-range floating conversions are undefined for Object::Cast.
+			if constexpr (std::is_floating_point_v<T> || !std::is_floating_point_v<U>) return true;
+			else return value >= 0.0 && value < std::ldexp(1.0, std::numeric_limits<T>::digits);
+		}
+
+		template<typename F, typename T>
+		ConstantValue Convert(const F& object) noexcept {
+			ConstantValue result;
+			if (!IsInRange<decltype(T::Value), decltype(F::Value)>(static_cast<double>(object.Value))) return result;
+
+			const T converted = object.template Cast<T>();
+			if constexpr (std::is_same_v<T, IntObject>) {
+				result.Code = TypeCode::Int;
+				result.Integer = converted.Value;
+			} else if constexpr (std::is_same_v<T, LongObject>) {
+				result.Code = TypeCode::Long;
+				result.Integer = converted.Value;
+			} else if constexpr (std::is_same_v<T, SingleObject>) {
+				result.Code = TypeCode::Single;
+				result.Real = converted.Value;
+			} else {
+				result.Code = TypeCode::Double;
+				result.Real = converted.Value;
+			}
+			return result;
+		}
+		template<typename T>
+		ConstantValue Convert(const ConstantValue& operand) noexcept {
+			switch (operand.Code) {
+			case TypeCode::Int: return Convert<IntObject, T>(IntObject(static_cast<std::uint32_t>(operand.Integer)));
+			case TypeCode::Long: return Convert<LongObject, T>(LongObject(operand.Integer));
+			case TypeCode::Single: return Convert<SingleObject, T>(SingleObject(static_cast<float>(operand.Real)));
+			case TypeCode::Double: return Convert<DoubleObject, T>(DoubleObject(operand.Real));
+			default: return {};
+			}
+		}
+	}
+}
+
+namespace svm::detail {
+	ConstantValue EvaluateBinary(OpCode opCode, const ConstantValue& lhs, const ConstantValue& rhs) noexcept {
+		ConstantValue result;
+		if (!lhs.IsConstant() || lhs.Code != rhs.Code) return result;
+
+		bool isSucceeded = false;
+		switch (lhs.Code) {
+		case TypeCode::Int: {
+			std::uint32_t value = 0;
+			isSucceeded = EvaluateInteger<std::uint32_t>(opCode, static_cast<std::uint32_t>(lhs.Integer), static_cast<std::uint32_t>(rhs.Integer), value);
+			result.Integer = value;
+			break;
+		}
+
+		case TypeCode::Long:
+			isSucceeded = EvaluateInteger<std::uint64_t>(opCode, lhs.Integer, rhs.Integer, result.Integer);
+			break;
+
+		case TypeCode::Single: {
+			float value = 0.0f;
+			isSucceeded = EvaluateReal<float>(opCode, static_cast<float>(lhs.Real), static_cast<float>(rhs.Real), value);
+			result.Real = value;
+			break;
+		}
+
+		case TypeCode::Double:
+			isSucceeded = EvaluateReal<double>(opCode, lhs.Real, rhs.Real, result.Real);
+			break;
+
+		default:
+			break;
+		}
+
+		if (isSucceeded) {
+			result.Code = lhs.Code;
+		}
+		return result;
+	}
+	ConstantValue EvaluateUnary(OpCode opCode, const ConstantValue& operand) noexcept {
+		ConstantValue result = operand;
+		const bool isInteger = operand.Code == TypeCode::Int || operand.Code == TypeCode::Long;
+		const bool isSingle = operand.Code == TypeCode::Single;
+
+		switch (opCode) {
+		case OpCode::Neg:
+			if (isInteger) {
+				result.Integer = 0 - operand.Integer;
+			} else {
+				result.Real = -operand.Real;
+			}
+			break;
+
+		case OpCode::Inc:
+		case OpCode::Dec: {
+			const int delta = opCode == OpCode::Inc ? 1 : -1;
+			if (isInteger) {
+				result.Integer = operand.Integer + static_cast<std::uint64_t>(delta);
+			} else if (isSingle) {
+				result.Real = static_cast<float>(operand.Real) + static_cast<float>(delta);
+			} else {
+				result.Real = operand.Real + delta;
+			}
+			break;
+		}
+
+		case OpCode::Not:
+			if (!isInteger) return {};
+			result.Integer = ~operand.Integer;
+			break;
+
+		default:
+			return {};
+		}
+
+		if (operand.Code == TypeCode::Int) {
+			result.Integer = static_cast<std::uint32_t>(result.Integer);
+		}
+		return result;
+	}
+	ConstantValue EvaluateConversion(OpCode opCode, const ConstantValue& operand) noexcept {
+		switch (opCode) {
+		case OpCode::ToI: return Convert<IntObject>(operand);
+		case OpCode::ToL: return Convert<LongObject>(operand);
+		case OpCode::ToSi: return Convert<SingleObject>(operand);
+		case OpCode::ToD: return Convert<DoubleObject>(operand);
+		default: return {};
+		}
+	}
+
+	// Yields -1, 0 or 1. Unordered operands are not folded.
+	bool CompareConstants(OpCode opCode, const ConstantValue& lhs, const ConstantValue& rhs, int& result) noexcept {
+		if (!lhs.IsConstant() || lhs.Code != rhs.Code) return false;
+
+		const auto order = [&result](auto l, auto r) {
+			result = l < r ? -1 : (r < l ? 1 : 0);
+		};
+		switch (lhs.Code) {
+		case TypeCode::Int:
+			if (opCode == OpCode::ICmp) order(static_cast<std::int32_t>(lhs.Integer), static_cast<std::int32_t>(rhs.Integer));
+			else order(static_cast<std::uint32_t>(lhs.Integer), static_cast<std::uint32_t>(rhs.Integer));
+			return true;
+
+		case TypeCode::Long:
+			if (opCode == OpCode::ICmp) order(static_cast<std::int64_t>(lhs.Integer), static_cast<std::int64_t>(rhs.Integer));
+			else order(lhs.Integer, rhs.Integer);
+			return true;
+
+		case TypeCode::Single:
+		case TypeCode::Double:
+			if (opCode == OpCode::ICmp || std::isnan(lhs.Real) || std::isnan(rhs.Real)) return false;
+			order(lhs.Real, rhs.Real);
+			return true;
+
+		default:
+			return false;
+		}
+	}
+	bool IsJumpTaken(OpCode opCode, int order) noexcept {
+		switch (opCode) {
+		case OpCode::Je: return order == 0;
+		case OpCode::Jne: return order != 0;
+		case OpCode::Ja: return order > 0;
+		case OpCode::Jae: return order >= 0;
+		case OpCode::Jb: return order < 0;
+		case OpCode::Jbe: return order <= 0;
+		default: return false;
+		}
+	}
+
+	// Returns the global index of the constant, or NPos if the pool does not have it.
+	std::uint32_t FindConstant(const core::ConstantPool& constantPool, const ConstantValue& value) noexcept {
+		std::uint32_t index = core::ConstantPool::NPos;
+		std::uint32_t offset = 0;
+		switch (value.Code) {
+		case TypeCode::Int:
+			index = constantPool.FindIntConstant(static_cast<std::uint32_t>(value.Integer));
+			offset = constantPool.GetIntOffset();
+			break;
+
+		case TypeCode::Long:
+			index = constantPool.FindLongConstant(value.Integer);
+			offset = constantPool.GetLongOffset();
+			break;
+
+		// NaN payloads are not guaranteed to survive folding.
+		case TypeCode::Single:
+			if (std::isnan(value.Real)) break;
+			index = constantPool.FindSingleConstant(static_cast<float>(value.Real));
+			offset = constantPool.GetSingleOffset();
+			break;
+
+		case TypeCode::Double:
+			if (std::isnan(value.Real)) break;
+			index = constantPool.FindDoubleConstant(value.Real);
+			offset = constantPool.GetDoubleOffset();
+			break;
+
+		default:
+			break;
+		}
+		return index == core::ConstantPool::NPos ? index : offset + index;
+	}
+	// Returns the global index of the constant, adding it to the pool if it does not have it.
+	std::uint32_t AddConstant(core::ConstantPool& constantPool, const ConstantValue& value, std::uint64_t& addedCount) {
+		if (const std::uint32_t index = FindConstant(constantPool, value); index != core::ConstantPool::NPos) return index;
+
+		std::uint32_t index = core::ConstantPool::NPos;
+		std::uint32_t offset = 0;
+		switch (value.Code) {
+		case TypeCode::Int:
+			index = constantPool.AddIntConstant(static_cast<std::uint32_t>(value.Integer));
+			offset = constantPool.GetIntOffset();
+			break;
+
+		case TypeCode::Long:
+			index = constantPool.AddLongConstant(value.Integer);
+			offset = constantPool.GetLongOffset();
+			break;
+
+		case TypeCode::Single:
+			if (std::isnan(value.Real)) return index;
+			index = constantPool.AddSingleConstant(static_cast<float>(value.Real));
+			offset = constantPool.GetSingleOffset();
+			break;
+
+		case TypeCode::Double:
+			if (std::isnan(value.Real)) return index;
+			index = constantPool.AddDoubleConstant(value.Real);
+			offset = constantPool.GetDoubleOffset();
+			break;
+
+		default:
+			return index;
+		}
+
+		++addedCount;
+		return offset + index;
+	}
+}
+
+namespace svm::core {
+	namespace {
+		bool IsFoldable(OpCode opCode) noexcept {
+			return (opCode >= OpCode::Add && opCode <= OpCode::Sar) ||
+				(opCode >= OpCode::ToI && opCode <= OpCode::ToD);
+		}
+		std::size_t GetOperandCount(OpCode opCode) noexcept {
+			switch (opCode) {
+			case OpCode::Neg:
+			case OpCode::Inc:
+			case OpCode::Dec:
+			case OpCode::Not:
+			case OpCode::ToI:
+			case OpCode::ToL:
+			case OpCode::ToSi:
+			case OpCode::ToD:
+				return 1;
+
+			default:
+				return 2;
+			}
+		}
+	}
+}
+
+namespace svm::core {
+	ConstantFolder::ConstantFolder(std::vector<FunctionSignature> mappedFunctions) noexcept
+		: m_MappedFunctions(std::move(mappedFunctions)) {}
+
+	void ConstantFolder::Fold(ByteFile& byteFile) {
+		ConstantPool& constantPool = byteFile.GetConstantPool();
+		Functions& functions = byteFile.GetFunctions();
+		Instructions& entrypoint = byteFile.GetEntrypoint();
+
+		for (unsigned int i = 0; i < m_MaxIterations; ++i) {
+			// Constants are added in a first sweep so that operands only have to be remapped once.
+			const ConstantPoolLayout oldLayout = constantPool.GetLayout();
+			for (FunctionInfo& function : functions) {
+				Fold(byteFile, constantPool, oldLayout, function.Instructions, function.Arity, false);
+			}
+			Fold(byteFile, constantPool, oldLayout, entrypoint, 0, false);
+
+			const ConstantPoolLayout layout = constantPool.GetLayout();
+			if (layout.AllCount != oldLayout.AllCount) {
+				const auto remap = [&](Instructions& instructions) {
+					const std::uint64_t instCount = instructions.GetInstructionCount();
+					for (std::uint64_t j = 0; j < instCount; ++j) {
+						Instruction inst = instructions.GetInstruction(j);
+						if (inst.OpCode != OpCode::Push) continue;
+
+						inst.Operand = oldLayout.Remap(inst.Operand, layout);
+						instructions.SetInstruction(j, inst);
+					}
+				};
+				for (FunctionInfo& function : functions) {
+					remap(function.Instructions);
+				}
+				remap(entrypoint);
+			}
+
+			bool isChanged = false;
+			for (FunctionInfo& function : functions) {
+				if (Fold(byteFile, constantPool, layout, function.Instructions, function.Arity, true)) {
+					function.Frame = {};
+					isChanged = true;
+				}
+			}
+			isChanged |= Fold(byteFile, constantPool, layout, entrypoint, 0, true);
+			if (!isChanged) break;
+		}
+	}
+
+	unsigned int ConstantFolder::GetMaxIterations() const noexcept {
+		return m_MaxIterations;
+	}
+	void ConstantFolder::SetMaxIterations(unsigned int newMaxIterations) noexcept {
+		m_MaxIterations = newMaxIterations;
+	}
+	const ConstantFoldingStatistics& ConstantFolder::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	void ConstantFolder::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+
+	bool ConstantFolder::Fold(const ByteFile& byteFile, ConstantPool& constantPool, const ConstantPoolLayout& layout,
+		Instructions& instructions, std::uint16_t arity, bool isRewriting) {
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		std::vector<bool> isEscaped;
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode != OpCode::Lea) continue;
+			if (inst.Operand >= isEscaped.size()) {
+				isEscaped.resize(static_cast<std::size_t>(inst.Operand) + 1);
+			}
+			isEscaped[inst.Operand] = true;
+		}
+
+		std::vector<State> states;
+		if (!Analyze(byteFile, constantPool, layout, instructions, arity, isEscaped, states)) return false;
+
+		// Each emitted instruction of the current block, with the constant it pushes or the order it compares.
+		struct Emitted final {
+			bool IsConstant = false;
+			bool IsOrder = false;
+			int Order = 0;
+		};
+
+		const ControlFlowGraph graph(instructions);
+		ArenaVector<Instruction> result;
+		std::vector<std::uint64_t> indexMap(static_cast<std::size_t>(instCount) + 1);
+		std::vector<Emitted> emitted;
+		ConstantFoldingStatistics statistics;
+
+		// While rewriting, the layout must not change, so only constants the pool already has can be pushed.
+		const auto intern = [&](const detail::ConstantValue& value) {
+			return isRewriting ? detail::FindConstant(constantPool, value) : detail::AddConstant(constantPool, value, m_Statistics.AddedConstants);
+		};
+		const auto isConstantTail = [&emitted](std::size_t count) {
+			if (emitted.size() < count) return false;
+			for (std::size_t i = emitted.size() - count; i < emitted.size(); ++i) {
+				if (!emitted[i].IsConstant) return false;
+			}
+			return true;
+		};
+		const auto popTail = [&](std::size_t count) {
+			result.resize(result.size() - count);
+			emitted.resize(emitted.size() - count);
+		};
+
+		for (std::uint32_t block = 0; block < graph.GetBlockCount(); ++block) {
+			const BasicBlock& range = graph.GetBlock(block);
+			State state = states[block];
+			emitted.clear();
+
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				indexMap[static_cast<std::size_t>(i)] = result.size();
+				if (!state.IsVisited) {
+					result.push_back(inst);
+					continue;
+				}
+
+				const State before = state;
+				Interpret(byteFile, constantPool, layout, inst, isEscaped, state);
+
+				if (inst.OpCode == OpCode::Push && state.Stack.back().IsConstant()) {
+					result.push_back(inst);
+					emitted.push_back({ true });
+					continue;
+				} else if (inst.OpCode == OpCode::Load && state.Stack.back().IsConstant()) {
+					if (const std::uint32_t index = intern(state.Stack.back()); index != ConstantPool::NPos) {
+						result.push_back(Instruction(OpCode::Push, index, inst.Offset));
+						emitted.push_back({ true });
+						++statistics.Propagated;
+						continue;
+					}
+				} else if (IsFoldable(inst.OpCode) && state.Stack.back().IsConstant() && isConstantTail(GetOperandCount(inst.OpCode))) {
+					if (const std::uint32_t index = intern(state.Stack.back()); index != ConstantPool::NPos) {
+						const std::uint64_t offset = result[result.size() - GetOperandCount(inst.OpCode)].Offset;
+						popTail(GetOperandCount(inst.OpCode));
+						result.push_back(Instruction(OpCode::Push, index, offset));
+						emitted.push_back({ true });
+						++statistics.Folded;
+						continue;
+					}
+				} else if ((inst.OpCode == OpCode::Cmp || inst.OpCode == OpCode::ICmp) && isConstantTail(2)) {
+					int order = 0;
+					if (detail::CompareConstants(inst.OpCode, before.Stack[before.Stack.size() - 2], before.Stack.back(), order)) {
+						result.push_back(inst);
+						emitted.push_back({ false, true, order });
+						continue;
+					}
+				} else if (IsConditionalJump(inst.OpCode) && inst.OpCode <= OpCode::Jbe &&
+					!emitted.empty() && emitted.back().IsOrder) {
+					const bool isTaken = detail::IsJumpTaken(inst.OpCode, emitted.back().Order);
+					const std::uint64_t offset = result[result.size() - 3].Offset;
+					popTail(3);
+					if (isTaken) {
+						result.push_back(Instruction(OpCode::Jmp, inst.Operand, offset));
+						emitted.push_back({});
+					}
+					++statistics.RemovedBranches;
+					continue;
+				} else if (inst.OpCode == OpCode::Copy && !emitted.empty() && emitted.back().IsConstant) {
+					result.push_back(inst);
+					emitted.push_back({ true });
+					continue;
+				}
+
+				result.push_back(inst);
+				emitted.push_back({});
+			}
+		}
+		indexMap.back() = result.size();
+
+		if (!isRewriting) return false;
+		if (!statistics.Propagated && !statistics.Folded && !statistics.RemovedBranches) return false;
+
+		instructions.SetInstructions(std::move(result), indexMap);
+		instructions.UpdateOffsets();
+
+		m_Statistics.Propagated += statistics.Propagated;
+		m_Statistics.Folded += statistics.Folded;
+		m_Statistics.RemovedBranches += statistics.RemovedBranches;
+		return true;
+	}
+	bool ConstantFolder::Analyze(const ByteFile& byteFile, const ConstantPool& constantPool, const ConstantPoolLayout& layout,
+		const Instructions& instructions, std::uint16_t arity, const std::vector<bool>& isEscaped, std::vector<State>& states) const {
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			if (instructions.GetLabel(i) >= instCount) return false;
+		}
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode >= OpCode::Count) return false;
+			if (IsJump(inst.OpCode) && inst.Operand >= labelCount) return false;
+		}
+
+		const ControlFlowGraph graph(instructions);
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		states.assign(blockCount, State());
+		if (blockCount == 0) return true;
+
+		std::vector<std::uint32_t> worklist{ 0 };
+		std::vector<bool> isQueued(blockCount);
+		states[0].IsVisited = true;
+		states[0].Locals.assign(arity, detail::ConstantValue());
+		isQueued[0] = true;
+
+		State state;
+		while (!worklist.empty()) {
+			const std::uint32_t block = worklist.back();
+			worklist.pop_back();
+			isQueued[block] = false;
+
+			state = states[block];
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				if (!Interpret(byteFile, constantPool, layout, instructions.GetInstruction(i), isEscaped, state)) return false;
+			}
+
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				bool isChanged = false;
+				if (!states[successor].Merge(state, isChanged)) return false;
+				if (isChanged && !isQueued[successor]) {
+					worklist.push_back(successor);
+					isQueued[successor] = true;
+				}
+			}
+		}
+		return true;
+	}
+	bool ConstantFolder::Interpret(const ByteFile& byteFile, const ConstantPool& constantPool, const ConstantPoolLayout& layout,
+		const Instruction& instruction, const std::vector<bool>& isEscaped, State& state) const {
+		std::vector<detail::ConstantValue>& stack = state.Stack;
+		const auto pop = [&stack](std::size_t count) {
+			if (stack.size() < count) return false;
+			stack.resize(stack.size() - count);
+			return true;
+		};
+		const auto replace = [&stack](std::size_t count, const detail::ConstantValue& value) {
+			if (stack.size() < count) return false;
+			stack.resize(stack.size() - count);
+			stack.push_back(value);
+			return true;
+		};
+
+		switch (instruction.OpCode) {
+		case OpCode::Nop:
+		case OpCode::Jmp:
+		case OpCode::Ret:
+			return true;
+
+		case OpCode::Push:
+			stack.push_back(detail::ReadConstant(constantPool, layout, instruction.Operand));
+			return true;
+
+		case OpCode::Pop:
+		case OpCode::Je:
+		case OpCode::Jne:
+		case OpCode::Ja:
+		case OpCode::Jae:
+		case OpCode::Jb:
+		case OpCode::Jbe:
+		case OpCode::Delete:
+			return pop(1);
+
+		case OpCode::Load:
+			stack.push_back(instruction.Operand < state.Locals.size() ? state.Locals[instruction.Operand] : detail::ConstantValue());
+			return true;
+
+		case OpCode::Store: {
+			if (stack.empty()) return false;
+			if (instruction.Operand >= state.Locals.size()) {
+				state.Locals.resize(static_cast<std::size_t>(instruction.Operand) + 1);
+			}
+
+			const bool isLocalEscaped = instruction.Operand < isEscaped.size() && isEscaped[instruction.Operand];
+			state.Locals[instruction.Operand] = isLocalEscaped ? detail::ConstantValue() : stack.back();
+			return pop(1);
+		}
+
+		case OpCode::Lea:
+		case OpCode::Null:
+		case OpCode::New:
+		case OpCode::GCNull:
+		case OpCode::GCNew:
+			stack.emplace_back();
+			return true;
+
+		case OpCode::FLea:
+		case OpCode::TLoad:
+		case OpCode::ToB:
+		case OpCode::ToSh:
+		case OpCode::ToP:
+		case OpCode::APush:
+		case OpCode::ANew:
+		case OpCode::AGCNew:
+			return replace(1, detail::ConstantValue());
+
+		case OpCode::TStore:
+			return pop(2);
+
+		case OpCode::Copy:
+			if (stack.empty()) return false;
+			stack.push_back(stack.back());
+			return true;
+
+		case OpCode::Swap:
+			if (stack.size() < 2) return false;
+			std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+			return true;
+
+		case OpCode::Add:
+		case OpCode::Sub:
+		case OpCode::Mul:
+		case OpCode::IMul:
+		case OpCode::Div:
+		case OpCode::IDiv:
+		case OpCode::Mod:
+		case OpCode::IMod:
+		case OpCode::And:
+		case OpCode::Or:
+		case OpCode::Xor:
+		case OpCode::Shl:
+		case OpCode::Shr:
+		case OpCode::Sal:
+		case OpCode::Sar:
+			if (stack.size() < 2) return false;
+			return replace(2, detail::EvaluateBinary(instruction.OpCode, stack[stack.size() - 2], stack.back()));
+
+		case OpCode::Neg:
+		case OpCode::Inc:
+		case OpCode::Dec:
+		case OpCode::Not:
+			if (stack.empty()) return false;
+			return replace(1, stack.back().IsConstant() ? detail::EvaluateUnary(instruction.OpCode, stack.back()) : detail::ConstantValue());
+
+		case OpCode::ToI:
+		case OpCode::ToL:
+		case OpCode::ToSi:
+		case OpCode::ToD:
+			if (stack.empty()) return false;
+			return replace(1, detail::EvaluateConversion(instruction.OpCode, stack.back()));
+
+		case OpCode::Cmp:
+		case OpCode::ICmp:
+		case OpCode::ALea:
+			return replace(2, detail::ConstantValue());
+
+		case OpCode::Call: {
+			FunctionSignature signature;
+			if (!GetSignature(byteFile, instruction.Operand, signature) || !pop(signature.Arity)) return false;
+			if (signature.HasResult) {
+				stack.emplace_back();
+			}
+			return true;
+		}
+
+		default:
+			return false;
+		}
+	}
+	bool ConstantFolder::GetSignature(const ByteFile& byteFile, std::uint32_t function, FunctionSignature& result) const noexcept {
+		const Functions& functions = byteFile.GetFunctions();
+		if (function < functions.size()) {
+			result.Arity = functions[function].Arity;
+			result.HasResult = functions[function].HasResult;
+			return true;
+		}
+
+		const std::size_t mapping = function - functions.size();
+		if (mapping >= m_MappedFunctions.size()) return false;
+
+		result = m_MappedFunctions[mapping];
+		return true;
+	}
+}
@@ -4,10 +4,22 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iterator>
 #include <string>
 #include <utility>
 
+namespace svm::core {
+	// Operands past the constant pool refer to structures and move along with its end.
+	std::uint32_t ConstantPoolLayout::Remap(std::uint32_t index, const ConstantPoolLayout& newLayout) const noexcept {
+		if (index >= AllCount) return index - AllCount + newLayout.AllCount;
+		else if (index >= DoubleOffset) return index - DoubleOffset + newLayout.DoubleOffset;
+		else if (index >= SingleOffset) return index - SingleOffset + newLayout.SingleOffset;
+		else if (index >= LongOffset) return index - LongOffset + newLayout.LongOffset;
+		else return index - IntOffset + newLayout.IntOffset;
+	}
+}
+
 namespace svm::core {
 	ConstantPool::ConstantPool(std::vector<IntObject> intPool, std::vector<LongObject> longPool,
 		std::vector<SingleObject> singlePool, std::vector<DoubleObject> doublePool) noexcept
@@ -44,6 +56,9 @@ namespace svm::core {
 	std::uint32_t ConstantPool::GetAllCount() const noexcept {
 		return GetIntCount() + GetLongCount() + GetSingleCount() + GetDoubleCount();
 	}
+	ConstantPoolLayout ConstantPool::GetLayout() const noexcept {
+		return { GetIntOffset(), GetLongOffset(), GetSingleOffset(), GetDoubleOffset(), GetAllCount() };
+	}
 	std::uint32_t ConstantPool::GetIntCount() const noexcept {
 		return static_cast<std::uint32_t>(m_IntPool.size());
 	}
@@ -88,19 +103,54 @@ namespace svm::core {
 		else return static_cast<std::uint32_t>(std::distance(m_LongPool.begin(), iter));
 	}
 	std::uint32_t ConstantPool::FindSingleConstant(float value) const noexcept {
+		// Compared bitwise, so that signed zeros are kept apart and NaNs can be found.
 		const auto iter = std::find_if(m_SinglePool.begin(), m_SinglePool.end(), [value](const auto& object) {
-			return object.Value == value;
+			return std::memcmp(&object.Value, &value, sizeof(value)) == 0;
 		});
 		if (iter == m_SinglePool.end()) return NPos;
 		else return static_cast<std::uint32_t>(std::distance(m_SinglePool.begin(), iter));
 	}
 	std::uint32_t ConstantPool::FindDoubleConstant(double value) const noexcept {
+		// Compared bitwise, so that signed zeros are kept apart and NaNs can be found.
 		const auto iter = std::find_if(m_DoublePool.begin(), m_DoublePool.end(), [value](const auto& object) {
-			return object.Value == value;
+			return std::memcmp(&object.Value, &value, sizeof(value)) == 0;
 		});
 		if (iter == m_DoublePool.end()) return NPos;
 		else return static_cast<std::uint32_t>(std::distance(m_DoublePool.begin(), iter));
 	}
+	std::uint32_t ConstantPool::FindConstant(const ConstantPool& constantPool, std::uint32_t index) const noexcept {
+		assert(index < constantPool.GetAllCount());
+
+		std::uint32_t result;
+		switch (constantPool.GetConstantType(index)->Code) {
+		case TypeCode::Int:
+			result = FindIntConstant(constantPool.GetConstant<IntObject>(index).Value);
+			return result == NPos ? NPos : GetIntOffset() + result;
+
+		case TypeCode::Long:
+			result = FindLongConstant(constantPool.GetConstant<LongObject>(index).Value);
+			return result == NPos ? NPos : GetLongOffset() + result;
+
+		case TypeCode::Single:
+			result = FindSingleConstant(constantPool.GetConstant<SingleObject>(index).Value);
+			return result == NPos ? NPos : GetSingleOffset() + result;
+
+		default:
+			result = FindDoubleConstant(constantPool.GetConstant<DoubleObject>(index).Value);
+			return result == NPos ? NPos : GetDoubleOffset() + result;
+		}
+	}
+	bool ConstantPool::ImportConstant(const ConstantPool& constantPool, std::uint32_t index) {
+		if (FindConstant(constantPool, index) != NPos) return false;
+
+		switch (constantPool.GetConstantType(index)->Code) {
+		case TypeCode::Int: AddIntConstant(constantPool.GetConstant<IntObject>(index).Value); break;
+		case TypeCode::Long: AddLongConstant(constantPool.GetConstant<LongObject>(index).Value); break;
+		case TypeCode::Single: AddSingleConstant(constantPool.GetConstant<SingleObject>(index).Value); break;
+		default: AddDoubleConstant(constantPool.GetConstant<DoubleObject>(index).Value); break;
+		}
+		return true;
+	}
 
 	const std::vector<IntObject>& ConstantPool::GetIntPool() const noexcept {
 		return m_IntPool;
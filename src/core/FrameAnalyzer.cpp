@@ -0,0 +1,337 @@
+#include <svm/core/FrameAnalyzer.hpp>
+
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/Structure.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace svm::core {
+	struct FrameAnalyzer::State final {
+		bool IsVisited = false;
+		std::vector<const TypeInfo*> Stack;
+		std::vector<const TypeInfo*> Locals;
+		std::uint64_t StackBytes = 0;
+
+		void Push(const TypeInfo* type, std::size_t size) {
+			Stack.push_back(type);
+			StackBytes += size;
+		}
+		bool Pop(std::size_t count, const FrameAnalyzer& analyzer) noexcept {
+			if (Stack.size() < count) return false;
+			for (std::size_t i = 0; i < count; ++i) {
+				StackBytes -= analyzer.GetSize(Stack.back());
+				Stack.pop_back();
+			}
+			return true;
+		}
+		const TypeInfo* Top(std::size_t index = 0) const noexcept {
+			return Stack[Stack.size() - 1 - index];
+		}
+		// Values whose type differs between paths become unknown (nullptr).
+		bool Merge(const State& state, const FrameAnalyzer& analyzer, bool& isChanged) {
+			if (!IsVisited) {
+				*this = state;
+				return isChanged = true;
+			}
+			if (Stack.size() != state.Stack.size()) return false;
+
+			isChanged = false;
+			for (std::size_t i = 0; i < Stack.size(); ++i) {
+				if (Stack[i] && Stack[i] != state.Stack[i]) {
+					StackBytes += analyzer.GetSize(nullptr) - analyzer.GetSize(Stack[i]);
+					Stack[i] = nullptr;
+					isChanged = true;
+				}
+			}
+			if (Locals.size() > state.Locals.size()) {
+				Locals.resize(state.Locals.size());
+				isChanged = true;
+			}
+			for (std::size_t i = 0; i < Locals.size(); ++i) {
+				if (Locals[i] && Locals[i] != state.Locals[i]) {
+					Locals[i] = nullptr;
+					isChanged = true;
+				}
+			}
+			return true;
+		}
+	};
+}
+
+namespace svm::core {
+	FrameAnalyzer::FrameAnalyzer(const ByteFile& byteFile) noexcept
+		: FrameAnalyzer(byteFile, {}, {}) {}
+	FrameAnalyzer::FrameAnalyzer(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions,
+		std::vector<const TypeInfo*> mappedStructures) noexcept
+		: m_ByteFile(byteFile), m_MappedFunctions(std::move(mappedFunctions)), m_MappedStructures(std::move(mappedStructures)) {
+		for (const Type& type : { IntType, LongType, SingleType, DoubleType, PointerType, GCPointerType, ArrayType }) {
+			m_UnknownSize = std::max(m_UnknownSize, type->Size);
+		}
+		for (const StructureInfo& structure : m_ByteFile.GetStructures()) {
+			m_UnknownSize = std::max(m_UnknownSize, structure.Type.Size);
+		}
+		for (const TypeInfo* type : m_MappedStructures) {
+			if (type) {
+				m_UnknownSize = std::max(m_UnknownSize, type->Size);
+			}
+		}
+	}
+
+	bool FrameAnalyzer::Analyze(FunctionInfo& function) const {
+		FrameInfo result;
+		if (!Analyze(function.Instructions, function.Arity, result)) return false;
+
+		function.Frame = result;
+		return true;
+	}
+	bool FrameAnalyzer::Analyze(const Instructions& instructions, std::uint16_t arity, FrameInfo& result) const {
+		result = {};
+		result.LocalCount = arity;
+
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Store || inst.OpCode == OpCode::Lea) {
+				result.LocalCount = std::max(result.LocalCount, inst.Operand + 1);
+			}
+		}
+
+		const ControlFlowGraph graph(instructions);
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		if (blockCount == 0) return result.IsAnalyzed = true;
+
+		std::vector<State> states(blockCount);
+		std::vector<std::uint32_t> worklist{ 0 };
+		std::vector<bool> isQueued(blockCount);
+		states[0].IsVisited = true;
+		states[0].Locals.assign(arity, nullptr);
+		isQueued[0] = true;
+
+		State state;
+		while (!worklist.empty()) {
+			const std::uint32_t block = worklist.back();
+			worklist.pop_back();
+			isQueued[block] = false;
+
+			state = states[block];
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				if (!Interpret(instructions.GetInstruction(i), state, result)) return false;
+			}
+
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				bool isChanged = false;
+				if (!states[successor].Merge(state, *this, isChanged)) return false;
+				if (isChanged && !isQueued[successor]) {
+					worklist.push_back(successor);
+					isQueued[successor] = true;
+				}
+			}
+		}
+
+		return result.IsAnalyzed = true;
+	}
+
+	std::size_t FrameAnalyzer::GetUnknownSize() const noexcept {
+		return m_UnknownSize;
+	}
+	void FrameAnalyzer::SetUnknownSize(std::size_t newUnknownSize) noexcept {
+		m_UnknownSize = newUnknownSize;
+	}
+
+	bool FrameAnalyzer::Interpret(const Instruction& instruction, State& state, FrameInfo& result) const {
+		const auto push = [&](const TypeInfo* type) {
+			state.Push(type, GetSize(type));
+			result.MaxStackSlots = std::max(result.MaxStackSlots, static_cast<std::uint32_t>(state.Stack.size()));
+			if (result.MaxStackBytes != FrameInfo::Unbounded) {
+				result.MaxStackBytes = std::max(result.MaxStackBytes, state.StackBytes);
+			}
+		};
+		const auto pop = [&](std::size_t count) {
+			return state.Pop(count, *this);
+		};
+
+		switch (instruction.OpCode) {
+		case OpCode::Nop:
+		case OpCode::Jmp:
+			return true;
+
+		case OpCode::Push: {
+			const ConstantPool& constantPool = m_ByteFile.GetConstantPool();
+			if (instruction.Operand < constantPool.GetAllCount()) {
+				push(constantPool.GetConstantType(instruction.Operand).GetPointer());
+			} else {
+				// Operands past the constant pool push a zero-initialized structure.
+				push(GetStructureType(instruction.Operand - constantPool.GetAllCount()));
+			}
+			return true;
+		}
+
+		case OpCode::Pop:
+		case OpCode::Je:
+		case OpCode::Jne:
+		case OpCode::Ja:
+		case OpCode::Jae:
+		case OpCode::Jb:
+		case OpCode::Jbe:
+		case OpCode::Delete:
+		case OpCode::Ret:
+			return pop(instruction.OpCode == OpCode::Ret ? 0 : 1);
+
+		case OpCode::Load:
+			push(instruction.Operand < state.Locals.size() ? state.Locals[instruction.Operand] : nullptr);
+			return true;
+
+		case OpCode::Store: {
+			if (state.Stack.empty()) return false;
+			const TypeInfo* const type = state.Top();
+			if (instruction.Operand >= state.Locals.size()) {
+				state.Locals.resize(static_cast<std::size_t>(instruction.Operand) + 1, nullptr);
+			}
+			state.Locals[instruction.Operand] = type;
+			return pop(1);
+		}
+
+		case OpCode::Lea:
+		case OpCode::Null:
+		case OpCode::New:
+			push(PointerType.GetPointer());
+			return true;
+
+		case OpCode::GCNull:
+		case OpCode::GCNew:
+			push(GCPointerType.GetPointer());
+			return true;
+
+		case OpCode::FLea:
+		case OpCode::ToP:
+			if (!pop(1)) return false;
+			push(PointerType.GetPointer());
+			return true;
+
+		case OpCode::TLoad:
+			if (!pop(1)) return false;
+			push(nullptr);
+			return true;
+
+		case OpCode::TStore:
+			return pop(2);
+
+		case OpCode::Copy:
+			if (state.Stack.empty()) return false;
+			push(state.Top());
+			return true;
+
+		case OpCode::Swap:
+			if (state.Stack.size() < 2) return false;
+			std::swap(state.Stack[state.Stack.size() - 1], state.Stack[state.Stack.size() - 2]);
+			return true;
+
+		case OpCode::Add:
+		case OpCode::Sub:
+		case OpCode::Mul:
+		case OpCode::IMul:
+		case OpCode::Div:
+		case OpCode::IDiv:
+		case OpCode::Mod:
+		case OpCode::IMod:
+		case OpCode::And:
+		case OpCode::Or:
+		case OpCode::Xor:
+		case OpCode::Shl:
+		case OpCode::Shr:
+		case OpCode::Sal:
+		case OpCode::Sar: {
+			if (state.Stack.size() < 2) return false;
+			const TypeInfo* const type = state.Top(1);
+			pop(2);
+			push(type);
+			return true;
+		}
+
+		case OpCode::Neg:
+		case OpCode::Inc:
+		case OpCode::Dec:
+		case OpCode::Not:
+			return !state.Stack.empty();
+
+		case OpCode::Cmp:
+		case OpCode::ICmp:
+			if (!pop(2)) return false;
+			push(IntType.GetPointer());
+			return true;
+
+		case OpCode::Call: {
+			FunctionSignature signature;
+			if (!GetSignature(instruction.Operand, signature) || !pop(signature.Arity)) return false;
+			if (signature.HasResult) {
+				push(nullptr);
+			}
+			return true;
+		}
+
+		case OpCode::ToB:
+		case OpCode::ToSh:
+		case OpCode::ToI:
+		case OpCode::ToL:
+		case OpCode::ToSi:
+		case OpCode::ToD: {
+			if (!pop(1)) return false;
+
+			static const Type types[] = { IntType, IntType, IntType, LongType, SingleType, DoubleType };
+			push(types[static_cast<std::size_t>(instruction.OpCode) - static_cast<std::size_t>(OpCode::ToB)].GetPointer());
+			return true;
+		}
+
+		case OpCode::APush:
+			// The size of the array depends on the count on the stack.
+			if (!pop(1)) return false;
+			push(ArrayType.GetPointer());
+			result.MaxStackBytes = FrameInfo::Unbounded;
+			return true;
+
+		case OpCode::ANew:
+			if (!pop(1)) return false;
+			push(PointerType.GetPointer());
+			return true;
+
+		case OpCode::AGCNew:
+			if (!pop(1)) return false;
+			push(GCPointerType.GetPointer());
+			return true;
+
+		case OpCode::ALea:
+			if (!pop(2)) return false;
+			push(PointerType.GetPointer());
+			return true;
+
+		default:
+			return false;
+		}
+	}
+	bool FrameAnalyzer::GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept {
+		const Functions& functions = m_ByteFile.GetFunctions();
+		if (function < functions.size()) {
+			result.Arity = functions[function].Arity;
+			result.HasResult = functions[function].HasResult;
+			return true;
+		}
+
+		const std::size_t mapping = function - functions.size();
+		if (mapping >= m_MappedFunctions.size()) return false;
+
+		result = m_MappedFunctions[mapping];
+		return true;
+	}
+	const TypeInfo* FrameAnalyzer::GetStructureType(std::uint32_t index) const noexcept {
+		const Structures& structures = m_ByteFile.GetStructures();
+		if (index < structures.size()) return &structures[index].Type;
+
+		const std::size_t mapping = index - structures.size();
+		return mapping < m_MappedStructures.size() ? m_MappedStructures[mapping] : nullptr;
+	}
+	std::size_t FrameAnalyzer::GetSize(const TypeInfo* type) const noexcept {
+		return type && type->Size ? type->Size : m_UnknownSize;
+	}
+}
@@ -0,0 +1,72 @@
+#include <svm/core/FunctionMap.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+namespace svm::core {
+	FunctionMap::FunctionMap(const Functions& functions, const std::vector<const ThreadedFunction*>& threadedFunctions) {
+		Build(functions, threadedFunctions);
+	}
+
+	void FunctionMap::Clear() noexcept {
+		m_Ranges.clear();
+		m_Indices.clear();
+	}
+	void FunctionMap::Build(const Functions& functions, const std::vector<const ThreadedFunction*>& threadedFunctions) {
+		Clear();
+		if (functions.size() != threadedFunctions.size()) throw std::runtime_error("Failed to build the function map. The number of threaded functions does not match.");
+
+		m_Indices.reserve(functions.size());
+		for (const FunctionInfo& function : functions) {
+			m_Indices.emplace_back(function.Instructions);
+		}
+
+		m_Ranges.reserve(threadedFunctions.size());
+		for (std::size_t i = 0; i < threadedFunctions.size(); ++i) {
+			const ThreadedFunction& function = *threadedFunctions[i];
+			if (function.GetInstructionCount() == 0) continue;
+
+			const auto begin = reinterpret_cast<std::uintptr_t>(function.GetInstructions());
+			const auto size = static_cast<std::uintptr_t>(function.GetInstructionCount() * sizeof(ThreadedInstruction));
+			m_Ranges.push_back({ begin, begin + size, static_cast<std::uint32_t>(i) });
+		}
+		std::sort(m_Ranges.begin(), m_Ranges.end(), [](const Range& lhs, const Range& rhs) {
+			return lhs.Begin < rhs.Begin;
+		});
+	}
+
+	std::uint32_t FunctionMap::FindFunction(const ThreadedInstruction* instruction) const noexcept {
+		const Range* const range = FindRange(instruction);
+		return range ? range->Function : NPos;
+	}
+	std::uint64_t FunctionMap::FindInstruction(const ThreadedInstruction* instruction) const noexcept {
+		const Range* const range = FindRange(instruction);
+		if (!range) return OffsetIndex::NPos;
+
+		return (reinterpret_cast<std::uintptr_t>(instruction) - range->Begin) / sizeof(ThreadedInstruction);
+	}
+	const OffsetIndex& FunctionMap::GetOffsetIndex(std::uint32_t function) const noexcept {
+		assert(function < m_Indices.size());
+
+		return m_Indices[function];
+	}
+	std::uint32_t FunctionMap::GetFunctionCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Indices.size());
+	}
+
+	const FunctionMap::Range* FunctionMap::FindRange(const ThreadedInstruction* instruction) const noexcept {
+		// Ranges never overlap, so only the last one beginning at or before the address can contain it.
+		const auto address = reinterpret_cast<std::uintptr_t>(instruction);
+		const auto iter = std::upper_bound(m_Ranges.begin(), m_Ranges.end(), address, [](std::uintptr_t address, const Range& range) {
+			return address < range.Begin;
+		});
+		if (iter == m_Ranges.begin()) return nullptr;
+
+		const Range& range = *std::prev(iter);
+		if (address >= range.End || (address - range.Begin) % sizeof(ThreadedInstruction) != 0) return nullptr;
+		else return &range;
+	}
+}
@@ -0,0 +1,108 @@
+#include <svm/core/Inliner.hpp>
+
+#include <svm/IO.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace svm::core {
+	void CallProfile::Clear() noexcept {
+		m_CallCounts.clear();
+	}
+	bool CallProfile::IsEmpty() const noexcept {
+		return m_CallCounts.empty();
+	}
+
+	void CallProfile::Load(const std::filesystem::path& path) {
+		std::ifstream stream(path);
+		if (!stream) throw std::runtime_error("Failed to open the file.");
+
+		Load(stream);
+	}
+	void CallProfile::Load(std::istream& stream) {
+		// Each line is '<module>\t<function>\t<count>'; empty lines and lines starting with '#' are skipped.
+		std::unordered_map<std::string, std::uint64_t> callCounts;
+		std::string line;
+		while (std::getline(stream, line)) {
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+			if (line.empty() || line.front() == '#') continue;
+
+			const std::size_t moduleEnd = line.find('\t');
+			const std::size_t functionEnd = moduleEnd == std::string::npos ? std::string::npos : line.find('\t', moduleEnd + 1);
+			if (functionEnd == std::string::npos || moduleEnd == 0 || functionEnd == moduleEnd + 1)
+				throw std::runtime_error("Failed to load the profile. Invalid format.");
+
+			std::uint64_t count = 0;
+			const char* const countBegin = line.data() + functionEnd + 1;
+			const char* const countEnd = line.data() + line.size();
+			const auto [countLast, error] = std::from_chars(countBegin, countEnd, count);
+			if (countBegin == countEnd || error != std::errc() || countLast != countEnd)
+				throw std::runtime_error("Failed to load the profile. Invalid format.");
+
+			std::uint64_t& callCount = callCounts[line.substr(0, functionEnd)];
+			callCount = std::max(callCount, callCount + count);
+		}
+
+		for (auto& [key, count] : callCounts) {
+			std::uint64_t& callCount = m_CallCounts[key];
+			callCount = std::max(callCount, callCount + count);
+		}
+	}
+	void CallProfile::Save(const std::filesystem::path& path) const {
+		std::ofstream stream(path);
+		if (!stream) throw std::runtime_error("Failed to open the file.");
+
+		Save(stream);
+	}
+	void CallProfile::Save(std::ostream& stream) const {
+		std::vector<std::pair<std::string_view, std::uint64_t>> callCounts(m_CallCounts.begin(), m_CallCounts.end());
+		std::sort(callCounts.begin(), callCounts.end());
+
+		for (const auto& [key, count] : callCounts) {
+			stream << key << '\t' << count << '\n';
+		}
+	}
+
+	std::uint64_t CallProfile::GetCallCount(const ModulePath& module, std::string_view function) const {
+		const auto iter = m_CallCounts.find(MakeKey(module, function));
+		if (iter == m_CallCounts.end()) return 0;
+		else return iter->second;
+	}
+	void CallProfile::SetCallCount(const ModulePath& module, std::string_view function, std::uint64_t count) {
+		m_CallCounts[MakeKey(module, function)] = count;
+	}
+	void CallProfile::AddCallCount(const ModulePath& module, std::string_view function, std::uint64_t count) {
+		std::uint64_t& callCount = m_CallCounts[MakeKey(module, function)];
+		callCount = std::max(callCount, callCount + count);
+	}
+
+	std::string CallProfile::MakeKey(const ModulePath& module, std::string_view function) {
+		std::ostringstream stream;
+		stream << module << '\t' << function;
+		return stream.str();
+	}
+}
+
+namespace svm::core {
+	std::ostream& operator<<(std::ostream& stream, const InlinerStatistics& statistics) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+		const std::string indent = defIndent + indentOnce;
+
+		stream << defIndent << "InlinerStatistics:\n"
+			<< indent << "Inlined: " << statistics.Inlined << '\n'
+			<< indent << "AddedInstructions: " << statistics.AddedInstructions << '\n'
+			<< indent << "RefusedRecursive: " << statistics.RefusedRecursive << '\n'
+			<< indent << "RefusedSize: " << statistics.RefusedSize << '\n'
+			<< indent << "RefusedBudget: " << statistics.RefusedBudget << '\n'
+			<< indent << "RefusedUnsupported: " << statistics.RefusedUnsupported;
+		return stream;
+	}
+}
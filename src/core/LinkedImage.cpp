@@ -0,0 +1,563 @@
+#include <svm/core/LinkedImage.hpp>
+
+#include <svm/Memory.hpp>
+#include <svm/Specification.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <variant>
+
+namespace svm::core {
+	bool LinkedModule::IsExternal() const noexcept {
+		return State == nullptr;
+	}
+}
+
+namespace svm::core {
+	namespace {
+		constexpr std::uint8_t s_Magic[] = { 0x74, 0x68, 0x6C, 0x69 };
+		constexpr std::uint16_t s_ImageVersion = 2;
+
+		class ImageReader final {
+		private:
+			const std::uint8_t* m_Data;
+			std::size_t m_Size;
+			std::size_t m_Cursor = 0;
+
+		public:
+			ImageReader(const std::uint8_t* data, std::size_t size) noexcept
+				: m_Data(data), m_Size(size) {}
+
+		public:
+			template<typename T>
+			bool Read(T& result) noexcept {
+				if (sizeof(result) > m_Size - m_Cursor) return false;
+
+				std::memcpy(&result, m_Data + m_Cursor, sizeof(result));
+				m_Cursor += sizeof(result);
+
+				if (sizeof(result) > 1 && GetEndian() != Endian::Little) {
+					result = ReverseEndian(result);
+				}
+				return true;
+			}
+			bool Read(std::size_t size, const std::uint8_t*& result) noexcept {
+				if (size > m_Size - m_Cursor) return false;
+
+				result = m_Data + m_Cursor;
+				m_Cursor += size;
+				return true;
+			}
+			bool Read(std::string& result) {
+				std::string_view view;
+				if (!Read(view)) return false;
+
+				result.assign(view);
+				return true;
+			}
+			bool Read(std::string_view& result) noexcept {
+				std::uint32_t length;
+				const std::uint8_t* begin;
+				if (!Read(length) || !Read(length, begin)) return false;
+
+				result = std::string_view(reinterpret_cast<const char*>(begin), length);
+				return true;
+			}
+
+			bool IsEnd() const noexcept {
+				return m_Cursor == m_Size;
+			}
+		};
+
+		class ImageWriter final {
+		private:
+			std::vector<std::uint8_t> m_Buffer;
+
+		public:
+			template<typename T>
+			void Write(T value) {
+				if (sizeof(value) > 1 && GetEndian() != Endian::Little) {
+					value = ReverseEndian(value);
+				}
+
+				const auto bytes = reinterpret_cast<const std::uint8_t*>(&value);
+				m_Buffer.insert(m_Buffer.end(), bytes, bytes + sizeof(value));
+			}
+			void Write(const std::uint8_t* data, std::size_t size) {
+				m_Buffer.insert(m_Buffer.end(), data, data + size);
+			}
+			void Write(std::string_view string) {
+				Write(static_cast<std::uint32_t>(string.size()));
+				Write(reinterpret_cast<const std::uint8_t*>(string.data()), string.size());
+			}
+			void Write(const std::string& string) {
+				Write(std::string_view(string));
+			}
+
+			const std::vector<std::uint8_t>& GetResult() const noexcept {
+				return m_Buffer;
+			}
+		};
+
+		std::string GetPathString(const ModulePath& path) {
+			if (std::holds_alternative<std::filesystem::path>(path)) return std::get<std::filesystem::path>(path).u8string();
+			else return std::get<std::string>(path);
+		}
+
+		template<typename T>
+		void WriteConstants(ImageWriter& writer, const ConstantPool& constantPool) {
+			const std::uint32_t offset = constantPool.GetOffset<T>();
+			const std::uint32_t count = constantPool.GetCount<T>();
+			writer.Write(count);
+			for (std::uint32_t i = 0; i < count; ++i) {
+				writer.Write(constantPool.GetConstant<T>(offset + i).Value);
+			}
+		}
+		template<typename T>
+		bool ReadConstants(ImageReader& reader, std::vector<T>& pool) {
+			std::uint32_t count;
+			const std::uint8_t* values;
+			if (!reader.Read(count) || !reader.Read(count * sizeof(T::Value), values)) return false;
+
+			ImageReader valueReader(values, count * sizeof(T::Value));
+			pool.resize(count);
+			for (T& object : pool) {
+				valueReader.Read(object.Value);
+			}
+			return true;
+		}
+
+		// Instructions are kept with their opcodes and operands apart and without offsets, which are recomputed.
+		void WriteInstructions(ImageWriter& writer, const Instructions& instructions) {
+			ImageWriter body;
+			const std::uint32_t labelCount = instructions.GetLabelCount();
+			body.Write(labelCount);
+			for (std::uint32_t i = 0; i < labelCount; ++i) {
+				body.Write(instructions.GetLabel(i));
+			}
+
+			const std::uint64_t instCount = instructions.GetInstructionCount();
+			body.Write(instCount);
+			for (std::uint64_t i = 0; i < instCount; ++i) {
+				body.Write(static_cast<std::uint8_t>(instructions.GetInstruction(i).OpCode));
+			}
+			for (std::uint64_t i = 0; i < instCount; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (inst.HasOperand()) {
+					body.Write(inst.Operand);
+				}
+			}
+
+			const auto& result = body.GetResult();
+			writer.Write(static_cast<std::uint64_t>(result.size()));
+			writer.Write(result.data(), result.size());
+		}
+		bool DecodeInstructions(const std::uint8_t* data, std::size_t size, std::pmr::memory_resource* arena, Instructions& result) {
+			ImageReader reader(data, size);
+
+			std::uint32_t labelCount;
+			if (!reader.Read(labelCount) || labelCount > size / sizeof(std::uint64_t)) return false;
+
+			ArenaVector<std::uint64_t> labels(labelCount, arena);
+			for (std::uint64_t& label : labels) {
+				if (!reader.Read(label)) return false;
+			}
+
+			std::uint64_t instCount;
+			const std::uint8_t* opCodes;
+			if (!reader.Read(instCount) || instCount > size || !reader.Read(static_cast<std::size_t>(instCount), opCodes)) return false;
+
+			ArenaVector<Instruction> insts(static_cast<std::size_t>(instCount), arena);
+			std::uint64_t nextOffset = 0;
+			for (std::size_t i = 0; i < insts.size(); ++i) {
+				Instruction& inst = insts[i];
+				if (opCodes[i] >= static_cast<std::uint8_t>(OpCode::Count)) return false;
+
+				inst.OpCode = static_cast<OpCode>(opCodes[i]);
+				inst.Offset = nextOffset;
+				nextOffset += inst.HasOperand() ? 5 : 1;
+
+				if (inst.HasOperand() && !reader.Read(inst.Operand)) return false;
+			}
+			if (!reader.IsEnd()) return false;
+
+			result = Instructions(std::move(labels), std::move(insts));
+			return true;
+		}
+		bool ReadInstructions(ImageReader& reader, bool isLazy, std::pmr::memory_resource* arena, Instructions& result) {
+			std::uint64_t size;
+			const std::uint8_t* data;
+			if (!reader.Read(size) || !reader.Read(static_cast<std::size_t>(size), data)) return false;
+			if (!isLazy) return DecodeInstructions(data, static_cast<std::size_t>(size), arena, result);
+
+			// Lazy bodies point into the image, which Loader keeps open while LazyFunctions is set.
+			result = Instructions([data, size = static_cast<std::size_t>(size)] {
+				Instructions instructions;
+				if (!DecodeInstructions(data, size, std::pmr::get_default_resource(), instructions))
+					throw std::runtime_error("Failed to load the image. Invalid format.");
+				return instructions;
+			});
+			return true;
+		}
+	}
+
+	void LinkedImage::Clear() noexcept {
+		m_File.Close();
+		m_Modules.clear();
+		m_Key = 0;
+	}
+
+	bool LinkedImage::Open(const std::filesystem::path& path) {
+		Clear();
+		if (!m_File.Open(path)) return false;
+
+		ImageReader reader(m_File.GetData(), m_File.GetSize());
+
+		const std::uint8_t* magic;
+		std::uint16_t imageVersion;
+		ShitBFVersion shitBFVersion;
+		std::uint32_t moduleCount;
+		if (!reader.Read(sizeof(s_Magic), magic) || !std::equal(magic, magic + sizeof(s_Magic), s_Magic) ||
+			!reader.Read(imageVersion) || imageVersion != s_ImageVersion ||
+			!reader.Read(shitBFVersion) || shitBFVersion != ShitBFVersion::Latest ||
+			!reader.Read(m_Key) || !reader.Read(moduleCount)) {
+			Clear();
+			return false;
+		}
+
+		std::vector<LinkedModule> modules(moduleCount);
+		for (LinkedModule& module : modules) {
+			std::uint8_t pathKind;
+			std::string modulePath;
+			std::uint64_t stateSize;
+			std::uint32_t dependencyCount, structCount;
+			if (!reader.Read(pathKind) || !reader.Read(modulePath) || !reader.Read(module.Hash) ||
+				!reader.Read(module.FileSize) || !reader.Read(module.FileTime) ||
+				!reader.Read(stateSize) || !reader.Read(static_cast<std::size_t>(stateSize), module.State) ||
+				!reader.Read(dependencyCount)) {
+				Clear();
+				return false;
+			}
+
+			if (pathKind == 0) {
+				module.Path = std::filesystem::u8path(modulePath);
+			} else {
+				module.Path = std::move(modulePath);
+			}
+			if (stateSize) {
+				module.StateSize = static_cast<std::size_t>(stateSize);
+			} else {
+				module.State = nullptr;
+			}
+
+			module.Dependencies.resize(dependencyCount);
+			for (std::uint32_t& dependency : module.Dependencies) {
+				if (!reader.Read(dependency) || dependency >= moduleCount) {
+					Clear();
+					return false;
+				}
+			}
+
+			if (!reader.Read(structCount)) {
+				Clear();
+				return false;
+			}
+
+			module.Structures.resize(structCount);
+			for (LinkedStructure& structure : module.Structures) {
+				std::uint32_t fieldCount;
+				if (!reader.Read(structure.Size) || !reader.Read(fieldCount)) {
+					Clear();
+					return false;
+				}
+
+				structure.Fields.resize(fieldCount);
+				for (LinkedField& field : structure.Fields) {
+					if (!reader.Read(field.Offset) || !reader.Read(field.Module) || !reader.Read(field.Structure) ||
+						(field.Module != NPos && field.Module >= moduleCount)) {
+						Clear();
+						return false;
+					}
+				}
+			}
+		}
+
+		m_Modules = std::move(modules);
+		return true;
+	}
+	void LinkedImage::Save(const std::filesystem::path& path) const {
+		ImageWriter writer;
+		writer.Write(s_Magic, sizeof(s_Magic));
+		writer.Write(s_ImageVersion);
+		writer.Write(ShitBFVersion::Latest);
+		writer.Write(CalcKey(m_Modules));
+		writer.Write(static_cast<std::uint32_t>(m_Modules.size()));
+
+		for (const LinkedModule& module : m_Modules) {
+			writer.Write(static_cast<std::uint8_t>(std::holds_alternative<std::string>(module.Path)));
+			writer.Write(GetPathString(module.Path));
+			writer.Write(module.Hash);
+			writer.Write(module.FileSize);
+			writer.Write(module.FileTime);
+			writer.Write(static_cast<std::uint64_t>(module.StateSize));
+			writer.Write(module.State, module.StateSize);
+
+			writer.Write(static_cast<std::uint32_t>(module.Dependencies.size()));
+			for (const std::uint32_t dependency : module.Dependencies) {
+				writer.Write(dependency);
+			}
+
+			writer.Write(static_cast<std::uint32_t>(module.Structures.size()));
+			for (const LinkedStructure& structure : module.Structures) {
+				writer.Write(structure.Size);
+				writer.Write(static_cast<std::uint32_t>(structure.Fields.size()));
+				for (const LinkedField& field : structure.Fields) {
+					writer.Write(field.Offset);
+					writer.Write(field.Module);
+					writer.Write(field.Structure);
+				}
+			}
+		}
+
+		const auto& result = writer.GetResult();
+		std::ofstream stream(path, std::ofstream::binary);
+		if (!stream) throw std::runtime_error("Failed to open the file.");
+
+		stream.write(reinterpret_cast<const char*>(result.data()), static_cast<std::streamsize>(result.size()));
+		if (!stream) throw std::runtime_error("Failed to write the file.");
+	}
+	bool LinkedImage::IsUpToDate() const {
+		if (CalcKey(m_Modules) != m_Key) return false;
+
+		for (const LinkedModule& module : m_Modules) {
+			if (module.IsExternal()) continue;
+			if (!std::holds_alternative<std::filesystem::path>(module.Path)) return false;
+
+			// Files are hashed again only when their size or modification time has changed.
+			const auto& path = std::get<std::filesystem::path>(module.Path);
+			std::uint64_t size, hash;
+			std::int64_t time;
+			if (!StatFile(path, size, time)) return false;
+			else if (size == module.FileSize && time == module.FileTime) continue;
+			else if (!HashFile(path, hash) || hash != module.Hash) return false;
+		}
+		return true;
+	}
+
+	const std::vector<LinkedModule>& LinkedImage::GetModules() const noexcept {
+		return m_Modules;
+	}
+	void LinkedImage::SetModules(std::vector<LinkedModule> newModules) noexcept {
+		m_Modules = std::move(newModules);
+	}
+	std::uint64_t LinkedImage::GetKey() const noexcept {
+		return m_Key;
+	}
+
+	std::uint64_t LinkedImage::Hash(const std::uint8_t* data, std::size_t size, std::uint64_t seed) noexcept {
+		std::uint64_t result = 0xCBF29CE484222325 ^ seed;
+		for (std::size_t i = 0; i < size; ++i) {
+			result ^= data[i];
+			result *= 0x100000001B3;
+		}
+		return result;
+	}
+	bool LinkedImage::HashFile(const std::filesystem::path& path, std::uint64_t& hash) noexcept {
+		MappedFile file;
+		if (file.Open(path)) {
+			hash = Hash(file.GetData(), file.GetSize());
+			return true;
+		}
+
+		try {
+			std::ifstream stream(path, std::ifstream::binary);
+			if (!stream) return false;
+
+			const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+			if (stream.bad()) return false;
+
+			hash = Hash(bytes.data(), bytes.size());
+			return true;
+		} catch (...) {
+			return false;
+		}
+	}
+
+	bool LinkedImage::StatFile(const std::filesystem::path& path, std::uint64_t& size, std::int64_t& time) noexcept {
+		std::error_code error;
+		const auto fileSize = std::filesystem::file_size(path, error);
+		if (error) return false;
+
+		const auto fileTime = std::filesystem::last_write_time(path, error);
+		if (error) return false;
+
+		size = static_cast<std::uint64_t>(fileSize);
+		time = static_cast<std::int64_t>(fileTime.time_since_epoch().count());
+		return true;
+	}
+
+	std::vector<std::uint8_t> LinkedImage::WriteState(const ByteFile& byteFile) {
+		ImageWriter writer;
+
+		const auto& dependencies = byteFile.GetDependencies();
+		writer.Write(static_cast<std::uint32_t>(dependencies.size()));
+		for (const Dependency& dependency : dependencies) {
+			writer.Write(dependency.Path);
+		}
+
+		const Mappings& mappings = byteFile.GetMappings();
+		const std::uint32_t structMappingCount = mappings.GetStructureMappingCount();
+		writer.Write(structMappingCount);
+		for (std::uint32_t i = 0; i < structMappingCount; ++i) {
+			const StructureMapping& mapping = mappings.GetStructureMapping(i);
+			writer.Write(mapping.Module);
+			writer.Write(mapping.Name);
+		}
+		const std::uint32_t funcMappingCount = mappings.GetFunctionMappingCount();
+		writer.Write(funcMappingCount);
+		for (std::uint32_t i = 0; i < funcMappingCount; ++i) {
+			const FunctionMapping& mapping = mappings.GetFunctionMapping(i);
+			writer.Write(mapping.Module);
+			writer.Write(mapping.Name);
+		}
+
+		const ConstantPool& constantPool = byteFile.GetConstantPool();
+		WriteConstants<IntObject>(writer, constantPool);
+		WriteConstants<LongObject>(writer, constantPool);
+		WriteConstants<SingleObject>(writer, constantPool);
+		WriteConstants<DoubleObject>(writer, constantPool);
+
+		// Structure fields only keep fundamental types; the types of structure fields are linked from LinkedField.
+		const Structures& structures = byteFile.GetStructures();
+		writer.Write(static_cast<std::uint32_t>(structures.size()));
+		for (const StructureInfo& structure : structures) {
+			writer.Write(structure.Name);
+			writer.Write(static_cast<std::uint32_t>(structure.Fields.size()));
+			for (const Field& field : structure.Fields) {
+				writer.Write(static_cast<std::uint32_t>(field.Type.IsFundamentalType() ? field.Type->Code : TypeCode::None));
+				writer.Write(field.Count);
+			}
+		}
+
+		const Functions& functions = byteFile.GetFunctions();
+		writer.Write(static_cast<std::uint32_t>(functions.size()));
+		for (const FunctionInfo& function : functions) {
+			writer.Write(function.Name);
+			writer.Write(function.Arity);
+			writer.Write(static_cast<std::uint8_t>(function.HasResult));
+			WriteInstructions(writer, function.Instructions);
+		}
+		WriteInstructions(writer, byteFile.GetEntrypoint());
+
+		return writer.GetResult();
+	}
+	bool LinkedImage::ReadState(const LinkedModule& module, const ParseOptions& options, ByteFile& result) {
+		ImageReader reader(module.State, module.StateSize);
+		result.Clear();
+		result.SetPath(module.Path);
+
+		std::pmr::memory_resource* const arena = options.ArenaAllocation ? result.GetArena() : std::pmr::get_default_resource();
+
+		std::uint32_t dependencyCount;
+		if (!reader.Read(dependencyCount)) return false;
+
+		std::vector<Dependency> dependencies(dependencyCount);
+		for (Dependency& dependency : dependencies) {
+			if (!reader.Read(dependency.Path)) return false;
+		}
+		result.SetDependencies(std::move(dependencies));
+
+		std::uint32_t structMappingCount, funcMappingCount;
+		if (!reader.Read(structMappingCount)) return false;
+
+		std::vector<StructureMapping> structMappings(structMappingCount);
+		for (StructureMapping& mapping : structMappings) {
+			std::string_view name;
+			if (!reader.Read(mapping.Module) || !reader.Read(name)) return false;
+
+			mapping.Name = result.Intern(name);
+			mapping.TempType.Name = mapping.Name;
+			mapping.TempType.Module = mapping.Module + 1;
+		}
+		if (!reader.Read(funcMappingCount)) return false;
+
+		std::vector<FunctionMapping> funcMappings(funcMappingCount);
+		for (FunctionMapping& mapping : funcMappings) {
+			std::string_view name;
+			if (!reader.Read(mapping.Module) || !reader.Read(name)) return false;
+
+			mapping.Name = result.Intern(name);
+		}
+		result.SetMappings({ std::move(structMappings), std::move(funcMappings) });
+
+		std::vector<IntObject> intPool;
+		std::vector<LongObject> longPool;
+		std::vector<SingleObject> singlePool;
+		std::vector<DoubleObject> doublePool;
+		if (!ReadConstants(reader, intPool) || !ReadConstants(reader, longPool) ||
+			!ReadConstants(reader, singlePool) || !ReadConstants(reader, doublePool)) return false;
+
+		result.SetConstantPool({ std::move(intPool), std::move(longPool), std::move(singlePool), std::move(doublePool) });
+
+		std::uint32_t structCount;
+		if (!reader.Read(structCount) || structCount != module.Structures.size()) return false;
+
+		Structures structures(structCount, arena);
+		for (std::uint32_t i = 0; i < structCount; ++i) {
+			StructureInfo& structure = structures[i];
+			std::string_view name;
+			std::uint32_t fieldCount;
+			if (!reader.Read(name) || !reader.Read(fieldCount) || fieldCount != module.Structures[i].Fields.size()) return false;
+
+			structure.Name = structure.Type.Name = result.Intern(name);
+			structure.Type.Code = static_cast<TypeCode>(i + static_cast<std::uint32_t>(TypeCode::Structure));
+			structure.Fields = ArenaVector<Field>(fieldCount, arena);
+			for (Field& field : structure.Fields) {
+				std::uint32_t typeCode;
+				if (!reader.Read(typeCode) || !reader.Read(field.Count)) return false;
+
+				field.Type = GetFundamentalType(static_cast<TypeCode>(typeCode));
+			}
+		}
+		result.SetStructures(std::move(structures));
+
+		std::uint32_t funcCount;
+		if (!reader.Read(funcCount)) return false;
+
+		Functions functions(funcCount, arena);
+		for (FunctionInfo& function : functions) {
+			std::string_view name;
+			std::uint8_t hasResult;
+			if (!reader.Read(name) || !reader.Read(function.Arity) || !reader.Read(hasResult) ||
+				!ReadInstructions(reader, options.LazyFunctions, arena, function.Instructions)) return false;
+
+			function.Name = result.Intern(name);
+			function.HasResult = hasResult != 0;
+		}
+		result.SetFunctions(std::move(functions));
+
+		Instructions entrypoint;
+		if (!ReadInstructions(reader, false, arena, entrypoint) || !reader.IsEnd()) return false;
+
+		result.SetEntrypoint(std::move(entrypoint));
+		return true;
+	}
+
+	std::uint64_t LinkedImage::CalcKey(const std::vector<LinkedModule>& modules) {
+		std::uint64_t result = 0;
+		for (const LinkedModule& module : modules) {
+			const std::string path = GetPathString(module.Path);
+			result = Hash(reinterpret_cast<const std::uint8_t*>(path.data()), path.size(), result);
+			result = Hash(reinterpret_cast<const std::uint8_t*>(&module.Hash), sizeof(module.Hash), result);
+		}
+		return result;
+	}
+}
@@ -0,0 +1,77 @@
+#include <svm/core/MappedFile.hpp>
+
+#include <svm/Predefined.hpp>
+
+#include <utility>
+
+#ifndef SVM_WINDOWS
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace svm::core {
+	MappedFile::MappedFile(MappedFile&& file) noexcept
+		: m_Data(std::exchange(file.m_Data, nullptr)), m_Size(std::exchange(file.m_Size, 0)) {}
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& file) noexcept {
+		Close();
+
+		m_Data = std::exchange(file.m_Data, nullptr);
+		m_Size = std::exchange(file.m_Size, 0);
+		return *this;
+	}
+
+	bool MappedFile::Open(const std::filesystem::path& path) noexcept {
+		Close();
+
+#ifndef SVM_WINDOWS
+		const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1) return false;
+
+		struct stat status;
+		if (fstat(fd, &status) == -1 || !S_ISREG(status.st_mode) || status.st_size <= 0) {
+			close(fd);
+			return false;
+		}
+
+		const auto size = static_cast<std::size_t>(status.st_size);
+		void* const data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED) return false;
+
+		madvise(data, size, MADV_SEQUENTIAL);
+		madvise(data, size, MADV_WILLNEED);
+
+		m_Data = data;
+		m_Size = size;
+		return true;
+#else
+		static_cast<void>(path);
+		return false;
+#endif
+	}
+	void MappedFile::Close() noexcept {
+		if (!m_Data) return;
+
+#ifndef SVM_WINDOWS
+		munmap(m_Data, m_Size);
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	bool MappedFile::IsOpen() const noexcept {
+		return m_Data != nullptr;
+	}
+	const std::uint8_t* MappedFile::GetData() const noexcept {
+		return static_cast<const std::uint8_t*>(m_Data);
+	}
+	std::size_t MappedFile::GetSize() const noexcept {
+		return m_Size;
+	}
+}
\ No newline at end of file
@@ -1,41 +1,71 @@
 #include <svm/core/Parser.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <fstream>
 #include <ios>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
 
 namespace svm::core {
 	void Parser::Clear() noexcept {
-		m_File.clear();
-		m_Cursor = 0;
+		CloseFile();
 
 		m_ByteFile.Clear();
 		m_ShitBFVersion = ShitBFVersion::Latest;
 		m_ShitBCVersion = ShitBCVersion::Latest;
+		m_Sections.clear();
+		m_FunctionSections.clear();
 	}
 
 	void Parser::Open(const std::filesystem::path& path) {
-		std::ifstream stream(path, std::ifstream::binary);
-		if (!stream) throw std::runtime_error("Failed to open the file.");
-
-		stream.seekg(0, std::ifstream::end);
-		const std::streamsize length = stream.tellg();
-		stream.seekg(0, std::ifstream::beg);
+		CloseFile();
 
-		if (length) {
-			std::vector<std::uint8_t> bytes(static_cast<std::size_t>(length));
-			stream.read(reinterpret_cast<char*>(bytes.data()), length);
-			if (stream.gcount() != length) throw std::runtime_error("Failed to read the file.");
+		if (m_FileMapping.Open(path)) {
+			m_File = m_FileMapping.GetData();
+			m_FileSize = m_FileMapping.GetSize();
+		} else {
+			std::ifstream stream(path, std::ifstream::binary);
+			if (!stream) throw std::runtime_error("Failed to open the file.");
 
-			m_File = std::move(bytes);
+			ReadStream(stream);
 		}
 
-		m_Cursor = 0;
-
 		m_ByteFile.Clear();
 		m_ByteFile.SetPath(std::filesystem::canonical(path));
 	}
+	void Parser::Open(const std::uint8_t* data, std::size_t size, ModulePath path) noexcept {
+		CloseFile();
+
+		m_File = data;
+		m_FileSize = size;
+
+		m_ByteFile.Clear();
+		m_ByteFile.SetPath(std::move(path));
+	}
+	void Parser::Open(std::vector<std::uint8_t> bytes, ModulePath path) noexcept {
+		CloseFile();
+
+		m_FileBuffer = std::move(bytes);
+		m_File = m_FileBuffer.data();
+		m_FileSize = m_FileBuffer.size();
+
+		m_ByteFile.Clear();
+		m_ByteFile.SetPath(std::move(path));
+	}
+	void Parser::Open(std::istream& stream, ModulePath path) {
+		CloseFile();
+		ReadStream(stream);
+
+		m_ByteFile.Clear();
+		m_ByteFile.SetPath(std::move(path));
+	}
 	void Parser::Parse() {
-		if (!m_File.size()) throw std::runtime_error("Failed to parse the file. Invalid format.");
+		if (!m_FileSize) throw std::runtime_error("Failed to parse the file. Invalid format.");
 
 		static constexpr std::uint8_t magic[] = { 0x74, 0x68, 0x74, 0x68 };
 		const auto [magicBegin, magicEnd] = ReadFile(4);
@@ -49,17 +79,80 @@ namespace svm::core {
 		if (m_ShitBCVersion > ShitBCVersion::Latest ||
 			m_ShitBCVersion < ShitBCVersion::Least) throw std::runtime_error("Failed to parse the file. Incompatible ShitBC version.");
 
+		m_Sections.clear();
+		m_FunctionSections.clear();
+		if (m_ShitBFVersion >= ShitBFVersion::v0_6_0) {
+			ParseSectionTable();
+		}
+
+		SeekSection(ShitBFSection::Dependencies);
 		ParseDependencies();
+		SeekSection(ShitBFSection::Mappings);
 		ParseMappings();
+		SeekSection(ShitBFSection::ConstantPool);
 		ParseConstantPool();
+		SeekSection(ShitBFSection::Structures);
 		ParseStructures();
+		SeekSection(ShitBFSection::Functions);
 		ParseFunctions();
+		SeekSection(ShitBFSection::Entrypoint);
 		m_ByteFile.SetEntrypoint(ParseInstructions());
 	}
 	ByteFile Parser::GetResult() noexcept {
+		CloseFile();
 		return std::move(m_ByteFile);
 	}
 
+	const ParseOptions& Parser::GetOptions() const noexcept {
+		return m_Options;
+	}
+	void Parser::SetOptions(const ParseOptions& newOptions) noexcept {
+		m_Options = newOptions;
+	}
+
+	void Parser::ReadStream(std::istream& stream) {
+		static constexpr std::size_t chunkSize = 64 * 1024;
+
+		std::vector<std::uint8_t> bytes;
+		std::size_t size = 0;
+		do {
+			bytes.resize(size + chunkSize);
+			stream.read(reinterpret_cast<char*>(bytes.data() + size), chunkSize);
+			size += static_cast<std::size_t>(stream.gcount());
+		} while (stream);
+
+		if (stream.bad()) throw std::runtime_error("Failed to read the file.");
+
+		bytes.resize(size);
+		m_FileBuffer = std::move(bytes);
+		m_File = m_FileBuffer.data();
+		m_FileSize = m_FileBuffer.size();
+	}
+	void Parser::CloseFile() noexcept {
+		m_FileMapping.Close();
+		m_FileBuffer.clear();
+		m_FileBuffer.shrink_to_fit();
+		m_FileOwner.reset();
+		m_File = nullptr;
+		m_FileSize = 0;
+		m_Cursor = 0;
+	}
+	std::shared_ptr<const void> Parser::ShareFile() {
+		if (m_FileOwner) return m_FileOwner;
+
+		if (m_FileMapping.IsOpen()) {
+			m_FileOwner = std::make_shared<MappedFile>(std::move(m_FileMapping));
+		} else if (!m_FileBuffer.empty()) {
+			m_FileOwner = std::make_shared<std::vector<std::uint8_t>>(std::move(m_FileBuffer));
+		}
+		return m_FileOwner;
+	}
+
+	std::pmr::memory_resource* Parser::GetArena() {
+		if (m_Options.ArenaAllocation) return m_ByteFile.GetArena();
+		else return std::pmr::get_default_resource();
+	}
+
 	Type Parser::GetType(Structures& structures, TypeCode code) {
 		auto result = GetFundamentalType(code);
 		if (result != NoneType) return result;
@@ -73,6 +166,44 @@ namespace svm::core {
 			- static_cast<std::uint32_t>(structures.size())).TempType;
 	}
 
+	void Parser::ParseSectionTable() {
+		m_Sections.resize(static_cast<std::size_t>(ShitBFSection::Count));
+		std::vector<bool> hasSections(m_Sections.size());
+
+		const auto sectionCount = ReadFile<std::uint32_t>();
+		for (std::uint32_t i = 0; i < sectionCount; ++i) {
+			const auto kind = ReadFile<std::uint32_t>();
+			const SectionInfo section = ReadSectionInfo();
+			if (kind >= m_Sections.size()) continue;
+
+			m_Sections[kind] = section;
+			hasSections[kind] = true;
+		}
+
+		if (std::find(hasSections.begin(), hasSections.end(), false) != hasSections.end())
+			throw std::runtime_error("Failed to parse the file. Invalid format.");
+
+		const auto funcCount = ReadFile<std::uint32_t>();
+		m_FunctionSections.resize(funcCount);
+		for (std::uint32_t i = 0; i < funcCount; ++i) {
+			m_FunctionSections[i] = ReadSectionInfo();
+		}
+	}
+	Parser::SectionInfo Parser::ReadSectionInfo() {
+		SectionInfo result;
+		result.Offset = ReadFile<std::uint64_t>();
+		result.Size = ReadFile<std::uint64_t>();
+
+		if (result.Offset > m_FileSize || result.Size > m_FileSize - result.Offset)
+			throw std::runtime_error("Failed to parse the file. Invalid format.");
+		return result;
+	}
+	void Parser::SeekSection(ShitBFSection section) noexcept {
+		if (m_Sections.empty()) return;
+
+		m_Cursor = static_cast<std::size_t>(m_Sections[static_cast<std::size_t>(section)].Offset);
+	}
+
 	void Parser::ParseDependencies() {
 		const auto depenCount = ReadFile<std::uint32_t>();
 		std::vector<Dependency> dependencies;
@@ -125,14 +256,14 @@ namespace svm::core {
 	}
 	void Parser::ParseStructures() {
 		const auto structCount = ReadFile<std::uint32_t>();
-		Structures structures(structCount);
+		Structures structures(structCount, GetArena());
 		for (std::uint32_t i = 0; i < structCount; ++i) {
-			structures[i].Type.Name = ReadFileString();
+			structures[i].Type.Name = ReadFileName();
 			structures[i].Name = structures[i].Type.Name;
 			structures[i].Type.Code = static_cast<TypeCode>(i + static_cast<std::uint32_t>(TypeCode::Structure));
 
 			const auto fieldCount = ReadFile<std::uint32_t>();
-			structures[i].Fields.resize(fieldCount);
+			structures[i].Fields = ArenaVector<Field>(fieldCount, GetArena());
 
 			for (std::uint32_t j = 0; j < fieldCount; ++j) {
 				Field& field = structures[i].Fields[j];
@@ -149,38 +280,196 @@ namespace svm::core {
 	}
 	void Parser::ParseFunctions() {
 		const auto funcCount = ReadFile<std::uint32_t>();
-		Functions functions(funcCount);
+		if (!m_Sections.empty() && funcCount != m_FunctionSections.size())
+			throw std::runtime_error("Failed to parse the file. Invalid format.");
+
+		Functions functions(funcCount, GetArena());
+		if (!m_Sections.empty() && m_Options.ParallelFunctions && !m_Options.LazyFunctions) {
+			ParseFunctionsParallel(functions);
+			m_ByteFile.SetFunctions(std::move(functions));
+			return;
+		}
+
 		for (std::uint32_t i = 0; i < funcCount; ++i) {
-			functions[i].Name = ReadFileString();
-			functions[i].Arity = ReadFile<std::uint16_t>();
-			functions[i].HasResult = ReadFile<bool>();
-			functions[i].Instructions = ParseInstructions();
+			if (m_Sections.empty()) {
+				ParseFunction(functions[i]);
+			} else {
+				ParseFunction(functions[i], m_FunctionSections[i]);
+			}
 		}
 
 		m_ByteFile.SetFunctions(std::move(functions));
 	}
+	void Parser::ParseFunction(FunctionInfo& function) {
+		ParseFunctionHeader(function);
+		function.Instructions = m_Options.LazyFunctions ? ParseInstructionsLazily() : ParseInstructions();
+	}
+	void Parser::ParseFunction(FunctionInfo& function, const SectionInfo& section) {
+		m_Cursor = static_cast<std::size_t>(section.Offset);
+		ParseFunctionHeader(function);
+
+		const auto end = static_cast<std::size_t>(section.Offset + section.Size);
+		if (m_Cursor > end) throw std::runtime_error("Failed to parse the file. Invalid format.");
+
+		function.Instructions = m_Options.LazyFunctions ? ParseInstructionsLazily(end) : ParseInstructions(end);
+		m_Cursor = end;
+	}
+	void Parser::ParseFunctionHeader(FunctionInfo& function) {
+		function.Name = ReadFileName();
+		function.Arity = ReadFile<std::uint16_t>();
+		function.HasResult = ReadFile<bool>();
+
+		if (m_ShitBFVersion >= ShitBFVersion::v0_7_0) {
+			// The stored frame info is only a claim of the file. Loader keeps it for verified functions, or computes it
+			// again when FrameAnalysis is set.
+			function.Frame.IsAnalyzed = ReadFile<bool>();
+			function.Frame.MaxStackSlots = ReadFile<std::uint32_t>();
+			function.Frame.MaxStackBytes = ReadFile<std::uint64_t>();
+			function.Frame.LocalCount = ReadFile<std::uint32_t>();
+			if (!function.Frame.IsAnalyzed) {
+				function.Frame = {};
+			}
+		}
+	}
+	void Parser::ParseFunctionsParallel(Functions& functions) {
+		const auto funcCount = functions.size();
+		std::vector<std::pair<std::size_t, std::size_t>> bodies(funcCount);
+		for (std::size_t i = 0; i < funcCount; ++i) {
+			const SectionInfo& section = m_FunctionSections[i];
+			m_Cursor = static_cast<std::size_t>(section.Offset);
+			ParseFunctionHeader(functions[i]);
+
+			const auto end = static_cast<std::size_t>(section.Offset + section.Size);
+			if (m_Cursor > end) throw std::runtime_error("Failed to parse the file. Invalid format.");
+
+			bodies[i] = { m_Cursor, end };
+		}
+
+		unsigned int threadCount = m_Options.ThreadCount ? m_Options.ThreadCount : std::thread::hardware_concurrency();
+		threadCount = static_cast<unsigned int>(std::min<std::size_t>(std::max(threadCount, 1u), funcCount));
+
+		std::atomic<std::size_t> next = 0;
+		std::exception_ptr exception;
+		std::mutex exceptionMutex;
+		const auto worker = [&] {
+			try {
+				for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < funcCount;) {
+					const auto [begin, end] = bodies[i];
+					functions[i].Instructions = DecodeInstructions(m_File + begin, end - begin, m_ShitBCVersion, m_Options);
+				}
+			} catch (...) {
+				next.store(funcCount, std::memory_order_relaxed);
+
+				std::lock_guard lock(exceptionMutex);
+				if (!exception) exception = std::current_exception();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned int i = 1; i < threadCount; ++i) {
+			try {
+				threads.emplace_back(worker);
+			} catch (const std::system_error&) {
+				break;
+			}
+		}
+		worker();
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		if (exception) std::rethrow_exception(exception);
+	}
 	Instructions Parser::ParseInstructions() {
+		return ParseInstructions(m_FileSize);
+	}
+	Instructions Parser::ParseInstructions(std::size_t end) {
+		const auto isInBounds = [this, end](std::uint64_t size) noexcept {
+			return m_Cursor <= end && size <= end - m_Cursor;
+		};
+
+		if (!isInBounds(sizeof(std::uint32_t))) throw std::runtime_error("Failed to parse the file. Invalid format.");
 		const auto labelCount = ReadFile<std::uint32_t>();
-		std::vector<std::uint64_t> labels(labelCount);
+		if (!isInBounds(labelCount * sizeof(std::uint64_t) + sizeof(std::uint64_t)))
+			throw std::runtime_error("Failed to parse the file. Invalid format.");
+
+		ArenaVector<std::uint64_t> labels(labelCount, GetArena());
 		for (std::uint32_t i = 0; i < labelCount; ++i) {
 			labels[i] = ReadFile<std::uint64_t>();
 		}
 
 		const auto instCount = ReadFile<std::uint64_t>();
-		std::vector<Instruction> insts(static_cast<std::size_t>(instCount));
+		if (!isInBounds(instCount)) throw std::runtime_error("Failed to parse the file. Invalid format.");
+		ArenaVector<Instruction> insts(static_cast<std::size_t>(instCount), GetArena());
 
 		std::uint64_t nextOffset = 0;
 		for (std::size_t i = 0; i < instCount; ++i) {
+			if (!isInBounds(sizeof(std::uint8_t))) throw std::runtime_error("Failed to parse the file. Invalid format.");
 			insts[i].OpCode = ReadOpCode();
+			if (insts[i].OpCode >= OpCode::Count) throw std::runtime_error("Failed to parse the file. Invalid format.");
 			insts[i].Offset = nextOffset;
 			if (insts[i].HasOperand()) {
+				if (!isInBounds(sizeof(std::uint32_t))) throw std::runtime_error("Failed to parse the file. Invalid format.");
 				insts[i].Operand = ReadFile<std::uint32_t>();
 				nextOffset += 4;
 			}
 			++nextOffset;
 		}
 
-		return { std::move(labels), std::move(insts) };
+		Instructions result(std::move(labels), std::move(insts));
+		if (m_Options.PeepholeOptimization) {
+			PeepholeOptimizer(m_Options.Peephole).Optimize(result);
+		}
+		return result;
+	}
+
+	Instructions Parser::ParseInstructionsLazily() {
+		const std::size_t begin = m_Cursor;
+		SkipInstructions();
+
+		const std::size_t end = m_Cursor;
+		m_Cursor = begin;
+		return ParseInstructionsLazily(end);
+	}
+	Instructions Parser::ParseInstructionsLazily(std::size_t end) {
+		const std::size_t begin = m_Cursor;
+		m_Cursor = end;
+
+		return Instructions([owner = ShareFile(), data = m_File + begin, size = end - begin, version = m_ShitBCVersion, options = m_Options] {
+			return DecodeInstructions(data, size, version, options);
+		});
+	}
+	void Parser::SkipInstructions() {
+		const auto isInBounds = [this](std::uint64_t size) noexcept {
+			return m_Cursor <= m_FileSize && size <= m_FileSize - m_Cursor;
+		};
+
+		if (!isInBounds(sizeof(std::uint32_t))) throw std::runtime_error("Failed to parse the file. Invalid format.");
+		const auto labelCount = ReadFile<std::uint32_t>();
+		if (!isInBounds(labelCount * sizeof(std::uint64_t) + sizeof(std::uint64_t)))
+			throw std::runtime_error("Failed to parse the file. Invalid format.");
+		m_Cursor += labelCount * sizeof(std::uint64_t);
+
+		const auto instCount = ReadFile<std::uint64_t>();
+		if (!isInBounds(instCount)) throw std::runtime_error("Failed to parse the file. Invalid format.");
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			if (!isInBounds(sizeof(std::uint8_t))) throw std::runtime_error("Failed to parse the file. Invalid format.");
+			const OpCode opCode = ReadOpCode();
+			if (opCode >= OpCode::Count) throw std::runtime_error("Failed to parse the file. Invalid format.");
+			if (Instruction(opCode).HasOperand()) {
+				if (!isInBounds(sizeof(std::uint32_t))) throw std::runtime_error("Failed to parse the file. Invalid format.");
+				m_Cursor += sizeof(std::uint32_t);
+			}
+		}
+	}
+	Instructions Parser::DecodeInstructions(const std::uint8_t* data, std::size_t size, ShitBCVersion version, const ParseOptions& options) {
+		Parser parser;
+		parser.m_File = data;
+		parser.m_FileSize = size;
+		parser.m_ShitBCVersion = version;
+		parser.m_Options.PeepholeOptimization = options.PeepholeOptimization;
+		parser.m_Options.Peephole = options.Peephole;
+		return parser.ParseInstructions();
 	}
 
 	OpCode Parser::ReadOpCode() noexcept {
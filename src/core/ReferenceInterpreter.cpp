@@ -0,0 +1,20 @@
+#include <svm/core/ReferenceInterpreter.hpp>
+
+#include <svm/IO.hpp>
+
+namespace svm::core {
+	std::ostream& operator<<(std::ostream& stream, const ReferenceValue& value) {
+		using svm::operator<<;
+
+		if (value.IsEmpty()) return stream << "none";
+
+		stream << value.Type->Name;
+		switch (value.Type->Code) {
+		case TypeCode::Int: return stream << ' ' << value.IntValue;
+		case TypeCode::Long: return stream << ' ' << value.LongValue;
+		case TypeCode::Single: return stream << ' ' << value.SingleValue;
+		case TypeCode::Double: return stream << ' ' << value.DoubleValue;
+		default: return stream << " 0x" << Hex(reinterpret_cast<std::uintptr_t>(value.PointerValue));
+		}
+	}
+}
@@ -0,0 +1,697 @@
+#include <svm/core/RegisterCode.hpp>
+
+#include <svm/IO.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <utility>
+
+namespace svm::core {
+	void RegisterCode::Clear() noexcept {
+		m_Labels.clear();
+		m_Instructions.clear();
+		m_Arguments.clear();
+		m_RegisterCount = 0;
+		m_RegisterFileSize = 0;
+		m_SpillSlotCount = 0;
+		m_Locations.clear();
+	}
+	bool RegisterCode::IsEmpty() const noexcept {
+		return m_Instructions.empty();
+	}
+
+	std::uint64_t RegisterCode::GetLabel(std::uint32_t index) const noexcept {
+		return m_Labels[index];
+	}
+	std::uint32_t RegisterCode::GetLabelCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Labels.size());
+	}
+	std::uint32_t RegisterCode::AddLabel(std::uint64_t index) {
+		m_Labels.push_back(index);
+		return static_cast<std::uint32_t>(m_Labels.size() - 1);
+	}
+	const RegisterInstruction& RegisterCode::GetInstruction(std::uint64_t index) const noexcept {
+		return m_Instructions[static_cast<std::size_t>(index)];
+	}
+	RegisterInstruction& RegisterCode::GetInstruction(std::uint64_t index) noexcept {
+		return m_Instructions[static_cast<std::size_t>(index)];
+	}
+	std::uint64_t RegisterCode::GetInstructionCount() const noexcept {
+		return m_Instructions.size();
+	}
+	std::uint64_t RegisterCode::AddInstruction(const RegisterInstruction& instruction) {
+		m_Instructions.push_back(instruction);
+		return m_Instructions.size() - 1;
+	}
+	const std::uint32_t* RegisterCode::GetArguments(const RegisterInstruction& instruction) const noexcept {
+		assert(instruction.OpCode == OpCode::Call);
+
+		return m_Arguments.data() + instruction.Left;
+	}
+	std::uint32_t RegisterCode::GetArgumentCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Arguments.size());
+	}
+	std::uint32_t RegisterCode::AddArgument(std::uint32_t reg) {
+		m_Arguments.push_back(reg);
+		return static_cast<std::uint32_t>(m_Arguments.size() - 1);
+	}
+
+	std::uint32_t RegisterCode::GetRegisterCount() const noexcept {
+		return m_RegisterCount;
+	}
+	void RegisterCode::SetRegisterCount(std::uint32_t newRegisterCount) noexcept {
+		m_RegisterCount = newRegisterCount;
+	}
+
+	bool RegisterCode::IsAllocated() const noexcept {
+		return !m_Locations.empty();
+	}
+	std::uint32_t RegisterCode::GetRegisterFileSize() const noexcept {
+		return m_RegisterFileSize;
+	}
+	std::uint32_t RegisterCode::GetSpillSlotCount() const noexcept {
+		return m_SpillSlotCount;
+	}
+	std::uint32_t RegisterCode::GetLocation(std::uint32_t reg) const noexcept {
+		return m_Locations[reg];
+	}
+	bool RegisterCode::IsSpilled(std::uint32_t location) const noexcept {
+		return location >= m_RegisterFileSize;
+	}
+	std::uint32_t RegisterCode::Allocate(std::uint32_t registerFileSize) {
+		assert(!IsAllocated());
+
+		const auto instCount = static_cast<std::size_t>(m_Instructions.size());
+		std::vector<std::vector<std::uint32_t>> uses(instCount);
+		std::vector<bool> isAddressTaken(m_RegisterCount);
+		for (std::size_t i = 0; i < instCount; ++i) {
+			GetUses(m_Instructions[i], uses[i]);
+			if (m_Instructions[i].OpCode == OpCode::Lea) {
+				isAddressTaken[m_Instructions[i].Left] = true;
+			}
+		}
+
+		// Backward liveness per instruction; jumps and fall through are the only edges.
+		const auto forEachSuccessor = [&](std::size_t index, auto&& function) {
+			const RegisterInstruction& inst = m_Instructions[index];
+			if (IsJump(inst.OpCode)) {
+				function(static_cast<std::size_t>(m_Labels[inst.Operand]));
+			}
+			if (inst.OpCode != OpCode::Jmp && inst.OpCode != OpCode::Ret && index + 1 < instCount) {
+				function(index + 1);
+			}
+		};
+		std::vector<std::vector<bool>> liveIn(instCount, std::vector<bool>(m_RegisterCount));
+		std::vector<std::vector<bool>> liveOut(instCount, std::vector<bool>(m_RegisterCount));
+		for (bool isChanged = true; isChanged;) {
+			isChanged = false;
+			for (std::size_t i = instCount; i-- > 0;) {
+				std::vector<bool> live(m_RegisterCount);
+				forEachSuccessor(i, [&](std::size_t successor) {
+					if (successor >= instCount) return;
+					for (std::uint32_t j = 0; j < m_RegisterCount; ++j) {
+						if (liveIn[successor][j]) {
+							live[j] = true;
+						}
+					}
+				});
+				liveOut[i] = live;
+
+				if (m_Instructions[i].Result != RegisterInstruction::NoRegister) {
+					live[m_Instructions[i].Result] = false;
+				}
+				for (const std::uint32_t reg : uses[i]) {
+					live[reg] = true;
+				}
+				if (live != liveIn[i]) {
+					liveIn[i] = std::move(live);
+					isChanged = true;
+				}
+			}
+		}
+
+		// Each register gets one interval covering every instruction it is live across.
+		constexpr std::uint64_t none = std::numeric_limits<std::uint64_t>::max();
+		std::vector<std::uint64_t> starts(m_RegisterCount, none), ends(m_RegisterCount, 0);
+		const auto extend = [&](std::uint32_t reg, std::uint64_t index) {
+			starts[reg] = std::min(starts[reg], index);
+			ends[reg] = std::max(ends[reg], index);
+		};
+		for (std::size_t i = 0; i < instCount; ++i) {
+			for (std::uint32_t j = 0; j < m_RegisterCount; ++j) {
+				if (liveIn[i][j] || liveOut[i][j]) {
+					extend(j, i);
+				}
+			}
+			if (m_Instructions[i].Result != RegisterInstruction::NoRegister) {
+				extend(m_Instructions[i].Result, i);
+			}
+		}
+
+		std::vector<std::uint32_t> intervals;
+		for (std::uint32_t i = 0; i < m_RegisterCount; ++i) {
+			if (starts[i] != none) {
+				intervals.push_back(i);
+			}
+		}
+		std::stable_sort(intervals.begin(), intervals.end(), [&](std::uint32_t lhs, std::uint32_t rhs) {
+			return starts[lhs] < starts[rhs];
+		});
+
+		// Linear scan; the interval ending last is spilled, and address-taken registers always live in memory.
+		m_Locations.assign(m_RegisterCount, RegisterInstruction::NoRegister);
+		m_RegisterFileSize = registerFileSize;
+		m_SpillSlotCount = 0;
+		std::uint32_t result = 0;
+		const auto spill = [&](std::uint32_t reg) {
+			m_Locations[reg] = registerFileSize + m_SpillSlotCount++;
+			++result;
+		};
+
+		std::vector<std::uint32_t> freeRegisters;
+		for (std::uint32_t i = registerFileSize; i-- > 0;) {
+			freeRegisters.push_back(i);
+		}
+		std::vector<std::uint32_t> active;
+		const auto activate = [&](std::uint32_t reg) {
+			active.insert(std::upper_bound(active.begin(), active.end(), reg, [&](std::uint32_t lhs, std::uint32_t rhs) {
+				return ends[lhs] < ends[rhs];
+			}), reg);
+		};
+		for (const std::uint32_t reg : intervals) {
+			const auto expired = std::find_if(active.begin(), active.end(), [&](std::uint32_t other) {
+				return ends[other] >= starts[reg];
+			});
+			for (auto iter = active.begin(); iter != expired; ++iter) {
+				freeRegisters.push_back(m_Locations[*iter]);
+			}
+			active.erase(active.begin(), expired);
+
+			if (isAddressTaken[reg]) {
+				spill(reg);
+			} else if (!freeRegisters.empty()) {
+				m_Locations[reg] = freeRegisters.back();
+				freeRegisters.pop_back();
+				activate(reg);
+			} else if (!active.empty() && ends[active.back()] > ends[reg]) {
+				const std::uint32_t victim = active.back();
+				active.pop_back();
+				m_Locations[reg] = m_Locations[victim];
+				spill(victim);
+				activate(reg);
+			} else {
+				spill(reg);
+			}
+		}
+
+		const auto relocate = [&](std::uint32_t& reg) {
+			if (reg != RegisterInstruction::NoRegister) {
+				reg = m_Locations[reg];
+			}
+		};
+		for (RegisterInstruction& inst : m_Instructions) {
+			relocate(inst.Result);
+			if (inst.OpCode != OpCode::Call) {
+				relocate(inst.Left);
+				relocate(inst.Right);
+			}
+		}
+		for (std::uint32_t& argument : m_Arguments) {
+			relocate(argument);
+		}
+		return result;
+	}
+
+	void RegisterCode::GetUses(const RegisterInstruction& instruction, std::vector<std::uint32_t>& result) const {
+		result.clear();
+		if (instruction.OpCode == OpCode::Call) {
+			const std::uint32_t* const arguments = GetArguments(instruction);
+			result.assign(arguments, arguments + instruction.Right);
+			return;
+		}
+
+		if (instruction.Left != RegisterInstruction::NoRegister) {
+			result.push_back(instruction.Left);
+		}
+		if (instruction.Right != RegisterInstruction::NoRegister) {
+			result.push_back(instruction.Right);
+		}
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const RegisterCode& registerCode) {
+		using svm::operator<<;
+
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+
+		const std::uint32_t labelCount = registerCode.GetLabelCount();
+		const std::uint64_t instCount = registerCode.GetInstructionCount();
+
+		stream << defIndent << "RegisterCode: " << instCount << '\n'
+			   << defIndent << indentOnce << "Registers: " << registerCode.GetRegisterCount();
+		if (registerCode.IsAllocated()) {
+			stream << " (" << registerCode.GetRegisterFileSize() << " in registers, "
+				   << registerCode.GetSpillSlotCount() << " spilled)";
+		}
+		stream << '\n' << defIndent << indentOnce << "Labels: " << labelCount;
+
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			stream << '\n' << defIndent << indentOnce << indentOnce << '[' << i << "]: " << registerCode.GetLabel(i);
+		}
+
+		// Virtual registers are printed as r<n>; after allocation, registers as %<n> and spill slots as [<n>].
+		const auto printRegister = [&](std::uint32_t reg) {
+			if (!registerCode.IsAllocated()) {
+				stream << 'r' << reg;
+			} else if (registerCode.IsSpilled(reg)) {
+				stream << '[' << reg - registerCode.GetRegisterFileSize() << ']';
+			} else {
+				stream << '%' << reg;
+			}
+		};
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const RegisterInstruction& inst = registerCode.GetInstruction(i);
+			stream << '\n' << defIndent << indentOnce << QWord(inst.Offset) << ": "
+				   << Mnemonics[static_cast<std::uint8_t>(inst.OpCode)];
+
+			const char* delimiter = " ";
+			if (inst.Result != RegisterInstruction::NoRegister) {
+				stream << delimiter;
+				printRegister(inst.Result);
+				delimiter = " <- ";
+			}
+			if (inst.OpCode == OpCode::Call) {
+				stream << delimiter << "0x" << Hex(inst.Operand) << '(';
+				const std::uint32_t* const arguments = registerCode.GetArguments(inst);
+				for (std::uint32_t j = 0; j < inst.Right; ++j) {
+					if (j) {
+						stream << ", ";
+					}
+					printRegister(arguments[j]);
+				}
+				stream << ')';
+				continue;
+			}
+			if (inst.Left != RegisterInstruction::NoRegister) {
+				stream << delimiter;
+				printRegister(inst.Left);
+				delimiter = ", ";
+			}
+			if (inst.Right != RegisterInstruction::NoRegister) {
+				stream << delimiter;
+				printRegister(inst.Right);
+				delimiter = ", ";
+			}
+			if (inst.OpCode != OpCode::Lea && HasOperand[static_cast<std::uint8_t>(inst.OpCode)]) {
+				stream << delimiter << "0x" << Hex(inst.Operand);
+			}
+		}
+
+		return stream;
+	}
+}
+
+namespace svm::core {
+	std::ostream& operator<<(std::ostream& stream, const RegisterCodeStatistics& statistics) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+		const std::string indent = defIndent + indentOnce;
+
+		stream << defIndent << "RegisterCodeStatistics:\n"
+			<< indent << "Functions: " << statistics.Functions << '\n'
+			<< indent << "StackInstructions: " << statistics.StackInstructions << '\n'
+			<< indent << "RegisterInstructions: " << statistics.RegisterInstructions << '\n'
+			<< indent << "Moves: " << statistics.Moves << '\n'
+			<< indent << "SpilledRegisters: " << statistics.SpilledRegisters;
+		return stream;
+	}
+}
+
+namespace svm::core {
+	struct RegisterTranslator::State final {
+		std::uint32_t StackBase = 0;
+		std::uint32_t Scratch = 0;
+		bool IsAddressTaken = false;
+		std::uint64_t BlockBegin = 0;
+		std::uint64_t Offset = 0;
+		std::vector<std::uint32_t> Stack;
+
+		bool IsReferenced(std::uint32_t reg, std::size_t depth) const noexcept {
+			return std::find(Stack.begin(), Stack.begin() + depth, reg) != Stack.begin() + depth;
+		}
+	};
+}
+
+namespace svm::core {
+	RegisterTranslator::RegisterTranslator(const ByteFile& byteFile) noexcept
+		: m_ByteFile(byteFile) {}
+	RegisterTranslator::RegisterTranslator(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions) noexcept
+		: m_ByteFile(byteFile), m_MappedFunctions(std::move(mappedFunctions)) {}
+
+	bool RegisterTranslator::Translate(const FunctionInfo& function, RegisterCode& result) {
+		// The stack depth must be the same on every path, which only verified functions guarantee.
+		if (function.Verification == VerificationLevel::Unverified) return false;
+
+		return Translate(function.Instructions, function.Arity, function.HasResult, result);
+	}
+	bool RegisterTranslator::Translate(const Instructions& instructions, std::uint16_t arity, bool hasResult, RegisterCode& result) {
+		result.Clear();
+
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			if (instructions.GetLabel(i) >= instCount) return false;
+		}
+
+		// Locals keep their index as register; stack slots follow them, and one scratch register breaks move cycles.
+		State state;
+		state.StackBase = arity;
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode >= OpCode::Count || (IsJump(inst.OpCode) && inst.Operand >= labelCount)) return false;
+			if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Store || inst.OpCode == OpCode::Lea) {
+				state.StackBase = std::max(state.StackBase, inst.Operand + 1);
+			}
+			if (inst.OpCode == OpCode::Lea) {
+				state.IsAddressTaken = true;
+			}
+		}
+
+		const ControlFlowGraph graph(instructions);
+		std::vector<std::uint32_t> depths;
+		std::uint32_t maxDepth = 0;
+		if (!GetStackDepths(instructions, graph, depths, maxDepth)) return false;
+
+		state.Scratch = state.StackBase + maxDepth;
+		result.SetRegisterCount(state.Scratch + 1);
+
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		std::vector<std::uint64_t> blockBegins(blockCount);
+		for (std::uint32_t block = 0; block < blockCount; ++block) {
+			blockBegins[block] = result.GetInstructionCount();
+			if (!graph.IsReachable(block)) continue;
+
+			state.BlockBegin = blockBegins[block];
+			state.Stack.clear();
+			for (std::uint32_t i = 0; i < depths[block]; ++i) {
+				state.Stack.push_back(state.StackBase + i);
+			}
+
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				if (!Interpret(instructions.GetInstruction(i), hasResult, state, result)) {
+					result.Clear();
+					return false;
+				}
+			}
+
+			const OpCode last = instructions.GetInstruction(range.End - 1).OpCode;
+			if (!IsTerminator(last) && !IsConditionalJump(last)) {
+				Materialize(state, result);
+			}
+		}
+
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			result.AddLabel(blockBegins[graph.GetBlockOf(instructions.GetLabel(i))]);
+		}
+
+		const std::uint64_t regInstCount = result.GetInstructionCount();
+		++m_Statistics.Functions;
+		m_Statistics.StackInstructions += instCount;
+		m_Statistics.RegisterInstructions += regInstCount;
+		for (std::uint64_t i = 0; i < regInstCount; ++i) {
+			if (result.GetInstruction(i).OpCode == OpCode::Copy) {
+				++m_Statistics.Moves;
+			}
+		}
+		if (m_RegisterFileSize) {
+			m_Statistics.SpilledRegisters += result.Allocate(m_RegisterFileSize);
+		}
+		return true;
+	}
+
+	std::uint32_t RegisterTranslator::GetRegisterFileSize() const noexcept {
+		return m_RegisterFileSize;
+	}
+	void RegisterTranslator::SetRegisterFileSize(std::uint32_t newRegisterFileSize) noexcept {
+		m_RegisterFileSize = newRegisterFileSize;
+	}
+	const RegisterCodeStatistics& RegisterTranslator::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	void RegisterTranslator::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+
+	bool RegisterTranslator::GetStackDepths(const Instructions& instructions, const ControlFlowGraph& graph,
+		std::vector<std::uint32_t>& depths, std::uint32_t& maxDepth) const {
+		constexpr std::uint32_t unvisited = std::numeric_limits<std::uint32_t>::max();
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		depths.assign(blockCount, unvisited);
+		maxDepth = 0;
+		if (blockCount == 0) return true;
+
+		std::vector<std::uint32_t> worklist{ 0 };
+		depths[0] = 0;
+		while (!worklist.empty()) {
+			const std::uint32_t block = worklist.back();
+			worklist.pop_back();
+
+			std::uint32_t depth = depths[block];
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				std::uint32_t popCount = 0, pushCount = 0;
+				if (inst.OpCode == OpCode::Call) {
+					FunctionSignature signature;
+					if (!GetSignature(inst.Operand, signature)) return false;
+
+					popCount = signature.Arity;
+					pushCount = signature.HasResult;
+				} else if (!GetStackEffect(inst.OpCode, popCount, pushCount)) return false;
+
+				if (depth < popCount) return false;
+				depth = depth - popCount + pushCount;
+				maxDepth = std::max(maxDepth, depth);
+			}
+
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				if (depths[successor] == unvisited) {
+					depths[successor] = depth;
+					worklist.push_back(successor);
+				} else if (depths[successor] != depth) return false;
+			}
+		}
+		return true;
+	}
+	bool RegisterTranslator::Interpret(const Instruction& instruction, bool hasResult, State& state, RegisterCode& result) const {
+		std::vector<std::uint32_t>& stack = state.Stack;
+		RegisterInstruction inst;
+		inst.OpCode = instruction.OpCode;
+		inst.Operand = instruction.Operand;
+		inst.Offset = instruction.Offset;
+		state.Offset = instruction.Offset;
+
+		// Before a register is written, stack slots still referring to it are moved to their own registers.
+		const auto define = [&](std::uint32_t reg, std::size_t popCount) {
+			if (state.IsReferenced(reg, stack.size() - popCount)) {
+				Materialize(state, result);
+			}
+		};
+
+		switch (instruction.OpCode) {
+		case OpCode::Nop:
+			return true;
+
+		case OpCode::Load:
+			// Loads only alias the local while no pointer to a local may write it behind our back.
+			if (!state.IsAddressTaken) {
+				stack.push_back(instruction.Operand);
+				return true;
+			}
+
+			inst.OpCode = OpCode::Copy;
+			inst.Left = instruction.Operand;
+			inst.Result = state.StackBase + static_cast<std::uint32_t>(stack.size());
+			define(inst.Result, 0);
+			result.AddInstruction(inst);
+			stack.push_back(inst.Result);
+			return true;
+
+		case OpCode::Store: {
+			if (stack.empty()) return false;
+			if (state.IsReferenced(instruction.Operand, stack.size() - 1)) {
+				Materialize(state, result);
+			}
+
+			const std::uint32_t source = stack.back();
+			stack.pop_back();
+
+			// A temporary computed right before is written to the local directly.
+			const std::uint64_t count = result.GetInstructionCount();
+			if (count > state.BlockBegin && source >= state.StackBase && source != state.Scratch &&
+				result.GetInstruction(count - 1).Result == source && !state.IsReferenced(source, stack.size())) {
+				result.GetInstruction(count - 1).Result = instruction.Operand;
+				return true;
+			}
+
+			inst.OpCode = OpCode::Copy;
+			inst.Result = instruction.Operand;
+			inst.Left = source;
+			result.AddInstruction(inst);
+			return true;
+		}
+
+		case OpCode::Lea:
+			inst.Left = instruction.Operand;
+			inst.Result = state.StackBase + static_cast<std::uint32_t>(stack.size());
+			define(inst.Result, 0);
+			result.AddInstruction(inst);
+			stack.push_back(inst.Result);
+			return true;
+
+		case OpCode::Pop:
+			if (stack.empty()) return false;
+			stack.pop_back();
+			return true;
+
+		case OpCode::Copy:
+			if (stack.empty()) return false;
+			stack.push_back(stack.back());
+			return true;
+
+		case OpCode::Swap:
+			if (stack.size() < 2) return false;
+			std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+			return true;
+
+		case OpCode::Jmp:
+			Materialize(state, result);
+			result.AddInstruction(inst);
+			return true;
+
+		case OpCode::Je:
+		case OpCode::Jne:
+		case OpCode::Ja:
+		case OpCode::Jae:
+		case OpCode::Jb:
+		case OpCode::Jbe:
+			if (stack.empty()) return false;
+			Materialize(state, result);
+			inst.Left = stack.back();
+			stack.pop_back();
+			result.AddInstruction(inst);
+			return true;
+
+		case OpCode::Call: {
+			FunctionSignature signature;
+			if (!GetSignature(instruction.Operand, signature) || stack.size() < signature.Arity) return false;
+
+			const std::size_t depth = stack.size() - signature.Arity;
+			if (signature.HasResult) {
+				inst.Result = state.StackBase + static_cast<std::uint32_t>(depth);
+				define(inst.Result, signature.Arity);
+			}
+
+			inst.Left = result.GetArgumentCount();
+			inst.Right = signature.Arity;
+			for (std::size_t i = depth; i < stack.size(); ++i) {
+				result.AddArgument(stack[i]);
+			}
+			stack.resize(depth);
+			result.AddInstruction(inst);
+			if (signature.HasResult) {
+				stack.push_back(inst.Result);
+			}
+			return true;
+		}
+
+		case OpCode::Ret:
+			if (hasResult) {
+				if (stack.empty()) return false;
+				inst.Left = stack.back();
+			}
+			result.AddInstruction(inst);
+			return true;
+
+		default: {
+			std::uint32_t popCount = 0, pushCount = 0;
+			if (!GetStackEffect(instruction.OpCode, popCount, pushCount) || pushCount > 1 || stack.size() < popCount) return false;
+
+			const std::size_t depth = stack.size() - popCount;
+			if (pushCount) {
+				inst.Result = state.StackBase + static_cast<std::uint32_t>(depth);
+				define(inst.Result, popCount);
+			}
+			if (popCount >= 1) {
+				inst.Left = stack[depth];
+			}
+			if (popCount >= 2) {
+				inst.Right = stack[depth + 1];
+			}
+			stack.resize(depth);
+			result.AddInstruction(inst);
+			if (pushCount) {
+				stack.push_back(inst.Result);
+			}
+			return true;
+		}
+		}
+	}
+	void RegisterTranslator::Materialize(State& state, RegisterCode& result) const {
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> moves; // (destination, source)
+		for (std::size_t i = 0; i < state.Stack.size(); ++i) {
+			const auto reg = state.StackBase + static_cast<std::uint32_t>(i);
+			if (state.Stack[i] != reg) {
+				moves.emplace_back(reg, state.Stack[i]);
+				state.Stack[i] = reg;
+			}
+		}
+
+		// Moves are sequentialized so that no source is overwritten before it is read.
+		const auto emit = [&](std::uint32_t destination, std::uint32_t source) {
+			RegisterInstruction inst;
+			inst.OpCode = OpCode::Copy;
+			inst.Result = destination;
+			inst.Left = source;
+			inst.Offset = state.Offset;
+			result.AddInstruction(inst);
+		};
+		while (!moves.empty()) {
+			const auto ready = std::find_if(moves.begin(), moves.end(), [&](const auto& move) {
+				return std::none_of(moves.begin(), moves.end(), [&](const auto& other) {
+					return other.second == move.first;
+				});
+			});
+			if (ready != moves.end()) {
+				emit(ready->first, ready->second);
+				moves.erase(ready);
+				continue;
+			}
+
+			// Every destination is still read by another move, so one of them is saved first.
+			const std::uint32_t saved = moves.front().first;
+			emit(state.Scratch, saved);
+			for (auto& move : moves) {
+				if (move.second == saved) {
+					move.second = state.Scratch;
+				}
+			}
+		}
+	}
+	bool RegisterTranslator::GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept {
+		const Functions& functions = m_ByteFile.GetFunctions();
+		if (function < functions.size()) {
+			result.Arity = functions[function].Arity;
+			result.HasResult = functions[function].HasResult;
+			return true;
+		}
+
+		const std::size_t mapping = function - functions.size();
+		if (mapping >= m_MappedFunctions.size()) return false;
+
+		result = m_MappedFunctions[mapping];
+		return true;
+	}
+}
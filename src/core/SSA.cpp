@@ -0,0 +1,1918 @@
+#include <svm/core/SSA.hpp>
+
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/IO.hpp>
+#include <svm/core/Verifier.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace svm::core {
+	void SSAFunction::Clear() noexcept {
+		m_Values.clear();
+		m_Blocks.clear();
+		m_Arity = 0;
+		m_HasResult = false;
+	}
+	void SSAFunction::Reset(std::uint16_t arity, bool hasResult) {
+		Clear();
+		m_Arity = arity;
+		m_HasResult = hasResult;
+
+		// Value 0 is the undefined value and values 1 to arity are the parameters.
+		m_Values.emplace_back();
+		for (std::uint16_t i = 0; i < arity; ++i) {
+			SSAValue& value = m_Values.emplace_back();
+			value.Kind = SSAValueKind::Parameter;
+			value.Operand = i;
+			value.HasResult = true;
+		}
+	}
+	bool SSAFunction::IsEmpty() const noexcept {
+		return m_Blocks.empty();
+	}
+
+	std::uint16_t SSAFunction::GetArity() const noexcept {
+		return m_Arity;
+	}
+	bool SSAFunction::HasResult() const noexcept {
+		return m_HasResult;
+	}
+
+	const SSAValue& SSAFunction::GetValue(std::uint32_t index) const noexcept {
+		return m_Values[index];
+	}
+	SSAValue& SSAFunction::GetValue(std::uint32_t index) noexcept {
+		return m_Values[index];
+	}
+	std::uint32_t SSAFunction::GetValueCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Values.size());
+	}
+	std::uint32_t SSAFunction::AddValue(SSAValue value) {
+		m_Values.push_back(std::move(value));
+		return static_cast<std::uint32_t>(m_Values.size() - 1);
+	}
+
+	const SSABlock& SSAFunction::GetBlock(std::uint32_t index) const noexcept {
+		return m_Blocks[index];
+	}
+	SSABlock& SSAFunction::GetBlock(std::uint32_t index) noexcept {
+		return m_Blocks[index];
+	}
+	std::uint32_t SSAFunction::GetBlockCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Blocks.size());
+	}
+	std::uint32_t SSAFunction::AddBlock() {
+		m_Blocks.emplace_back();
+		return static_cast<std::uint32_t>(m_Blocks.size() - 1);
+	}
+	void SSAFunction::InsertBlock(std::uint32_t index) {
+		const auto shift = [index](std::uint32_t& block) {
+			if (block != NPos && block >= index) {
+				++block;
+			}
+		};
+		for (SSABlock& block : m_Blocks) {
+			std::for_each(block.Predecessors.begin(), block.Predecessors.end(), shift);
+			std::for_each(block.Successors.begin(), block.Successors.end(), shift);
+		}
+		for (SSAValue& value : m_Values) {
+			shift(value.Block);
+		}
+		m_Blocks.emplace(m_Blocks.begin() + index);
+	}
+	void SSAFunction::RemoveBlocks(const std::vector<bool>& isRemoved) {
+		const auto blockCount = static_cast<std::uint32_t>(m_Blocks.size());
+		std::vector<std::uint32_t> blockMap(blockCount, NPos);
+		std::uint32_t count = 0;
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			if (!isRemoved[i]) {
+				blockMap[i] = count++;
+			}
+		}
+
+		// Edges from removed blocks disappear together with their phi operands.
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			if (isRemoved[i]) continue;
+
+			SSABlock& block = m_Blocks[i];
+			for (std::size_t j = block.Predecessors.size(); j-- > 0;) {
+				if (!isRemoved[block.Predecessors[j]]) continue;
+
+				block.Predecessors.erase(block.Predecessors.begin() + j);
+				for (const std::uint32_t phi : block.Phis) {
+					std::vector<std::uint32_t>& operands = m_Values[phi].Operands;
+					operands.erase(operands.begin() + j);
+				}
+			}
+			block.Successors.erase(std::remove_if(block.Successors.begin(), block.Successors.end(), [&](std::uint32_t successor) {
+				return isRemoved[successor];
+			}), block.Successors.end());
+
+			for (std::uint32_t& predecessor : block.Predecessors) {
+				predecessor = blockMap[predecessor];
+			}
+			for (std::uint32_t& successor : block.Successors) {
+				successor = blockMap[successor];
+			}
+		}
+		for (SSAValue& value : m_Values) {
+			if (value.Block != NPos) {
+				value.Block = blockMap[value.Block];
+			}
+		}
+
+		std::vector<SSABlock> blocks;
+		blocks.reserve(count);
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			if (!isRemoved[i]) {
+				blocks.push_back(std::move(m_Blocks[i]));
+			}
+		}
+		m_Blocks = std::move(blocks);
+	}
+	void SSAFunction::AddEdge(std::uint32_t from, std::uint32_t to) {
+		m_Blocks[from].Successors.push_back(to);
+		m_Blocks[to].Predecessors.push_back(from);
+	}
+	void SSAFunction::RemoveEdge(std::uint32_t from, std::uint32_t to) {
+		std::vector<std::uint32_t>& successors = m_Blocks[from].Successors;
+		successors.erase(std::find(successors.begin(), successors.end(), to));
+
+		SSABlock& block = m_Blocks[to];
+		const auto index = std::find(block.Predecessors.begin(), block.Predecessors.end(), from) - block.Predecessors.begin();
+		block.Predecessors.erase(block.Predecessors.begin() + index);
+		for (const std::uint32_t phi : block.Phis) {
+			std::vector<std::uint32_t>& operands = m_Values[phi].Operands;
+			operands.erase(operands.begin() + index);
+		}
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const SSAFunction& function) {
+		using svm::operator<<;
+
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+		const std::string indent = defIndent + indentOnce + indentOnce;
+
+		const std::uint32_t blockCount = function.GetBlockCount();
+		stream << defIndent << "SSAFunction: " << blockCount << '\n'
+			   << defIndent << indentOnce << "Arity: " << function.GetArity() << '\n'
+			   << defIndent << indentOnce << "HasResult: " << std::boolalpha << function.HasResult() << std::noboolalpha;
+
+		const auto printOperand = [&](std::uint32_t index) {
+			const SSAValue& value = function.GetValue(index);
+			switch (value.Kind) {
+			case SSAValueKind::Undefined:
+				stream << "undef";
+				break;
+
+			case SSAValueKind::Parameter:
+				stream << "arg" << value.Operand;
+				break;
+
+			case SSAValueKind::Constant:
+				stream << (value.Type ? value.Type->Name : "?") << ' ';
+				if (value.Constant.Code == TypeCode::Single || value.Constant.Code == TypeCode::Double) {
+					stream << value.Constant.Real;
+				} else if (value.Constant.Code == TypeCode::Int) {
+					stream << static_cast<std::int32_t>(value.Constant.Integer);
+				} else {
+					stream << static_cast<std::int64_t>(value.Constant.Integer);
+				}
+				break;
+
+			default:
+				stream << 'v' << index;
+				break;
+			}
+		};
+		const auto printOperands = [&](const std::vector<std::uint32_t>& operands) {
+			for (std::size_t i = 0; i < operands.size(); ++i) {
+				stream << (i ? ", " : " ");
+				printOperand(operands[i]);
+			}
+		};
+
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			const SSABlock& block = function.GetBlock(i);
+			stream << '\n' << defIndent << indentOnce << "Block [" << i << "]:";
+			for (std::size_t j = 0; j < block.Predecessors.size(); ++j) {
+				stream << (j ? ", [" : " <- [") << block.Predecessors[j] << ']';
+			}
+
+			for (const std::uint32_t phi : block.Phis) {
+				const SSAValue& value = function.GetValue(phi);
+				stream << '\n' << indent << 'v' << phi << ": " << (value.Type ? value.Type->Name : "?") << " = phi";
+				printOperands(value.Operands);
+			}
+			for (const std::uint32_t index : block.Values) {
+				const SSAValue& value = function.GetValue(index);
+				stream << '\n' << indent;
+				if (value.HasResult) {
+					stream << 'v' << index << ": " << (value.Type ? value.Type->Name : "?") << " = ";
+				}
+				stream << Mnemonics[static_cast<std::uint8_t>(value.OpCode)];
+
+				if (IsJump(value.OpCode)) {
+					for (std::size_t j = 0; j < block.Successors.size(); ++j) {
+						stream << (j ? ", [" : " [") << block.Successors[j] << ']';
+					}
+					if (!value.Operands.empty()) {
+						stream << ',';
+					}
+				} else if (HasOperand[static_cast<std::uint8_t>(value.OpCode)]) {
+					stream << " 0x" << Hex(value.Operand);
+					if (!value.Operands.empty()) {
+						stream << ',';
+					}
+				}
+				printOperands(value.Operands);
+			}
+		}
+		return stream;
+	}
+}
+
+namespace svm::core {
+	std::ostream& operator<<(std::ostream& stream, const SSAStatistics& statistics) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+		const std::string indent = defIndent + indentOnce;
+
+		stream << defIndent << "SSAStatistics:\n"
+			<< indent << "Functions: " << statistics.Functions << '\n'
+			<< indent << "Rejected: " << statistics.Rejected << '\n'
+			<< indent << "OriginalCount: " << statistics.OriginalCount << '\n'
+			<< indent << "ResultCount: " << statistics.ResultCount << '\n'
+			<< indent << "FoldedValues: " << statistics.FoldedValues << '\n'
+			<< indent << "RemovedBranches: " << statistics.RemovedBranches << '\n'
+			<< indent << "RemovedBlocks: " << statistics.RemovedBlocks << '\n'
+			<< indent << "NumberedValues: " << statistics.NumberedValues << '\n'
+			<< indent << "HoistedValues: " << statistics.HoistedValues << '\n'
+			<< indent << "DeadValues: " << statistics.DeadValues << '\n'
+			<< indent << "AddedConstants: " << statistics.AddedConstants;
+		return stream;
+	}
+}
+
+namespace svm::core {
+	struct SSAOptimizer::BuildState final {
+		std::uint32_t Block = 0;
+		std::vector<std::uint32_t> Locals;
+		std::vector<std::uint32_t> Stack;
+	};
+
+	namespace {
+		enum class LatticeState : std::uint8_t {
+			Top,
+			Constant,
+			Order,
+			Bottom,
+		};
+
+		// Comparisons are tracked as the order of their operands; only conditional jumps consume it.
+		struct Lattice final {
+			LatticeState State = LatticeState::Top;
+			detail::ConstantValue Value;
+			int Order = 0;
+
+			bool operator==(const Lattice& lattice) const noexcept {
+				return State == lattice.State && Value == lattice.Value && Order == lattice.Order;
+			}
+			bool operator!=(const Lattice& lattice) const noexcept {
+				return !(*this == lattice);
+			}
+		};
+
+		Lattice Meet(const Lattice& lhs, const Lattice& rhs) noexcept {
+			if (lhs.State == LatticeState::Top) return rhs;
+			else if (rhs.State == LatticeState::Top || lhs == rhs) return lhs;
+
+			Lattice result;
+			result.State = LatticeState::Bottom;
+			return result;
+		}
+	}
+
+	namespace {
+		constexpr std::uint32_t NPos = SSAFunction::NPos;
+
+		bool IsPure(OpCode opCode) noexcept {
+			switch (opCode) {
+			case OpCode::Push:
+			case OpCode::FLea:
+			case OpCode::ALea:
+			case OpCode::Null:
+			case OpCode::GCNull:
+				return true;
+
+			default:
+				return (opCode >= OpCode::Add && opCode <= OpCode::ICmp) || (opCode >= OpCode::ToB && opCode <= OpCode::ToP);
+			}
+		}
+		bool IsInteger(const TypeInfo* type) noexcept {
+			return type && (type->Code == TypeCode::Int || type->Code == TypeCode::Long);
+		}
+		bool IsCommutative(const SSAValue& value) noexcept {
+			switch (value.OpCode) {
+			case OpCode::Add:
+			case OpCode::Mul:
+			case OpCode::IMul:
+			case OpCode::And:
+			case OpCode::Or:
+			case OpCode::Xor:
+				return IsInteger(value.Type);
+
+			default:
+				return false;
+			}
+		}
+
+		// Values that cannot trap may be computed on paths that did not compute them before.
+		bool IsSpeculatable(const SSAFunction& function, const SSAValue& value) noexcept {
+			if (value.Kind != SSAValueKind::Instruction) return false;
+
+			switch (value.OpCode) {
+			case OpCode::FLea:
+			case OpCode::ALea:
+				return false;
+
+			case OpCode::Div:
+			case OpCode::Mod:
+			case OpCode::IDiv:
+			case OpCode::IMod: {
+				const SSAValue& divisor = function.GetValue(value.Operands[1]);
+				if (divisor.Kind != SSAValueKind::Constant) return false;
+
+				const bool isSigned = value.OpCode == OpCode::IDiv || value.OpCode == OpCode::IMod;
+				switch (divisor.Constant.Code) {
+				case TypeCode::Int:
+					return divisor.Constant.Integer != 0 && !(isSigned && divisor.Constant.Integer == 0xFFFFFFFF);
+				case TypeCode::Long:
+					return divisor.Constant.Integer != 0 && !(isSigned && divisor.Constant.Integer == ~std::uint64_t(0));
+				case TypeCode::Single:
+				case TypeCode::Double:
+					return true;
+				default:
+					return false;
+				}
+			}
+
+			default:
+				return IsPure(value.OpCode);
+			}
+		}
+
+		// Results whose type does not depend on the operands.
+		const TypeInfo* GetResultType(OpCode opCode) noexcept {
+			switch (opCode) {
+			case OpCode::Cmp:
+			case OpCode::ICmp:
+			case OpCode::ToB:
+			case OpCode::ToSh:
+			case OpCode::ToI:
+				return IntType.GetPointer();
+
+			case OpCode::ToL: return LongType.GetPointer();
+			case OpCode::ToSi: return SingleType.GetPointer();
+			case OpCode::ToD: return DoubleType.GetPointer();
+
+			case OpCode::ToP:
+			case OpCode::Null:
+			case OpCode::New:
+			case OpCode::FLea:
+			case OpCode::ANew:
+			case OpCode::ALea:
+				return PointerType.GetPointer();
+
+			case OpCode::GCNull:
+			case OpCode::GCNew:
+			case OpCode::AGCNew:
+				return GCPointerType.GetPointer();
+
+			case OpCode::APush:
+				return ArrayType.GetPointer();
+
+			default:
+				return nullptr;
+			}
+		}
+		bool IsTypePropagating(OpCode opCode) noexcept {
+			return opCode >= OpCode::Add && opCode <= OpCode::Sar;
+		}
+	}
+
+	namespace {
+		std::uint32_t Resolve(std::vector<std::uint32_t>& forward, std::uint32_t value) noexcept {
+			std::uint32_t root = value;
+			while (forward[root] != NPos) {
+				root = forward[root];
+			}
+			while (forward[value] != NPos) {
+				value = std::exchange(forward[value], root);
+			}
+			return root;
+		}
+
+		// Rewrites every operand through forward and drops the values that were replaced.
+		void ReplaceValues(SSAFunction& function, std::vector<std::uint32_t>& forward) {
+			const auto replace = [&](std::vector<std::uint32_t>& values) {
+				for (const std::uint32_t value : values) {
+					for (std::uint32_t& operand : function.GetValue(value).Operands) {
+						operand = Resolve(forward, operand);
+					}
+				}
+				values.erase(std::remove_if(values.begin(), values.end(), [&](std::uint32_t value) {
+					if (forward[value] == NPos) return false;
+
+					function.GetValue(value).Block = NPos;
+					return true;
+				}), values.end());
+			};
+			for (std::uint32_t i = 0; i < function.GetBlockCount(); ++i) {
+				replace(function.GetBlock(i).Phis);
+				replace(function.GetBlock(i).Values);
+			}
+		}
+
+		// Phis whose operands are all the same value, or the phi itself, are replaced by that value.
+		bool SimplifyPhis(SSAFunction& function) {
+			std::vector<std::uint32_t> forward(function.GetValueCount(), NPos);
+			bool isSimplified = false;
+			for (bool isChanged = true; isChanged;) {
+				isChanged = false;
+				for (std::uint32_t i = 0; i < function.GetBlockCount(); ++i) {
+					for (const std::uint32_t phi : function.GetBlock(i).Phis) {
+						if (forward[phi] != NPos) continue;
+
+						std::uint32_t same = NPos;
+						bool isTrivial = true;
+						for (std::uint32_t operand : function.GetValue(phi).Operands) {
+							operand = Resolve(forward, operand);
+							if (operand == phi || operand == same) continue;
+							if (same != NPos) {
+								isTrivial = false;
+								break;
+							}
+							same = operand;
+						}
+						if (isTrivial) {
+							forward[phi] = same == NPos ? SSAFunction::Undefined : same;
+							isChanged = isSimplified = true;
+						}
+					}
+				}
+			}
+
+			if (isSimplified) {
+				ReplaceValues(function, forward);
+			}
+			return isSimplified;
+		}
+
+		// Phis and instructions that can neither trap nor have side effects are removed unless something else depends on them.
+		std::uint64_t RemoveDeadValues(SSAFunction& function) {
+			std::vector<bool> isLive(function.GetValueCount());
+			std::vector<std::uint32_t> worklist;
+			for (std::uint32_t i = 0; i < function.GetBlockCount(); ++i) {
+				for (const std::uint32_t value : function.GetBlock(i).Values) {
+					if (!IsSpeculatable(function, function.GetValue(value))) {
+						isLive[value] = true;
+						worklist.push_back(value);
+					}
+				}
+			}
+			while (!worklist.empty()) {
+				const std::uint32_t value = worklist.back();
+				worklist.pop_back();
+
+				for (const std::uint32_t operand : function.GetValue(value).Operands) {
+					if (!isLive[operand]) {
+						isLive[operand] = true;
+						worklist.push_back(operand);
+					}
+				}
+			}
+
+			std::uint64_t count = 0;
+			const auto remove = [&](std::vector<std::uint32_t>& values) {
+				values.erase(std::remove_if(values.begin(), values.end(), [&](std::uint32_t value) {
+					if (isLive[value]) return false;
+
+					function.GetValue(value).Block = NPos;
+					++count;
+					return true;
+				}), values.end());
+			};
+			for (std::uint32_t i = 0; i < function.GetBlockCount(); ++i) {
+				remove(function.GetBlock(i).Phis);
+				remove(function.GetBlock(i).Values);
+			}
+			return count;
+		}
+
+		// Phis start without a type and lose it when their operands disagree, as in the verifier.
+		void InferTypes(SSAFunction& function) {
+			std::vector<bool> isKnown(function.GetValueCount());
+			for (std::uint32_t i = 0; i < function.GetValueCount(); ++i) {
+				const SSAValue& value = function.GetValue(i);
+				isKnown[i] = value.Kind != SSAValueKind::Phi && !(value.Kind == SSAValueKind::Instruction && IsTypePropagating(value.OpCode));
+			}
+
+			for (bool isChanged = true; isChanged;) {
+				isChanged = false;
+				const auto update = [&](std::uint32_t index, const TypeInfo* type) {
+					SSAValue& value = function.GetValue(index);
+					if (!isKnown[index] || value.Type != type) {
+						isKnown[index] = true;
+						value.Type = type;
+						isChanged = true;
+					}
+				};
+
+				for (std::uint32_t i = 0; i < function.GetBlockCount(); ++i) {
+					const SSABlock& block = function.GetBlock(i);
+					for (const std::uint32_t phi : block.Phis) {
+						const TypeInfo* type = nullptr;
+						bool isTyped = false, isConflicting = false;
+						for (const std::uint32_t operand : function.GetValue(phi).Operands) {
+							if (operand == SSAFunction::Undefined || !isKnown[operand]) continue;
+
+							const TypeInfo* const operandType = function.GetValue(operand).Type;
+							if (!isTyped) {
+								type = operandType;
+								isTyped = true;
+							} else if (type != operandType) {
+								isConflicting = true;
+							}
+						}
+						if (isTyped) {
+							update(phi, isConflicting ? nullptr : type);
+						}
+					}
+					for (const std::uint32_t index : block.Values) {
+						const SSAValue& value = function.GetValue(index);
+						if (!IsTypePropagating(value.OpCode)) continue;
+						if (std::any_of(value.Operands.begin(), value.Operands.end(), [&](std::uint32_t operand) {
+							return !isKnown[operand];
+						})) continue;
+
+						const TypeInfo* const lhs = function.GetValue(value.Operands.front()).Type;
+						update(index, lhs ? lhs : function.GetValue(value.Operands.back()).Type);
+					}
+				}
+			}
+		}
+	}
+
+	namespace {
+		void GetReversePostOrder(const SSAFunction& function, std::vector<std::uint32_t>& order) {
+			order.clear();
+			if (function.IsEmpty()) return;
+
+			std::vector<bool> isVisited(function.GetBlockCount());
+			std::vector<std::pair<std::uint32_t, std::size_t>> stack{ { 0, 0 } };
+			isVisited[0] = true;
+			while (!stack.empty()) {
+				const std::uint32_t block = stack.back().first;
+				const std::vector<std::uint32_t>& successors = function.GetBlock(block).Successors;
+				if (stack.back().second < successors.size()) {
+					const std::uint32_t successor = successors[stack.back().second++];
+					if (!isVisited[successor]) {
+						isVisited[successor] = true;
+						stack.emplace_back(successor, 0);
+					}
+				} else {
+					order.push_back(block);
+					stack.pop_back();
+				}
+			}
+			std::reverse(order.begin(), order.end());
+		}
+
+		// Cooper, Harvey and Kennedy's iterative algorithm; unreachable blocks have no dominator.
+		void GetDominators(const SSAFunction& function, const std::vector<std::uint32_t>& order, std::vector<std::uint32_t>& dominators) {
+			std::vector<std::uint32_t> positions(function.GetBlockCount(), NPos);
+			for (std::size_t i = 0; i < order.size(); ++i) {
+				positions[order[i]] = static_cast<std::uint32_t>(i);
+			}
+
+			dominators.assign(function.GetBlockCount(), NPos);
+			if (order.empty()) return;
+
+			dominators[0] = 0;
+			const auto intersect = [&](std::uint32_t lhs, std::uint32_t rhs) {
+				while (lhs != rhs) {
+					while (positions[lhs] > positions[rhs]) {
+						lhs = dominators[lhs];
+					}
+					while (positions[rhs] > positions[lhs]) {
+						rhs = dominators[rhs];
+					}
+				}
+				return lhs;
+			};
+			for (bool isChanged = true; isChanged;) {
+				isChanged = false;
+				for (std::size_t i = 1; i < order.size(); ++i) {
+					std::uint32_t dominator = NPos;
+					for (const std::uint32_t predecessor : function.GetBlock(order[i]).Predecessors) {
+						if (dominators[predecessor] == NPos) continue;
+						dominator = dominator == NPos ? predecessor : intersect(predecessor, dominator);
+					}
+					if (dominators[order[i]] != dominator) {
+						dominators[order[i]] = dominator;
+						isChanged = true;
+					}
+				}
+			}
+		}
+		bool Dominates(const std::vector<std::uint32_t>& dominators, std::uint32_t dominator, std::uint32_t block) noexcept {
+			while (block != dominator) {
+				if (block == 0 || dominators[block] == NPos) return false;
+				block = dominators[block];
+			}
+			return true;
+		}
+
+		struct Loop final {
+			std::uint32_t Header = 0;
+			std::uint32_t Size = 0;
+			std::vector<bool> IsBody;
+		};
+
+		// Natural loops, innermost first.
+		void FindLoops(const SSAFunction& function, std::vector<std::uint32_t>& order, std::vector<Loop>& loops) {
+			std::vector<std::uint32_t> dominators;
+			GetReversePostOrder(function, order);
+			GetDominators(function, order, dominators);
+
+			loops.clear();
+			for (const std::uint32_t header : order) {
+				std::vector<std::uint32_t> worklist;
+				for (const std::uint32_t predecessor : function.GetBlock(header).Predecessors) {
+					if (Dominates(dominators, header, predecessor)) {
+						worklist.push_back(predecessor);
+					}
+				}
+				if (worklist.empty()) continue;
+
+				Loop& loop = loops.emplace_back();
+				loop.Header = header;
+				loop.IsBody.assign(function.GetBlockCount(), false);
+				loop.IsBody[header] = true;
+				loop.Size = 1;
+				while (!worklist.empty()) {
+					const std::uint32_t block = worklist.back();
+					worklist.pop_back();
+					if (loop.IsBody[block]) continue;
+
+					loop.IsBody[block] = true;
+					++loop.Size;
+					for (const std::uint32_t predecessor : function.GetBlock(block).Predecessors) {
+						if (!loop.IsBody[predecessor] && dominators[predecessor] != NPos) {
+							worklist.push_back(predecessor);
+						}
+					}
+				}
+			}
+			std::stable_sort(loops.begin(), loops.end(), [](const Loop& lhs, const Loop& rhs) {
+				return lhs.Size < rhs.Size;
+			});
+		}
+
+		// The only block entering the loop, if it has no other successor.
+		std::uint32_t GetPreheader(const SSAFunction& function, const Loop& loop) noexcept {
+			std::uint32_t result = NPos;
+			for (const std::uint32_t predecessor : function.GetBlock(loop.Header).Predecessors) {
+				if (loop.IsBody[predecessor]) continue;
+				if (result != NPos) return NPos;
+				result = predecessor;
+			}
+			return result != NPos && function.GetBlock(result).Successors.size() == 1 ? result : NPos;
+		}
+		void InsertPreheader(SSAFunction& function, const Loop& loop) {
+			std::vector<std::uint32_t> outside;
+			for (const std::uint32_t predecessor : function.GetBlock(loop.Header).Predecessors) {
+				if (!loop.IsBody[predecessor]) {
+					outside.push_back(predecessor >= loop.Header ? predecessor + 1 : predecessor);
+				}
+			}
+
+			// The preheader takes the place of the header in the layout, so that entering the loop falls through.
+			function.InsertBlock(loop.Header);
+			const std::uint32_t preheader = loop.Header;
+			const std::uint32_t header = loop.Header + 1;
+
+			std::vector<std::size_t> outsideIndices;
+			std::vector<std::uint32_t> predecessors{ preheader };
+			const std::vector<std::uint32_t> oldPredecessors = function.GetBlock(header).Predecessors;
+			for (std::size_t i = 0; i < oldPredecessors.size(); ++i) {
+				if (std::find(outside.begin(), outside.end(), oldPredecessors[i]) != outside.end()) {
+					outsideIndices.push_back(i);
+				} else {
+					predecessors.push_back(oldPredecessors[i]);
+				}
+			}
+
+			const std::vector<std::uint32_t> phis = function.GetBlock(header).Phis;
+			for (const std::uint32_t phi : phis) {
+				const std::vector<std::uint32_t> operands = function.GetValue(phi).Operands;
+				std::vector<std::uint32_t> incoming;
+				for (const std::size_t index : outsideIndices) {
+					incoming.push_back(operands[index]);
+				}
+
+				std::uint32_t entering = incoming.front();
+				if (std::any_of(incoming.begin(), incoming.end(), [&](std::uint32_t operand) { return operand != entering; })) {
+					SSAValue value;
+					value.Kind = SSAValueKind::Phi;
+					value.Type = function.GetValue(phi).Type;
+					value.HasResult = true;
+					value.Block = preheader;
+					value.Operands = std::move(incoming);
+					entering = function.AddValue(std::move(value));
+					function.GetBlock(preheader).Phis.push_back(entering);
+				}
+
+				std::vector<std::uint32_t> newOperands{ entering };
+				for (std::size_t i = 0; i < operands.size(); ++i) {
+					if (std::find(outsideIndices.begin(), outsideIndices.end(), i) == outsideIndices.end()) {
+						newOperands.push_back(operands[i]);
+					}
+				}
+				function.GetValue(phi).Operands = std::move(newOperands);
+			}
+			function.GetBlock(header).Predecessors = std::move(predecessors);
+
+			for (const std::uint32_t predecessor : outside) {
+				for (std::uint32_t& successor : function.GetBlock(predecessor).Successors) {
+					if (successor == header) {
+						successor = preheader;
+					}
+				}
+			}
+
+			SSAValue jump;
+			jump.Kind = SSAValueKind::Instruction;
+			jump.OpCode = OpCode::Jmp;
+			jump.Block = preheader;
+			const std::uint32_t jumpIndex = function.AddValue(std::move(jump));
+
+			SSABlock& block = function.GetBlock(preheader);
+			block.Values.push_back(jumpIndex);
+			block.Predecessors = std::move(outside);
+			block.Successors.push_back(header);
+		}
+	}
+}
+
+namespace svm::core {
+	SSAOptimizer::SSAOptimizer(const SSAOptions& options) noexcept
+		: m_Options(options) {}
+	SSAOptimizer::SSAOptimizer(const SSAOptions& options, std::vector<FunctionSignature> mappedFunctions,
+		std::vector<const StructureInfo*> mappedStructures) noexcept
+		: m_Options(options), m_MappedFunctions(std::move(mappedFunctions)), m_MappedStructures(std::move(mappedStructures)) {}
+
+	void SSAOptimizer::Optimize(ByteFile& byteFile) {
+		ConstantPool& constantPool = byteFile.GetConstantPool();
+		Functions& functions = byteFile.GetFunctions();
+		Instructions& entrypoint = byteFile.GetEntrypoint();
+
+		// The entrypoint is handled as a function without parameters and result after the others.
+		const std::size_t targetCount = functions.size() + 1;
+		const auto getInstructions = [&](std::size_t index) -> Instructions& {
+			return index < functions.size() ? functions[index].Instructions : entrypoint;
+		};
+		const auto getArity = [&](std::size_t index) -> std::uint16_t {
+			return index < functions.size() ? functions[index].Arity : 0;
+		};
+		const auto hasResult = [&](std::size_t index) {
+			return index < functions.size() && functions[index].HasResult;
+		};
+
+		const Verifier verifier(byteFile, m_MappedFunctions, m_MappedStructures);
+		std::vector<SSAFunction> ssaFunctions(targetCount);
+		std::vector<VerificationLevel> levels(targetCount);
+		std::vector<bool> isBuilt(targetCount), isHoisted(targetCount);
+		for (std::size_t i = 0; i < targetCount; ++i) {
+			const Instructions& instructions = getInstructions(i);
+			const VerifierResult verified = verifier.Verify(instructions, getArity(i), hasResult(i));
+			if (verified.Error != VerifierError::None) continue;
+			if (!Build(byteFile, instructions, getArity(i), hasResult(i), ssaFunctions[i])) continue;
+
+			const std::uint64_t hoistedValues = m_Statistics.HoistedValues;
+			Optimize(ssaFunctions[i]);
+			levels[i] = verified.Level;
+			isBuilt[i] = true;
+			isHoisted[i] = m_Statistics.HoistedValues != hoistedValues;
+		}
+
+		// Constants are staged, so the pool only gets the constants of functions whose lowered form is accepted. Whether
+		// a function verifies does not depend on the others, so a round without rejections settles the pool.
+		const ConstantPoolLayout oldLayout = constantPool.GetLayout();
+		const ConstantPool original(constantPool.GetIntPool(), constantPool.GetLongPool(), constantPool.GetSinglePool(), constantPool.GetDoublePool());
+		std::vector<std::vector<std::uint32_t>> operands(targetCount);
+		for (std::size_t i = 0; i < targetCount; ++i) {
+			if (!isBuilt[i]) continue;
+
+			for (std::uint32_t j = 0; j < ssaFunctions[i].GetValueCount(); ++j) {
+				operands[i].push_back(ssaFunctions[i].GetValue(j).Operand);
+			}
+		}
+
+		// The result replaces the original only if it verifies at least as well, and only grows if code was hoisted.
+		std::vector<bool> isAccepted = isBuilt;
+		std::vector<Instructions> results(targetCount);
+		std::uint64_t addedConstants = 0;
+		for (bool isChanged = true; isChanged;) {
+			isChanged = false;
+			constantPool = ConstantPool(original.GetIntPool(), original.GetLongPool(), original.GetSinglePool(), original.GetDoublePool());
+			addedConstants = 0;
+			for (std::size_t i = 0; i < targetCount; ++i) {
+				if (!isAccepted[i]) continue;
+
+				for (std::uint32_t j = 0; j < ssaFunctions[i].GetValueCount(); ++j) {
+					const SSAValue& value = ssaFunctions[i].GetValue(j);
+					if (value.Kind == SSAValueKind::Constant && operands[i][j] == NPos) {
+						detail::AddConstant(constantPool, value.Constant, addedConstants);
+					}
+				}
+			}
+
+			const ConstantPoolLayout layout = constantPool.GetLayout();
+			for (std::size_t i = 0; i < targetCount; ++i) {
+				if (!isAccepted[i]) continue;
+
+				for (std::uint32_t j = 0; j < ssaFunctions[i].GetValueCount(); ++j) {
+					SSAValue& value = ssaFunctions[i].GetValue(j);
+					if (value.Kind != SSAValueKind::Constant) continue;
+
+					value.Operand = operands[i][j] == NPos ? detail::FindConstant(constantPool, value.Constant) : oldLayout.Remap(operands[i][j], layout);
+				}
+
+				results[i] = Instructions();
+				if (Lower(byteFile, ssaFunctions[i], results[i])) {
+					const VerifierResult verified = verifier.Verify(results[i], getArity(i), hasResult(i));
+					if (verified.Error == VerifierError::None && verified.Level >= levels[i] &&
+						(results[i].GetInstructionCount() <= getInstructions(i).GetInstructionCount() || isHoisted[i])) continue;
+				}
+
+				isAccepted[i] = false;
+				isChanged = true;
+			}
+		}
+
+		const ConstantPoolLayout layout = constantPool.GetLayout();
+		m_Statistics.AddedConstants += addedConstants;
+		for (std::size_t i = 0; i < targetCount; ++i) {
+			Instructions& instructions = getInstructions(i);
+			const std::uint64_t instCount = instructions.GetInstructionCount();
+			if (isBuilt[i]) {
+				++m_Statistics.Functions;
+				m_Statistics.OriginalCount += instCount;
+			}
+			if (isAccepted[i]) {
+				m_Statistics.ResultCount += results[i].GetInstructionCount();
+				instructions = std::move(results[i]);
+				if (i < functions.size()) {
+					functions[i].Frame = {};
+				}
+				continue;
+			}
+			if (isBuilt[i]) {
+				++m_Statistics.Rejected;
+				m_Statistics.ResultCount += instCount;
+			}
+
+			if (layout.AllCount == oldLayout.AllCount) continue;
+			for (std::uint64_t j = 0; j < instCount; ++j) {
+				Instruction inst = instructions.GetInstruction(j);
+				if (inst.OpCode != OpCode::Push) continue;
+
+				inst.Operand = oldLayout.Remap(inst.Operand, layout);
+				instructions.SetInstruction(j, inst);
+			}
+		}
+	}
+	bool SSAOptimizer::Build(const ByteFile& byteFile, const Instructions& instructions, std::uint16_t arity, bool hasResult, SSAFunction& result) const {
+		result.Reset(arity, hasResult);
+
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		if (instCount == 0) return false;
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			if (instructions.GetLabel(i) >= instCount) return false;
+		}
+
+		// Pointers to locals would let stores bypass the renaming, so functions taking one are left alone.
+		std::uint32_t localCount = arity;
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode >= OpCode::Count || inst.OpCode == OpCode::Lea || (IsJump(inst.OpCode) && inst.Operand >= labelCount)) return false;
+			if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Store) {
+				localCount = std::max(localCount, inst.Operand + 1);
+			}
+		}
+
+		// Block 0 is an entry block without predecessors; the reachable blocks of the graph follow in their order.
+		const ControlFlowGraph graph(instructions);
+		const std::uint32_t graphBlockCount = graph.GetBlockCount();
+		std::vector<std::uint32_t> blockMap(graphBlockCount, NPos);
+		std::vector<std::uint32_t> graphBlocks{ ControlFlowGraph::NPos };
+		result.AddBlock();
+		for (std::uint32_t i = 0; i < graphBlockCount; ++i) {
+			if (graph.IsReachable(i)) {
+				blockMap[i] = result.AddBlock();
+				graphBlocks.push_back(i);
+			}
+		}
+
+		result.AddEdge(0, 1);
+		for (std::uint32_t i = 1; i < result.GetBlockCount(); ++i) {
+			const BasicBlock& range = graph.GetBlock(graphBlocks[i]);
+			const Instruction& last = instructions.GetInstruction(range.End - 1);
+			const std::uint32_t next = range.End < instCount ? blockMap[graph.GetBlockOf(range.End)] : NPos;
+			if (last.OpCode == OpCode::Ret) continue;
+			else if (last.OpCode == OpCode::Jmp) {
+				result.AddEdge(i, blockMap[graph.GetBlockOf(instructions.GetLabel(last.Operand))]);
+				continue;
+			} else if (next == NPos) return false;
+
+			if (IsConditionalJump(last.OpCode)) {
+				const std::uint32_t target = blockMap[graph.GetBlockOf(instructions.GetLabel(last.Operand))];
+				if (target != next) {
+					result.AddEdge(i, target);
+				}
+			}
+			result.AddEdge(i, next);
+		}
+
+		std::vector<std::uint32_t> order;
+		GetReversePostOrder(result, order);
+
+		std::vector<BuildState> states(result.GetBlockCount());
+		std::vector<bool> isFinished(result.GetBlockCount());
+		std::vector<std::uint32_t> stackDepths(result.GetBlockCount());
+		for (const std::uint32_t block : order) {
+			BuildState& state = states[block];
+			state.Block = block;
+
+			const std::vector<std::uint32_t>& predecessors = result.GetBlock(block).Predecessors;
+			if (block == 0) {
+				state.Locals.assign(localCount, SSAFunction::Undefined);
+				for (std::uint16_t i = 0; i < arity; ++i) {
+					state.Locals[i] = i + 1;
+				}
+			} else if (predecessors.size() == 1) {
+				if (!isFinished[predecessors.front()]) return false;
+
+				state.Locals = states[predecessors.front()].Locals;
+				state.Stack = states[predecessors.front()].Stack;
+			} else {
+				// Every local and stack slot gets a phi; the trivial ones are removed once the operands are known.
+				const auto finished = std::find_if(predecessors.begin(), predecessors.end(), [&](std::uint32_t predecessor) {
+					return isFinished[predecessor];
+				});
+				if (finished == predecessors.end()) return false;
+
+				stackDepths[block] = static_cast<std::uint32_t>(states[*finished].Stack.size());
+				const auto addPhi = [&]() {
+					SSAValue value;
+					value.Kind = SSAValueKind::Phi;
+					value.HasResult = true;
+					value.Block = block;
+					const std::uint32_t index = result.AddValue(std::move(value));
+					result.GetBlock(block).Phis.push_back(index);
+					return index;
+				};
+				for (std::uint32_t i = 0; i < localCount; ++i) {
+					state.Locals.push_back(addPhi());
+				}
+				for (std::uint32_t i = 0; i < stackDepths[block]; ++i) {
+					state.Stack.push_back(addPhi());
+				}
+			}
+
+			if (block == 0) {
+				SSAValue jump;
+				jump.Kind = SSAValueKind::Instruction;
+				jump.OpCode = OpCode::Jmp;
+				jump.Block = 0;
+				result.GetBlock(0).Values.push_back(result.AddValue(std::move(jump)));
+			} else {
+				const BasicBlock& range = graph.GetBlock(graphBlocks[block]);
+				for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+					if (!Interpret(byteFile, instructions.GetInstruction(i), state, result)) return false;
+				}
+
+				const OpCode last = instructions.GetInstruction(range.End - 1).OpCode;
+				if (!IsJump(last) && last != OpCode::Ret) {
+					SSAValue jump;
+					jump.Kind = SSAValueKind::Instruction;
+					jump.OpCode = OpCode::Jmp;
+					jump.Block = block;
+					result.GetBlock(block).Values.push_back(result.AddValue(std::move(jump)));
+				} else if (IsConditionalJump(last) && result.GetBlock(block).Successors.size() == 1) {
+					SSAValue& jump = result.GetValue(result.GetBlock(block).Values.back());
+					jump.OpCode = OpCode::Jmp;
+					jump.Operands.clear();
+				}
+			}
+			isFinished[block] = true;
+		}
+
+		for (const std::uint32_t block : order) {
+			const SSABlock& ssaBlock = result.GetBlock(block);
+			if (ssaBlock.Phis.empty()) continue;
+
+			for (std::size_t i = 0; i < ssaBlock.Predecessors.size(); ++i) {
+				const BuildState& state = states[ssaBlock.Predecessors[i]];
+				if (state.Stack.size() != stackDepths[block]) return false;
+
+				for (std::size_t j = 0; j < ssaBlock.Phis.size(); ++j) {
+					const std::uint32_t operand = j < localCount ? state.Locals[j] : state.Stack[j - localCount];
+					result.GetValue(ssaBlock.Phis[j]).Operands.push_back(operand);
+				}
+			}
+		}
+
+		SimplifyPhis(result);
+		RemoveDeadValues(result);
+		InferTypes(result);
+		return true;
+	}
+	void SSAOptimizer::Optimize(SSAFunction& function) {
+		if (m_Options.ConditionalConstantPropagation && PropagateConstants(function)) {
+			SimplifyPhis(function);
+			EliminateDeadValues(function);
+		}
+		if (m_Options.GlobalValueNumbering) {
+			NumberValues(function);
+		}
+		if (m_Options.LoopInvariantCodeMotion && HoistInvariants(function) && m_Options.GlobalValueNumbering) {
+			NumberValues(function);
+		}
+		EliminateDeadValues(function);
+		InferTypes(function);
+	}
+	bool SSAOptimizer::Lower(const ByteFile& byteFile, const SSAFunction& function, Instructions& result) const {
+		if (function.IsEmpty()) return false;
+
+		const std::uint32_t valueCount = function.GetValueCount();
+		const std::uint32_t blockCount = function.GetBlockCount();
+		const ConstantPool& constantPool = byteFile.GetConstantPool();
+
+		std::vector<std::uint32_t> useCounts(valueCount), users(valueCount, NPos);
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			const SSABlock& block = function.GetBlock(i);
+			for (const std::uint32_t phi : block.Phis) {
+				for (const std::uint32_t operand : function.GetValue(phi).Operands) {
+					++useCounts[operand];
+				}
+			}
+			for (const std::uint32_t value : block.Values) {
+				for (const std::uint32_t operand : function.GetValue(value).Operands) {
+					++useCounts[operand];
+					users[operand] = value;
+				}
+			}
+		}
+
+		// A result used once by a later instruction of its block may stay on the stack instead of going through a local,
+		// as long as it is on top of the stack when the user runs. Results on the wrong place are spilled until none is left.
+		std::vector<bool> isStacked(valueCount);
+		const auto getStackedCount = [&](const std::vector<std::uint32_t>& operands) {
+			return static_cast<std::size_t>(std::find_if(operands.begin(), operands.end(), [&](std::uint32_t operand) {
+				return !isStacked[operand];
+			}) - operands.begin());
+		};
+		const auto isSwapped = [&](const std::vector<std::uint32_t>& operands) {
+			return operands.size() == 2 && !isStacked[operands[0]] && isStacked[operands[1]];
+		};
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			const std::vector<std::uint32_t>& values = function.GetBlock(i).Values;
+			for (const std::uint32_t value : values) {
+				const SSAValue& ssaValue = function.GetValue(value);
+				isStacked[value] = ssaValue.Kind == SSAValueKind::Instruction && ssaValue.HasResult && useCounts[value] == 1 &&
+					users[value] != NPos && function.GetValue(users[value]).Block == i;
+			}
+
+			for (bool isChanged = true; isChanged;) {
+				isChanged = false;
+
+				std::vector<std::uint32_t> pending;
+				for (const std::uint32_t value : values) {
+					const std::vector<std::uint32_t>& operands = function.GetValue(value).Operands;
+					const std::size_t stackedCount = getStackedCount(operands);
+					const bool isConsumable = isSwapped(operands) ? !pending.empty() && pending.back() == operands[1] :
+						std::none_of(operands.begin() + stackedCount, operands.end(), [&](std::uint32_t operand) { return isStacked[operand]; }) &&
+						pending.size() >= stackedCount && std::equal(operands.begin(), operands.begin() + stackedCount, pending.end() - stackedCount);
+					if (!isConsumable) {
+						for (const std::uint32_t operand : operands) {
+							isStacked[operand] = false;
+						}
+						isChanged = true;
+						break;
+					}
+
+					pending.resize(pending.size() - (isSwapped(operands) ? 1 : stackedCount));
+					if (isStacked[value]) {
+						pending.push_back(value);
+					}
+				}
+				if (!isChanged && !pending.empty()) {
+					for (const std::uint32_t value : pending) {
+						isStacked[value] = false;
+					}
+					isChanged = true;
+				}
+			}
+		}
+
+		// Parameters stay in their locals; every other value gets a local of its own until CompactLocals shares them.
+		std::vector<std::uint32_t> locals(valueCount, NPos);
+		std::vector<const TypeInfo*> localTypes(function.GetArity());
+		for (std::uint16_t i = 0; i < function.GetArity(); ++i) {
+			locals[i + 1] = i;
+		}
+		const auto getLocal = [&](std::uint32_t value) {
+			if (locals[value] == NPos) {
+				locals[value] = static_cast<std::uint32_t>(localTypes.size());
+				localTypes.push_back(function.GetValue(value).Type);
+			}
+			return locals[value];
+		};
+
+		ArenaVector<Instruction> insts;
+		ArenaVector<std::uint64_t> labels(blockCount);
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> edgeBlocks;
+		const auto load = [&](std::uint32_t value) {
+			const SSAValue& ssaValue = function.GetValue(value);
+			switch (ssaValue.Kind) {
+			case SSAValueKind::Undefined:
+				return false;
+
+			case SSAValueKind::Constant: {
+				const std::uint32_t index = ssaValue.Operand == NPos ? detail::FindConstant(constantPool, ssaValue.Constant) : ssaValue.Operand;
+				if (index == NPos) return false;
+
+				insts.push_back(Instruction(OpCode::Push, index, std::uint64_t(0)));
+				return true;
+			}
+
+			default:
+				insts.push_back(Instruction(OpCode::Load, getLocal(value), std::uint64_t(0)));
+				return true;
+			}
+		};
+
+		// Phis are assigned on the edges; all sources are read before any phi is written.
+		const auto getCopies = [&](std::uint32_t from, std::uint32_t to) {
+			const SSABlock& block = function.GetBlock(to);
+			const std::size_t index = std::find(block.Predecessors.begin(), block.Predecessors.end(), from) - block.Predecessors.begin();
+
+			std::vector<std::pair<std::uint32_t, std::uint32_t>> copies; // (phi, source)
+			for (const std::uint32_t phi : block.Phis) {
+				const std::uint32_t source = function.GetValue(phi).Operands[index];
+				if (source != SSAFunction::Undefined && source != phi && (locals[source] == NPos || locals[source] != locals[phi])) {
+					copies.emplace_back(phi, source);
+				}
+			}
+			return copies;
+		};
+
+		// A value only flowing into a phi over an unconditional jump is written to the local of the phi directly,
+		// unless the old value of the phi is still read after the value is defined.
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			const SSABlock& block = function.GetBlock(i);
+			if (function.GetValue(block.Values.back()).OpCode != OpCode::Jmp) continue;
+
+			const auto copies = getCopies(i, block.Successors[0]);
+			for (const auto& [phi, source] : copies) {
+				const SSAValue& value = function.GetValue(source);
+				const bool isPhi = value.Kind == SSAValueKind::Phi;
+				if ((!isPhi && value.Kind != SSAValueKind::Instruction) || value.Block != i || useCounts[source] != 1 || locals[source] != NPos) continue;
+				if (std::any_of(copies.begin(), copies.end(), [phi = phi](const auto& copy) { return copy.second == phi; })) continue;
+
+				const auto definition = isPhi ? block.Values.begin() : std::find(block.Values.begin(), block.Values.end(), source) + 1;
+				if (std::any_of(definition, block.Values.end(), [&, phi = phi](std::uint32_t user) {
+					const std::vector<std::uint32_t>& operands = function.GetValue(user).Operands;
+					return std::find(operands.begin(), operands.end(), phi) != operands.end();
+				})) continue;
+
+				locals[source] = getLocal(phi);
+			}
+		}
+		const auto copy = [&](std::uint32_t from, std::uint32_t to) {
+			const auto copies = getCopies(from, to);
+			for (const auto& [phi, source] : copies) {
+				if (!load(source)) return false;
+			}
+			for (auto iter = copies.rbegin(); iter != copies.rend(); ++iter) {
+				insts.push_back(Instruction(OpCode::Store, getLocal(iter->first), std::uint64_t(0)));
+			}
+			return true;
+		};
+		const auto jump = [&](OpCode opCode, std::uint32_t label) {
+			insts.push_back(Instruction(opCode, label, std::uint64_t(0)));
+		};
+
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			const SSABlock& block = function.GetBlock(i);
+			labels[i] = insts.size();
+
+			for (const std::uint32_t value : block.Values) {
+				const SSAValue& ssaValue = function.GetValue(value);
+				const std::vector<std::uint32_t>& operands = ssaValue.Operands;
+				if (isSwapped(operands)) {
+					if (!load(operands[0])) return false;
+					if (!IsCommutative(ssaValue)) {
+						insts.push_back(Instruction(OpCode::Swap));
+					}
+				} else {
+					for (std::size_t j = getStackedCount(operands); j < operands.size(); ++j) {
+						if (!load(operands[j])) return false;
+					}
+				}
+
+				switch (ssaValue.OpCode) {
+				case OpCode::Jmp:
+					if (!copy(i, block.Successors[0])) return false;
+					if (block.Successors[0] != i + 1) {
+						jump(OpCode::Jmp, block.Successors[0]);
+					}
+					break;
+
+				case OpCode::Je:
+				case OpCode::Jne:
+				case OpCode::Ja:
+				case OpCode::Jae:
+				case OpCode::Jb:
+				case OpCode::Jbe:
+					if (getCopies(i, block.Successors[0]).empty()) {
+						jump(ssaValue.OpCode, block.Successors[0]);
+					} else {
+						jump(ssaValue.OpCode, blockCount + static_cast<std::uint32_t>(edgeBlocks.size()));
+						edgeBlocks.emplace_back(i, block.Successors[0]);
+					}
+
+					if (!copy(i, block.Successors[1])) return false;
+					if (block.Successors[1] != i + 1) {
+						jump(OpCode::Jmp, block.Successors[1]);
+					}
+					break;
+
+				case OpCode::Push:
+					insts.push_back(Instruction(OpCode::Push, constantPool.GetAllCount() + ssaValue.Operand, std::uint64_t(0)));
+					break;
+
+				default:
+					insts.push_back(Instruction(ssaValue.OpCode, ssaValue.Operand, std::uint64_t(0)));
+					break;
+				}
+
+				if (!ssaValue.HasResult || isStacked[value]) continue;
+				else if (useCounts[value]) {
+					insts.push_back(Instruction(OpCode::Store, getLocal(value), std::uint64_t(0)));
+				} else {
+					insts.push_back(Instruction(OpCode::Pop));
+				}
+			}
+		}
+		for (const auto& [from, to] : edgeBlocks) {
+			labels.push_back(insts.size());
+			if (!copy(from, to)) return false;
+			jump(OpCode::Jmp, to);
+		}
+
+		result = Instructions(std::move(labels), std::move(insts));
+		result.CompactLabels();
+		result.UpdateOffsets();
+		CompactLocals(result, function.GetArity(), localTypes);
+		return true;
+	}
+
+	const SSAOptions& SSAOptimizer::GetOptions() const noexcept {
+		return m_Options;
+	}
+	void SSAOptimizer::SetOptions(const SSAOptions& newOptions) noexcept {
+		m_Options = newOptions;
+	}
+	const SSAStatistics& SSAOptimizer::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	void SSAOptimizer::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+
+	bool SSAOptimizer::Interpret(const ByteFile& byteFile, const Instruction& instruction, BuildState& state, SSAFunction& function) const {
+		std::vector<std::uint32_t>& stack = state.Stack;
+		SSAValue value;
+		value.Kind = SSAValueKind::Instruction;
+		value.OpCode = instruction.OpCode;
+		value.Operand = instruction.Operand;
+		value.Block = state.Block;
+
+		const auto pop = [&](std::uint32_t count) {
+			if (stack.size() < count) return false;
+
+			value.Operands.assign(stack.end() - count, stack.end());
+			stack.resize(stack.size() - count);
+			return true;
+		};
+		const auto add = [&]() {
+			const bool hasResult = value.HasResult;
+			const std::uint32_t index = function.AddValue(std::move(value));
+			if (hasResult) {
+				stack.push_back(index);
+			}
+			return index;
+		};
+
+		switch (instruction.OpCode) {
+		case OpCode::Nop:
+			return true;
+
+		case OpCode::Push: {
+			const ConstantPool& constantPool = byteFile.GetConstantPool();
+			const std::uint32_t constCount = constantPool.GetAllCount();
+			value.HasResult = true;
+			if (instruction.Operand < constCount) {
+				value.Kind = SSAValueKind::Constant;
+				value.Constant = detail::ReadConstant(constantPool, constantPool.GetLayout(), instruction.Operand);
+				value.Type = GetFundamentalType(value.Constant.Code).GetPointer();
+				value.Block = NPos;
+				add();
+				return true;
+			}
+
+			// Structures are pushed by type; the operand is kept relative to the constants, which may still grow.
+			value.Operand = instruction.Operand - constCount;
+			value.Type = GetType(byteFile, static_cast<std::uint32_t>(TypeCode::Structure) + value.Operand);
+			if (!value.Type) return false;
+			break;
+		}
+
+		case OpCode::Pop:
+			if (stack.empty()) return false;
+			stack.pop_back();
+			return true;
+
+		case OpCode::Load:
+			stack.push_back(state.Locals[instruction.Operand]);
+			return true;
+
+		case OpCode::Store:
+			if (stack.empty()) return false;
+			state.Locals[instruction.Operand] = stack.back();
+			stack.pop_back();
+			return true;
+
+		case OpCode::Copy:
+			if (stack.empty()) return false;
+			stack.push_back(stack.back());
+			return true;
+
+		case OpCode::Swap:
+			if (stack.size() < 2) return false;
+			std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+			return true;
+
+		case OpCode::Call: {
+			FunctionSignature signature;
+			if (!GetSignature(byteFile, instruction.Operand, signature) || !pop(signature.Arity)) return false;
+
+			value.HasResult = signature.HasResult;
+			break;
+		}
+
+		case OpCode::Ret:
+			if (function.HasResult() && !pop(1)) return false;
+			break;
+
+		default: {
+			std::uint32_t popCount = 0, pushCount = 0;
+			if (!GetStackEffect(instruction.OpCode, popCount, pushCount) || pushCount > 1 || !pop(popCount)) return false;
+
+			value.HasResult = pushCount;
+			value.Type = GetResultType(instruction.OpCode);
+			break;
+		}
+		}
+
+		function.GetBlock(state.Block).Values.push_back(add());
+		return true;
+	}
+	bool SSAOptimizer::PropagateConstants(SSAFunction& function) {
+		const std::uint32_t valueCount = function.GetValueCount();
+		const std::uint32_t blockCount = function.GetBlockCount();
+
+		std::vector<Lattice> lattices(valueCount);
+		std::vector<std::vector<std::uint32_t>> users(valueCount);
+		for (std::uint32_t i = 0; i < valueCount; ++i) {
+			const SSAValue& value = function.GetValue(i);
+			if (value.Kind == SSAValueKind::Undefined || value.Kind == SSAValueKind::Parameter) {
+				lattices[i].State = LatticeState::Bottom;
+			} else if (value.Kind == SSAValueKind::Constant) {
+				lattices[i].State = LatticeState::Constant;
+				lattices[i].Value = value.Constant;
+			}
+		}
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			const SSABlock& block = function.GetBlock(i);
+			for (const std::vector<std::uint32_t>* values : { &block.Phis, &block.Values }) {
+				for (const std::uint32_t value : *values) {
+					for (const std::uint32_t operand : function.GetValue(value).Operands) {
+						users[operand].push_back(value);
+					}
+				}
+			}
+		}
+
+		// Edges are marked by the index of the predecessor in the target block.
+		std::vector<bool> isExecutable(blockCount);
+		std::vector<std::vector<bool>> isEdgeExecutable(blockCount);
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			isEdgeExecutable[i].assign(function.GetBlock(i).Predecessors.size(), false);
+		}
+
+		std::vector<std::uint32_t> blockWorklist{ 0 }, valueWorklist;
+		isExecutable[0] = true;
+		const auto markEdge = [&](std::uint32_t from, std::uint32_t to) {
+			const std::vector<std::uint32_t>& predecessors = function.GetBlock(to).Predecessors;
+			const std::size_t index = std::find(predecessors.begin(), predecessors.end(), from) - predecessors.begin();
+			if (isEdgeExecutable[to][index]) return;
+
+			isEdgeExecutable[to][index] = true;
+			if (!isExecutable[to]) {
+				isExecutable[to] = true;
+				blockWorklist.push_back(to);
+			} else {
+				valueWorklist.insert(valueWorklist.end(), function.GetBlock(to).Phis.begin(), function.GetBlock(to).Phis.end());
+			}
+		};
+		const auto update = [&](std::uint32_t index, const Lattice& lattice) {
+			const Lattice merged = Meet(lattices[index], lattice);
+			if (merged != lattices[index]) {
+				lattices[index] = merged;
+				valueWorklist.insert(valueWorklist.end(), users[index].begin(), users[index].end());
+			}
+		};
+		const auto evaluate = [&](std::uint32_t index) {
+			const SSAValue& value = function.GetValue(index);
+			const SSABlock& block = function.GetBlock(value.Block);
+			if (value.Kind == SSAValueKind::Phi) {
+				Lattice result;
+				for (std::size_t i = 0; i < value.Operands.size(); ++i) {
+					if (isEdgeExecutable[value.Block][i]) {
+						result = Meet(result, lattices[value.Operands[i]]);
+					}
+				}
+				update(index, result);
+				return;
+			}
+
+			std::vector<const Lattice*> operands;
+			for (const std::uint32_t operand : value.Operands) {
+				operands.push_back(&lattices[operand]);
+			}
+			const bool isTop = std::any_of(operands.begin(), operands.end(), [](const Lattice* operand) {
+				return operand->State == LatticeState::Top;
+			});
+			const bool isConstant = std::all_of(operands.begin(), operands.end(), [](const Lattice* operand) {
+				return operand->State == LatticeState::Constant;
+			});
+
+			switch (value.OpCode) {
+			case OpCode::Jmp:
+				markEdge(value.Block, block.Successors[0]);
+				return;
+
+			case OpCode::Je:
+			case OpCode::Jne:
+			case OpCode::Ja:
+			case OpCode::Jae:
+			case OpCode::Jb:
+			case OpCode::Jbe:
+				if (isTop) return;
+				else if (operands[0]->State == LatticeState::Order) {
+					markEdge(value.Block, block.Successors[detail::IsJumpTaken(value.OpCode, operands[0]->Order) ? 0 : 1]);
+				} else {
+					markEdge(value.Block, block.Successors[0]);
+					markEdge(value.Block, block.Successors[1]);
+				}
+				return;
+
+			default:
+				break;
+			}
+			if (!value.HasResult || isTop) return;
+
+			Lattice result;
+			result.State = LatticeState::Bottom;
+			if (isConstant && !operands.empty()) {
+				if (value.OpCode == OpCode::Cmp || value.OpCode == OpCode::ICmp) {
+					if (detail::CompareConstants(value.OpCode, operands[0]->Value, operands[1]->Value, result.Order)) {
+						result.State = LatticeState::Order;
+					}
+				} else {
+					detail::ConstantValue constant;
+					if ((value.OpCode >= OpCode::Neg && value.OpCode <= OpCode::Dec) || value.OpCode == OpCode::Not) {
+						constant = detail::EvaluateUnary(value.OpCode, operands[0]->Value);
+					} else if (value.OpCode >= OpCode::Add && value.OpCode <= OpCode::Sar) {
+						constant = detail::EvaluateBinary(value.OpCode, operands[0]->Value, operands[1]->Value);
+					} else if (value.OpCode >= OpCode::ToI && value.OpCode <= OpCode::ToD) {
+						constant = detail::EvaluateConversion(value.OpCode, operands[0]->Value);
+					}
+
+					// NaN payloads are not guaranteed to survive folding.
+					const bool isReal = constant.Code == TypeCode::Single || constant.Code == TypeCode::Double;
+					if (constant.IsConstant() && !(isReal && std::isnan(constant.Real))) {
+						result.State = LatticeState::Constant;
+						result.Value = constant;
+					}
+				}
+			}
+			update(index, result);
+		};
+
+		while (!blockWorklist.empty() || !valueWorklist.empty()) {
+			if (!blockWorklist.empty()) {
+				const std::uint32_t block = blockWorklist.back();
+				blockWorklist.pop_back();
+
+				const SSABlock& ssaBlock = function.GetBlock(block);
+				std::for_each(ssaBlock.Phis.begin(), ssaBlock.Phis.end(), evaluate);
+				std::for_each(ssaBlock.Values.begin(), ssaBlock.Values.end(), evaluate);
+				continue;
+			}
+
+			const std::uint32_t value = valueWorklist.back();
+			valueWorklist.pop_back();
+			if (isExecutable[function.GetValue(value).Block]) {
+				evaluate(value);
+			}
+		}
+
+		// A value still undecided in an executable block means the analysis could not see all of its inputs.
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			if (!isExecutable[i]) continue;
+
+			const SSABlock& block = function.GetBlock(i);
+			for (const std::vector<std::uint32_t>* values : { &block.Phis, &block.Values }) {
+				for (const std::uint32_t value : *values) {
+					const SSAValue& ssaValue = function.GetValue(value);
+					if (IsConditionalJump(ssaValue.OpCode) && lattices[ssaValue.Operands[0]].State == LatticeState::Top) return false;
+					if (ssaValue.HasResult && lattices[value].State == LatticeState::Top) return false;
+				}
+			}
+		}
+
+		std::vector<std::uint32_t> forward(valueCount, NPos);
+		std::map<std::tuple<TypeCode, std::uint64_t, std::uint64_t>, std::uint32_t> constants;
+		std::uint64_t foldedValues = 0;
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			if (!isExecutable[i]) continue;
+
+			const SSABlock& block = function.GetBlock(i);
+			for (const std::vector<std::uint32_t>* values : { &block.Phis, &block.Values }) {
+				for (const std::uint32_t value : *values) {
+					const Lattice& lattice = lattices[value];
+					if (lattice.State != LatticeState::Constant || !function.GetValue(value).HasResult) continue;
+
+					std::uint64_t realBits = 0;
+					std::memcpy(&realBits, &lattice.Value.Real, sizeof(realBits));
+					const auto [iter, isInserted] = constants.emplace(std::make_tuple(lattice.Value.Code, lattice.Value.Integer, realBits), 0);
+					if (isInserted) {
+						SSAValue constant;
+						constant.Kind = SSAValueKind::Constant;
+						constant.Operand = NPos;
+						constant.Constant = lattice.Value;
+						constant.Type = GetFundamentalType(lattice.Value.Code).GetPointer();
+						constant.HasResult = true;
+						iter->second = function.AddValue(std::move(constant));
+						forward.push_back(NPos);
+					}
+					forward[value] = iter->second;
+					++foldedValues;
+				}
+			}
+		}
+
+		std::uint64_t removedBranches = 0;
+		for (std::uint32_t i = 0; i < blockCount; ++i) {
+			if (!isExecutable[i]) continue;
+
+			SSAValue& terminator = function.GetValue(function.GetBlock(i).Values.back());
+			if (!IsConditionalJump(terminator.OpCode) || lattices[terminator.Operands[0]].State != LatticeState::Order) continue;
+
+			const bool isTaken = detail::IsJumpTaken(terminator.OpCode, lattices[terminator.Operands[0]].Order);
+			function.RemoveEdge(i, function.GetBlock(i).Successors[isTaken ? 1 : 0]);
+			terminator.OpCode = OpCode::Jmp;
+			terminator.Operands.clear();
+			++removedBranches;
+		}
+
+		const auto removedBlocks = static_cast<std::uint64_t>(std::count(isExecutable.begin(), isExecutable.end(), false));
+		if (!foldedValues && !removedBranches && !removedBlocks) return false;
+
+		if (foldedValues) {
+			ReplaceValues(function, forward);
+		}
+		if (removedBlocks) {
+			std::vector<bool> isRemoved(blockCount);
+			for (std::uint32_t i = 0; i < blockCount; ++i) {
+				isRemoved[i] = !isExecutable[i];
+			}
+			function.RemoveBlocks(isRemoved);
+		}
+
+		m_Statistics.FoldedValues += foldedValues;
+		m_Statistics.RemovedBranches += removedBranches;
+		m_Statistics.RemovedBlocks += removedBlocks;
+		return true;
+	}
+	bool SSAOptimizer::NumberValues(SSAFunction& function) {
+		const std::uint32_t valueCount = function.GetValueCount();
+		std::vector<std::uint32_t> forward(valueCount, NPos);
+
+		// Constants read from the pool are preferred, since they do not have to be added to it.
+		std::map<std::tuple<TypeCode, std::uint64_t, std::uint64_t>, std::uint32_t> constants;
+		for (const bool isFromPool : { true, false }) {
+			for (std::uint32_t i = 0; i < valueCount; ++i) {
+				const SSAValue& value = function.GetValue(i);
+				if (value.Kind != SSAValueKind::Constant || (value.Operand != NPos) != isFromPool) continue;
+
+				std::uint64_t realBits = 0;
+				std::memcpy(&realBits, &value.Constant.Real, sizeof(realBits));
+				const auto [iter, isInserted] = constants.emplace(std::make_tuple(value.Constant.Code, value.Constant.Integer, realBits), i);
+				if (!isInserted) {
+					forward[i] = iter->second;
+				}
+			}
+		}
+
+		std::vector<std::uint32_t> order, dominators;
+		GetReversePostOrder(function, order);
+		GetDominators(function, order, dominators);
+
+		std::vector<std::vector<std::uint32_t>> children(function.GetBlockCount());
+		for (const std::uint32_t block : order) {
+			if (block != 0) {
+				children[dominators[block]].push_back(block);
+			}
+		}
+
+		// Values are available in the blocks their definition dominates, so the table is scoped to the dominator tree.
+		using Key = std::tuple<OpCode, std::uint32_t, std::vector<std::uint32_t>>;
+		std::map<Key, std::uint32_t> available;
+		std::uint64_t numberedValues = 0;
+		const auto getKey = [&](const SSAValue& value, OpCode opCode, std::uint32_t operand) {
+			Key key(opCode, operand, value.Operands);
+			std::vector<std::uint32_t>& operands = std::get<2>(key);
+			for (std::uint32_t& op : operands) {
+				op = Resolve(forward, op);
+			}
+			if (IsCommutative(value) && operands[0] > operands[1]) {
+				std::swap(operands[0], operands[1]);
+			}
+			return key;
+		};
+
+		std::vector<std::pair<std::uint32_t, std::vector<Key>>> stack;
+		stack.emplace_back(0, std::vector<Key>());
+		std::vector<std::size_t> childIndices(function.GetBlockCount());
+		bool isEntered = false;
+		while (!stack.empty()) {
+			const std::uint32_t block = stack.back().first;
+			if (!isEntered) {
+				const SSABlock& ssaBlock = function.GetBlock(block);
+				const auto number = [&](std::uint32_t index, Key key) {
+					const auto [iter, isInserted] = available.emplace(key, index);
+					if (isInserted) {
+						stack.back().second.push_back(std::move(key));
+					} else {
+						forward[index] = iter->second;
+						++numberedValues;
+					}
+				};
+				for (const std::uint32_t phi : ssaBlock.Phis) {
+					number(phi, getKey(function.GetValue(phi), OpCode::Nop, block));
+				}
+				for (const std::uint32_t index : ssaBlock.Values) {
+					const SSAValue& value = function.GetValue(index);
+					if (value.HasResult && IsPure(value.OpCode)) {
+						number(index, getKey(value, value.OpCode, value.Operand));
+					}
+				}
+			}
+
+			if (childIndices[block] < children[block].size()) {
+				stack.emplace_back(children[block][childIndices[block]++], std::vector<Key>());
+				isEntered = false;
+			} else {
+				for (const Key& key : stack.back().second) {
+					available.erase(key);
+				}
+				stack.pop_back();
+				isEntered = true;
+			}
+		}
+
+		const bool isChanged = std::any_of(forward.begin(), forward.end(), [](std::uint32_t value) { return value != NPos; });
+		if (isChanged) {
+			ReplaceValues(function, forward);
+			m_Statistics.NumberedValues += numberedValues;
+		}
+		return isChanged;
+	}
+	bool SSAOptimizer::HoistInvariants(SSAFunction& function) {
+		std::vector<std::uint32_t> order;
+		std::vector<Loop> loops;
+		const auto isInvariant = [&](const Loop& loop, const SSAValue& value) {
+			return value.HasResult && IsSpeculatable(function, value) &&
+				std::none_of(value.Operands.begin(), value.Operands.end(), [&](std::uint32_t operand) {
+					const std::uint32_t block = function.GetValue(operand).Block;
+					return block != NPos && loop.IsBody[block];
+				});
+		};
+		const auto hasInvariant = [&](const Loop& loop) {
+			for (std::uint32_t i = 0; i < function.GetBlockCount(); ++i) {
+				if (!loop.IsBody[i]) continue;
+
+				const std::vector<std::uint32_t>& values = function.GetBlock(i).Values;
+				if (std::any_of(values.begin(), values.end(), [&](std::uint32_t value) {
+					return isInvariant(loop, function.GetValue(value));
+				})) return true;
+			}
+			return false;
+		};
+
+		// Loops with something to hoist get a preheader first, which changes the block indices of every loop.
+		for (bool isInserted = true; isInserted;) {
+			isInserted = false;
+			FindLoops(function, order, loops);
+			for (const Loop& loop : loops) {
+				if (GetPreheader(function, loop) == NPos && hasInvariant(loop)) {
+					InsertPreheader(function, loop);
+					isInserted = true;
+					break;
+				}
+			}
+		}
+
+		// Inner loops come first, so that their invariants can move further out with the outer loops.
+		std::uint64_t hoistedValues = 0;
+		for (const Loop& loop : loops) {
+			const std::uint32_t preheader = GetPreheader(function, loop);
+			if (preheader == NPos) continue;
+
+			for (const std::uint32_t block : order) {
+				if (!loop.IsBody[block]) continue;
+
+				std::vector<std::uint32_t>& values = function.GetBlock(block).Values;
+				for (std::size_t i = 0; i < values.size();) {
+					SSAValue& value = function.GetValue(values[i]);
+					if (!isInvariant(loop, value)) {
+						++i;
+						continue;
+					}
+
+					std::vector<std::uint32_t>& preheaderValues = function.GetBlock(preheader).Values;
+					preheaderValues.insert(preheaderValues.end() - 1, values[i]);
+					value.Block = preheader;
+					values.erase(values.begin() + i);
+					++hoistedValues;
+				}
+			}
+		}
+
+		m_Statistics.HoistedValues += hoistedValues;
+		return hoistedValues != 0;
+	}
+	bool SSAOptimizer::EliminateDeadValues(SSAFunction& function) {
+		const std::uint64_t deadValues = RemoveDeadValues(function);
+		m_Statistics.DeadValues += deadValues;
+		return deadValues != 0;
+	}
+
+	void SSAOptimizer::CompactLocals(Instructions& instructions, std::uint16_t arity, const std::vector<const TypeInfo*>& localTypes) const {
+		const std::size_t localCount = localTypes.size();
+		if (localCount <= arity || localCount > 4096) return;
+
+		const ControlFlowGraph graph(instructions);
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		std::vector<std::vector<bool>> liveIns(blockCount, std::vector<bool>(localCount));
+		const auto transfer = [&](std::uint32_t block, std::vector<bool>& live, const auto& onStore) {
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				for (std::size_t i = 0; i < localCount; ++i) {
+					if (liveIns[successor][i]) {
+						live[i] = true;
+					}
+				}
+			}
+
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.End; i-- > range.Begin;) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (inst.OpCode == OpCode::Store) {
+					onStore(inst.Operand, live);
+					live[inst.Operand] = false;
+				} else if (inst.OpCode == OpCode::Load) {
+					live[inst.Operand] = true;
+				}
+			}
+		};
+
+		for (bool isChanged = true; isChanged;) {
+			isChanged = false;
+			for (std::uint32_t block = blockCount; block-- > 0;) {
+				std::vector<bool> live(localCount);
+				transfer(block, live, [](std::uint32_t, const std::vector<bool>&) {});
+				if (live != liveIns[block]) {
+					liveIns[block] = std::move(live);
+					isChanged = true;
+				}
+			}
+		}
+
+		// A local interferes with everything live where it is written.
+		std::vector<bool> isInterfering(localCount * localCount);
+		for (std::uint32_t block = 0; block < blockCount; ++block) {
+			std::vector<bool> live(localCount);
+			transfer(block, live, [&](std::uint32_t local, const std::vector<bool>& liveAfter) {
+				for (std::size_t i = 0; i < localCount; ++i) {
+					if (liveAfter[i] && i != local) {
+						isInterfering[local * localCount + i] = isInterfering[i * localCount + local] = true;
+					}
+				}
+			});
+		}
+
+		// Only scalar locals are shared; the verifier tracks references more precisely than these types do.
+		const auto isShareable = [](const TypeInfo* type) {
+			return type && type->Code >= TypeCode::Int && type->Code <= TypeCode::Double;
+		};
+		std::vector<std::uint32_t> colors(localCount);
+		std::vector<std::vector<std::uint32_t>> slots;
+		for (std::size_t i = 0; i < arity; ++i) {
+			colors[i] = static_cast<std::uint32_t>(i);
+		}
+		for (std::size_t i = arity; i < localCount; ++i) {
+			const auto slot = std::find_if(slots.begin(), slots.end(), [&](const std::vector<std::uint32_t>& members) {
+				return isShareable(localTypes[i]) && localTypes[members.front()] == localTypes[i] &&
+					std::none_of(members.begin(), members.end(), [&](std::uint32_t member) {
+						return isInterfering[i * localCount + member];
+					});
+			});
+			if (slot == slots.end()) {
+				colors[i] = arity + static_cast<std::uint32_t>(slots.size());
+				slots.push_back({ static_cast<std::uint32_t>(i) });
+			} else {
+				colors[i] = arity + static_cast<std::uint32_t>(slot - slots.begin());
+				slot->push_back(static_cast<std::uint32_t>(i));
+			}
+		}
+
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			Instruction inst = instructions.GetInstruction(i);
+			if (inst.OpCode != OpCode::Load && inst.OpCode != OpCode::Store) continue;
+
+			inst.Operand = colors[inst.Operand];
+			instructions.SetInstruction(i, inst);
+		}
+	}
+	bool SSAOptimizer::GetSignature(const ByteFile& byteFile, std::uint32_t function, FunctionSignature& result) const noexcept {
+		const Functions& functions = byteFile.GetFunctions();
+		if (function < functions.size()) {
+			result.Arity = functions[function].Arity;
+			result.HasResult = functions[function].HasResult;
+			return true;
+		}
+
+		const std::size_t mapping = function - functions.size();
+		if (mapping >= m_MappedFunctions.size()) return false;
+
+		result = m_MappedFunctions[mapping];
+		return true;
+	}
+	const TypeInfo* SSAOptimizer::GetType(const ByteFile& byteFile, std::uint32_t code) const noexcept {
+		if (const Type type = GetFundamentalType(static_cast<TypeCode>(code)); type != NoneType) return type.GetPointer();
+		if (code < static_cast<std::uint32_t>(TypeCode::Structure)) return nullptr;
+
+		const Structures& structures = byteFile.GetStructures();
+		const std::uint32_t index = code - static_cast<std::uint32_t>(TypeCode::Structure);
+		if (index < structures.size()) return &structures[index].Type;
+
+		const std::size_t mapping = index - structures.size();
+		return mapping < m_MappedStructures.size() ? &m_MappedStructures[mapping]->Type : nullptr;
+	}
+}
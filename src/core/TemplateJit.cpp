@@ -0,0 +1,880 @@
+#include <svm/core/TemplateJit.hpp>
+
+#include <svm/IO.hpp>
+#include <svm/Type.hpp>
+#include <svm/core/ReferenceInterpreter.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <utility>
+
+#ifdef SVM_JIT
+#	include <sys/mman.h>
+#endif
+
+namespace svm::core {
+	std::ostream& operator<<(std::ostream& stream, const JitStatistics& statistics) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+		const std::string indent = defIndent + indentOnce;
+
+		stream << defIndent << "JitStatistics:\n"
+			<< indent << "Compiled: " << statistics.Compiled << '\n'
+			<< indent << "Rejected: " << statistics.Rejected << '\n'
+			<< indent << "NativeInstructions: " << statistics.NativeInstructions << '\n'
+			<< indent << "ExitInstructions: " << statistics.ExitInstructions << '\n'
+			<< indent << "CodeSize: " << statistics.CodeSize;
+		return stream;
+	}
+}
+
+namespace svm::core {
+	NativeFunction::NativeFunction(void* code, std::size_t size, std::vector<std::uint32_t> entries) noexcept
+		: m_Code(code), m_Size(size), m_Entries(std::move(entries)) {}
+	NativeFunction::NativeFunction(NativeFunction&& function) noexcept
+		: m_Code(std::exchange(function.m_Code, nullptr)), m_Size(std::exchange(function.m_Size, 0)), m_Entries(std::move(function.m_Entries)) {}
+	NativeFunction::~NativeFunction() {
+#ifdef SVM_JIT
+		if (m_Code) {
+			munmap(m_Code, m_Size);
+		}
+#endif
+	}
+
+	NativeFunction& NativeFunction::operator=(NativeFunction&& function) noexcept {
+		NativeFunction temp(std::move(function));
+		std::swap(m_Code, temp.m_Code);
+		std::swap(m_Size, temp.m_Size);
+		std::swap(m_Entries, temp.m_Entries);
+		return *this;
+	}
+
+	bool NativeFunction::IsEmpty() const noexcept {
+		return m_Code == nullptr;
+	}
+	std::size_t NativeFunction::GetSize() const noexcept {
+		return m_Size;
+	}
+
+	void NativeFunction::Enter(NativeFrame& frame) const noexcept {
+		// The code starts with a prologue that loads the frame and jumps to the entry of the instruction.
+		using Prologue = void(*)(NativeFrame*, const void*);
+
+		const auto prologue = reinterpret_cast<Prologue>(m_Code);
+		prologue(&frame, static_cast<const std::uint8_t*>(m_Code) + m_Entries[frame.Index]);
+	}
+}
+
+namespace svm::core {
+	void CodeCache::Clear() noexcept {
+		m_Functions.clear();
+		m_CodeSize = 0;
+	}
+
+	const NativeFunction* CodeCache::Find(const ThreadedFunction& function) const noexcept {
+		const auto iter = m_Functions.find(function.GetId());
+		return iter != m_Functions.end() ? &iter->second : nullptr;
+	}
+	const NativeFunction* CodeCache::Add(const ThreadedFunction& function, const std::vector<std::uint8_t>& code, std::vector<std::uint32_t> entries) {
+#ifdef SVM_JIT
+		void* const data = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED) return nullptr;
+
+		std::memcpy(data, code.data(), code.size());
+		if (mprotect(data, code.size(), PROT_READ | PROT_EXEC) == -1) {
+			munmap(data, code.size());
+			return nullptr;
+		}
+
+		NativeFunction& result = m_Functions[function.GetId()];
+		result = NativeFunction(data, code.size(), std::move(entries));
+		m_CodeSize += code.size();
+		return &result;
+#else
+		static_cast<void>(function);
+		static_cast<void>(code);
+		static_cast<void>(entries);
+		return nullptr;
+#endif
+	}
+	std::uint32_t CodeCache::GetFunctionCount() const noexcept {
+		return static_cast<std::uint32_t>(m_Functions.size());
+	}
+	std::size_t CodeCache::GetCodeSize() const noexcept {
+		return m_CodeSize;
+	}
+}
+
+#ifdef SVM_JIT
+namespace svm::core {
+	namespace {
+		enum Register : std::uint8_t {
+			RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+			R8, R9, R10, R11, R12, R13, R14, R15,
+		};
+		enum Condition : std::uint8_t {
+			CB = 0x2, CAE = 0x3, CE = 0x4, CNE = 0x5, CA = 0x7,
+			CL = 0xC, CGE = 0xD, CLE = 0xE, CG = 0xF,
+		};
+
+		// Register assignment of compiled code:
+		//   rbx: NativeFrame*, r12: locals, r13: the stack top, r14: IntType, r15: LongType
+		// rax, rcx, rdx, r8 and xmm0 are scratch.
+		// Slots are always moved as two quadwords and integer results are always stored as quadwords, so a load never
+		// spans stores of different widths and store forwarding keeps working.
+		constexpr std::int32_t SlotSize = static_cast<std::int32_t>(sizeof(ReferenceValue));
+		constexpr std::int32_t ValueOffset = 8;
+		constexpr std::int32_t CountOffset = static_cast<std::int32_t>(sizeof(Object));
+
+		static_assert(sizeof(ReferenceValue) == 16 && sizeof(svm::Type) == ValueOffset);
+		static_assert(sizeof(IntObject) == sizeof(ReferenceValue) && sizeof(ArrayObject) == CountOffset + sizeof(std::size_t));
+
+		std::uint64_t GetTypeBits(const svm::Type& type) noexcept {
+			return reinterpret_cast<std::uintptr_t>(type.GetPointer());
+		}
+
+		class Assembler final {
+		public:
+			static constexpr std::size_t NPos = std::numeric_limits<std::size_t>::max();
+
+		private:
+			std::vector<std::uint8_t>& m_Code;
+			std::vector<std::size_t> m_Labels;
+			std::vector<std::pair<std::size_t, std::size_t>> m_Fixups;
+
+		public:
+			explicit Assembler(std::vector<std::uint8_t>& code) noexcept
+				: m_Code(code) {}
+			Assembler(const Assembler&) = delete;
+			~Assembler() = default;
+
+		public:
+			Assembler& operator=(const Assembler&) = delete;
+			bool operator==(const Assembler&) = delete;
+			bool operator!=(const Assembler&) = delete;
+
+		public:
+			std::size_t GetSize() const noexcept {
+				return m_Code.size();
+			}
+
+			std::size_t NewLabel() {
+				m_Labels.push_back(NPos);
+				return m_Labels.size() - 1;
+			}
+			void Bind(std::size_t label) noexcept {
+				m_Labels[label] = m_Code.size();
+			}
+			void ResolveFixups() noexcept {
+				for (const auto& [position, label] : m_Fixups) {
+					const auto displacement = static_cast<std::int32_t>(m_Labels[label] - (position + 4));
+					std::memcpy(m_Code.data() + position, &displacement, 4);
+				}
+				m_Fixups.clear();
+			}
+
+			void Byte(std::uint8_t value) {
+				m_Code.push_back(value);
+			}
+			void Dword(std::uint32_t value) {
+				for (int i = 0; i < 4; ++i) {
+					Byte(static_cast<std::uint8_t>(value >> (i * 8)));
+				}
+			}
+			void Qword(std::uint64_t value) {
+				for (int i = 0; i < 8; ++i) {
+					Byte(static_cast<std::uint8_t>(value >> (i * 8)));
+				}
+			}
+
+			// op reg, [base + displacement], or the reversed direction, depending on the opcode.
+			void Memory(std::initializer_list<std::uint8_t> opCode, bool isWide, std::uint8_t reg, std::uint8_t base, std::int32_t displacement,
+				std::uint8_t prefix = 0) {
+				if (prefix) {
+					Byte(prefix);
+				}
+				Rex(isWide, reg, base);
+				for (const std::uint8_t byte : opCode) {
+					Byte(byte);
+				}
+				Byte(static_cast<std::uint8_t>(0x80 | (reg & 7) << 3 | (base & 7)));
+				if ((base & 7) == RSP) {
+					Byte(0x24);
+				}
+				Dword(static_cast<std::uint32_t>(displacement));
+			}
+			// op rm, reg
+			void Direct(std::initializer_list<std::uint8_t> opCode, bool isWide, std::uint8_t reg, std::uint8_t rm) {
+				Rex(isWide, reg, rm);
+				for (const std::uint8_t byte : opCode) {
+					Byte(byte);
+				}
+				Byte(static_cast<std::uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)));
+			}
+
+			void MoveImmediate(std::uint8_t reg, std::uint64_t value) {
+				Rex(true, 0, reg);
+				Byte(static_cast<std::uint8_t>(0xB8 + (reg & 7)));
+				Qword(value);
+			}
+			void AddImmediate(std::uint8_t reg, std::int8_t value) {
+				Direct({ 0x83 }, true, 0, reg);
+				Byte(static_cast<std::uint8_t>(value));
+			}
+			void SubtractImmediate(bool isWide, std::uint8_t reg, std::int8_t value) {
+				Direct({ 0x83 }, isWide, 5, reg);
+				Byte(static_cast<std::uint8_t>(value));
+			}
+			void CompareImmediate(bool isWide, std::uint8_t reg, std::int8_t value) {
+				Direct({ 0x83 }, isWide, 7, reg);
+				Byte(static_cast<std::uint8_t>(value));
+			}
+			void Push(std::uint8_t reg) {
+				Rex(false, 0, reg);
+				Byte(static_cast<std::uint8_t>(0x50 + (reg & 7)));
+			}
+			void Pop(std::uint8_t reg) {
+				Rex(false, 0, reg);
+				Byte(static_cast<std::uint8_t>(0x58 + (reg & 7)));
+			}
+
+			void Jump(std::size_t label) {
+				Byte(0xE9);
+				Fixup(label);
+			}
+			void Jump(Condition condition, std::size_t label) {
+				Byte(0x0F);
+				Byte(static_cast<std::uint8_t>(0x80 | condition));
+				Fixup(label);
+			}
+			void Set(Condition condition, std::uint8_t reg) {
+				Byte(0x0F);
+				Byte(static_cast<std::uint8_t>(0x90 | condition));
+				Byte(static_cast<std::uint8_t>(0xC0 | reg));
+			}
+
+		private:
+			void Rex(bool isWide, std::uint8_t reg, std::uint8_t rm) {
+				const auto rex = static_cast<std::uint8_t>(0x40 | isWide << 3 | (reg >> 3) << 2 | (rm >> 3));
+				if (rex != 0x40) {
+					Byte(rex);
+				}
+			}
+			void Fixup(std::size_t label) {
+				m_Fixups.emplace_back(m_Code.size(), label);
+				Dword(0);
+			}
+		};
+
+		class TemplateEmitter final {
+		private:
+			Assembler m_Assembler;
+			std::vector<std::size_t> m_Starts;
+			std::vector<std::size_t> m_Exits;
+			std::size_t m_Index = 0;
+
+		public:
+			TemplateEmitter(std::vector<std::uint8_t>& code, std::uint64_t instCount)
+				: m_Assembler(code), m_Exits(instCount, Assembler::NPos) {
+				m_Starts.reserve(instCount);
+				for (std::uint64_t i = 0; i < instCount; ++i) {
+					m_Starts.push_back(m_Assembler.NewLabel());
+				}
+			}
+			TemplateEmitter(const TemplateEmitter&) = delete;
+			~TemplateEmitter() = default;
+
+		public:
+			TemplateEmitter& operator=(const TemplateEmitter&) = delete;
+			bool operator==(const TemplateEmitter&) = delete;
+			bool operator!=(const TemplateEmitter&) = delete;
+
+		public:
+			void EmitPrologue();
+			std::size_t Begin(std::uint64_t index);
+			bool EmitInstruction(const ThreadedInstruction& inst);
+			void EmitExits();
+
+		private:
+			std::size_t GetExit();
+			void EmitAggregateGuard(std::uint8_t base, std::int32_t displacement);
+			void EmitBinaryGuard(std::size_t intLabel, std::size_t longLabel, std::size_t singleLabel, std::size_t doubleLabel);
+			void EmitUnaryGuard(std::size_t intLabel, std::size_t longLabel);
+			void EmitFundamentalGuard();
+			void EmitCopySlot(std::uint8_t sourceBase, std::int32_t source, std::uint8_t destinationBase, std::int32_t destination);
+			void EmitStoreType(const svm::Type& type, std::int32_t displacement);
+
+			void EmitLoadObject();
+			void EmitStoreObject();
+			void EmitElement();
+
+			void EmitArithmetic(std::initializer_list<std::uint8_t> intOpCode, std::uint8_t floatOpCode);
+			void EmitDivide(bool isSigned, bool isRemainder);
+			void EmitUnary(std::uint8_t opCode, std::uint8_t extension);
+			void EmitShift(std::uint8_t extension);
+			void EmitCompare(bool isSigned);
+			void EmitConditionalJump(Condition condition, std::uint64_t target);
+			void EmitConvert(bool isToLong);
+		};
+
+		void TemplateEmitter::EmitPrologue() {
+			Assembler& a = m_Assembler;
+			a.Push(RBX);
+			a.Push(R12);
+			a.Push(R13);
+			a.Push(R14);
+			a.Push(R15);
+			a.Direct({ 0x89 }, true, RDI, RBX);
+			a.Memory({ 0x8B }, true, R12, RBX, static_cast<std::int32_t>(offsetof(NativeFrame, Locals)));
+			a.Memory({ 0x8B }, true, R13, RBX, static_cast<std::int32_t>(offsetof(NativeFrame, Stack)));
+			a.MoveImmediate(R14, GetTypeBits(IntType));
+			a.MoveImmediate(R15, GetTypeBits(LongType));
+			a.Direct({ 0xFF }, false, 4, RSI);
+		}
+		std::size_t TemplateEmitter::Begin(std::uint64_t index) {
+			m_Index = static_cast<std::size_t>(index);
+			m_Assembler.Bind(m_Starts[m_Index]);
+			return m_Assembler.GetSize();
+		}
+		void TemplateEmitter::EmitExits() {
+			Assembler& a = m_Assembler;
+			const std::size_t commonExit = a.NewLabel();
+			for (std::size_t i = 0; i < m_Exits.size(); ++i) {
+				if (m_Exits[i] == Assembler::NPos) continue;
+
+				a.Bind(m_Exits[i]);
+				a.Memory({ 0xC7 }, true, 0, RBX, static_cast<std::int32_t>(offsetof(NativeFrame, Index)));
+				a.Dword(static_cast<std::uint32_t>(i));
+				a.Jump(commonExit);
+			}
+
+			a.Bind(commonExit);
+			a.Memory({ 0x89 }, true, R13, RBX, static_cast<std::int32_t>(offsetof(NativeFrame, Stack)));
+			a.Pop(R15);
+			a.Pop(R14);
+			a.Pop(R13);
+			a.Pop(R12);
+			a.Pop(RBX);
+			a.Byte(0xC3);
+			a.ResolveFixups();
+		}
+
+		std::size_t TemplateEmitter::GetExit() {
+			if (m_Exits[m_Index] == Assembler::NPos) {
+				m_Exits[m_Index] = m_Assembler.NewLabel();
+			}
+			return m_Exits[m_Index];
+		}
+		void TemplateEmitter::EmitAggregateGuard(std::uint8_t base, std::int32_t displacement) {
+			// Structures and arrays are copied by the interpreter.
+			Assembler& a = m_Assembler;
+			const std::size_t exit = GetExit();
+			const std::size_t done = a.NewLabel();
+			a.Memory({ 0x8B }, true, RAX, base, displacement);
+			a.Direct({ 0x85 }, true, RAX, RAX);
+			a.Jump(CE, done);
+			a.Memory({ 0x8B }, false, RCX, RAX, static_cast<std::int32_t>(offsetof(TypeInfo, Code)));
+			a.CompareImmediate(false, RCX, static_cast<std::int8_t>(TypeCode::Array));
+			a.Jump(CE, exit);
+			a.CompareImmediate(false, RCX, static_cast<std::int8_t>(TypeCode::Structure));
+			a.Jump(CAE, exit);
+			a.Bind(done);
+		}
+		void TemplateEmitter::EmitBinaryGuard(std::size_t intLabel, std::size_t longLabel, std::size_t singleLabel, std::size_t doubleLabel) {
+			Assembler& a = m_Assembler;
+			const std::size_t exit = GetExit();
+			a.Memory({ 0x8B }, true, RAX, R13, -2 * SlotSize);
+			a.Memory({ 0x3B }, true, RAX, R13, -SlotSize);
+			a.Jump(CNE, exit);
+			a.Direct({ 0x39 }, true, R14, RAX);
+			a.Jump(CE, intLabel);
+			a.Direct({ 0x39 }, true, R15, RAX);
+			a.Jump(CE, longLabel);
+			if (singleLabel != Assembler::NPos) {
+				a.MoveImmediate(RCX, GetTypeBits(SingleType));
+				a.Direct({ 0x39 }, true, RCX, RAX);
+				a.Jump(CE, singleLabel);
+			}
+			if (doubleLabel != Assembler::NPos) {
+				a.MoveImmediate(RCX, GetTypeBits(DoubleType));
+				a.Direct({ 0x39 }, true, RCX, RAX);
+				a.Jump(CE, doubleLabel);
+			}
+			a.Jump(exit);
+		}
+		void TemplateEmitter::EmitUnaryGuard(std::size_t intLabel, std::size_t longLabel) {
+			Assembler& a = m_Assembler;
+			a.Memory({ 0x8B }, true, RAX, R13, -SlotSize);
+			a.Direct({ 0x39 }, true, R14, RAX);
+			a.Jump(CE, intLabel);
+			a.Direct({ 0x39 }, true, R15, RAX);
+			a.Jump(CE, longLabel);
+			a.Jump(GetExit());
+		}
+		void TemplateEmitter::EmitFundamentalGuard() {
+			// rax holds the type of an object; anything but Int to GCPointer is left to the interpreter.
+			Assembler& a = m_Assembler;
+			a.Memory({ 0x8B }, false, RCX, RAX, static_cast<std::int32_t>(offsetof(TypeInfo, Code)));
+			a.SubtractImmediate(false, RCX, static_cast<std::int8_t>(TypeCode::Int));
+			a.CompareImmediate(false, RCX, static_cast<std::int8_t>(TypeCode::GCPointer) - static_cast<std::int8_t>(TypeCode::Int));
+			a.Jump(CA, GetExit());
+		}
+		void TemplateEmitter::EmitCopySlot(std::uint8_t sourceBase, std::int32_t source, std::uint8_t destinationBase, std::int32_t destination) {
+			Assembler& a = m_Assembler;
+			a.Memory({ 0x8B }, true, RAX, sourceBase, source);
+			a.Memory({ 0x8B }, true, RCX, sourceBase, source + ValueOffset);
+			a.Memory({ 0x89 }, true, RAX, destinationBase, destination);
+			a.Memory({ 0x89 }, true, RCX, destinationBase, destination + ValueOffset);
+		}
+		void TemplateEmitter::EmitStoreType(const svm::Type& type, std::int32_t displacement) {
+			Assembler& a = m_Assembler;
+			if (type == IntType) {
+				a.Memory({ 0x89 }, true, R14, R13, displacement);
+			} else if (type == LongType) {
+				a.Memory({ 0x89 }, true, R15, R13, displacement);
+			} else {
+				a.MoveImmediate(RAX, GetTypeBits(type));
+				a.Memory({ 0x89 }, true, RAX, R13, displacement);
+			}
+		}
+
+		void TemplateEmitter::EmitLoadObject() {
+			// Objects of fundamental types have the layout of a stack slot.
+			Assembler& a = m_Assembler;
+			a.Memory({ 0x8B }, true, RDX, R13, -SlotSize + ValueOffset);
+			a.Direct({ 0x85 }, true, RDX, RDX);
+			a.Jump(CE, GetExit());
+			a.Memory({ 0x8B }, true, RAX, RDX, 0);
+			EmitFundamentalGuard();
+			EmitCopySlot(RDX, 0, R13, -SlotSize);
+		}
+		void TemplateEmitter::EmitStoreObject() {
+			Assembler& a = m_Assembler;
+			a.Memory({ 0x8B }, true, RDX, R13, -SlotSize + ValueOffset);
+			a.Direct({ 0x85 }, true, RDX, RDX);
+			a.Jump(CE, GetExit());
+			a.Memory({ 0x8B }, true, RAX, RDX, 0);
+			a.Memory({ 0x3B }, true, RAX, R13, -2 * SlotSize);
+			a.Jump(CNE, GetExit());
+			EmitFundamentalGuard();
+			a.Memory({ 0x8B }, true, RAX, R13, -2 * SlotSize + ValueOffset);
+			a.Memory({ 0x89 }, true, RAX, RDX, ValueOffset);
+			a.AddImmediate(R13, -2 * SlotSize);
+		}
+		void TemplateEmitter::EmitElement() {
+			Assembler& a = m_Assembler;
+			const std::size_t exit = GetExit();
+			const std::size_t longLabel = a.NewLabel(), hasIndex = a.NewLabel();
+			a.Memory({ 0x8B }, true, RAX, R13, -SlotSize);
+			a.Direct({ 0x39 }, true, R14, RAX);
+			a.Jump(CNE, longLabel);
+			a.Memory({ 0x8B }, false, RCX, R13, -SlotSize + ValueOffset);
+			a.Jump(hasIndex);
+			a.Bind(longLabel);
+			a.Direct({ 0x39 }, true, R15, RAX);
+			a.Jump(CNE, exit);
+			a.Memory({ 0x8B }, true, RCX, R13, -SlotSize + ValueOffset);
+
+			a.Bind(hasIndex);
+			a.Memory({ 0x8B }, true, RDX, R13, -2 * SlotSize + ValueOffset);
+			a.Direct({ 0x85 }, true, RDX, RDX);
+			a.Jump(CE, exit);
+			a.MoveImmediate(RAX, GetTypeBits(ArrayType));
+			a.Memory({ 0x3B }, true, RAX, RDX, 0);
+			a.Jump(CNE, exit);
+			a.Memory({ 0x3B }, true, RCX, RDX, CountOffset);
+			a.Jump(CAE, exit);
+
+			a.Memory({ 0x8B }, true, RAX, RDX, static_cast<std::int32_t>(sizeof(ArrayObject)));
+			a.Memory({ 0x8B }, true, RAX, RAX, static_cast<std::int32_t>(offsetof(TypeInfo, Size)));
+			a.Direct({ 0x0F, 0xAF }, true, RCX, RAX);
+			a.Direct({ 0x01 }, true, RDX, RCX);
+			a.AddImmediate(RCX, static_cast<std::int8_t>(sizeof(ArrayObject)));
+			EmitStoreType(PointerType, -2 * SlotSize);
+			a.Memory({ 0x89 }, true, RCX, R13, -2 * SlotSize + ValueOffset);
+			a.AddImmediate(R13, -SlotSize);
+		}
+
+		void TemplateEmitter::EmitArithmetic(std::initializer_list<std::uint8_t> intOpCode, std::uint8_t floatOpCode) {
+			// The low half of a product does not depend on the signedness, so imul serves both multiplications.
+			Assembler& a = m_Assembler;
+			const std::size_t intLabel = a.NewLabel(), longLabel = a.NewLabel();
+			const std::size_t singleLabel = floatOpCode ? a.NewLabel() : Assembler::NPos;
+			const std::size_t doubleLabel = floatOpCode ? a.NewLabel() : Assembler::NPos;
+			const std::size_t done = a.NewLabel();
+			EmitBinaryGuard(intLabel, longLabel, singleLabel, doubleLabel);
+
+			for (const bool isWide : { false, true }) {
+				a.Bind(isWide ? longLabel : intLabel);
+				a.Memory({ 0x8B }, isWide, RAX, R13, -2 * SlotSize + ValueOffset);
+				a.Memory(intOpCode, isWide, RAX, R13, -SlotSize + ValueOffset);
+				a.Memory({ 0x89 }, true, RAX, R13, -2 * SlotSize + ValueOffset);
+				a.Jump(done);
+			}
+			if (floatOpCode) {
+				for (const std::uint8_t prefix : { 0xF3, 0xF2 }) {
+					a.Bind(prefix == 0xF3 ? singleLabel : doubleLabel);
+					a.Memory({ 0x0F, 0x10 }, false, 0, R13, -2 * SlotSize + ValueOffset, prefix);
+					a.Memory({ 0x0F, floatOpCode }, false, 0, R13, -SlotSize + ValueOffset, prefix);
+					a.Memory({ 0x0F, 0x11 }, false, 0, R13, -2 * SlotSize + ValueOffset, prefix);
+					a.Jump(done);
+				}
+			}
+
+			a.Bind(done);
+			a.AddImmediate(R13, -SlotSize);
+		}
+		void TemplateEmitter::EmitDivide(bool isSigned, bool isRemainder) {
+			// A zero divisor and, for the signed forms, -1 are left to the interpreter. Floating-point division is
+			// inlined; the floating-point remainder is not.
+			Assembler& a = m_Assembler;
+			const std::size_t exit = GetExit();
+			const std::size_t intLabel = a.NewLabel(), longLabel = a.NewLabel();
+			const bool hasFloat = !isSigned && !isRemainder;
+			const std::size_t singleLabel = hasFloat ? a.NewLabel() : Assembler::NPos;
+			const std::size_t doubleLabel = hasFloat ? a.NewLabel() : Assembler::NPos;
+			const std::size_t done = a.NewLabel();
+			EmitBinaryGuard(intLabel, longLabel, singleLabel, doubleLabel);
+
+			for (const bool isWide : { false, true }) {
+				a.Bind(isWide ? longLabel : intLabel);
+				a.Memory({ 0x8B }, isWide, RCX, R13, -SlotSize + ValueOffset);
+				a.Direct({ 0x85 }, isWide, RCX, RCX);
+				a.Jump(CE, exit);
+				a.Memory({ 0x8B }, isWide, RAX, R13, -2 * SlotSize + ValueOffset);
+				if (isSigned) {
+					a.CompareImmediate(isWide, RCX, -1);
+					a.Jump(CE, exit);
+					if (isWide) {
+						a.Byte(0x48);
+					}
+					a.Byte(0x99);
+					a.Direct({ 0xF7 }, isWide, 7, RCX);
+				} else {
+					a.Direct({ 0x31 }, false, RDX, RDX);
+					a.Direct({ 0xF7 }, isWide, 6, RCX);
+				}
+				a.Memory({ 0x89 }, true, isRemainder ? RDX : RAX, R13, -2 * SlotSize + ValueOffset);
+				a.Jump(done);
+			}
+			if (hasFloat) {
+				for (const std::uint8_t prefix : { 0xF3, 0xF2 }) {
+					a.Bind(prefix == 0xF3 ? singleLabel : doubleLabel);
+					a.Memory({ 0x0F, 0x10 }, false, 0, R13, -2 * SlotSize + ValueOffset, prefix);
+					a.Memory({ 0x0F, 0x5E }, false, 0, R13, -SlotSize + ValueOffset, prefix);
+					a.Memory({ 0x0F, 0x11 }, false, 0, R13, -2 * SlotSize + ValueOffset, prefix);
+					a.Jump(done);
+				}
+			}
+
+			a.Bind(done);
+			a.AddImmediate(R13, -SlotSize);
+		}
+		void TemplateEmitter::EmitUnary(std::uint8_t opCode, std::uint8_t extension) {
+			Assembler& a = m_Assembler;
+			const std::size_t intLabel = a.NewLabel(), longLabel = a.NewLabel();
+			const std::size_t done = a.NewLabel();
+			EmitUnaryGuard(intLabel, longLabel);
+
+			for (const bool isWide : { false, true }) {
+				a.Bind(isWide ? longLabel : intLabel);
+				a.Memory({ 0x8B }, isWide, RAX, R13, -SlotSize + ValueOffset);
+				a.Direct({ opCode }, isWide, extension, RAX);
+				a.Memory({ 0x89 }, true, RAX, R13, -SlotSize + ValueOffset);
+				a.Jump(done);
+			}
+			a.Bind(done);
+		}
+		void TemplateEmitter::EmitShift(std::uint8_t extension) {
+			// The hardware masks the count to the width of the operand like the interpreter does.
+			Assembler& a = m_Assembler;
+			const std::size_t intLabel = a.NewLabel(), longLabel = a.NewLabel();
+			const std::size_t done = a.NewLabel();
+			EmitBinaryGuard(intLabel, longLabel, Assembler::NPos, Assembler::NPos);
+
+			for (const bool isWide : { false, true }) {
+				a.Bind(isWide ? longLabel : intLabel);
+				a.Memory({ 0x8B }, false, RCX, R13, -SlotSize + ValueOffset);
+				a.Memory({ 0x8B }, isWide, RAX, R13, -2 * SlotSize + ValueOffset);
+				a.Direct({ 0xD3 }, isWide, extension, RAX);
+				a.Memory({ 0x89 }, true, RAX, R13, -2 * SlotSize + ValueOffset);
+				a.Jump(done);
+			}
+
+			a.Bind(done);
+			a.AddImmediate(R13, -SlotSize);
+		}
+		void TemplateEmitter::EmitCompare(bool isSigned) {
+			// Pointers are ordered as unsigned 64-bit integers. Floating-point orders are left to the interpreter.
+			Assembler& a = m_Assembler;
+			const std::size_t exit = GetExit();
+			const std::size_t intLabel = a.NewLabel(), longLabel = a.NewLabel();
+			const std::size_t order = a.NewLabel();
+			a.Memory({ 0x8B }, true, RAX, R13, -2 * SlotSize);
+			a.Memory({ 0x3B }, true, RAX, R13, -SlotSize);
+			a.Jump(CNE, exit);
+			a.Direct({ 0x39 }, true, R14, RAX);
+			a.Jump(CE, intLabel);
+			a.Direct({ 0x39 }, true, R15, RAX);
+			a.Jump(CE, longLabel);
+			if (!isSigned) {
+				for (const svm::Type& type : { PointerType, GCPointerType }) {
+					a.MoveImmediate(RCX, GetTypeBits(type));
+					a.Direct({ 0x39 }, true, RCX, RAX);
+					a.Jump(CE, longLabel);
+				}
+			}
+			a.Jump(exit);
+
+			for (const bool isWide : { false, true }) {
+				a.Bind(isWide ? longLabel : intLabel);
+				a.Memory({ 0x8B }, isWide, RAX, R13, -2 * SlotSize + ValueOffset);
+				a.Memory({ 0x3B }, isWide, RAX, R13, -SlotSize + ValueOffset);
+				if (!isWide) {
+					a.Jump(order);
+				}
+			}
+
+			a.Bind(order);
+			a.Set(isSigned ? CG : CA, RDX);
+			a.Set(isSigned ? CL : CB, RAX);
+			a.Direct({ 0x0F, 0xB6 }, false, RDX, RDX);
+			a.Direct({ 0x0F, 0xB6 }, false, RAX, RAX);
+			a.Direct({ 0x29 }, false, RAX, RDX);
+			a.Memory({ 0x89 }, true, R14, R13, -2 * SlotSize);
+			a.Memory({ 0x89 }, true, RDX, R13, -2 * SlotSize + ValueOffset);
+			a.AddImmediate(R13, -SlotSize);
+		}
+		void TemplateEmitter::EmitConditionalJump(Condition condition, std::uint64_t target) {
+			Assembler& a = m_Assembler;
+			a.AddImmediate(R13, -SlotSize);
+			a.Memory({ 0x8B }, false, RAX, R13, ValueOffset);
+			a.Direct({ 0x85 }, false, RAX, RAX);
+			a.Jump(condition, m_Starts[static_cast<std::size_t>(target)]);
+		}
+		void TemplateEmitter::EmitConvert(bool isToLong) {
+			Assembler& a = m_Assembler;
+			const std::size_t done = a.NewLabel();
+			a.Memory({ 0x8B }, true, RAX, R13, -SlotSize);
+			a.Direct({ 0x39 }, true, isToLong ? R15 : R14, RAX);
+			a.Jump(CE, done);
+			a.Direct({ 0x39 }, true, isToLong ? R14 : R15, RAX);
+			a.Jump(CNE, GetExit());
+			if (isToLong) {
+				a.Memory({ 0x8B }, false, RAX, R13, -SlotSize + ValueOffset);
+				a.Memory({ 0x89 }, true, RAX, R13, -SlotSize + ValueOffset);
+			}
+			a.Memory({ 0x89 }, true, isToLong ? R15 : R14, R13, -SlotSize);
+			a.Bind(done);
+		}
+
+		bool TemplateEmitter::EmitInstruction(const ThreadedInstruction& inst) {
+			Assembler& a = m_Assembler;
+			const auto local = static_cast<std::int32_t>(inst.Operand * SlotSize);
+
+			switch (inst.OpCode) {
+			case OpCode::Nop: return true;
+
+			case OpCode::Push:
+				if (inst.ConstantType == TypeCode::Structure) break;
+
+				EmitStoreType(detail::GetConstantType(inst.ConstantType), 0);
+				a.MoveImmediate(RAX, inst.LongValue);
+				a.Memory({ 0x89 }, true, RAX, R13, ValueOffset);
+				a.AddImmediate(R13, SlotSize);
+				return true;
+
+			case OpCode::Pop:
+				a.AddImmediate(R13, -SlotSize);
+				return true;
+
+			case OpCode::Load:
+				EmitAggregateGuard(R12, local);
+				EmitCopySlot(R12, local, R13, 0);
+				a.AddImmediate(R13, SlotSize);
+				return true;
+
+			case OpCode::Store:
+				EmitAggregateGuard(R13, -SlotSize);
+				a.AddImmediate(R13, -SlotSize);
+				EmitCopySlot(R13, 0, R12, local);
+				return true;
+
+			case OpCode::Lea:
+				EmitAggregateGuard(R12, local);
+				a.Memory({ 0x8D }, true, RAX, R12, local);
+				a.Memory({ 0x89 }, true, RAX, R13, ValueOffset);
+				EmitStoreType(PointerType, 0);
+				a.AddImmediate(R13, SlotSize);
+				return true;
+
+			case OpCode::TLoad:
+				EmitLoadObject();
+				return true;
+
+			case OpCode::TStore:
+				EmitStoreObject();
+				return true;
+
+			case OpCode::Copy:
+				EmitAggregateGuard(R13, -SlotSize);
+				EmitCopySlot(R13, -SlotSize, R13, 0);
+				a.AddImmediate(R13, SlotSize);
+				return true;
+
+			case OpCode::Swap:
+				a.Memory({ 0x8B }, true, RDX, R13, -SlotSize);
+				a.Memory({ 0x8B }, true, R8, R13, -SlotSize + ValueOffset);
+				EmitCopySlot(R13, -2 * SlotSize, R13, -SlotSize);
+				a.Memory({ 0x89 }, true, RDX, R13, -2 * SlotSize);
+				a.Memory({ 0x89 }, true, R8, R13, -2 * SlotSize + ValueOffset);
+				return true;
+
+			case OpCode::Add: EmitArithmetic({ 0x03 }, 0x58); return true;
+			case OpCode::Sub: EmitArithmetic({ 0x2B }, 0x5C); return true;
+			case OpCode::Mul: EmitArithmetic({ 0x0F, 0xAF }, 0x59); return true;
+			case OpCode::IMul: EmitArithmetic({ 0x0F, 0xAF }, 0); return true;
+			case OpCode::Div: EmitDivide(false, false); return true;
+			case OpCode::IDiv: EmitDivide(true, false); return true;
+			case OpCode::Mod: EmitDivide(false, true); return true;
+			case OpCode::IMod: EmitDivide(true, true); return true;
+			case OpCode::Neg: EmitUnary(0xF7, 3); return true;
+			case OpCode::Inc: EmitUnary(0xFF, 0); return true;
+			case OpCode::Dec: EmitUnary(0xFF, 1); return true;
+			case OpCode::And: EmitArithmetic({ 0x23 }, 0); return true;
+			case OpCode::Or: EmitArithmetic({ 0x0B }, 0); return true;
+			case OpCode::Xor: EmitArithmetic({ 0x33 }, 0); return true;
+			case OpCode::Not: EmitUnary(0xF7, 2); return true;
+			case OpCode::Shl:
+			case OpCode::Sal: EmitShift(4); return true;
+			case OpCode::Shr: EmitShift(5); return true;
+			case OpCode::Sar: EmitShift(7); return true;
+			case OpCode::Cmp: EmitCompare(false); return true;
+			case OpCode::ICmp: EmitCompare(true); return true;
+
+			case OpCode::Jmp:
+				a.Jump(m_Starts[static_cast<std::size_t>(inst.Target)]);
+				return true;
+
+			case OpCode::Je: EmitConditionalJump(CE, inst.Target); return true;
+			case OpCode::Jne: EmitConditionalJump(CNE, inst.Target); return true;
+			case OpCode::Ja: EmitConditionalJump(CG, inst.Target); return true;
+			case OpCode::Jae: EmitConditionalJump(CGE, inst.Target); return true;
+			case OpCode::Jb: EmitConditionalJump(CL, inst.Target); return true;
+			case OpCode::Jbe: EmitConditionalJump(CLE, inst.Target); return true;
+
+			case OpCode::ToI: EmitConvert(false); return true;
+			case OpCode::ToL: EmitConvert(true); return true;
+
+			case OpCode::ALea:
+				EmitElement();
+				return true;
+
+			case OpCode::Null:
+			case OpCode::GCNull:
+				EmitStoreType(inst.OpCode == OpCode::Null ? PointerType : GCPointerType, 0);
+				a.Memory({ 0xC7 }, true, 0, R13, ValueOffset);
+				a.Dword(0);
+				a.AddImmediate(R13, SlotSize);
+				return true;
+
+			default: break;
+			}
+
+			// Calls, returns, allocations, field addresses and the fused forms run in the interpreter.
+			a.Jump(GetExit());
+			return false;
+		}
+	}
+}
+#endif
+
+namespace svm::core {
+	bool TemplateCompiler::IsSupported() noexcept {
+#ifdef SVM_JIT
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	const NativeFunction* TemplateCompiler::Compile(const ThreadedFunction& function, CodeCache& cache) {
+		if (const NativeFunction* const native = cache.Find(function); native) return native;
+
+		std::vector<std::uint8_t> code;
+		std::vector<std::uint32_t> entries;
+		if (!Compile(function, code, entries)) return nullptr;
+
+		const NativeFunction* const native = cache.Add(function, code, std::move(entries));
+		if (!native) {
+			--m_Statistics.Compiled;
+			++m_Statistics.Rejected;
+		}
+		return native;
+	}
+	bool TemplateCompiler::Compile(const ThreadedFunction& function, std::vector<std::uint8_t>& code, std::vector<std::uint32_t>& entries) {
+		code.clear();
+		entries.clear();
+
+#ifdef SVM_JIT
+		// Templates trust the stack discipline, which only verified functions guarantee. The entrypoint has no
+		// verification level of its own, so it stays interpreted.
+		if (const FunctionInfo* const info = function.GetFunction(); !info || info->Verification == VerificationLevel::Unverified) {
+			++m_Statistics.Rejected;
+			return false;
+		}
+
+		// Displacements of locals and exit indices are 32-bit.
+		const std::uint64_t instCount = function.GetInstructionCount();
+		bool isEncodable = instCount <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max());
+		for (std::uint64_t i = 0; i < instCount && isEncodable; ++i) {
+			const ThreadedInstruction& inst = function.GetInstruction(i);
+			if (inst.OpCode == OpCode::Load || inst.OpCode == OpCode::Store || inst.OpCode == OpCode::Lea) {
+				isEncodable = inst.Operand < static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max() / SlotSize);
+			}
+		}
+		if (!isEncodable) {
+			++m_Statistics.Rejected;
+			return false;
+		}
+
+		TemplateEmitter emitter(code, instCount);
+		emitter.EmitPrologue();
+
+		std::uint64_t nativeCount = 0;
+		entries.reserve(static_cast<std::size_t>(instCount));
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			entries.push_back(static_cast<std::uint32_t>(emitter.Begin(i)));
+			nativeCount += emitter.EmitInstruction(function.GetInstruction(i));
+		}
+		emitter.EmitExits();
+
+		if (nativeCount == 0 || code.size() > std::numeric_limits<std::uint32_t>::max()) {
+			code.clear();
+			entries.clear();
+			++m_Statistics.Rejected;
+			return false;
+		}
+
+		++m_Statistics.Compiled;
+		m_Statistics.NativeInstructions += nativeCount;
+		m_Statistics.ExitInstructions += instCount - nativeCount;
+		m_Statistics.CodeSize += code.size();
+		return true;
+#else
+		static_cast<void>(function);
+		++m_Statistics.Rejected;
+		return false;
+#endif
+	}
+
+	const JitStatistics& TemplateCompiler::GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+	void TemplateCompiler::ResetStatistics() noexcept {
+		m_Statistics = {};
+	}
+}
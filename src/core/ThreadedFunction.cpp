@@ -0,0 +1,93 @@
+#include <svm/core/ThreadedFunction.hpp>
+
+#include <svm/IO.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace svm::core {
+	ThreadedInstruction::ThreadedInstruction(svm::OpCode opCode, std::uint64_t operand) noexcept
+		: OpCode(opCode), Operand(operand) {}
+
+	std::ostream& operator<<(std::ostream& stream, const ThreadedInstruction& instruction) {
+		using svm::operator<<;
+
+		stream << Mnemonics[static_cast<std::uint8_t>(instruction.OpCode)];
+		if (!svm::HasOperand[static_cast<std::uint8_t>(instruction.OpCode)]) return stream;
+
+		switch (instruction.OpCode) {
+		case svm::OpCode::Push:
+			switch (instruction.ConstantType) {
+			case TypeCode::Int: return stream << ' ' << instruction.IntValue;
+			case TypeCode::Long: return stream << ' ' << instruction.LongValue;
+			case TypeCode::Single: return stream << ' ' << instruction.SingleValue;
+			case TypeCode::Double: return stream << ' ' << instruction.DoubleValue;
+			case TypeCode::Structure: return stream << ' ' << instruction.Type->Name;
+			default: return stream << " 0x" << Hex(instruction.Operand);
+			}
+
+		case svm::OpCode::Jmp:
+		case svm::OpCode::Je:
+		case svm::OpCode::Jne:
+		case svm::OpCode::Ja:
+		case svm::OpCode::Jae:
+		case svm::OpCode::Jb:
+		case svm::OpCode::Jbe:
+			return stream << " [" << instruction.Target << ']';
+
+		case svm::OpCode::Call:
+			if (instruction.IsVirtualCall) return stream << " <virtual>";
+			else return stream << ' ' << instruction.Function->Name;
+
+		case svm::OpCode::New:
+		case svm::OpCode::GCNew:
+		case svm::OpCode::APush:
+		case svm::OpCode::ANew:
+		case svm::OpCode::AGCNew:
+			return stream << ' ' << instruction.Type->Name;
+
+		default:
+			return stream << " 0x" << Hex(instruction.Operand);
+		}
+	}
+}
+
+namespace svm::core {
+	namespace {
+		std::atomic<std::uint64_t> NextId = 1;
+	}
+
+	ThreadedFunction::ThreadedFunction(const FunctionInfo* function, std::vector<ThreadedInstruction> instructions) noexcept
+		: m_Function(function), m_Instructions(std::move(instructions)), m_Id(NextId.fetch_add(1, std::memory_order_relaxed)) {}
+
+	const FunctionInfo* ThreadedFunction::GetFunction() const noexcept {
+		return m_Function;
+	}
+	std::uint64_t ThreadedFunction::GetId() const noexcept {
+		return m_Id;
+	}
+	const ThreadedInstruction& ThreadedFunction::GetInstruction(std::uint64_t index) const noexcept {
+		return m_Instructions[static_cast<std::size_t>(index)];
+	}
+	std::uint64_t ThreadedFunction::GetInstructionCount() const noexcept {
+		return m_Instructions.size();
+	}
+	const ThreadedInstruction* ThreadedFunction::GetInstructions() const noexcept {
+		return m_Instructions.data();
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const ThreadedFunction& function) {
+		const std::string defIndent = detail::MakeIndent(stream);
+		const std::string indentOnce(4, ' ');
+
+		const std::uint64_t instCount = function.GetInstructionCount();
+
+		stream << defIndent << "ThreadedFunction: " << instCount;
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			stream << '\n' << defIndent << indentOnce << '[' << i << "]: " << function.GetInstruction(i);
+		}
+		return stream;
+	}
+}
@@ -0,0 +1,509 @@
+#include <svm/core/Verifier.hpp>
+
+#include <svm/ControlFlowGraph.hpp>
+#include <svm/Structure.hpp>
+
+#include <utility>
+
+namespace svm::core {
+	std::ostream& operator<<(std::ostream& stream, const VerifierResult& result) {
+		if (result.Error == VerifierError::None) {
+			return stream << (result.Level == VerificationLevel::TypeSafe ? "typesafe" : "structural");
+		}
+		return stream << VerifierErrorMessages[static_cast<std::uint8_t>(result.Error)] << " at [" << result.Instruction << ']';
+	}
+}
+
+namespace svm::core {
+	struct Verifier::Value final {
+		const TypeInfo* Type = nullptr;
+		const TypeInfo* Pointee = nullptr;
+		bool IsArray = false;
+
+		bool operator==(const Value& value) const noexcept {
+			return Type == value.Type && Pointee == value.Pointee && IsArray == value.IsArray;
+		}
+		bool operator!=(const Value& value) const noexcept {
+			return !(*this == value);
+		}
+	};
+
+	struct Verifier::State final {
+		bool IsVisited = false;
+		std::vector<Value> Stack;
+		std::vector<Value> Locals;
+		std::vector<bool> IsDefined;
+
+		// Values that differ between paths lose their static type.
+		VerifierError Merge(const State& state, bool& isChanged) {
+			if (!IsVisited) {
+				*this = state;
+				isChanged = true;
+				return VerifierError::None;
+			}
+			if (Stack.size() != state.Stack.size()) return VerifierError::StackMismatch;
+
+			isChanged = false;
+			for (std::size_t i = 0; i < Stack.size(); ++i) {
+				if (Stack[i].Type && Stack[i] != state.Stack[i]) {
+					Stack[i] = {};
+					isChanged = true;
+				}
+			}
+			for (std::size_t i = 0; i < Locals.size(); ++i) {
+				const bool isDefined = i < state.Locals.size() && state.IsDefined[i];
+				if (IsDefined[i] && !isDefined) {
+					IsDefined[i] = false;
+					isChanged = true;
+				} else if (IsDefined[i] && Locals[i].Type && Locals[i] != state.Locals[i]) {
+					Locals[i] = {};
+					isChanged = true;
+				}
+			}
+			return VerifierError::None;
+		}
+	};
+
+	namespace {
+		bool IsInteger(const TypeInfo* type) noexcept {
+			return type->Code == TypeCode::Int || type->Code == TypeCode::Long;
+		}
+		bool IsNumeric(const TypeInfo* type) noexcept {
+			return IsInteger(type) || type->Code == TypeCode::Single || type->Code == TypeCode::Double;
+		}
+		bool IsPointer(const TypeInfo* type) noexcept {
+			return type->Code == TypeCode::Pointer || type->Code == TypeCode::GCPointer;
+		}
+		bool IsNumericOrPointer(const TypeInfo* type) noexcept {
+			return IsNumeric(type) || IsPointer(type);
+		}
+	}
+}
+
+namespace svm::core {
+	Verifier::Verifier(const ByteFile& byteFile) noexcept
+		: Verifier(byteFile, {}, {}) {}
+	Verifier::Verifier(const ByteFile& byteFile, std::vector<FunctionSignature> mappedFunctions,
+		std::vector<const StructureInfo*> mappedStructures) noexcept
+		: m_ByteFile(byteFile), m_MappedFunctions(std::move(mappedFunctions)), m_MappedStructures(std::move(mappedStructures)) {}
+
+	VerifierResult Verifier::Verify(FunctionInfo& function) const {
+		const VerifierResult result = Verify(function.Instructions, function.Arity, function.HasResult);
+		function.Verification = result.Level;
+		return result;
+	}
+	VerifierResult Verifier::Verify(const Instructions& instructions, std::uint16_t arity, bool hasResult) const {
+		VerifierResult result;
+		if (result.Error = CheckOperands(instructions, result.Instruction); result.Error != VerifierError::None) return result;
+
+		const ControlFlowGraph graph(instructions);
+		const std::uint32_t blockCount = graph.GetBlockCount();
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+
+		std::vector<State> states(blockCount);
+		std::vector<std::uint32_t> worklist;
+		std::vector<bool> isQueued(blockCount);
+		if (blockCount) {
+			states[0].IsVisited = true;
+			states[0].Locals.assign(arity, Value());
+			states[0].IsDefined.assign(arity, true);
+			worklist.push_back(0);
+			isQueued[0] = true;
+		}
+
+		bool isTypeSafe = true;
+		State state;
+		while (!worklist.empty()) {
+			const std::uint32_t block = worklist.back();
+			worklist.pop_back();
+			isQueued[block] = false;
+
+			state = states[block];
+			const BasicBlock& range = graph.GetBlock(block);
+			for (std::uint64_t i = range.Begin; i < range.End; ++i) {
+				const Instruction& inst = instructions.GetInstruction(i);
+				if (result.Error = Interpret(inst, state, hasResult, isTypeSafe); result.Error != VerifierError::None) {
+					result.Instruction = i;
+					return result;
+				}
+			}
+
+			const OpCode last = instructions.GetInstruction(range.End - 1).OpCode;
+			if (range.End == instCount && !IsTerminator(last)) {
+				result.Error = VerifierError::FallOffEnd;
+				result.Instruction = range.End - 1;
+				return result;
+			}
+
+			for (const std::uint32_t successor : graph.GetSuccessors(block)) {
+				bool isChanged = false;
+				if (result.Error = states[successor].Merge(state, isChanged); result.Error != VerifierError::None) {
+					result.Instruction = graph.GetBlock(successor).Begin;
+					return result;
+				}
+				if (isChanged && !isQueued[successor]) {
+					worklist.push_back(successor);
+					isQueued[successor] = true;
+				}
+			}
+		}
+
+		result.Level = isTypeSafe ? VerificationLevel::TypeSafe : VerificationLevel::Structural;
+		return result;
+	}
+
+	VerifierError Verifier::CheckOperands(const Instructions& instructions, std::uint64_t& index) const {
+		const std::uint32_t labelCount = instructions.GetLabelCount();
+		const std::uint64_t instCount = instructions.GetInstructionCount();
+		const std::uint32_t constCount = m_ByteFile.GetConstantPool().GetAllCount();
+
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			if (instructions.GetLabel(i) >= instCount) return VerifierError::InvalidLabel;
+		}
+
+		FunctionSignature signature;
+		for (index = 0; index < instCount; ++index) {
+			const Instruction& inst = instructions.GetInstruction(index);
+			if (inst.OpCode >= OpCode::Count) return VerifierError::InvalidOpCode;
+
+			switch (inst.OpCode) {
+			case OpCode::Push:
+				if (inst.Operand >= constCount &&
+					!GetType(static_cast<std::uint32_t>(TypeCode::Structure) + inst.Operand - constCount)) return VerifierError::InvalidConstant;
+				break;
+
+			case OpCode::Jmp:
+			case OpCode::Je:
+			case OpCode::Jne:
+			case OpCode::Ja:
+			case OpCode::Jae:
+			case OpCode::Jb:
+			case OpCode::Jbe:
+				if (inst.Operand >= labelCount) return VerifierError::InvalidLabel;
+				break;
+
+			case OpCode::Call:
+				if (!GetSignature(inst.Operand, signature)) return VerifierError::InvalidFunction;
+				break;
+
+			case OpCode::New:
+			case OpCode::GCNew:
+			case OpCode::APush:
+			case OpCode::ANew:
+			case OpCode::AGCNew:
+				if (!GetType(inst.Operand)) return VerifierError::InvalidType;
+				break;
+
+			default:
+				break;
+			}
+		}
+		return VerifierError::None;
+	}
+	VerifierError Verifier::Interpret(const Instruction& instruction, State& state, bool hasResult, bool& isTypeSafe) const {
+		std::vector<Value>& stack = state.Stack;
+		const auto top = [&stack](std::size_t index = 0) -> const Value& {
+			return stack[stack.size() - 1 - index];
+		};
+		const auto push = [&stack](const TypeInfo* type, const TypeInfo* pointee = nullptr, bool isArray = false) {
+			stack.push_back({ type, pointee, isArray });
+		};
+		// Unknown operand types cannot be rejected, but they leave a dynamic check to the engine.
+		const auto check = [&isTypeSafe](const Value& value, bool (*predicate)(const TypeInfo*)) {
+			if (!value.Type) return isTypeSafe = false, true;
+			return predicate(value.Type);
+		};
+		const auto checkBinary = [&](bool (*predicate)(const TypeInfo*)) {
+			if (!check(top(), predicate) || !check(top(1), predicate)) return false;
+			return !top().Type || !top(1).Type || top().Type == top(1).Type;
+		};
+		const auto require = [&stack](std::size_t count) {
+			return stack.size() >= count;
+		};
+
+		switch (instruction.OpCode) {
+		case OpCode::Nop:
+		case OpCode::Jmp:
+			return VerifierError::None;
+
+		case OpCode::Push: {
+			const ConstantPool& constantPool = m_ByteFile.GetConstantPool();
+			if (instruction.Operand < constantPool.GetAllCount()) {
+				push(constantPool.GetConstantType(instruction.Operand).GetPointer());
+			} else {
+				push(GetType(static_cast<std::uint32_t>(TypeCode::Structure) + instruction.Operand - constantPool.GetAllCount()));
+			}
+			return VerifierError::None;
+		}
+
+		case OpCode::Pop:
+			if (!require(1)) return VerifierError::StackUnderflow;
+			stack.pop_back();
+			return VerifierError::None;
+
+		case OpCode::Load:
+			if (instruction.Operand >= state.Locals.size() || !state.IsDefined[instruction.Operand]) return VerifierError::InvalidLocal;
+			stack.push_back(state.Locals[instruction.Operand]);
+			return VerifierError::None;
+
+		case OpCode::Store: {
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (instruction.Operand >= state.Locals.size()) {
+				state.Locals.resize(static_cast<std::size_t>(instruction.Operand) + 1);
+				state.IsDefined.resize(static_cast<std::size_t>(instruction.Operand) + 1);
+			}
+
+			Value& local = state.Locals[instruction.Operand];
+			if (state.IsDefined[instruction.Operand] && local.Type && top().Type && local.Type != top().Type) return VerifierError::TypeMismatch;
+			if (!state.IsDefined[instruction.Operand] || local.Type) {
+				local = top();
+			}
+			state.IsDefined[instruction.Operand] = true;
+			stack.pop_back();
+			return VerifierError::None;
+		}
+
+		case OpCode::Lea:
+			if (instruction.Operand >= state.Locals.size() || !state.IsDefined[instruction.Operand]) return VerifierError::InvalidLocal;
+			push(PointerType.GetPointer(), state.Locals[instruction.Operand].Type);
+			return VerifierError::None;
+
+		case OpCode::FLea: {
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsPointer)) return VerifierError::TypeMismatch;
+
+			const TypeInfo* fieldType = nullptr;
+			bool isArray = false;
+			if (const TypeInfo* const pointee = top().Pointee; pointee && !top().IsArray) {
+				const StructureInfo* const structure = GetStructure(pointee);
+				if (!structure) return VerifierError::TypeMismatch;
+				if (instruction.Operand >= structure->Fields.size()) return VerifierError::InvalidType;
+
+				const Field& field = structure->Fields[instruction.Operand];
+				fieldType = field.Type.GetPointer();
+				isArray = field.IsArray();
+			} else {
+				isTypeSafe = false;
+			}
+
+			stack.pop_back();
+			push(PointerType.GetPointer(), fieldType, isArray);
+			return VerifierError::None;
+		}
+
+		case OpCode::TLoad: {
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsPointer)) return VerifierError::TypeMismatch;
+
+			const Value pointer = top();
+			if (!pointer.Pointee || pointer.IsArray) {
+				isTypeSafe = false;
+			}
+			stack.pop_back();
+			push(pointer.IsArray ? nullptr : pointer.Pointee);
+			return VerifierError::None;
+		}
+
+		case OpCode::TStore:
+			if (!require(2)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsPointer)) return VerifierError::TypeMismatch;
+			if (!top().Pointee || top().IsArray || !top(1).Type) {
+				isTypeSafe = false;
+			} else if (top().Pointee != top(1).Type) return VerifierError::TypeMismatch;
+
+			stack.resize(stack.size() - 2);
+			return VerifierError::None;
+
+		case OpCode::Copy:
+			if (!require(1)) return VerifierError::StackUnderflow;
+			stack.push_back(top());
+			return VerifierError::None;
+
+		case OpCode::Swap:
+			if (!require(2)) return VerifierError::StackUnderflow;
+			std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+			return VerifierError::None;
+
+		case OpCode::Add:
+		case OpCode::Sub:
+		case OpCode::Mul:
+		case OpCode::Div:
+		case OpCode::Mod:
+		case OpCode::IMul:
+		case OpCode::IDiv:
+		case OpCode::IMod:
+		case OpCode::And:
+		case OpCode::Or:
+		case OpCode::Xor:
+		case OpCode::Shl:
+		case OpCode::Shr:
+		case OpCode::Sal:
+		case OpCode::Sar: {
+			if (!require(2)) return VerifierError::StackUnderflow;
+
+			const bool isInteger = instruction.OpCode >= OpCode::IMul && instruction.OpCode != OpCode::Div && instruction.OpCode != OpCode::Mod;
+			if (!checkBinary(isInteger ? IsInteger : IsNumeric)) return VerifierError::TypeMismatch;
+
+			const TypeInfo* const type = top(1).Type ? top(1).Type : top().Type;
+			stack.resize(stack.size() - 2);
+			push(type);
+			return VerifierError::None;
+		}
+
+		case OpCode::Neg:
+		case OpCode::Inc:
+		case OpCode::Dec:
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsNumeric)) return VerifierError::TypeMismatch;
+			return VerifierError::None;
+
+		case OpCode::Not:
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsInteger)) return VerifierError::TypeMismatch;
+			return VerifierError::None;
+
+		case OpCode::Cmp:
+		case OpCode::ICmp:
+			if (!require(2)) return VerifierError::StackUnderflow;
+			if (!checkBinary(instruction.OpCode == OpCode::Cmp ? IsNumericOrPointer : IsInteger)) return VerifierError::TypeMismatch;
+
+			stack.resize(stack.size() - 2);
+			push(IntType.GetPointer());
+			return VerifierError::None;
+
+		case OpCode::Je:
+		case OpCode::Jne:
+		case OpCode::Ja:
+		case OpCode::Jae:
+		case OpCode::Jb:
+		case OpCode::Jbe:
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), [](const TypeInfo* type) { return type->Code == TypeCode::Int; })) return VerifierError::TypeMismatch;
+			stack.pop_back();
+			return VerifierError::None;
+
+		case OpCode::Call: {
+			FunctionSignature signature;
+			GetSignature(instruction.Operand, signature);
+			if (!require(signature.Arity)) return VerifierError::StackUnderflow;
+
+			stack.resize(stack.size() - signature.Arity);
+			if (signature.HasResult) {
+				push(nullptr);
+			}
+			return VerifierError::None;
+		}
+
+		case OpCode::Ret:
+			if (hasResult && !require(1)) return VerifierError::MissingResult;
+			return VerifierError::None;
+
+		case OpCode::ToB:
+		case OpCode::ToSh:
+		case OpCode::ToI:
+		case OpCode::ToL:
+		case OpCode::ToSi:
+		case OpCode::ToD:
+		case OpCode::ToP: {
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsNumericOrPointer)) return VerifierError::TypeMismatch;
+
+			static const Type types[] = { IntType, IntType, IntType, LongType, SingleType, DoubleType, PointerType };
+			stack.pop_back();
+			push(types[static_cast<std::size_t>(instruction.OpCode) - static_cast<std::size_t>(OpCode::ToB)].GetPointer());
+			return VerifierError::None;
+		}
+
+		case OpCode::Null:
+			push(PointerType.GetPointer());
+			return VerifierError::None;
+
+		case OpCode::GCNull:
+			push(GCPointerType.GetPointer());
+			return VerifierError::None;
+
+		case OpCode::New:
+			push(PointerType.GetPointer(), GetType(instruction.Operand));
+			return VerifierError::None;
+
+		case OpCode::GCNew:
+			push(GCPointerType.GetPointer(), GetType(instruction.Operand));
+			return VerifierError::None;
+
+		case OpCode::Delete:
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), [](const TypeInfo* type) { return type->Code == TypeCode::Pointer; })) return VerifierError::TypeMismatch;
+			stack.pop_back();
+			return VerifierError::None;
+
+		case OpCode::APush:
+		case OpCode::ANew:
+		case OpCode::AGCNew: {
+			if (!require(1)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsInteger)) return VerifierError::TypeMismatch;
+
+			static const Type types[] = { ArrayType, PointerType, GCPointerType };
+			stack.pop_back();
+			push(types[static_cast<std::size_t>(instruction.OpCode) - static_cast<std::size_t>(OpCode::APush)].GetPointer(),
+				GetType(instruction.Operand), true);
+			return VerifierError::None;
+		}
+
+		case OpCode::ALea: {
+			if (!require(2)) return VerifierError::StackUnderflow;
+			if (!check(top(), IsInteger)) return VerifierError::TypeMismatch;
+
+			const Value& array = top(1);
+			if (array.Type && !((array.Type->Code == TypeCode::Array || IsPointer(array.Type)) && (array.IsArray || !array.Pointee)))
+				return VerifierError::TypeMismatch;
+			if (!array.Type || !array.IsArray) {
+				isTypeSafe = false;
+			}
+
+			const TypeInfo* const element = array.IsArray ? array.Pointee : nullptr;
+			stack.resize(stack.size() - 2);
+			push(PointerType.GetPointer(), element);
+			return VerifierError::None;
+		}
+
+		default:
+			return VerifierError::InvalidOpCode;
+		}
+	}
+	bool Verifier::GetSignature(std::uint32_t function, FunctionSignature& result) const noexcept {
+		const Functions& functions = m_ByteFile.GetFunctions();
+		if (function < functions.size()) {
+			result.Arity = functions[function].Arity;
+			result.HasResult = functions[function].HasResult;
+			return true;
+		}
+
+		const std::size_t mapping = function - functions.size();
+		if (mapping >= m_MappedFunctions.size()) return false;
+
+		result = m_MappedFunctions[mapping];
+		return true;
+	}
+	const TypeInfo* Verifier::GetType(std::uint32_t code) const noexcept {
+		if (const Type type = GetFundamentalType(static_cast<TypeCode>(code)); type != NoneType) return type.GetPointer();
+		if (code < static_cast<std::uint32_t>(TypeCode::Structure)) return nullptr;
+
+		const Structures& structures = m_ByteFile.GetStructures();
+		const std::uint32_t index = code - static_cast<std::uint32_t>(TypeCode::Structure);
+		if (index < structures.size()) return &structures[index].Type;
+
+		const std::size_t mapping = index - structures.size();
+		return mapping < m_MappedStructures.size() ? &m_MappedStructures[mapping]->Type : nullptr;
+	}
+	const StructureInfo* Verifier::GetStructure(const TypeInfo* type) const noexcept {
+		if (type->Code < TypeCode::Structure) return nullptr;
+
+		for (const StructureInfo& structure : m_ByteFile.GetStructures()) {
+			if (&structure.Type == type) return &structure;
+		}
+		for (const StructureInfo* structure : m_MappedStructures) {
+			if (&structure->Type == type) return structure;
+		}
+		return nullptr;
+	}
+}
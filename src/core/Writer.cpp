@@ -0,0 +1,266 @@
+#include <svm/core/Writer.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <utility>
+
+namespace svm::core {
+	namespace {
+		constexpr std::uint8_t s_Magic[] = { 0x74, 0x68, 0x74, 0x68 };
+		constexpr std::size_t s_SectionInfoSize = sizeof(std::uint64_t) * 2;
+	}
+
+	void Writer::Clear() noexcept {
+		m_Buffer.clear();
+		m_Cursor = 0;
+	}
+
+	void Writer::Write(const ByteFile& byteFile) {
+		const auto& functions = byteFile.GetFunctions();
+		const auto funcCount = functions.size();
+		const auto sectionCount = static_cast<std::size_t>(ShitBFSection::Count);
+
+		std::size_t sectionSizes[sectionCount] = {
+			CalcSize(byteFile.GetDependencies()),
+			CalcSize(byteFile.GetMappings()),
+			CalcSize(byteFile.GetConstantPool()),
+			CalcSize(byteFile.GetStructures()),
+			sizeof(std::uint32_t),
+			CalcSize(byteFile.GetEntrypoint()),
+		};
+		std::vector<std::size_t> funcSizes(funcCount);
+		for (std::size_t i = 0; i < funcCount; ++i) {
+			sectionSizes[static_cast<std::size_t>(ShitBFSection::Functions)] += funcSizes[i] = CalcSize(functions[i]);
+		}
+
+		const std::size_t headerSize = sizeof(s_Magic) + sizeof(ShitBFVersion) + sizeof(ShitBCVersion)
+			+ sizeof(std::uint32_t) + sectionCount * (sizeof(std::uint32_t) + s_SectionInfoSize)
+			+ sizeof(std::uint32_t) + funcCount * s_SectionInfoSize;
+		std::size_t totalSize = headerSize;
+		for (const std::size_t size : sectionSizes) {
+			totalSize += size;
+		}
+
+		m_Buffer.assign(totalSize, 0);
+		m_Cursor = 0;
+
+		std::memcpy(m_Buffer.data(), s_Magic, sizeof(s_Magic));
+		m_Cursor += sizeof(s_Magic);
+		WriteFile(ShitBFVersion::Latest);
+		WriteFile(ShitBCVersion::Latest);
+
+		WriteFile(static_cast<std::uint32_t>(sectionCount));
+		std::uint64_t offset = headerSize;
+		for (std::size_t i = 0; i < sectionCount; ++i) {
+			WriteFile(static_cast<std::uint32_t>(i));
+			WriteSectionInfo(offset, sectionSizes[i]);
+			offset += sectionSizes[i];
+		}
+
+		WriteFile(static_cast<std::uint32_t>(funcCount));
+		offset = headerSize;
+		for (std::size_t i = 0; i < static_cast<std::size_t>(ShitBFSection::Functions); ++i) {
+			offset += sectionSizes[i];
+		}
+		offset += sizeof(std::uint32_t);
+		for (std::size_t i = 0; i < funcCount; ++i) {
+			WriteSectionInfo(offset, funcSizes[i]);
+			offset += funcSizes[i];
+		}
+
+		WriteDependencies(byteFile.GetDependencies());
+		WriteMappings(byteFile.GetMappings());
+		WriteConstantPool(byteFile.GetConstantPool());
+		WriteStructures(byteFile.GetStructures(), byteFile.GetMappings(), byteFile.GetDependencies());
+		WriteFile(static_cast<std::uint32_t>(funcCount));
+		for (const FunctionInfo& function : functions) {
+			WriteFunction(function);
+		}
+		WriteInstructions(byteFile.GetEntrypoint());
+	}
+	void Writer::Save(const std::filesystem::path& path) const {
+		std::ofstream stream(path, std::ofstream::binary);
+		if (!stream) throw std::runtime_error("Failed to open the file.");
+
+		Save(stream);
+	}
+	void Writer::Save(std::ostream& stream) const {
+		stream.write(reinterpret_cast<const char*>(m_Buffer.data()), static_cast<std::streamsize>(m_Buffer.size()));
+		if (!stream) throw std::runtime_error("Failed to write the file.");
+	}
+	const std::vector<std::uint8_t>& Writer::GetResult() const noexcept {
+		return m_Buffer;
+	}
+	std::vector<std::uint8_t> Writer::GetResult() noexcept {
+		m_Cursor = 0;
+		return std::move(m_Buffer);
+	}
+
+	void Writer::WriteSectionInfo(std::uint64_t offset, std::uint64_t size) noexcept {
+		WriteFile(offset);
+		WriteFile(size);
+	}
+
+	std::size_t Writer::CalcSize(std::string_view string) noexcept {
+		return sizeof(std::uint32_t) + string.size();
+	}
+	std::size_t Writer::CalcSize(const std::vector<Dependency>& dependencies) noexcept {
+		std::size_t result = sizeof(std::uint32_t);
+		for (const Dependency& dependency : dependencies) {
+			result += CalcSize(dependency.Path);
+		}
+		return result;
+	}
+	std::size_t Writer::CalcSize(const Mappings& mappings) noexcept {
+		std::size_t result = sizeof(std::uint32_t) * 2;
+
+		const auto structMappingCount = mappings.GetStructureMappingCount();
+		for (std::uint32_t i = 0; i < structMappingCount; ++i) {
+			result += sizeof(std::uint32_t) + CalcSize(mappings.GetStructureMapping(i).Name);
+		}
+
+		const auto funcMappingCount = mappings.GetFunctionMappingCount();
+		for (std::uint32_t i = 0; i < funcMappingCount; ++i) {
+			result += sizeof(std::uint32_t) + CalcSize(mappings.GetFunctionMapping(i).Name);
+		}
+		return result;
+	}
+	std::size_t Writer::CalcSize(const ConstantPool& constantPool) noexcept {
+		return sizeof(std::uint32_t) * 4
+			+ constantPool.GetIntCount() * sizeof(IntObject::Value)
+			+ constantPool.GetLongCount() * sizeof(LongObject::Value)
+			+ constantPool.GetSingleCount() * sizeof(SingleObject::Value)
+			+ constantPool.GetDoubleCount() * sizeof(DoubleObject::Value);
+	}
+	std::size_t Writer::CalcSize(const Structures& structures) noexcept {
+		std::size_t result = sizeof(std::uint32_t);
+		for (const StructureInfo& structure : structures) {
+			result += CalcSize(structure.Name) + sizeof(std::uint32_t);
+			for (const Field& field : structure.Fields) {
+				result += sizeof(std::uint32_t);
+				if (field.IsArray()) {
+					result += sizeof(std::uint64_t);
+				}
+			}
+		}
+		return result;
+	}
+	std::size_t Writer::CalcSize(const FunctionInfo& function) {
+		return CalcSize(function.Name) + sizeof(std::uint16_t) + sizeof(std::uint8_t)
+			+ sizeof(std::uint8_t) + sizeof(std::uint32_t) + sizeof(std::uint64_t) + sizeof(std::uint32_t)
+			+ CalcSize(function.Instructions);
+	}
+	std::size_t Writer::CalcSize(const Instructions& instructions) {
+		const auto instCount = instructions.GetInstructionCount();
+
+		std::size_t result = sizeof(std::uint32_t) + instructions.GetLabelCount() * sizeof(std::uint64_t)
+			+ sizeof(std::uint64_t) + static_cast<std::size_t>(instCount);
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			if (inst.OpCode >= OpCode::Count) throw std::runtime_error("Failed to write the file. Fused or unknown instructions cannot be stored.");
+			if (inst.HasOperand()) {
+				result += sizeof(std::uint32_t);
+			}
+		}
+		return result;
+	}
+
+	void Writer::WriteDependencies(const std::vector<Dependency>& dependencies) noexcept {
+		WriteFile(static_cast<std::uint32_t>(dependencies.size()));
+		for (const Dependency& dependency : dependencies) {
+			WriteFileString(dependency.Path);
+		}
+	}
+	void Writer::WriteMappings(const Mappings& mappings) noexcept {
+		const auto structMappingCount = mappings.GetStructureMappingCount();
+		WriteFile(structMappingCount);
+		for (std::uint32_t i = 0; i < structMappingCount; ++i) {
+			const StructureMapping& mapping = mappings.GetStructureMapping(i);
+			WriteFile(mapping.Module);
+			WriteFileString(mapping.Name);
+		}
+
+		const auto funcMappingCount = mappings.GetFunctionMappingCount();
+		WriteFile(funcMappingCount);
+		for (std::uint32_t i = 0; i < funcMappingCount; ++i) {
+			const FunctionMapping& mapping = mappings.GetFunctionMapping(i);
+			WriteFile(mapping.Module);
+			WriteFileString(mapping.Name);
+		}
+	}
+	void Writer::WriteConstantPool(const ConstantPool& constantPool) noexcept {
+		WriteConstants(constantPool.GetIntPool());
+		WriteConstants(constantPool.GetLongPool());
+		WriteConstants(constantPool.GetSinglePool());
+		WriteConstants(constantPool.GetDoublePool());
+	}
+	void Writer::WriteStructures(const Structures& structures, const Mappings& mappings, const std::vector<Dependency>& dependencies) {
+		WriteFile(static_cast<std::uint32_t>(structures.size()));
+		for (const StructureInfo& structure : structures) {
+			WriteFileString(structure.Name);
+			WriteFile(static_cast<std::uint32_t>(structure.Fields.size()));
+
+			for (const Field& field : structure.Fields) {
+				const auto typeCode = static_cast<std::uint32_t>(GetTypeCode(structures, mappings, dependencies, field.Type));
+				if (field.IsArray()) {
+					WriteFile(typeCode | 0x80000000);
+					WriteFile(field.Count);
+				} else {
+					WriteFile(typeCode);
+				}
+			}
+		}
+	}
+	void Writer::WriteFunction(const FunctionInfo& function) {
+		WriteFileString(function.Name);
+		WriteFile(function.Arity);
+		WriteFile(static_cast<std::uint8_t>(function.HasResult));
+		WriteFile(static_cast<std::uint8_t>(function.Frame.IsAnalyzed));
+		WriteFile(function.Frame.MaxStackSlots);
+		WriteFile(function.Frame.MaxStackBytes);
+		WriteFile(function.Frame.LocalCount);
+		WriteInstructions(function.Instructions);
+	}
+	void Writer::WriteInstructions(const Instructions& instructions) {
+		const auto labelCount = instructions.GetLabelCount();
+		WriteFile(labelCount);
+		for (std::uint32_t i = 0; i < labelCount; ++i) {
+			WriteFile(instructions.GetLabel(i));
+		}
+
+		const auto instCount = instructions.GetInstructionCount();
+		WriteFile(instCount);
+		for (std::uint64_t i = 0; i < instCount; ++i) {
+			const Instruction& inst = instructions.GetInstruction(i);
+			WriteFile(ConvertOpCode(inst.OpCode, ShitBCVersion::Latest));
+			if (inst.HasOperand()) {
+				WriteFile(inst.Operand);
+			}
+		}
+	}
+
+	TypeCode Writer::GetTypeCode(const Structures& structures, const Mappings& mappings, const std::vector<Dependency>& dependencies, Type type) {
+		if (type.IsFundamentalType()) return type->Code;
+
+		for (const StructureInfo& structure : structures) {
+			if (&structure.Type == type.GetPointer()) return structure.Type.Code;
+		}
+
+		const auto structCount = static_cast<std::uint32_t>(structures.size());
+		const auto structMappingCount = mappings.GetStructureMappingCount();
+		for (std::uint32_t i = 0; i < structMappingCount; ++i) {
+			const StructureMapping& mapping = mappings.GetStructureMapping(i);
+			if (mapping.Name != type->Name) continue;
+
+			// Unlinked types number their module as a dependency plus one; linked types carry the index the loader gave it.
+			const bool isSameModule = type->Code == TypeCode::None ? type->Module == mapping.Module + 1 :
+				mapping.Module < dependencies.size() && dependencies[mapping.Module].Module && dependencies[mapping.Module].ModuleIndex == type->Module;
+			if (&mapping.TempType == type.GetPointer() || isSameModule)
+				return static_cast<TypeCode>(static_cast<std::uint32_t>(TypeCode::Structure) + structCount + i);
+		}
+
+		throw std::runtime_error("Failed to write the file. Unknown structure type.");
+	}
+}